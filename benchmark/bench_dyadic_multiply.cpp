@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "hexl-fpga.h"
+#include "test_utils/test_vectors.hpp"
 
 class dyadic_multiply : public benchmark::Fixture {
 public:
@@ -25,23 +26,10 @@ void dyadic_multiply::setup_dyadic_multiply_io(uint64_t n_dyadic_multiply,
                                                uint64_t num_moduli,
                                                uint64_t coeff_count) {
     for (uint64_t b = 0; b < n_dyadic_multiply; b++) {
-        for (uint64_t m = 0; m < num_moduli; m++) {
-            moduli.push_back((b + m + 1) * 10);
-        }
-
-        for (uint64_t m = 0; m < num_moduli; m++) {
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                op1.push_back(b + i + 1 + m * coeff_count);
-                op2.push_back(b + i + 2 + m * coeff_count);
-            }
-        }
-
-        for (uint64_t m = 0; m < num_moduli; m++) {
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                op1.push_back(b + i + 11 + m * coeff_count);
-                op2.push_back(b + i + 22 + m * coeff_count);
-            }
-        }
+        hetest::utils::DyadicMultiplyVector tv(coeff_count, num_moduli, 50, b);
+        moduli.insert(moduli.end(), tv.moduli.begin(), tv.moduli.end());
+        op1.insert(op1.end(), tv.operand1.begin(), tv.operand1.end());
+        op2.insert(op2.end(), tv.operand2.begin(), tv.operand2.end());
     }
 }
 
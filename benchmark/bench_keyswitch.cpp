@@ -1,8 +1,6 @@
 // Copyright (C) 2020-2021 Intel Corporation
 // SPDX-License-Identifier: Apache-2.0
 //
-#include <glob.h>
-#include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -11,6 +9,8 @@
 #include <benchmark/benchmark.h>
 
 #include "hexl-fpga.h"
+#include "test_utils/keyswitch_test_vector.hpp"
+#include "test_utils/test_vectors.hpp"
 
 static uint32_t get_iter() {
     char* env = getenv("ITER");
@@ -23,61 +23,13 @@ static uint32_t get_iter() {
 
 static uint32_t n_iter = get_iter();
 
-struct KeySwitchTestVector {
-    explicit KeySwitchTestVector(const char* json_filename);
-
-    size_t coeff_count;
-    size_t decomp_modulus_size;
-    size_t key_modulus_size;
-    size_t rns_modulus_size;
-    size_t key_component_count;
-
-    std::vector<uint64_t> moduli;
-    std::vector<uint64_t> modswitch_factors;
-    std::vector<const uint64_t*> key_vectors;
-
-    std::vector<uint64_t> t_target_iter_ptr;
-    std::vector<uint64_t> input;
-    std::vector<uint64_t> expected_output;
-
-    std::vector<std::vector<uint64_t>> vectors;
-
-private:
-    std::ifstream json_file;
-    nlohmann::json js;
-};
-
-KeySwitchTestVector::KeySwitchTestVector(const char* json_filename)
-    : json_file(json_filename) {
-    json_file >> js;
-
-    coeff_count = js["coeff_count"].get<uint64_t>();
-    decomp_modulus_size = js["decomp_modulus_size"].get<uint64_t>();
-    key_modulus_size = js["key_modulus_size"].get<uint64_t>();
-    rns_modulus_size = js["rns_modulus_size"].get<uint64_t>();
-    key_component_count = js["key_component_count"].get<uint64_t>();
-
-    moduli = js["moduli"].get<std::vector<uint64_t>>();
-    modswitch_factors = js["modswitch_factors"].get<std::vector<uint64_t>>();
-
-    for (uint64_t k = 0; k < decomp_modulus_size; k++) {
-        std::vector<uint64_t> key_vector;
-        for (uint64_t i = 0; i < 2 * key_modulus_size * coeff_count; i++) {
-            key_vector.push_back(js["key_vector"][k][i]);
-        }
-        vectors.push_back(key_vector);
-        key_vectors.push_back(const_cast<uint64_t*>(&vectors[k].data()[0]));
-    }
-
-    t_target_iter_ptr = js["t_target_iter_ptr"].get<std::vector<uint64_t>>();
-    input = js["input"].get<std::vector<uint64_t>>();
-}
+using hetest::utils::KeySwitchTestVector;
 
 class keyswitch : public benchmark::Fixture {
 public:
-    std::vector<std::string> glob(const char* pattern);
     void setup_keyswitch(const std::vector<std::string>& files);
     void bench_keyswitch();
+    void run(benchmark::State& state, const std::string& test_file);
 
     enum { ITERATIONS = 40 };
 
@@ -86,19 +38,6 @@ private:
     size_t test_vector_size_;
 };
 
-std::vector<std::string> keyswitch::glob(const char* pattern) {
-    glob_t glob_result = {0};
-
-    ::glob(pattern, GLOB_TILDE, NULL, &glob_result);
-
-    std::vector<std::string> filenames(
-        glob_result.gl_pathv, glob_result.gl_pathv + glob_result.gl_pathc);
-
-    globfree(&glob_result);
-
-    return filenames;
-}
-
 void keyswitch::setup_keyswitch(const std::vector<std::string>& files) {
     for (size_t i = 0; i < files.size(); i++) {
         std::cout << "Constructing Test Vector " << i << " from File ... "
@@ -130,8 +69,7 @@ void keyswitch::bench_keyswitch() {
     intel::hexl::KeySwitchCompleted();
 }
 
-BENCHMARK_F(keyswitch, 16384_6_7_7_2)
-(benchmark::State& state) {
+void keyswitch::run(benchmark::State& state, const std::string& test_file) {
     const char* fname = getenv("KEYSWITCH_DATA_DIR");
     if (!fname) {
         std::cerr << "set env KEYSWITCH_DATA_DIR to the test vector dir"
@@ -139,9 +77,9 @@ BENCHMARK_F(keyswitch, 16384_6_7_7_2)
         exit(1);
     }
 
-    std::string test_file = "/16384_6_7_7_2_*";
-    std::string test_fullname = fname + test_file + ".json";
-    std::vector<std::string> filesx = glob(test_fullname.c_str());
+    std::string test_fullname = fname + test_file;
+    std::vector<std::string> filesx =
+        hetest::utils::GlobTestVectors(test_fullname);
 
     std::vector<std::string> files;
     for (size_t i = 0; i < filesx.size(); i++) {
@@ -157,3 +95,65 @@ BENCHMARK_F(keyswitch, 16384_6_7_7_2)
         bench_keyswitch();
     }
 }
+
+BENCHMARK_F(keyswitch, 16384_6_7_7_2)
+(benchmark::State& state) { run(state, "/16384_6_7_7_2_*"); }
+
+// requires libkeyswitch_32k.so
+BENCHMARK_F(keyswitch, 32768_6_7_7_2)
+(benchmark::State& state) { run(state, "/32768_6_7_7_2_*"); }
+
+// random operations generated in memory, of any shape
+// n x decomp_modulus_size x key_modulus_size, without test vector files
+class keyswitch_synthetic : public benchmark::Fixture {
+public:
+    void bench_keyswitch();
+    void run(benchmark::State& state);
+
+private:
+    std::vector<hetest::utils::KeySwitchVector> test_vectors_;
+};
+
+void keyswitch_synthetic::bench_keyswitch() {
+    intel::hexl::set_worksize_KeySwitch(test_vectors_.size() * n_iter);
+
+    hetest::utils::KeySwitchVector& tv = test_vectors_[0];
+    for (size_t n = 0; n < n_iter; n++) {
+        for (size_t i = 0; i < test_vectors_.size(); i++) {
+            intel::hexl::KeySwitch(
+                test_vectors_[i].input.data(),
+                test_vectors_[i].t_target_iter_ptr.data(), tv.coeff_count,
+                tv.decomp_modulus_size, tv.key_modulus_size,
+                tv.rns_modulus_size, tv.key_component_count, tv.moduli.data(),
+                tv.key_vectors.data(), tv.modswitch_factors.data(),
+                tv.twiddle_factors.data());
+        }
+    }
+    intel::hexl::KeySwitchCompleted();
+}
+
+void keyswitch_synthetic::run(benchmark::State& state) {
+    test_vectors_.clear();
+    // as many operations as test vector files of a shape
+    for (uint64_t i = 0; i < 2; i++) {
+        test_vectors_.emplace_back(state.range(0), state.range(1),
+                                   state.range(2), 50, i);
+    }
+
+    // warm up the FPGA kernels specially the twiddle factor dispatching kernel
+    bench_keyswitch();
+
+    for (auto st : state) {
+        bench_keyswitch();
+    }
+}
+
+BENCHMARK_DEFINE_F(keyswitch_synthetic, shape)
+(benchmark::State& state) { run(state); }
+
+BENCHMARK_REGISTER_F(keyswitch_synthetic, shape)
+    ->ArgNames({"n", "decomp", "key"})
+    ->Args({16384, 6, 7})
+    ->Args({16384, 3, 4})
+    ->Args({8192, 3, 4})
+    ->Args({4096, 2, 3});
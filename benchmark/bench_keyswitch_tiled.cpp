@@ -0,0 +1,211 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+
+#include <benchmark/benchmark.h>
+
+#include "hexl-fpga.h"
+#include "test_utils/keyswitch_test_vector.hpp"
+#include "test_utils/test_vectors.hpp"
+
+static uint32_t get_iter() {
+    char* env = getenv("ITER");
+    uint32_t val = 40;
+    if (env) {
+        val = strtol(env, NULL, 10);
+    }
+    return val;
+}
+
+static uint32_t n_iter = get_iter();
+
+using hetest::utils::KeySwitchTestVector;
+
+class keyswitch_tiled : public benchmark::Fixture {
+public:
+    void run(benchmark::State& state, uint64_t special_modulus_size,
+             uint64_t dnum);
+
+private:
+    void bench_keyswitch(uint64_t special_modulus_size, uint64_t dnum);
+
+    std::vector<KeySwitchTestVector> test_vectors_;
+    std::vector<uint64_t*> results_;
+    std::vector<const uint64_t*> t_target_iter_ptrs_;
+};
+
+void keyswitch_tiled::bench_keyswitch(uint64_t special_modulus_size,
+                                      uint64_t dnum) {
+    KeySwitchTestVector& tv = test_vectors_[0];
+    for (size_t n = 0; n < n_iter; n++) {
+        intel::hexl::KeySwitchHybrid(
+            results_.data(), t_target_iter_ptrs_.data(), results_.size(),
+            tv.coeff_count, tv.decomp_modulus_size, tv.key_modulus_size,
+            special_modulus_size, dnum, tv.key_component_count,
+            tv.moduli.data(), tv.key_vectors.data());
+    }
+}
+
+// the test vectors hold per-limb keys: the first dnum of them stand in for
+// the keys of the coarser decompositions, which only changes the results.
+void keyswitch_tiled::run(benchmark::State& state,
+                          uint64_t special_modulus_size, uint64_t dnum) {
+    const char* fname = getenv("KEYSWITCH_DATA_DIR");
+    if (!fname) {
+        std::cerr << "set env KEYSWITCH_DATA_DIR to the test vector dir"
+                  << std::endl;
+        exit(1);
+    }
+
+    std::string test_fullname = std::string(fname) + "/16384_6_7_7_2_*";
+    std::vector<std::string> files =
+        hetest::utils::GlobTestVectors(test_fullname);
+    for (size_t i = 0; i < files.size(); i++) {
+        std::cout << "Constructing Test Vector " << i << " from File ... "
+                  << files[i] << std::endl;
+        test_vectors_.push_back(KeySwitchTestVector(files[i].c_str()));
+    }
+    assert(test_vectors_.size() > 0);
+
+    for (auto& tv : test_vectors_) {
+        results_.push_back(tv.input.data());
+        t_target_iter_ptrs_.push_back(tv.t_target_iter_ptr.data());
+    }
+
+    // warm up the twiddle factors and the packed keys
+    bench_keyswitch(special_modulus_size, dnum);
+
+    for (auto st : state) {
+        bench_keyswitch(special_modulus_size, dnum);
+    }
+}
+
+// dnum = 6, one special modulus: the per-limb decomposition of KeySwitch
+BENCHMARK_F(keyswitch_tiled, 16384_6_7_7_2_dnum6)
+(benchmark::State& state) { run(state, 1, 6); }
+
+BENCHMARK_F(keyswitch_tiled, 16384_6_7_7_2_dnum3)
+(benchmark::State& state) { run(state, 1, 3); }
+
+BENCHMARK_F(keyswitch_tiled, 16384_6_7_7_2_dnum2)
+(benchmark::State& state) { run(state, 1, 2); }
+
+// random operations generated in memory, of several special moduli:
+// n = 16384 x decomp_modulus_size x key_modulus_size x special_modulus_size x
+// dnum. The generated vectors hold decomp_modulus_size keys, the first dnum
+// of which are used.
+class keyswitch_tiled_synthetic : public benchmark::Fixture {
+public:
+    void run(benchmark::State& state);
+
+private:
+    void bench_keyswitch(uint64_t special_modulus_size, uint64_t dnum);
+
+    std::vector<hetest::utils::KeySwitchVector> test_vectors_;
+    std::vector<uint64_t*> results_;
+    std::vector<const uint64_t*> t_target_iter_ptrs_;
+};
+
+void keyswitch_tiled_synthetic::bench_keyswitch(uint64_t special_modulus_size,
+                                                uint64_t dnum) {
+    hetest::utils::KeySwitchVector& tv = test_vectors_[0];
+    for (size_t n = 0; n < n_iter; n++) {
+        intel::hexl::KeySwitchHybrid(
+            results_.data(), t_target_iter_ptrs_.data(), results_.size(),
+            tv.coeff_count, tv.decomp_modulus_size, tv.key_modulus_size,
+            special_modulus_size, dnum, tv.key_component_count,
+            tv.moduli.data(), tv.key_vectors.data());
+    }
+}
+
+void keyswitch_tiled_synthetic::run(benchmark::State& state) {
+    test_vectors_.clear();
+    results_.clear();
+    t_target_iter_ptrs_.clear();
+    for (uint64_t i = 0; i < 2; i++) {
+        test_vectors_.emplace_back(16384, state.range(0), state.range(1), 50,
+                                   i);
+    }
+    for (auto& tv : test_vectors_) {
+        results_.push_back(tv.input.data());
+        t_target_iter_ptrs_.push_back(tv.t_target_iter_ptr.data());
+    }
+
+    // warm up the twiddle factors and the packed keys
+    bench_keyswitch(state.range(2), state.range(3));
+
+    for (auto st : state) {
+        bench_keyswitch(state.range(2), state.range(3));
+    }
+}
+
+BENCHMARK_DEFINE_F(keyswitch_tiled_synthetic, shape)
+(benchmark::State& state) { run(state); }
+
+BENCHMARK_REGISTER_F(keyswitch_tiled_synthetic, shape)
+    ->ArgNames({"decomp", "key", "special", "dnum"})
+    ->Args({6, 7, 1, 6})
+    ->Args({8, 10, 2, 4})
+    ->Args({8, 10, 2, 2})
+    ->Args({8, 11, 3, 2})
+    ->Args({12, 15, 3, 3});
+
+// the per-limb keyswitch of the same shapes through KeySwitchBatch, which
+// runs on the keyswitch kernel with FPGA_KERNEL=KEYSWITCH, to compare with
+// the tiled dnum = decomp_modulus_size, one special modulus.
+class keyswitch_per_limb : public benchmark::Fixture {
+public:
+    void run(benchmark::State& state);
+
+private:
+    void bench_keyswitch();
+
+    std::vector<hetest::utils::KeySwitchVector> test_vectors_;
+    std::vector<uint64_t*> results_;
+    std::vector<const uint64_t*> t_target_iter_ptrs_;
+};
+
+void keyswitch_per_limb::bench_keyswitch() {
+    hetest::utils::KeySwitchVector& tv = test_vectors_[0];
+    for (size_t n = 0; n < n_iter; n++) {
+        intel::hexl::KeySwitchBatch(
+            results_.data(), t_target_iter_ptrs_.data(), results_.size(),
+            tv.coeff_count, tv.decomp_modulus_size, tv.key_modulus_size,
+            tv.rns_modulus_size, tv.key_component_count, tv.moduli.data(),
+            tv.key_vectors.data(), tv.modswitch_factors.data(),
+            tv.twiddle_factors.data());
+    }
+}
+
+void keyswitch_per_limb::run(benchmark::State& state) {
+    test_vectors_.clear();
+    results_.clear();
+    t_target_iter_ptrs_.clear();
+    for (uint64_t i = 0; i < 2; i++) {
+        test_vectors_.emplace_back(16384, state.range(0), state.range(1), 50,
+                                   i);
+    }
+    for (auto& tv : test_vectors_) {
+        results_.push_back(tv.input.data());
+        t_target_iter_ptrs_.push_back(tv.t_target_iter_ptr.data());
+    }
+
+    // warm up the FPGA kernels specially the twiddle factor dispatching kernel
+    bench_keyswitch();
+
+    for (auto st : state) {
+        bench_keyswitch();
+    }
+}
+
+BENCHMARK_DEFINE_F(keyswitch_per_limb, shape)
+(benchmark::State& state) { run(state); }
+
+BENCHMARK_REGISTER_F(keyswitch_per_limb, shape)
+    ->ArgNames({"decomp", "key"})
+    ->Args({6, 7});
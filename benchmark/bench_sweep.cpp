@@ -0,0 +1,467 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+// Latency and throughput sweep of the synchronous batch functions. Every
+// combination of operation x polynomial size x number of moduli x batch
+// size x producer threads runs for a fixed time; each producer thread calls
+// the batch function in a loop on its own results. All the operations of a
+// call complete when it returns, so the latency of an operation is the one
+// of its call. The percentiles of the latency and the sustained throughput
+// of every combination are printed, and written to JSON and/or CSV files,
+// appended to the files of previous runs.
+//
+// usage: bench_sweep [--ops=ntt,intt,dyadic,keyswitch] [--n=16384]
+//                    [--moduli=1,4] [--batch=1,8,32] [--threads=1,2,4]
+//                    [--seconds=1] [--json=<file>] [--csv=<file>]
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hexl-fpga.h"
+#include "test_utils/ntt.hpp"
+#include "test_utils/test_vectors.hpp"
+
+struct SweepPoint {
+    std::string op;
+    uint64_t n;
+    uint64_t moduli;
+    uint64_t batch;
+    uint64_t threads;
+};
+
+struct SweepResult {
+    SweepPoint point;
+    uint64_t calls;
+    uint64_t ops;
+    double seconds;
+    double ops_per_second;
+    double mean_us;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+};
+
+// inputs shared by the producer threads of a sweep point, and the results
+// and transformed polynomials of each thread.
+class SweepData {
+public:
+    explicit SweepData(const SweepPoint& p);
+    ~SweepData();
+
+    void call(uint64_t thread, uint64_t call);
+
+private:
+    void random_limb(uint64_t* limb, uint64_t modulus);
+
+    SweepPoint p_;
+    std::mt19937_64 gen_;
+    std::vector<uint64_t> moduli_;
+    std::vector<uint64_t> plans_;
+    // operands, one vector per operation of the batch
+    std::vector<std::vector<uint64_t>> operand1_;
+    std::vector<std::vector<uint64_t>> operand2_;
+    std::vector<const uint64_t*> operand1_ptrs_;
+    std::vector<const uint64_t*> operand2_ptrs_;
+    // KeySwitch moduli, keys, modswitch and twiddle factors
+    std::unique_ptr<hetest::utils::KeySwitchVector> keyswitch_;
+    // results of each thread, or polynomials transformed in place by each
+    // thread and plan
+    std::vector<std::vector<std::vector<uint64_t>>> results_;
+    std::vector<std::vector<uint64_t*>> result_ptrs_;
+};
+
+// n coefficients reduced by modulus
+void SweepData::random_limb(uint64_t* limb, uint64_t modulus) {
+    std::uniform_int_distribution<uint64_t> distrib(0, modulus - 1);
+    for (uint64_t i = 0; i < p_.n; i++) {
+        limb[i] = distrib(gen_);
+    }
+}
+
+SweepData::SweepData(const SweepPoint& p) : p_(p), gen_(p.n + p.moduli) {
+    if (p.op == "keyswitch") {
+        // a special modulus after the moduli of the input
+        keyswitch_.reset(
+            new hetest::utils::KeySwitchVector(p.n, p.moduli, p.moduli + 1));
+        moduli_ = keyswitch_->moduli;
+    } else {
+        moduli_ = hetest::utils::GeneratePrimes(p.moduli, 49, p.n);
+    }
+
+    uint64_t size_in = 0;
+    uint64_t size_out = 0;
+    if ((p.op == "ntt") || (p.op == "intt")) {
+        // the calls of a thread go round-robin over one plan per modulus
+        for (auto q : moduli_) {
+            plans_.push_back(intel::hexl::CreateTransformPlan(p.n, q));
+        }
+        size_out = p.n;
+    } else if (p.op == "dyadic") {
+        size_in = 2 * p.moduli * p.n;
+        size_out = 3 * p.moduli * p.n;
+    } else if (p.op == "keyswitch") {
+        size_in = p.moduli * p.n;
+        size_out = 2 * p.moduli * p.n;
+    } else {
+        std::cerr << "unknown operation " << p.op << std::endl;
+        exit(1);
+    }
+
+    // operand limb m is reduced by moduli[m]
+    for (uint64_t b = 0; b < p.batch; b++) {
+        std::vector<uint64_t> op1(size_in);
+        std::vector<uint64_t> op2(size_in);
+        for (uint64_t i = 0; i < size_in; i += p.n) {
+            random_limb(&op1[i], moduli_[(i / p.n) % p.moduli]);
+            random_limb(&op2[i], moduli_[(i / p.n) % p.moduli]);
+        }
+        operand1_.push_back(op1);
+        operand2_.push_back(op2);
+    }
+    for (uint64_t b = 0; b < p.batch; b++) {
+        operand1_ptrs_.push_back(operand1_[b].data());
+        operand2_ptrs_.push_back(operand2_[b].data());
+    }
+
+    uint64_t slots = p.threads * std::max<uint64_t>(plans_.size(), 1);
+    results_.resize(slots);
+    result_ptrs_.resize(slots);
+    for (uint64_t s = 0; s < slots; s++) {
+        for (uint64_t b = 0; b < p.batch; b++) {
+            std::vector<uint64_t> out(size_out);
+            if (!plans_.empty()) {
+                random_limb(out.data(), moduli_[s % plans_.size()]);
+            }
+            results_[s].push_back(out);
+        }
+        for (auto& out : results_[s]) {
+            result_ptrs_[s].push_back(out.data());
+        }
+    }
+}
+
+SweepData::~SweepData() {
+    for (auto plan : plans_) {
+        intel::hexl::DestroyTransformPlan(plan);
+    }
+}
+
+void SweepData::call(uint64_t thread, uint64_t call) {
+    if (!plans_.empty()) {
+        uint64_t plan = call % plans_.size();
+        uint64_t** polys = result_ptrs_[thread * plans_.size() + plan].data();
+        if (p_.op == "ntt") {
+            intel::hexl::ForwardTransform(polys, p_.batch, plans_[plan]);
+        } else {
+            intel::hexl::InverseTransform(polys, p_.batch, plans_[plan]);
+        }
+        return;
+    }
+    uint64_t** results = result_ptrs_[thread].data();
+    if (p_.op == "dyadic") {
+        intel::hexl::DyadicMultiplyBatch(
+            results, operand1_ptrs_.data(), operand2_ptrs_.data(), p_.batch,
+            p_.n, moduli_.data(), p_.moduli);
+    } else if (p_.op == "keyswitch") {
+        hetest::utils::KeySwitchVector& ks = *keyswitch_;
+        intel::hexl::KeySwitchBatch(
+            results, operand1_ptrs_.data(), p_.batch, p_.n,
+            ks.decomp_modulus_size, ks.key_modulus_size, ks.rns_modulus_size,
+            ks.key_component_count, ks.moduli.data(), ks.key_vectors.data(),
+            ks.modswitch_factors.data(), ks.twiddle_factors.data());
+    }
+}
+
+// nearest rank percentile of sorted samples
+static double percentile(const std::vector<double>& sorted, double p) {
+    uint64_t rank = std::ceil(p * sorted.size());
+    return sorted[std::max<uint64_t>(rank, 1) - 1];
+}
+
+static SweepResult run_point(const SweepPoint& p, double seconds) {
+    SweepData data(p);
+
+    // first call of the point, twiddle factors and keys loading
+    data.call(0, 0);
+
+    std::vector<std::vector<double>> latencies(p.threads);
+    std::vector<std::thread> producers;
+    std::atomic<uint64_t> ready(0);
+    std::atomic<bool> go(false);
+    auto duration = std::chrono::duration<double>(seconds);
+    std::chrono::steady_clock::time_point start;
+
+    for (uint64_t t = 0; t < p.threads; t++) {
+        producers.emplace_back([&, t]() {
+            ready++;
+            while (!go) {
+                std::this_thread::yield();
+            }
+            auto end = start + duration;
+            uint64_t call = 0;
+            do {
+                auto begin = std::chrono::steady_clock::now();
+                data.call(t, call++);
+                auto done = std::chrono::steady_clock::now();
+                latencies[t].push_back(
+                    std::chrono::duration<double, std::micro>(done - begin)
+                        .count());
+            } while (std::chrono::steady_clock::now() < end);
+        });
+    }
+    while (ready < p.threads) {
+        std::this_thread::yield();
+    }
+    start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::vector<double> all;
+    for (auto& l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    SweepResult r;
+    r.point = p;
+    r.calls = all.size();
+    r.ops = r.calls * p.batch;
+    r.seconds = std::chrono::duration<double>(end - start).count();
+    r.ops_per_second = r.ops / r.seconds;
+    double sum = 0;
+    for (auto l : all) {
+        sum += l;
+    }
+    r.mean_us = sum / all.size();
+    r.p50_us = percentile(all, 0.5);
+    r.p90_us = percentile(all, 0.9);
+    r.p99_us = percentile(all, 0.99);
+    r.p999_us = percentile(all, 0.999);
+    r.max_us = all.back();
+    return r;
+}
+
+static std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> items;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+static std::vector<uint64_t> split_uint(const std::string& s) {
+    std::vector<uint64_t> values;
+    for (const auto& item : split(s)) {
+        values.push_back(strtoul(item.c_str(), NULL, 10));
+    }
+    return values;
+}
+
+// operations of the kernels of env(FPGA_KERNEL), all of them on the CPU
+static std::string default_ops() {
+    char* choice = getenv("RUN_CHOICE");
+    if (choice && (atoi(choice) == 0)) {
+        return "ntt,intt,dyadic,keyswitch";
+    }
+    char* env = getenv("FPGA_KERNEL");
+    std::string kernel = env ? env : "DYADIC_MULTIPLY_KEYSWITCH";
+    static const std::map<std::string, std::string> ops = {
+        {"NTT", "ntt"},
+        {"INTT", "intt"},
+        {"DYADIC_MULTIPLY", "dyadic"},
+        {"KEYSWITCH", "keyswitch"},
+        {"DYADIC_MULTIPLY_KEYSWITCH", "dyadic,keyswitch"},
+        {"RESCALE", "ntt,intt"},
+        {"KEYSWITCH_TILED", "ntt,intt,dyadic"}};
+    auto iter = ops.find(kernel);
+    return (iter != ops.end()) ? iter->second : "ntt";
+}
+
+// runtime settings of the results
+static nlohmann::json environment() {
+    static const char* names[] = {"RUN_CHOICE",
+                                  "FPGA_KERNEL",
+                                  "FPGA_BITSTREAM",
+                                  "NUM_DEV",
+                                  "BATCH_SIZE_DYADIC_MULTIPLY",
+                                  "BATCH_SIZE_NTT",
+                                  "BATCH_SIZE_INTT",
+                                  "BATCH_SIZE_KEYSWITCH",
+                                  "FPGA_HYBRID",
+                                  "NUM_CPU_THREADS",
+                                  "FPGA_MOCK_DELAY_US"};
+    nlohmann::json env = nlohmann::json::object();
+    for (auto name : names) {
+        char* value = getenv(name);
+        if (value) {
+            env[name] = value;
+        }
+    }
+    return env;
+}
+
+// env(BATCH_SIZE_<kernel>) of an operation, the size of the device batches
+static uint64_t device_batch(const std::string& op) {
+    static const std::map<std::string, const char*> names = {
+        {"ntt", "BATCH_SIZE_NTT"},
+        {"intt", "BATCH_SIZE_INTT"},
+        {"dyadic", "BATCH_SIZE_DYADIC_MULTIPLY"},
+        {"keyswitch", "BATCH_SIZE_KEYSWITCH"}};
+    char* env = getenv(names.at(op));
+    return env ? strtoul(env, NULL, 10) : 1;
+}
+
+static nlohmann::json to_json(const SweepResult& r) {
+    return {{"op", r.point.op},
+            {"device_batch", device_batch(r.point.op)},
+            {"n", r.point.n},
+            {"moduli", r.point.moduli},
+            {"batch", r.point.batch},
+            {"threads", r.point.threads},
+            {"calls", r.calls},
+            {"ops", r.ops},
+            {"seconds", r.seconds},
+            {"ops_per_second", r.ops_per_second},
+            {"mean_us", r.mean_us},
+            {"p50_us", r.p50_us},
+            {"p90_us", r.p90_us},
+            {"p99_us", r.p99_us},
+            {"p999_us", r.p999_us},
+            {"max_us", r.max_us}};
+}
+
+// appends the run to the runs of the file
+static void write_json(const std::string& file,
+                       const std::vector<SweepResult>& results) {
+    nlohmann::json js = {{"runs", nlohmann::json::array()}};
+    std::ifstream in(file);
+    if (in.good()) {
+        in >> js;
+    }
+    in.close();
+
+    nlohmann::json run = {{"environment", environment()},
+                          {"results", nlohmann::json::array()}};
+    for (const auto& r : results) {
+        run["results"].push_back(to_json(r));
+    }
+    js["runs"].push_back(run);
+
+    std::ofstream out(file);
+    out << std::setw(4) << js << std::endl;
+}
+
+// appends the results to the file, the header first in a new file
+static void write_csv(const std::string& file,
+                      const std::vector<SweepResult>& results) {
+    bool header = !std::ifstream(file).good();
+    std::ofstream out(file, std::ios::app);
+    if (header) {
+        out << "fpga_kernel,op,device_batch,n,moduli,batch,threads,calls,ops,"
+               "seconds,ops_per_second,mean_us,p50_us,p90_us,p99_us,p999_us,"
+               "max_us"
+            << std::endl;
+    }
+    char* kernel = getenv("FPGA_KERNEL");
+    for (const auto& r : results) {
+        out << (kernel ? kernel : "") << "," << r.point.op << ","
+            << device_batch(r.point.op) << "," << r.point.n << ","
+            << r.point.moduli << "," << r.point.batch << ","
+            << r.point.threads << "," << r.calls << "," << r.ops << ","
+            << r.seconds << "," << r.ops_per_second << "," << r.mean_us
+            << "," << r.p50_us << "," << r.p90_us << "," << r.p99_us << ","
+            << r.p999_us << "," << r.max_us << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::map<std::string, std::string> args = {{"ops", default_ops()},
+                                               {"n", "16384"},
+                                               {"moduli", "1,4"},
+                                               {"batch", "1,8,32"},
+                                               {"threads", "1,2,4"},
+                                               {"seconds", "1"},
+                                               {"json", ""},
+                                               {"csv", ""}};
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(2, eq - 2);
+        if ((arg.compare(0, 2, "--") != 0) || (eq == std::string::npos) ||
+            (args.count(key) == 0)) {
+            std::cerr << "usage: " << argv[0]
+                      << " [--ops=ntt,intt,dyadic,keyswitch] [--n=16384]"
+                         " [--moduli=1,4] [--batch=1,8,32] [--threads=1,2,4]"
+                         " [--seconds=1] [--json=<file>] [--csv=<file>]"
+                      << std::endl;
+            return 1;
+        }
+        args[key] = arg.substr(eq + 1);
+    }
+    double seconds = atof(args["seconds"].c_str());
+
+    intel::hexl::acquire_FPGA_resources();
+
+    std::vector<SweepResult> results;
+    std::cout << std::setw(10) << "op" << std::setw(7) << "n" << std::setw(7)
+              << "moduli" << std::setw(7) << "batch" << std::setw(8)
+              << "threads" << std::setw(12) << "ops/s" << std::setw(11)
+              << "p50 us" << std::setw(11) << "p90 us" << std::setw(11)
+              << "p99 us" << std::setw(11) << "p999 us" << std::endl;
+    for (const auto& op : split(args["ops"])) {
+        for (auto n : split_uint(args["n"])) {
+            for (auto moduli : split_uint(args["moduli"])) {
+                for (auto batch : split_uint(args["batch"])) {
+                    for (auto threads : split_uint(args["threads"])) {
+                        SweepResult r = run_point(
+                            {op, n, moduli, batch, threads}, seconds);
+                        std::cout << std::fixed << std::setprecision(1)
+                                  << std::setw(10) << op << std::setw(7) << n
+                                  << std::setw(7) << moduli << std::setw(7)
+                                  << batch << std::setw(8) << threads
+                                  << std::setw(12) << r.ops_per_second
+                                  << std::setw(11) << r.p50_us
+                                  << std::setw(11) << r.p90_us
+                                  << std::setw(11) << r.p99_us
+                                  << std::setw(11) << r.p999_us << std::endl;
+                        results.push_back(r);
+                    }
+                }
+            }
+        }
+    }
+
+    intel::hexl::release_FPGA_resources();
+
+    if (!args["json"].empty()) {
+        write_json(args["json"], results);
+    }
+    if (!args["csv"].empty()) {
+        write_csv(args["csv"], results);
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+# Copyright (C) 2020-2022 Intel Corporation
+# SPDX-License-Identifier: Apache-2.0
+
+#!/usr/bin/env bash
+
+set -eo pipefail
+
+spath=$(dirname $0)
+. ${spath}/bitstream_dir.sh
+
+########################################
+# Host runtime overhead, with the mock bitstream, whose kernels complete
+# at once or after FPGA_MOCK_DELAY_US microseconds per frame. FPGA_DEBUG=3
+# reports the host time per batch and per operation of each kernel when the
+# device is released.
+########################################
+
+mock=${bitstream_dir}/libmock_kernels.so
+export RUN_CHOICE=1
+export FPGA_DEBUG=3
+
+for batch in 1 8 32 128
+do
+    echo ""
+    echo "FPGA_BITSTREAM=${mock} FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY = ${batch}"
+    FPGA_BITSTREAM=${mock} FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY=${batch} ./bench_dyadic_multiply
+
+    echo ""
+    echo "FPGA_BITSTREAM=${mock} FPGA_KERNEL=NTT BATCH_SIZE_NTT = ${batch}"
+    FPGA_BITSTREAM=${mock} FPGA_KERNEL=NTT BATCH_SIZE_NTT=${batch} ./bench_fwd_ntt
+
+    echo ""
+    echo "FPGA_BITSTREAM=${mock} FPGA_KERNEL=INTT BATCH_SIZE_INTT = ${batch}"
+    FPGA_BITSTREAM=${mock} FPGA_KERNEL=INTT BATCH_SIZE_INTT=${batch} ./bench_inv_ntt
+
+    echo ""
+    echo "FPGA_BITSTREAM=${mock} N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH = ${batch}"
+    FPGA_BITSTREAM=${mock} ITER=256 N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=${batch} ./bench_keyswitch --benchmark_filter=16384
+done
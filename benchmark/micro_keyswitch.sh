@@ -19,10 +19,16 @@ fi
 
 echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1"
-FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=256 N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1 ./bench_keyswitch
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=256 N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1 ./bench_keyswitch --benchmark_filter=keyswitch/16384
 echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=16"
-FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=256 N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=16 ./bench_keyswitch
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=256 N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=16 ./bench_keyswitch --benchmark_filter=keyswitch/16384
 echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=128"
-FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=256 N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=128 ./bench_keyswitch
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=256 N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=128 ./bench_keyswitch --benchmark_filter=keyswitch/16384
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_32k.so N=32768 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=16"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_32k.so ITER=256 N=32768 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=16 ./bench_keyswitch --benchmark_filter=keyswitch/32768
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=16 generated test vectors"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=256 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=16 ./bench_keyswitch --benchmark_filter=keyswitch_synthetic
@@ -0,0 +1,26 @@
+# Copyright (C) 2020-2021 Intel Corporation
+# SPDX-License-Identifier: Apache-2.0
+
+#!/usr/bin/env bash
+
+set -eo pipefail
+
+spath=$(dirname $0)
+. ${spath}/bitstream_dir.sh
+
+if [[ -z ${RUN_CHOICE} ]] || [[ ${RUN_CHOICE} -eq 2 ]]
+then
+    aocl initialize acl0 pac_s10_usm
+fi
+
+########################################
+# FPGA run with individual bitstream
+########################################
+
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_tiled.so FPGA_KERNEL=KEYSWITCH_TILED BATCH_SIZE_DYADIC_MULTIPLY=8 BATCH_SIZE_NTT=8 BATCH_SIZE_INTT=8"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_tiled.so ITER=16 FPGA_KERNEL=KEYSWITCH_TILED BATCH_SIZE_DYADIC_MULTIPLY=8 BATCH_SIZE_NTT=8 BATCH_SIZE_INTT=8 ./bench_keyswitch_tiled --benchmark_filter=keyswitch_tiled
+
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 per-limb keyswitch kernel"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so ITER=16 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 ./bench_keyswitch_tiled --benchmark_filter=keyswitch_per_limb
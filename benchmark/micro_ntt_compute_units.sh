@@ -0,0 +1,36 @@
+# Copyright (C) 2020-2021 Intel Corporation
+# SPDX-License-Identifier: Apache-2.0
+
+#!/usr/bin/env bash
+
+set -eo pipefail
+
+spath=$(dirname $0)
+. ${spath}/bitstream_dir.sh
+
+if [[ -z ${RUN_CHOICE} ]] || [[ ${RUN_CHOICE} -eq 2 ]]
+then
+    aocl initialize acl0 pac_s10_usm
+fi
+
+########################################
+# NTT/INTT scaling with 1, 2 and 4 compute units. The 2 and 4 units
+# bitstreams are only built for emulation.
+########################################
+
+for units in 1 2 4
+do
+    suffix=""
+    if [[ ${units} -gt 1 ]]
+    then
+        suffix="_cu${units}"
+    fi
+
+    echo ""
+    echo "FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt${suffix}.so FPGA_KERNEL=NTT BATCH_SIZE_NTT = 32"
+    FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt${suffix}.so FPGA_KERNEL=NTT BATCH_SIZE_NTT=32 ./bench_fwd_ntt
+
+    echo ""
+    echo "FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt${suffix}.so FPGA_KERNEL=INTT BATCH_SIZE_INTT = 32"
+    FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt${suffix}.so FPGA_KERNEL=INTT BATCH_SIZE_INTT=32 ./bench_inv_ntt
+done
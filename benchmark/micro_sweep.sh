@@ -0,0 +1,41 @@
+# Copyright (C) 2020-2022 Intel Corporation
+# SPDX-License-Identifier: Apache-2.0
+
+#!/usr/bin/env bash
+
+set -eo pipefail
+
+spath=$(dirname $0)
+. ${spath}/bitstream_dir.sh
+
+if [[ -z ${RUN_CHOICE} ]] || [[ ${RUN_CHOICE} -eq 2 ]]
+then
+    aocl initialize acl0 pac_s10_usm
+fi
+
+########################################
+# Latency percentiles and throughput of batch size x producer threads x
+# polynomial size x number of moduli, for device batches of the same size
+# as the calls. The results of all the runs are appended to sweep.json and
+# sweep.csv.
+########################################
+
+json=${SWEEP_JSON:-sweep.json}
+csv=${SWEEP_CSV:-sweep.csv}
+threads=${SWEEP_THREADS:-1,2,4}
+seconds=${SWEEP_SECONDS:-1}
+
+for batch in 1 8 32
+do
+    echo ""
+    echo "FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt.so FPGA_KERNEL=NTT BATCH_SIZE_NTT = ${batch}"
+    FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt.so FPGA_KERNEL=NTT BATCH_SIZE_NTT=${batch} ./bench_sweep --ops=ntt --n=4096,16384 --moduli=1,4 --batch=${batch} --threads=${threads} --seconds=${seconds} --json=${json} --csv=${csv}
+
+    echo ""
+    echo "FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt.so FPGA_KERNEL=INTT BATCH_SIZE_INTT = ${batch}"
+    FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt.so FPGA_KERNEL=INTT BATCH_SIZE_INTT=${batch} ./bench_sweep --ops=intt --n=4096,16384 --moduli=1,4 --batch=${batch} --threads=${threads} --seconds=${seconds} --json=${json} --csv=${csv}
+
+    echo ""
+    echo "FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply.so FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY = ${batch}"
+    FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply.so FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY=${batch} ./bench_sweep --ops=dyadic --n=4096,16384 --moduli=1,7 --batch=${batch} --threads=${threads} --seconds=${seconds} --json=${json} --csv=${csv}
+done
@@ -17,6 +17,11 @@ compile() {
     bin_dir=$4
     others=${@:5}
 
+    # a kernel is built from device/<kernel>.cpp, unless source_<kernel>
+    # names another file
+    source="source_${kernel}"
+    source=${!source:-${kernel}}
+
     export TMPDIR=${bin_dir}/device/${kernel}
     mkdir -p ${TMPDIR}
 
@@ -25,12 +30,17 @@ compile() {
         -Wno-ignored-attributes -Wno-return-type-c-linkage -Wno-unknown-pragmas \
         ${others} \
         -o lib${kernel}.so \
-        ${src_dir}/device/${kernel}.cpp
+        ${src_dir}/device/${source}.cpp
 
     rm -rf ${TMPDIR}
     export TMPDIR=
 }
 
+if [[ ${target} == -DFPGA_EMULATOR ]]
+then
+    kernels+=${emulation_kernels}
+fi
+
 for kernel in ${kernels}
 do
     echo "Compiling bitstream for ${kernel}"
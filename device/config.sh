@@ -9,6 +9,11 @@ kernels+=" fwd_ntt"
 kernels+=" inv_ntt"
 kernels+=" keyswitch"
 kernels+=" dyadic_multiply_keyswitch"
+kernels+=" rescale"
+kernels+=" keyswitch_32k"
+kernels+=" keyswitch_tiled"
+kernels+=" keyswitch_60"
+kernels+=" dyadic_multiply_keyswitch_60"
 
 config_dyadic_multiply=""
 config_dyadic_multiply+=" -Xsboard=intel_s10sx_pac:pac_s10_usm"
@@ -33,9 +38,51 @@ config_keyswitch+=" -Xshyper-optimized-handshaking=off"
 config_keyswitch+=" -Xsboard=intel_s10sx_pac:pac_s10"
 config_keyswitch+=" -Xsclock=240MHz"
 
+config_keyswitch_32k=${config_keyswitch}
+config_keyswitch_32k+=" -DMAX_COFF_COUNT=32768"
+
+config_keyswitch_60=${config_keyswitch}
+config_keyswitch_60+=" -DMAX_MODULUS_BITS=60"
+
 config_dyadic_multiply_keyswitch=${config_dyadic_multiply}
 config_dyadic_multiply_keyswitch+=" -DCORES=1"
 
+config_dyadic_multiply_keyswitch_60=${config_dyadic_multiply_keyswitch}
+config_dyadic_multiply_keyswitch_60+=" -DMAX_MODULUS_BITS=60"
+
+config_rescale="  -DFPGA_NTT_SIZE=16384"
+config_rescale+=" -DNUM_NTT_COMPUTE_UNITS=1"
+config_rescale+=" -DVEC=8"
+config_rescale+=" -DFPGA_INTT_SIZE=16384"
+config_rescale+=" -DNUM_INTT_COMPUTE_UNITS=1"
+config_rescale+=" -DVEC_INTT=8"
+config_rescale+=" -Xsboard=intel_s10sx_pac:pac_s10_usm"
+config_rescale+=" -Xsclock=360MHz"
+
+config_keyswitch_tiled=${config_rescale}
+
+# NTT and INTT with 2 and 4 compute units, only built for emulation to
+# measure the scaling of the host dispatch.
+emulation_kernels=""
+emulation_kernels+=" fwd_ntt_cu2"
+emulation_kernels+=" fwd_ntt_cu4"
+emulation_kernels+=" inv_ntt_cu2"
+emulation_kernels+=" inv_ntt_cu4"
+
+source_fwd_ntt_cu2="fwd_ntt"
+config_fwd_ntt_cu2=${config_fwd_ntt/-DNUM_NTT_COMPUTE_UNITS=1/-DNUM_NTT_COMPUTE_UNITS=2}
+source_fwd_ntt_cu4="fwd_ntt"
+config_fwd_ntt_cu4=${config_fwd_ntt/-DNUM_NTT_COMPUTE_UNITS=1/-DNUM_NTT_COMPUTE_UNITS=4}
+source_inv_ntt_cu2="inv_ntt"
+config_inv_ntt_cu2=${config_inv_ntt/-DNUM_INTT_COMPUTE_UNITS=1/-DNUM_INTT_COMPUTE_UNITS=2}
+source_inv_ntt_cu4="inv_ntt"
+config_inv_ntt_cu4=${config_inv_ntt/-DNUM_INTT_COMPUTE_UNITS=1/-DNUM_INTT_COMPUTE_UNITS=4}
+
+# mock bitstream exporting the interfaces of all the kernels, with host tasks
+# in place of the kernels, to measure the overhead of the host runtime.
+emulation_kernels+=" mock_kernels"
+config_mock_kernels=""
+
 fpga_args=""
 fpga_args+=" -Xsbsp-flow=flat"
 fpga_args+=" -Xsseed=789045"
@@ -26,12 +26,18 @@ typedef struct {
     } op[2];
 } operands_t;
 
+// plain is set for ciphertext x plaintext batches, which carry one
+// plaintext polynomial per modulus and produce two output polynomials.
+// accumulate is set when the products of a batch are summed into a single
+// set of output polynomials.
 typedef struct {
     ubitwidth_t* operands_in_ddr;
     moduli_info_t* moduli_info;
     ubitwidth_t n;
     ubitwidth_t n_moduli;
     ubitwidth_t n_batch;
+    ubitwidth_t plain;
+    ubitwidth_t accumulate;
 } operands_fetcher_info;
 
 typedef struct {
@@ -45,6 +51,7 @@ typedef struct {
     ubitwidth_t n;
     ubitwidth_t n_moduli;
     ubitwidth_t n_batch;
+    ubitwidth_t plain;
     int tag;
 } output_t;
 
@@ -62,7 +69,8 @@ void input_fifo_kernel(ubitwidth_t* operand1_host, ubitwidth_t* operand2_host,
                        ubitwidth_t n, moduli_info_t* moduli_info_host,
                        ubitwidth_t n_moduli, int tag,
                        ubitwidth_t* operands_in_ddr_dev,
-                       ubitwidth_t* results_ddr_dev, ubitwidth_t n_batch) {
+                       ubitwidth_t* results_ddr_dev, ubitwidth_t n_batch,
+                       ubitwidth_t accumulate) {
     sycl::host_ptr<ubitwidth_t> operand1_in_svm(operand1_host);
     sycl::host_ptr<ubitwidth_t> operand2_in_svm(operand2_host);
     sycl::host_ptr<moduli_info_t> moduli_info(moduli_info_host);
@@ -111,6 +119,8 @@ void input_fifo_kernel(ubitwidth_t* operand1_host, ubitwidth_t* operand2_host,
     data_info.n = n;
     data_info.n_moduli = n_moduli;
     data_info.n_batch = n_batch;
+    data_info.plain = 0;
+    data_info.accumulate = accumulate;
 
     input_t input_info;
     input_info.data_info = data_info;
@@ -120,6 +130,80 @@ void input_fifo_kernel(ubitwidth_t* operand1_host, ubitwidth_t* operand2_host,
     input_pipe::write(input_info);
 }
 
+// the ciphertexts are read through a host_ptr from the staging buffer, or
+// through a device_ptr from keys resident in device memory.
+class input_fifo_plain_kern_usm;
+template <typename CiphertextPtr>
+void input_fifo_plain_kernel(CiphertextPtr ciphertext,
+                             ubitwidth_t* plaintext_host, ubitwidth_t n,
+                             moduli_info_t* moduli_info_host,
+                             ubitwidth_t n_moduli, int tag,
+                             ubitwidth_t* operands_in_ddr_dev,
+                             ubitwidth_t* results_ddr_dev,
+                             ubitwidth_t n_batch, ubitwidth_t accumulate) {
+    sycl::host_ptr<ubitwidth_t> plaintext_in_svm(plaintext_host);
+    sycl::host_ptr<moduli_info_t> moduli_info(moduli_info_host);
+
+    sycl::device_ptr<ubitwidth_t> operands_in_ddr(operands_in_ddr_dev);
+    sycl::device_ptr<ubitwidth_t> results_ddr(results_ddr_dev);
+
+    ubitwidth_t ddr_offset = 0;
+    ubitwidth_t nn = n >> 1;
+
+    // (x0, x1, y) per coefficient, y is fetched as both y0 and y1.
+    [[intel::ivdep]] for (ubitwidth_t batch = 0; batch < n_batch; batch++) {
+        ubitwidth_t batch_offset = batch * 2 * n_moduli * n;
+        ubitwidth_t plain_batch_offset = batch * n_moduli * n;
+
+        [[intel::ivdep]] [[intel::initiation_interval(
+            1)]] for (ubitwidth_t m = 0; m < n_moduli; m++) {
+            ubitwidth_t poly0_offset = batch_offset + m * n;
+            ubitwidth_t poly1_offset = batch_offset + (m + n_moduli) * n;
+            ubitwidth_t plain_offset = plain_batch_offset + m * n;
+
+            [[intel::ivdep]] for (ubitwidth_t i = 0; i < nn; i++) {
+                ubitwidth_t p0 = poly0_offset + i * 2;
+                ubitwidth_t p1 = poly1_offset + i * 2;
+                ubitwidth_t pp = plain_offset + i * 2;
+
+                ubitwidth_t data[6];
+#pragma unroll
+                for (ubitwidth_t j = 0; j < 2; j++) {
+                    data[3 * j + 0] = ciphertext[p0 + j];
+                    data[3 * j + 1] = ciphertext[p1 + j];
+                    data[3 * j + 2] = plaintext_in_svm[pp + j];
+                }
+
+#pragma unroll
+                for (ubitwidth_t j = 0; j < 6; j++) {
+                    operands_in_ddr[ddr_offset] = data[j];
+                    ddr_offset++;
+                }
+            }
+        }
+    }
+
+    sycl::atomic_fence(sycl::memory_order::seq_cst, sycl::memory_scope::device);
+
+    operands_fetcher_info data_info;
+    data_info.operands_in_ddr = (ubitwidth_t*)operands_in_ddr;
+    data_info.moduli_info = (moduli_info_t*)moduli_info;
+    data_info.n = n;
+    data_info.n_moduli = n_moduli;
+    data_info.n_batch = n_batch;
+    data_info.plain = 1;
+    data_info.accumulate = accumulate;
+
+    input_t input_info;
+    input_info.data_info = data_info;
+    input_info.results_ddr = (ubitwidth_t*)results_ddr;
+    input_info.tag = tag;
+
+    input_pipe::write(input_info);
+}
+
+class input_fifo_acc_kern_usm;
+class input_fifo_acc_keys_kern_usm;
 class output_nb_fifo_kern_usm;
 void output_nb_fifo_kernel(ubitwidth_t* results_host, int* tag_host,
                            int* output_valid_host) {
@@ -135,16 +219,17 @@ void output_nb_fifo_kernel(ubitwidth_t* results_host, int* tag_host,
 
     if (valid) {
         ubitwidth_t nn = output_info.n >> 3;
+        ubitwidth_t n_out = output_info.plain ? 2 : 3;
         for (ubitwidth_t batch = 0; batch < output_info.n_batch; batch++) {
             ubitwidth_t batch_poly_offset = batch * output_info.n_moduli;
             for (ubitwidth_t m = 0; m < output_info.n_moduli; m++) {
                 ubitwidth_t poly0_offset =
-                    (batch_poly_offset * 3 + m) * output_info.n;
+                    (batch_poly_offset * n_out + m) * output_info.n;
                 ubitwidth_t poly1_offset =
-                    (batch_poly_offset * 3 + m + output_info.n_moduli) *
+                    (batch_poly_offset * n_out + m + output_info.n_moduli) *
                     output_info.n;
                 ubitwidth_t poly2_offset =
-                    (batch_poly_offset * 3 + m + 2 * output_info.n_moduli) *
+                    (batch_poly_offset * n_out + m + 2 * output_info.n_moduli) *
                     output_info.n;
 
                 [[intel::ivdep]] for (ubitwidth_t i = 0; i < nn; i++) {
@@ -161,7 +246,9 @@ void output_nb_fifo_kernel(ubitwidth_t* results_host, int* tag_host,
                                           j++) {
                         results0[j] = output_info.results_ddr[p0 + j];
                         results1[j] = output_info.results_ddr[p1 + j];
-                        results2[j] = output_info.results_ddr[p2 + j];
+                        if (!output_info.plain) {
+                            results2[j] = output_info.results_ddr[p2 + j];
+                        }
                     }
 
 #pragma unroll
@@ -176,10 +263,12 @@ void output_nb_fifo_kernel(ubitwidth_t* results_host, int* tag_host,
                         results_svm[p1 + j] = results1[j];
                     }
 
+                    if (!output_info.plain) {
 #pragma unroll
-                    [[intel::ivdep]] for (ubitwidth_t j = 0; j < DATA_PATH;
-                                          j++) {
-                        results_svm[p2 + j] = results2[j];
+                        [[intel::ivdep]] for (ubitwidth_t j = 0; j < DATA_PATH;
+                                              j++) {
+                            results_svm[p2 + j] = results2[j];
+                        }
                     }
                 }
             }
@@ -260,7 +349,9 @@ void operands_fetcher_kernel() {
                         operands.op[j].x0 = info.operands_in_ddr[ddr_offset++];
                         operands.op[j].x1 = info.operands_in_ddr[ddr_offset++];
                         operands.op[j].y0 = info.operands_in_ddr[ddr_offset++];
-                        operands.op[j].y1 = info.operands_in_ddr[ddr_offset++];
+                        operands.op[j].y1 =
+                            info.plain ? operands.op[j].y0
+                                       : info.operands_in_ddr[ddr_offset++];
                     }
                     operands_in_pipe::write(operands);
                 }
@@ -279,21 +370,30 @@ void dyadic_multiply_kernel() {
         output_t output_info;
         output_info.tag = input_info.tag;
         output_info.n = info.n;
-        output_info.n_batch = info.n_batch;
+        output_info.n_batch = info.accumulate ? 1 : info.n_batch;
         output_info.n_moduli = info.n_moduli;
+        output_info.plain = info.plain;
         output_info.results_ddr = input_info.results_ddr;
 
         ubitwidth_t nn = info.n >> 3;
+        ubitwidth_t n_out = info.plain ? 2 : 3;
 
         for (ubitwidth_t batch = 0; batch < info.n_batch; batch++) {
-            ubitwidth_t batch_poly_offset = batch * info.n_moduli;
+            // an accumulated batch keeps a running sum in the slot of the
+            // first product, and only that slot is read back.
+            ubitwidth_t batch_poly_offset =
+                info.accumulate ? 0 : batch * info.n_moduli;
+            bool add = info.accumulate && (batch > 0);
             for (ubitwidth_t m = 0; m < info.n_moduli; m++) {
+                ubitwidth_t modulus =
+                    info.moduli_info[batch * info.n_moduli + m].moduli;
                 ubitwidth_t result_poly0_offset =
-                    (batch_poly_offset * 3 + m) * info.n;
+                    (batch_poly_offset * n_out + m) * info.n;
                 ubitwidth_t result_poly1_offset =
-                    (batch_poly_offset * 3 + m + info.n_moduli) * info.n;
+                    (batch_poly_offset * n_out + m + info.n_moduli) * info.n;
                 ubitwidth_t result_poly2_offset =
-                    (batch_poly_offset * 3 + m + 2 * info.n_moduli) * info.n;
+                    (batch_poly_offset * n_out + m + 2 * info.n_moduli) *
+                    info.n;
 
                 [[intel::ivdep]] for (ubitwidth_t i = 0; i < nn; i++) {
                     ubitwidth_t p0 = result_poly0_offset + i * DATA_PATH;
@@ -316,6 +416,29 @@ void dyadic_multiply_kernel() {
                         results2[2 * k + 1] = results2_int[1];
                     }
 
+                    if (add) {
+#pragma unroll
+                        for (ubitwidth_t j = 0; j < DATA_PATH; j++) {
+                            results0[j] =
+                                AddMod(output_info.results_ddr[p0 + j],
+                                       results0[j], modulus);
+                            results1[j] = AddMod(
+                                output_info.results_ddr[p1 + j],
+                                info.plain ? results2[j] : results1[j],
+                                modulus);
+                            if (!info.plain) {
+                                results2[j] =
+                                    AddMod(output_info.results_ddr[p2 + j],
+                                           results2[j], modulus);
+                            }
+                        }
+                    } else if (info.plain) {
+#pragma unroll
+                        for (ubitwidth_t j = 0; j < DATA_PATH; j++) {
+                            results1[j] = results2[j];
+                        }
+                    }
+
 #pragma unroll
                     for (ubitwidth_t j = 0; j < DATA_PATH; j++) {
                         output_info.results_ddr[p0 + j] = results0[j];
@@ -326,9 +449,11 @@ void dyadic_multiply_kernel() {
                         output_info.results_ddr[p1 + j] = results1[j];
                     }
 
+                    if (!info.plain) {
 #pragma unroll
-                    for (ubitwidth_t j = 0; j < DATA_PATH; j++) {
-                        output_info.results_ddr[p2 + j] = results2[j];
+                        for (ubitwidth_t j = 0; j < DATA_PATH; j++) {
+                            output_info.results_ddr[p2 + j] = results2[j];
+                        }
                     }
                 }
             }
@@ -356,7 +481,81 @@ sycl::event input_fifo_usm(sycl::queue& q, ubitwidth_t* operand1_in_svm,
         ]() [[intel::kernel_args_restrict]] {
             input_fifo_kernel(operand1_in_svm, operand2_in_svm, n, moduli_info,
                               n_moduli, tag, operands_in_ddr, results_ddr,
-                              n_batch);
+                              n_batch, 0);
+        });
+    });
+
+    return e;
+}
+
+sycl::event input_fifo_plain_usm(sycl::queue& q, ubitwidth_t* ciphertext_in_svm,
+                                 ubitwidth_t* plaintext_in_svm, ubitwidth_t n,
+                                 moduli_info_t* moduli_info,
+                                 ubitwidth_t n_moduli, int tag,
+                                 ubitwidth_t* operands_in_ddr,
+                                 ubitwidth_t* results_ddr,
+                                 ubitwidth_t n_batch) {
+    sycl::event e = q.submit([&](sycl::handler& h) {
+        h.single_task<input_fifo_plain_kern_usm>([=
+        ]() [[intel::kernel_args_restrict]] {
+            input_fifo_plain_kernel(
+                sycl::host_ptr<ubitwidth_t>(ciphertext_in_svm),
+                plaintext_in_svm, n, moduli_info, n_moduli, tag,
+                operands_in_ddr, results_ddr, n_batch, 0);
+        });
+    });
+
+    return e;
+}
+
+// sums the n_batch products of the batch, plain selects the ciphertext x
+// plaintext operand layout of input_fifo_plain_usm.
+sycl::event input_fifo_accumulate_usm(sycl::queue& q,
+                                      ubitwidth_t* operand1_in_svm,
+                                      ubitwidth_t* operand2_in_svm,
+                                      ubitwidth_t n, moduli_info_t* moduli_info,
+                                      ubitwidth_t n_moduli, int tag,
+                                      ubitwidth_t* operands_in_ddr,
+                                      ubitwidth_t* results_ddr,
+                                      ubitwidth_t n_batch, ubitwidth_t plain) {
+    sycl::event e = q.submit([&](sycl::handler& h) {
+        h.single_task<input_fifo_acc_kern_usm>([=
+        ]() [[intel::kernel_args_restrict]] {
+            if (plain) {
+                input_fifo_plain_kernel(
+                    sycl::host_ptr<ubitwidth_t>(operand1_in_svm),
+                    operand2_in_svm, n, moduli_info, n_moduli, tag,
+                    operands_in_ddr, results_ddr, n_batch, 1);
+            } else {
+                input_fifo_kernel(operand1_in_svm, operand2_in_svm, n,
+                                  moduli_info, n_moduli, tag, operands_in_ddr,
+                                  results_ddr, n_batch, 1);
+            }
+        });
+    });
+
+    return e;
+}
+
+// input_fifo_accumulate_usm of a ciphertext x plaintext batch whose
+// ciphertexts, the switch keys of a tiled KeySwitch, stay in device memory
+// across batches instead of being staged every time.
+sycl::event input_fifo_accumulate_keys_usm(sycl::queue& q,
+                                           ubitwidth_t* keys_in_ddr,
+                                           ubitwidth_t* operand2_in_svm,
+                                           ubitwidth_t n,
+                                           moduli_info_t* moduli_info,
+                                           ubitwidth_t n_moduli, int tag,
+                                           ubitwidth_t* operands_in_ddr,
+                                           ubitwidth_t* results_ddr,
+                                           ubitwidth_t n_batch) {
+    sycl::event e = q.submit([&](sycl::handler& h) {
+        h.single_task<input_fifo_acc_keys_kern_usm>([=
+        ]() [[intel::kernel_args_restrict]] {
+            input_fifo_plain_kernel(sycl::device_ptr<ubitwidth_t>(keys_in_ddr),
+                                    operand2_in_svm, n, moduli_info, n_moduli,
+                                    tag, operands_in_ddr, results_ddr, n_batch,
+                                    1);
         });
     });
 
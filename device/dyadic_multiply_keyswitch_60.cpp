@@ -0,0 +1,6 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+// dyadic multiply and keyswitch for moduli of up to 60 bits,
+// MAX_MODULUS_BITS is set by config_dyadic_multiply_keyswitch_60.
+#include "dyadic_multiply_keyswitch.cpp"  // NOLINT
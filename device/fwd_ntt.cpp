@@ -20,6 +20,7 @@
 #define REORDER 1
 #define PRINT_ROW_RESULT 0
 
+// maximum transform size, the size of each batch is set at runtime
 #ifndef FPGA_NTT_SIZE
 #define FPGA_NTT_SIZE 16384
 #else
@@ -57,6 +58,9 @@ typedef struct {
 
 defPipe1d(inDataPipe, WideVecType, 16, NUM_NTT_COMPUTE_UNITS);
 defPipe1d(miniBatchSizePipeNTT, unsigned32Bits_t, 16, NUM_NTT_COMPUTE_UNITS);
+defPipe1d(nttSizeLogPipe, unsigned32Bits_t, 16, NUM_NTT_COMPUTE_UNITS);
+defPipe1d(twiddleTableIdPipe, unsigned32Bits_t, 16, NUM_NTT_COMPUTE_UNITS);
+defPipe1d(twiddleRequestPipe, bool, 16, NUM_NTT_COMPUTE_UNITS);
 defPipe1d(outDataPipe, WideVecType, 16, NUM_NTT_COMPUTE_UNITS);
 defPipe1d(modulusPipe, unsigned64Bits_t, 16, NUM_NTT_COMPUTE_UNITS);
 defPipe1d(twiddleFactorsPipe, Wide64BytesType, 16, NUM_NTT_COMPUTE_UNITS);
@@ -99,55 +103,77 @@ void fwd_ntt_kernel(sycl::queue& q) {
             constexpr size_t numTwiddlePerWord =
                 sizeof(Wide64BytesType) / sizeof(unsigned64Bits_t);
 
-            for (int i = 0; i < FPGA_NTT_SIZE / VEC; i++) {
-#pragma unroll
-                for (int j = 0; j < VEC; j++) {
-                    Xm[i][j] = 0;
-                }
-            }
+            unsigned int prev_ntt_size = 0;
+            // id of the twiddle table held in local_roots/local_precons
+            unsigned32Bits_t loaded_table_id = 0;
 
             while (true) {
                 unsigned32Bits_t miniBatchSize =
                     miniBatchSizePipeNTT::PipeAt<computeUnitID>::read();
+                unsigned32Bits_t ntt_size_log =
+                    nttSizeLogPipe::PipeAt<computeUnitID>::read();
+                unsigned int ntt_size = 1 << ntt_size_log;
 
-                for (int i = 0; i < FPGA_NTT_SIZE / numTwiddlePerWord; i++) {
-                    Wide64BytesType vecTwiddle =
-                        twiddleFactorsPipe::PipeAt<computeUnitID>::read();
+                // the stage markers of another size would select stale data
+                if (ntt_size != prev_ntt_size) {
+                    for (int i = 0; i < FPGA_NTT_SIZE / VEC; i++) {
 #pragma unroll
-                    for (size_t j = 0; j < numTwiddlePerWord; ++j) {
-                        local_roots[i * numTwiddlePerWord + j] =
-                            vecTwiddle.data[j];
+                        for (int j = 0; j < VEC; j++) {
+                            Xm[i][j] = 0;
+                        }
                     }
+                    prev_ntt_size = ntt_size;
                 }
 
-                for (int i = 0; i < FPGA_NTT_SIZE / numTwiddlePerWord; i++) {
-                    Wide64BytesType vecExponent =
-                        barrettTwiddleFactorsPipe::PipeAt<
-                            computeUnitID>::read();
+                for (int mb = 0; mb < miniBatchSize; mb++) {
+                    // each frame carries its own modulus and twiddle table
+                    unsigned32Bits_t table_id =
+                        twiddleTableIdPipe::PipeAt<computeUnitID>::read();
+                    unsigned64Bits_t modulus =
+                        modulusPipe::PipeAt<computeUnitID>::read();
+                    bool reload = (table_id != loaded_table_id);
+                    twiddleRequestPipe::PipeAt<computeUnitID>::write(reload);
+
+                    // the twiddles are streamed only when the table changes
+                    if (reload) {
+                        for (int i = 0; i < ntt_size / numTwiddlePerWord;
+                             i++) {
+                            Wide64BytesType vecTwiddle = twiddleFactorsPipe::
+                                PipeAt<computeUnitID>::read();
 #pragma unroll
-                    for (size_t j = 0; j < numTwiddlePerWord; ++j) {
-                        local_precons[i * numTwiddlePerWord + j] =
-                            vecExponent.data[j];
-                    }
-                }
+                            for (size_t j = 0; j < numTwiddlePerWord; ++j) {
+                                local_roots[i * numTwiddlePerWord + j] =
+                                    vecTwiddle.data[j];
+                            }
+                        }
 
-                unsigned64Bits_t modulus =
-                    modulusPipe::PipeAt<computeUnitID>::read();
+                        for (int i = 0; i < ntt_size / numTwiddlePerWord;
+                             i++) {
+                            Wide64BytesType vecExponent =
+                                barrettTwiddleFactorsPipe::PipeAt<
+                                    computeUnitID>::read();
+#pragma unroll
+                            for (size_t j = 0; j < numTwiddlePerWord; ++j) {
+                                local_precons[i * numTwiddlePerWord + j] =
+                                    vecExponent.data[j];
+                            }
+                        }
+                        loaded_table_id = table_id;
+                    }
 
-                for (int mb = 0; mb < miniBatchSize; mb++) {
                     unsigned64Bits_t coeff_mod = modulus;
                     unsigned64Bits_t twice_mod = modulus << 1;
-                    unsigned64Bits_t t = (FPGA_NTT_SIZE >> 1);
+                    unsigned64Bits_t t = (ntt_size >> 1);
 
-                    unsigned int t_log = FPGA_NTT_SIZE_LOG - 1;
+                    unsigned int t_log = ntt_size_log - 1;
                     unsigned char Xm_val = 0;
                     size_t s_index = 0;
 
-                    for (unsigned int m = 1; m < FPGA_NTT_SIZE; m <<= 1) {
+                    for (unsigned int m = 1; m < ntt_size; m <<= 1) {
                         Xm_val++;
                         [[intel::ivdep(X)]] [[intel::ivdep(X2)]] [[intel::ivdep(
                             Xm)]] for (unsigned int k = 0;
-                                       k < FPGA_NTT_SIZE / 2 / VEC; k++) {
+                                       k < ntt_size / 2 / VEC; k++) {
                             [[intel::fpga_register]] unsigned long
                                 curX[VEC * 2];
                             [[intel::fpga_register]] unsigned long
@@ -365,7 +391,7 @@ void fwd_ntt_kernel(sycl::queue& q) {
                                 Xm[(j1 + j) / VEC][(j1 + j) % VEC] = Xm_val;
 #endif
                                 // the last outer loop, t == 1
-                                if (m == (FPGA_NTT_SIZE / 2)) {
+                                if (m == (ntt_size / 2)) {
                                     unsigned long val = tx + Q;
                                     if (val >= twice_mod) {
                                         val -= twice_mod;
@@ -469,7 +495,7 @@ void fwd_ntt_kernel(sycl::queue& q) {
                                 }
                             }
 
-                            if (m == (FPGA_NTT_SIZE / 2)) {
+                            if (m == (ntt_size / 2)) {
                                 s_index = k * (VEC * 2);
                                 outDataPipe::PipeAt<computeUnitID>::write(
                                     elements_out);
@@ -497,14 +523,19 @@ void fwd_ntt_kernel(sycl::queue& q) {
 }
 
 void ntt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
-                      uint64_t* k_inData2, uint64_t* k_modulus,
+                      uint64_t* k_inData2, uint64_t* k_moduli,
                       uint64_t* k_twiddleFactors,
-                      uint64_t* k_barrettTwiddleFactors) {
+                      uint64_t* k_barrettTwiddleFactors, unsigned int n,
+                      unsigned int* k_tableIds, unsigned int* k_tableSlots) {
     sycl::host_ptr<uint64_t> inData(k_inData);
     sycl::host_ptr<uint64_t> inData2(k_inData2);
-    sycl::host_ptr<uint64_t> modulus(k_modulus);
-    sycl::host_ptr<uint64_t> twiddleFactors(k_twiddleFactors);
-    sycl::host_ptr<uint64_t> barrettTwiddleFactors(k_barrettTwiddleFactors);
+    sycl::host_ptr<uint64_t> moduli(k_moduli);
+    sycl::host_ptr<unsigned int> tableIds(k_tableIds);
+    sycl::host_ptr<unsigned int> tableSlots(k_tableSlots);
+    // the twiddle tables are resident in device memory, one slot of
+    // FPGA_NTT_SIZE words per table
+    sycl::device_ptr<uint64_t> twiddleFactors(k_twiddleFactors);
+    sycl::device_ptr<uint64_t> barrettTwiddleFactors(k_barrettTwiddleFactors);
 
     // Boardcast send miniBatchSize to each NTT autorun kernel instances
     Unroller<0, NUM_NTT_COMPUTE_UNITS>::Step([&](auto i) {
@@ -519,40 +550,16 @@ void ntt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
         miniBatchSizePipeNTT::PipeAt<i>::write(miniBatchSize);
     });
 
-    // Assuming the twiddle factors and the complex root of unity are similar
-    // distribute roots of unity to each kernel
-    constexpr size_t numTwiddlePerWord =
-        sizeof(Wide64BytesType) / sizeof(unsigned64Bits_t);
-    constexpr unsigned int iterations = FPGA_NTT_SIZE / numTwiddlePerWord;
-
-    for (size_t i = 0; i < iterations; i++) {
-        Wide64BytesType tw;
-#pragma unroll
-        for (size_t j = 0; j < numTwiddlePerWord; j++) {
-            tw.data[j] = twiddleFactors[i * numTwiddlePerWord + j];
-        }
-
-        // broadcast twiddles to all compute units
-        Unroller<0, NUM_NTT_COMPUTE_UNITS>::Step(
-            [&](auto c) { twiddleFactorsPipe::PipeAt<c>::write(tw); });
+    // boardcast the transform size, as its log, to all the kernels
+    unsigned32Bits_t n_log = 0;
+    while ((1u << n_log) < n) {
+        n_log++;
     }
-
-    for (size_t i = 0; i < FPGA_NTT_SIZE / numTwiddlePerWord; i++) {
-        Wide64BytesType tw;
-#pragma unroll
-        for (size_t j = 0; j < numTwiddlePerWord; j++) {
-            tw.data[j] = barrettTwiddleFactors[i * numTwiddlePerWord + j];
-        }
-
-        // broadcast twiddles to all compute units
-        Unroller<0, NUM_NTT_COMPUTE_UNITS>::Step(
-            [&](auto c) { barrettTwiddleFactorsPipe::PipeAt<c>::write(tw); });
-    }
-
-    // boardcast modulus to all the kernels
-    unsigned64Bits_t mod = modulus[0];
     Unroller<0, NUM_NTT_COMPUTE_UNITS>::Step(
-        [&](auto c) { modulusPipe::PipeAt<c>::write(mod); });
+        [&](auto c) { nttSizeLogPipe::PipeAt<c>::write(n_log); });
+
+    constexpr size_t numTwiddlePerWord =
+        sizeof(Wide64BytesType) / sizeof(unsigned64Bits_t);
 
     ////////////////////////////////////////////////////////////////////////////////////
     // Retrieve one NTT data and stream to different kernels, per iteration for
@@ -563,14 +570,46 @@ void ntt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
     Unroller<0, NUM_NTT_COMPUTE_UNITS>::Step([&](auto computeUnitID) {
         for (unsigned int b = 0; b < numFrames; b++) {
             if (b % NUM_NTT_COMPUTE_UNITS == computeUnitID) {
-                for (size_t i = 0; i < FPGA_NTT_SIZE / numElementsInVec; i++) {
+                // send the modulus and the table id of the frame, the
+                // kernel requests the twiddles when it holds another table
+                twiddleTableIdPipe::PipeAt<computeUnitID>::write(tableIds[b]);
+                modulusPipe::PipeAt<computeUnitID>::write(moduli[b]);
+                bool reload =
+                    twiddleRequestPipe::PipeAt<computeUnitID>::read();
+                unsigned int iterations = reload ? n / numTwiddlePerWord : 0;
+                unsigned long tw_offset =
+                    (unsigned long)tableSlots[b] * FPGA_NTT_SIZE;
+
+                for (size_t i = 0; i < iterations; i++) {
+                    Wide64BytesType tw;
+#pragma unroll
+                    for (size_t j = 0; j < numTwiddlePerWord; j++) {
+                        tw.data[j] =
+                            twiddleFactors[tw_offset + i * numTwiddlePerWord +
+                                           j];
+                    }
+                    twiddleFactorsPipe::PipeAt<computeUnitID>::write(tw);
+                }
+
+                for (size_t i = 0; i < iterations; i++) {
+                    Wide64BytesType tw;
+#pragma unroll
+                    for (size_t j = 0; j < numTwiddlePerWord; j++) {
+                        tw.data[j] = barrettTwiddleFactors
+                            [tw_offset + i * numTwiddlePerWord + j];
+                    }
+                    barrettTwiddleFactorsPipe::PipeAt<computeUnitID>::write(
+                        tw);
+                }
+
+                for (size_t i = 0; i < n / numElementsInVec; i++) {
                     WideVecType inVec;
-                    unsigned long offset = b * FPGA_NTT_SIZE + i * VEC;
+                    unsigned long offset = b * n + i * VEC;
 #pragma unroll
                     for (size_t j = 0; j < VEC; j++) {
                         inVec.data[j] = inData[offset + j];
                         inVec.data[j + VEC] =
-                            inData2[offset + FPGA_NTT_SIZE / 2 + j];
+                            inData2[offset + n / 2 + j];
                     }
                     inDataPipe::PipeAt<computeUnitID>::write(inVec);
                 }
@@ -579,7 +618,7 @@ void ntt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
     });
 }
 
-void ntt_output_kernel(int numFrames, uint64_t* k_outData) {
+void ntt_output_kernel(int numFrames, uint64_t* k_outData, unsigned int n) {
     sycl::host_ptr<uint64_t> outData(k_outData);
 
     constexpr unsigned int numElementsInVec =
@@ -588,11 +627,10 @@ void ntt_output_kernel(int numFrames, uint64_t* k_outData) {
     Unroller<0, NUM_NTT_COMPUTE_UNITS>::Step([&](auto computeUnitID) {
         for (size_t b = 0; b < numFrames; b++) {
             if (b % NUM_NTT_COMPUTE_UNITS == computeUnitID) {
-                for (size_t i = 0; i < FPGA_NTT_SIZE / numElementsInVec; i++) {
+                for (size_t i = 0; i < n / numElementsInVec; i++) {
                     WideVecType oVec =
                         outDataPipe::PipeAt<computeUnitID>::read();
-                    unsigned long offset =
-                        b * FPGA_NTT_SIZE + i * numElementsInVec;
+                    unsigned long offset = b * n + i * numElementsInVec;
 #pragma unroll
                     for (size_t j = 0; j < numElementsInVec; j++) {
                         outData[offset + j] = oVec.data[j];
@@ -621,14 +659,23 @@ void fwd_ntt(sycl::queue& q) {
         [&](auto idx) { fwd_ntt_kernel<idx>(q); });
 }
 
+/**
+ * @brief stream a batch of numFrames polynomials of n coefficients, a power
+ * of two up to FPGA_NTT_SIZE, to the ntt kernels. Frame b is reduced by
+ * moduli[b] with the twiddle table tableIds[b], held in slot tableSlots[b] of
+ * the device memory tables. A table is only streamed to a kernel that holds
+ * another one.
+ */
 sycl::event ntt_input(sycl::queue& q, unsigned int numFrames, uint64_t* inData,
-                      uint64_t* inData2, uint64_t* modulus,
+                      uint64_t* inData2, uint64_t* moduli,
                       uint64_t* twiddleFactors,
-                      uint64_t* barrettTwiddleFactors) {
+                      uint64_t* barrettTwiddleFactors, unsigned int n,
+                      unsigned int* tableIds, unsigned int* tableSlots) {
     auto e = q.submit([&](sycl::handler& h) {
         h.single_task<FWD_NTT_INPUT>([=]() [[intel::kernel_args_restrict]] {
-            ntt_input_kernel(numFrames, inData, inData2, modulus,
-                             twiddleFactors, barrettTwiddleFactors);
+            ntt_input_kernel(numFrames, inData, inData2, moduli,
+                             twiddleFactors, barrettTwiddleFactors, n,
+                             tableIds, tableSlots);
         });
     });
 
@@ -636,12 +683,23 @@ sycl::event ntt_input(sycl::queue& q, unsigned int numFrames, uint64_t* inData,
 }
 
 sycl::event ntt_output(sycl::queue& q, int numFrames,
-                       uint64_t* outData_in_svm) {
+                       uint64_t* outData_in_svm, unsigned int n) {
     auto e = q.submit([&](sycl::handler& h) {
         h.single_task<FWD_NTT_OUTPUT>([=]() [[intel::kernel_args_restrict]] {
-            ntt_output_kernel(numFrames, outData_in_svm);
+            ntt_output_kernel(numFrames, outData_in_svm, n);
         });
     });
     return e;
 }
+
+/**
+ * @brief largest transform size of the ntt kernels.
+ */
+uint64_t ntt_max_coeff_count() { return FPGA_NTT_SIZE; }
+
+/**
+ * @brief number of ntt kernel compute units, the frames of a batch are
+ * distributed round-robin over them.
+ */
+uint64_t ntt_compute_units() { return NUM_NTT_COMPUTE_UNITS; }
 }  // end of extern "C"
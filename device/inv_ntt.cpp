@@ -10,6 +10,7 @@
 
 #include "dpc_common.hpp"
 
+// maximum transform size, the size of each batch is set at runtime
 #ifndef FPGA_INTT_SIZE
 #define FPGA_INTT_SIZE 16384
 #endif
@@ -47,6 +48,9 @@ typedef struct {
 #ifndef __FULL_DEPTH_CHANNELS__
 defPipe1d(modulusPipeINTT, ulong64Bit, 16, NUM_INTT_COMPUTE_UNITS);
 defPipe1d(miniBatchPipeINTT, ulong64Bit, 16, NUM_INTT_COMPUTE_UNITS);
+defPipe1d(inttSizeLogPipe, uint32Bit, 16, NUM_INTT_COMPUTE_UNITS);
+defPipe1d(twiddleTableIdPipeINTT, uint32Bit, 16, NUM_INTT_COMPUTE_UNITS);
+defPipe1d(twiddleRequestPipeINTT, bool, 16, NUM_INTT_COMPUTE_UNITS);
 defPipe1d(inDataPipeINTT, WideVecInType, 16, NUM_INTT_COMPUTE_UNITS);
 defPipe1d(outDataPipeINTT, WideVecOutType, (FPGA_INTT_SIZE / VEC_INTT / 2),
           NUM_INTT_COMPUTE_UNITS);
@@ -62,6 +66,10 @@ defPipe1d(barrettTwiddleFactorsPipeINTT, Wide64ByteType, 16,
 /// pipes//////////////////////////////////////////////////////
 defPipe1d(modulusPipeINTT, ulong64Bit, FPGA_INTT_SIZE, NUM_INTT_COMPUTE_UNITS);
 defPipe1d(miniBatchPipeINTT, uint32Bit, FPGA_INTT_SIZE, NUM_INTT_COMPUTE_UNITS);
+defPipe1d(inttSizeLogPipe, uint32Bit, FPGA_INTT_SIZE, NUM_INTT_COMPUTE_UNITS);
+defPipe1d(twiddleTableIdPipeINTT, uint32Bit, FPGA_INTT_SIZE,
+          NUM_INTT_COMPUTE_UNITS);
+defPipe1d(twiddleRequestPipeINTT, bool, FPGA_INTT_SIZE, NUM_INTT_COMPUTE_UNITS);
 defPipe1d(inDataPipeINTT, WideVecInType, FPGA_INTT_SIZE,
           NUM_INTT_COMPUTE_UNITS);
 defPipe1d(outDataPipeINTT, WideVecOutType, FPGA_INTT_SIZE,
@@ -84,7 +92,7 @@ void inv_ntt_kernel(sycl::queue& q) {
     q.submit([&](sycl::handler& h) {
         h.single_task<INV_NTT_KERN<id>>([=]() {
             constexpr int computeUnitID = id;
-            int n = (int)FPGA_INTT_SIZE;
+            int n = 0;
             unsigned char Xm_val;
             unsigned int roots_acc;
             int t;
@@ -99,47 +107,67 @@ void inv_ntt_kernel(sycl::queue& q) {
             unsigned long local_roots[FPGA_INTT_SIZE];
             unsigned long local_precons[FPGA_INTT_SIZE];
 
-            for (int i = 0; i < FPGA_INTT_SIZE / VEC_INTT; i++) {
-                Xm[i] = 0;
-            }
-
             ulong64Bit prime;
+            // id of the twiddle table held in local_roots/local_precons
+            uint32Bit loaded_table_id = 0;
 
             [[intel::disable_loop_pipelining]] while (true) {
                 uint32Bit miniBatchSize =
                     miniBatchPipeINTT::PipeAt<computeUnitID>::read();
-                prime = modulusPipeINTT::PipeAt<computeUnitID>::read();
-                ulong64Bit inv_n = inv_ni_pipe::PipeAt<computeUnitID>::read();
-                ulong64Bit inv_n_w =
-                    inv_n_wi_pipe::PipeAt<computeUnitID>::read();
-
-                unsigned long twice_mod = prime << 1;
-                unsigned long output_mod_factor = 1;
-                constexpr size_t numTwiddlePerWord =
-                    sizeof(Wide64ByteType) / sizeof(ulong64Bit);
-
-                for (int i = 0; i < FPGA_INTT_SIZE / numTwiddlePerWord; i++) {
-                    Wide64ByteType VEC_INTTTwiddle =
-                        twiddleFactorsPipeINTT::PipeAt<computeUnitID>::read();
-#pragma unroll
-                    for (size_t j = 0; j < numTwiddlePerWord; ++j) {
-                        local_roots[i * numTwiddlePerWord + j] =
-                            VEC_INTTTwiddle.data[j];
+                uint32Bit n_log =
+                    inttSizeLogPipe::PipeAt<computeUnitID>::read();
+
+                // the stage markers of another size would select stale data
+                if ((1 << n_log) != n) {
+                    n = 1 << n_log;
+                    for (int i = 0; i < FPGA_INTT_SIZE / VEC_INTT; i++) {
+                        Xm[i] = 0;
                     }
                 }
+                for (int i = 0; i < miniBatchSize; i++) {
+                    // each frame carries its own modulus and twiddle table
+                    uint32Bit table_id =
+                        twiddleTableIdPipeINTT::PipeAt<computeUnitID>::read();
+                    prime = modulusPipeINTT::PipeAt<computeUnitID>::read();
+                    ulong64Bit inv_n =
+                        inv_ni_pipe::PipeAt<computeUnitID>::read();
+                    ulong64Bit inv_n_w =
+                        inv_n_wi_pipe::PipeAt<computeUnitID>::read();
+
+                    unsigned long twice_mod = prime << 1;
+                    unsigned long output_mod_factor = 1;
+                    constexpr size_t numTwiddlePerWord =
+                        sizeof(Wide64ByteType) / sizeof(ulong64Bit);
+
+                    // the twiddles are streamed only when the table changes
+                    bool reload = (table_id != loaded_table_id);
+                    twiddleRequestPipeINTT::PipeAt<computeUnitID>::write(
+                        reload);
+                    if (reload) {
+                        for (int i = 0; i < n / numTwiddlePerWord; i++) {
+                            Wide64ByteType VEC_INTTTwiddle =
+                                twiddleFactorsPipeINTT::PipeAt<
+                                    computeUnitID>::read();
+#pragma unroll
+                            for (size_t j = 0; j < numTwiddlePerWord; ++j) {
+                                local_roots[i * numTwiddlePerWord + j] =
+                                    VEC_INTTTwiddle.data[j];
+                            }
+                        }
 
-                for (int i = 0; i < FPGA_INTT_SIZE / numTwiddlePerWord; i++) {
-                    Wide64ByteType VEC_INTTExponent =
-                        barrettTwiddleFactorsPipeINTT::PipeAt<
-                            computeUnitID>::read();
+                        for (int i = 0; i < n / numTwiddlePerWord; i++) {
+                            Wide64ByteType VEC_INTTExponent =
+                                barrettTwiddleFactorsPipeINTT::PipeAt<
+                                    computeUnitID>::read();
 #pragma unroll
-                    for (size_t j = 0; j < numTwiddlePerWord; ++j) {
-                        local_precons[i * numTwiddlePerWord + j] =
-                            VEC_INTTExponent.data[j];
+                            for (size_t j = 0; j < numTwiddlePerWord; ++j) {
+                                local_precons[i * numTwiddlePerWord + j] =
+                                    VEC_INTTExponent.data[j];
+                            }
+                        }
+                        loaded_table_id = table_id;
                     }
-                }
 
-                for (int i = 0; i < miniBatchSize; i++) {
                     Xm_val = 0;
                     roots_acc = 1;
                     t = 1;
@@ -152,7 +180,7 @@ void inv_ntt_kernel(sycl::queue& q) {
 
                         [[intel::ivdep(X)]] [[intel::ivdep(X2)]] [[intel::ivdep(
                             Xm)]] for (int k = 0;
-                                       k < FPGA_INTT_SIZE / 2 / VEC_INTT; k++) {
+                                       k < n / 2 / VEC_INTT; k++) {
                             [[intel::fpga_register]] unsigned long
                                 curX[VEC_INTT * 2];
                             [[intel::fpga_register]] unsigned long
@@ -442,15 +470,20 @@ void inv_ntt_kernel(sycl::queue& q) {
 }
 
 void intt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
-                       uint64_t* k_modulus, uint64_t* k_inv_ni,
+                       uint64_t* k_moduli, uint64_t* k_inv_ni,
                        uint64_t* k_inv_n_wi, uint64_t* k_twiddleFactors,
-                       uint64_t* k_barrettTwiddleFactors) {
+                       uint64_t* k_barrettTwiddleFactors, unsigned int n,
+                       unsigned int* k_tableIds, unsigned int* k_tableSlots) {
     sycl::host_ptr<uint64_t> inData(k_inData);
-    sycl::host_ptr<uint64_t> modulus(k_modulus);
+    sycl::host_ptr<uint64_t> moduli(k_moduli);
     sycl::host_ptr<uint64_t> inv_ni(k_inv_ni);
     sycl::host_ptr<uint64_t> inv_n_wi(k_inv_n_wi);
-    sycl::host_ptr<uint64_t> twiddleFactors(k_twiddleFactors);
-    sycl::host_ptr<uint64_t> barrettTwiddleFactors(k_barrettTwiddleFactors);
+    sycl::host_ptr<unsigned int> tableIds(k_tableIds);
+    sycl::host_ptr<unsigned int> tableSlots(k_tableSlots);
+    // the twiddle tables are resident in device memory, one slot of
+    // FPGA_INTT_SIZE words per table
+    sycl::device_ptr<uint64_t> twiddleFactors(k_twiddleFactors);
+    sycl::device_ptr<uint64_t> barrettTwiddleFactors(k_barrettTwiddleFactors);
 
     // Create mini batches for every INTT instance
     Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step([&](auto i) {
@@ -466,47 +499,16 @@ void intt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
         miniBatchPipeINTT::PipeAt<i>::write(miniBatchSize);
     });
 
-    // Assuming the twiddle factors and the complex root of unity are similar
-    // broadcast roots of unity to each kernel
-    uint64_t temp = modulus[0];
-    Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step(
-        [&](auto c) { modulusPipeINTT::PipeAt<c>::write(temp); });
-
-    uint64_t inv_ni_temp = inv_ni[0];
-    Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step(
-        [&](auto c) { inv_ni_pipe::PipeAt<c>::write(inv_ni_temp); });
-
-    uint64_t inv_n_wi_temp = inv_n_wi[0];
+    // broadcast the transform size, as its log, to all the kernels
+    uint32Bit n_log = 0;
+    while ((1u << n_log) < n) {
+        n_log++;
+    }
     Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step(
-        [&](auto c) { inv_n_wi_pipe::PipeAt<c>::write(inv_n_wi_temp); });
+        [&](auto c) { inttSizeLogPipe::PipeAt<c>::write(n_log); });
 
     constexpr size_t numTwiddlePerWord =
         sizeof(Wide64ByteType) / sizeof(ulong64Bit);
-    constexpr unsigned int iterations = FPGA_INTT_SIZE / numTwiddlePerWord;
-
-    for (size_t i = 0; i < iterations; i++) {
-        Wide64ByteType tw;
-#pragma unroll
-        for (size_t j = 0; j < numTwiddlePerWord; j++) {
-            tw.data[j] = twiddleFactors[i * numTwiddlePerWord + j];
-        }
-
-        // broadcast twiddles to all compute units
-        Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step(
-            [&](auto c) { twiddleFactorsPipeINTT::PipeAt<c>::write(tw); });
-    }
-
-    for (size_t i = 0; i < FPGA_INTT_SIZE / numTwiddlePerWord; i++) {
-        Wide64ByteType tw;
-#pragma unroll
-        for (size_t j = 0; j < numTwiddlePerWord; j++) {
-            tw.data[j] = barrettTwiddleFactors[i * numTwiddlePerWord + j];
-        }
-        // broadcast twiddles to all compute units
-        Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step([&](auto c) {
-            barrettTwiddleFactorsPipeINTT::PipeAt<c>::write(tw);
-        });
-    }
 
     ////////////////////////////////////////////////////////////////////////////////////
     // Retrieve one INTT data and stream to different kernels, per iteration for
@@ -518,10 +520,45 @@ void intt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
     Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step([&](auto computeUnitIndex) {
         for (unsigned int b = 0; b < numFrames; b++) {
             if (b % NUM_INTT_COMPUTE_UNITS == computeUnitIndex) {
-                for (size_t i = 0; i < FPGA_INTT_SIZE / numElementsInVec; i++) {
+                // send the modulus and the table id of the frame, the
+                // kernel requests the twiddles when it holds another table
+                twiddleTableIdPipeINTT::PipeAt<computeUnitIndex>::write(
+                    tableIds[b]);
+                modulusPipeINTT::PipeAt<computeUnitIndex>::write(moduli[b]);
+                inv_ni_pipe::PipeAt<computeUnitIndex>::write(inv_ni[b]);
+                inv_n_wi_pipe::PipeAt<computeUnitIndex>::write(inv_n_wi[b]);
+                bool reload =
+                    twiddleRequestPipeINTT::PipeAt<computeUnitIndex>::read();
+                unsigned int iterations = reload ? n / numTwiddlePerWord : 0;
+                unsigned long tw_offset =
+                    (unsigned long)tableSlots[b] * FPGA_INTT_SIZE;
+
+                for (size_t i = 0; i < iterations; i++) {
+                    Wide64ByteType tw;
+#pragma unroll
+                    for (size_t j = 0; j < numTwiddlePerWord; j++) {
+                        tw.data[j] =
+                            twiddleFactors[tw_offset + i * numTwiddlePerWord +
+                                           j];
+                    }
+                    twiddleFactorsPipeINTT::PipeAt<computeUnitIndex>::write(
+                        tw);
+                }
+
+                for (size_t i = 0; i < iterations; i++) {
+                    Wide64ByteType tw;
+#pragma unroll
+                    for (size_t j = 0; j < numTwiddlePerWord; j++) {
+                        tw.data[j] = barrettTwiddleFactors
+                            [tw_offset + i * numTwiddlePerWord + j];
+                    }
+                    barrettTwiddleFactorsPipeINTT::PipeAt<
+                        computeUnitIndex>::write(tw);
+                }
+
+                for (size_t i = 0; i < n / numElementsInVec; i++) {
                     WideVecInType inVec;
-                    unsigned long offset =
-                        b * FPGA_INTT_SIZE + i * numElementsInVec;
+                    unsigned long offset = b * n + i * numElementsInVec;
 #pragma unroll
                     for (size_t j = 0; j < numElementsInVec / 2; j++) {
                         inVec.data[j] = inData[offset + j];
@@ -540,17 +577,18 @@ void intt_input_kernel(unsigned int numFrames, uint64_t* k_inData,
     });
 }
 
-void intt_output_kernel(unsigned int numFrames, uint64_t* k_outData) {
+void intt_output_kernel(unsigned int numFrames, uint64_t* k_outData,
+                        unsigned int n) {
     sycl::host_ptr<uint64_t> outData(k_outData);
 
     Unroller<0, NUM_INTT_COMPUTE_UNITS>::Step([&](auto computeUnitIndex) {
         for (size_t i = 0; i < numFrames; i++) {
             if (i % NUM_INTT_COMPUTE_UNITS == computeUnitIndex) {
-                size_t frameOffset = i * FPGA_INTT_SIZE;
-                for (unsigned int k = 0; k < FPGA_INTT_SIZE / VEC_INTT; k++) {
+                size_t frameOffset = i * n;
+                for (unsigned int k = 0; k < n / VEC_INTT; k++) {
                     size_t offset = frameOffset + k * VEC_INTT;
                     WideVecOutType elements_out;
-                    if (k < FPGA_INTT_SIZE / VEC_INTT / 2) {
+                    if (k < n / VEC_INTT / 2) {
                         elements_out =
                             outDataPipeINTT::PipeAt<computeUnitIndex>::read();
                     } else {
@@ -579,16 +617,26 @@ void inv_ntt(sycl::queue& q) {
         [&](auto idx) { inv_ntt_kernel<idx>(q); });
 }
 
+/**
+ * @brief stream a batch of numFrames polynomials of n coefficients, a power
+ * of two up to FPGA_INTT_SIZE, to the intt kernels. Frame b is reduced by
+ * moduli[b] with the twiddle table tableIds[b], held in slot tableSlots[b] of
+ * the device memory tables. A table is only streamed to a kernel that holds
+ * another one.
+ */
 sycl::event intt_input(sycl::queue& q, unsigned int numFrames,
-                       uint64_t* inData_svm, uint64_t* modulus_svm,
+                       uint64_t* inData_svm, uint64_t* moduli_svm,
                        uint64_t* inv_ni_svm, uint64_t* inv_n_wi_svm,
-                       uint64_t* twiddleFactors_svm,
-                       uint64_t* barrettTwiddleFactors_svm) {
+                       uint64_t* twiddleFactors_ddr,
+                       uint64_t* barrettTwiddleFactors_ddr, unsigned int n,
+                       unsigned int* tableIds_svm,
+                       unsigned int* tableSlots_svm) {
     auto e = q.submit([&](sycl::handler& h) {
         h.single_task<INV_NTT_INPUT>([=]() [[intel::kernel_args_restrict]] {
-            intt_input_kernel(numFrames, inData_svm, modulus_svm, inv_ni_svm,
-                              inv_n_wi_svm, twiddleFactors_svm,
-                              barrettTwiddleFactors_svm);
+            intt_input_kernel(numFrames, inData_svm, moduli_svm, inv_ni_svm,
+                              inv_n_wi_svm, twiddleFactors_ddr,
+                              barrettTwiddleFactors_ddr, n, tableIds_svm,
+                              tableSlots_svm);
         });
     });
 
@@ -596,14 +644,25 @@ sycl::event intt_input(sycl::queue& q, unsigned int numFrames,
 }
 
 sycl::event intt_output(sycl::queue& q, unsigned int numFrames,
-                        uint64_t* outData_svm) {
+                        uint64_t* outData_svm, unsigned int n) {
     auto e = q.submit([&](sycl::handler& h) {
         h.single_task<INV_NTT_OUTPUT>([=]() [[intel::kernel_args_restrict]] {
-            intt_output_kernel(numFrames, outData_svm);
+            intt_output_kernel(numFrames, outData_svm, n);
         });
     });
 
     return e;
 }
 
+/**
+ * @brief largest transform size of the intt kernels.
+ */
+uint64_t intt_max_coeff_count() { return FPGA_INTT_SIZE; }
+
+/**
+ * @brief number of intt kernel compute units, the frames of a batch are
+ * distributed round-robin over them.
+ */
+uint64_t intt_compute_units() { return NUM_INTT_COMPUTE_UNITS; }
+
 }  // end of extern C
@@ -8,6 +8,7 @@
 #include "keyswitch/store.hpp"
 
 class keyswitch_load_kernel;
+class keyswitch_load_usm_kernel;
 class keyswitch_store_kernel;
 
 extern "C" {
@@ -22,6 +23,18 @@ sycl::event load(sycl::queue& q, sycl::event* inDepsEv,
     return event;
 }
 
+// the frames are read from device memory, where the dyadic multiply kernel
+// of the combined bitstream left them.
+sycl::event load_usm(sycl::queue& q, sycl::event* inDepsEv, unsigned num_deps,
+                     uint64_t** t_target_iter_ptrs, moduli_t moduli,
+                     uint64_t coeff_count, uint64_t decomp_modulus_size,
+                     uint64_t num_batch, invn_t inv_n, unsigned rmem) {
+    auto event = load_usm<keyswitch_load_usm_kernel>(
+        q, inDepsEv, num_deps, t_target_iter_ptrs, moduli, coeff_count,
+        decomp_modulus_size, num_batch, inv_n, rmem);
+    return event;
+}
+
 sycl::event store(sycl::queue& q, sycl::event* inDepsEv,
                   sycl::buffer<sycl::ulong2>& dp_results, uint64_t num_batch,
                   uint64_t coeff_count, uint64_t decomp_modulus_size,
@@ -48,6 +61,9 @@ void launchStoreSwitchKeys(sycl::queue& q,
                       buff_k_switch_keys3, batch_size);
 }
 
+uint64_t keyswitch_max_coeff_count() { return MAX_COFF_COUNT; }
+uint64_t keyswitch_max_modulus_bits() { return MAX_MODULUS_BITS; }
+
 void launchAllAutoRunKernels(sycl::queue& q) {
     initTwiddleGenerator(q);
     initInnt1Kernels(q);
@@ -29,35 +29,29 @@ void broadcast_keys(sycl::queue& q,
             for (int i = 0; i < batch_size; i++) {
                 unsigned params_size = tt_ch_keyswitch_params::read();
                 for (int i = 0; i < params_size; i++) {
-                    uint256_t keys1 = k_switch_keys1[i];
-                    uint256_t keys2 = k_switch_keys2[i];
-                    uint256_t keys3 = k_switch_keys3[i];
+                    // gather the KEY_WORDS words of the coefficient, then
+                    // cut them into keys of MAX_MODULUS_BITS bits.
+                    ac_int<KEY_WORDS * 256, false> packed = 0;
+                    Unroller<0, KEY_WORDS>::Step([&](auto w) {
+                        unsigned row = i * KEY_ROWS + w / 3;
+                        uint256_t word;
+                        if (w % 3 == 0) {
+                            word = k_switch_keys1[row];
+                        } else if (w % 3 == 1) {
+                            word = k_switch_keys2[row];
+                        } else {
+                            word = k_switch_keys3[row];
+                        }
+                        packed |= ac_int<KEY_WORDS * 256, false>(word)
+                                  << (w * 256);
+                    });
                     ulong keys[KEYS_LEN];
-                    int j = 0;
-                    keys[j++] = (keys1 & BIT_MASK_52).to_uint64();
-                    keys[j++] = ((keys1 >> 52) & BIT_MASK_52).to_uint64();
-                    keys[j++] = ((keys1 >> (52 * 2)) & BIT_MASK_52).to_uint64();
-                    keys[j++] = ((keys1 >> (52 * 3)) & BIT_MASK_52).to_uint64();
-                    keys[j++] = (((keys1 >> (52 * 4)) & BIT_MASK_52) |
-                                 ((keys2 & BIT_MASK_4) << 48))
-                                    .to_uint64();
-
-                    keys[j++] = ((keys2 >> 4) & BIT_MASK_52).to_uint64();
-                    keys[j++] = ((keys2 >> (4 + 52)) & BIT_MASK_52).to_uint64();
-                    keys[j++] =
-                        ((keys2 >> (4 + 52 * 2)) & BIT_MASK_52).to_uint64();
-                    keys[j++] =
-                        ((keys2 >> (4 + 52 * 3)) & BIT_MASK_52).to_uint64();
-                    keys[j++] = (((keys2 >> (4 + 52 * 4)) & BIT_MASK_52) |
-                                 ((keys3 & BIT_MASK_8) << 44))
-                                    .to_uint64();
-
-                    keys[j++] = ((keys3 >> 8) & BIT_MASK_52).to_uint64();
-                    keys[j++] = ((keys3 >> (8 + 52)) & BIT_MASK_52).to_uint64();
-                    keys[j++] =
-                        ((keys3 >> (8 + 52 * 2)) & BIT_MASK_52).to_uint64();
-                    keys[j++] =
-                        ((keys3 >> (8 + 52 * 3)) & BIT_MASK_52).to_uint64();
+                    Unroller<0, KEYS_LEN>::Step([&](auto j) {
+                        keys[j] = packed
+                                      .template slc<MAX_MODULUS_BITS>(
+                                          j * MAX_MODULUS_BITS)
+                                      .to_uint64();
+                    });
 
                     Unroller<0, tp_MAX_RNS_MODULUS_SIZE>::Step([&](auto ins) {
                         sycl::ulong2 key;
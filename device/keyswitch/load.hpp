@@ -9,6 +9,75 @@
 #include "../utils/pipe_array.hpp"
 #include "../utils/unroller.hpp"
 
+// the moduli with the polynomial size folded into their spare bits.
+inline moduli_t load_moduli(moduli_t moduli, uint64_t coeff_count) {
+#pragma unroll
+    for (int i = 0; i < MAX_KEY_MODULUS_SIZE; i++) {
+        moduli.data[i].s0() =
+            moduli.data[i].s0() |
+            ((coeff_count >> COEFF_COUNT_SHIFT) << MAX_MODULUS_BITS);
+    }
+    return moduli;
+}
+
+// the parameters every core needs ahead of the coefficients of modulus
+// decomp_index of a frame, and the sizes of the frame ahead of its first
+// modulus.
+inline void load_params(const moduli_t& moduli, const invn_t& inv_n,
+                        unsigned decomp_index, uint64_t coeff_count,
+                        uint64_t decomp_modulus_size) {
+    if (decomp_index == 0) {
+        ch_ntt2_decomp_size::write(decomp_modulus_size * coeff_count);
+        ch_intt1_decomp_size::write(decomp_modulus_size * coeff_count);
+        ch_keyswitch_params::write(decomp_modulus_size * coeff_count);
+    }
+
+    Unroller<0, NUM_CORES>::Step([&](auto COREID) {
+        Unroller<0, MAX_RNS_MODULUS_SIZE>::Step([&](auto engid) {
+            using temp_pipe =
+                typename ch_intt_redu_params::template PipeAt<COREID, engid>;
+            temp_pipe::write(moduli.data[engid]);
+        });
+
+        sycl::ulong4 ms_params = moduli.data[decomp_index];
+        ms_params.s1() = decomp_index;
+
+        Unroller<0, MAX_KEY_COMPONENT_SIZE>::Step([&](auto engid) {
+            using temp_pipe =
+                typename ch_ms_params::template PipeAt<COREID, engid>;
+            temp_pipe::write(ms_params);
+        });
+
+        sycl::ulong4 intt2_redu_params = moduli.data[decomp_index];
+        intt2_redu_params.s2() =
+            ((moduli.data[MAX_KEY_MODULUS_SIZE - 1].s0() & MODULUS_BIT_MASK)
+             << 4) |
+            decomp_index;
+
+        Unroller<0, MAX_KEY_COMPONENT_SIZE>::Step([&](auto engid) {
+            using temp_pipe =
+                typename ch_intt2_redu_params::template PipeAt<COREID, engid>;
+            temp_pipe::write(intt2_redu_params);
+        });
+
+        sycl::ulong4 dyadmult_params;
+        Unroller<0, MAX_RNS_MODULUS_SIZE>::Step([&](auto engid) {
+            dyadmult_params = moduli.data[engid];
+            dyadmult_params.s1() = (decomp_modulus_size << 4) | decomp_index;
+            dyadmult_params.s2() = inv_n.data[engid].s0();
+            using temp_pipe =
+                typename ch_dyadmult_params::template PipeAt<COREID, engid>;
+            temp_pipe::write(dyadmult_params);
+        });
+
+        sycl::ulong4 cur_moduli = moduli.data[decomp_index];
+        cur_moduli.s2() = inv_n.data[decomp_index].s0();
+        using temp_pipe = typename ch_intt_modulus::template PipeAt<COREID, 0>;
+
+        temp_pipe::write(cur_moduli);
+    });
+}
+
 template <int id = 22786>
 class load_kernelNameClass;
 template <class tt_kernelNameClass = load_kernelNameClass<>>
@@ -27,8 +96,7 @@ sycl::event load(sycl::queue& q, sycl::event* inDepsEv,
                                             sycl::read_only);
         auto kernelLambda = [=]()
             [[intel::kernel_args_restrict]] [[intel::max_global_work_dim(0)]] {
-            moduli_t moduli = moduli_in;
-            unsigned i = 0;
+            moduli_t moduli = load_moduli(moduli_in, coeff_count);
             sycl::device_ptr<uint64_t> t_target_iter_ptr(dp_t_target_iter_ptr);
             unsigned ptr_index[NUM_CORES];
             unsigned num_batch_per_core = (num_batch - 1) / NUM_CORES + 1;
@@ -39,76 +107,13 @@ sycl::event load(sycl::queue& q, sycl::event* inDepsEv,
                     num_batch_per_core * decomp_modulus_size * coeff_count * i;
             }
             unsigned decomp_index = 0;
-#pragma unroll
-            for (int i = 0; i < MAX_KEY_MODULUS_SIZE; i++) {
-                moduli.data[i].s0() = moduli.data[i].s0() |
-                                      ((coeff_count >> 10) << MAX_MODULUS_BITS);
-            }
 
             [[intel::disable_loop_pipelining]] for (unsigned j = 0;
                                                     j < decomp_modulus_size *
                                                             num_batch_per_core;
                                                     j++) {
-                if (decomp_index == 0) {
-                    ch_ntt2_decomp_size::write(decomp_modulus_size *
-                                               coeff_count);
-                    ch_intt1_decomp_size::write(decomp_modulus_size *
-                                                coeff_count);
-                    ch_keyswitch_params::write(decomp_modulus_size *
-                                               coeff_count);
-                }
-
-                Unroller<0, NUM_CORES>::Step([&](auto COREID) {
-                    Unroller<0, MAX_RNS_MODULUS_SIZE>::Step([&](auto engid) {
-                        using temp_pipe =
-                            typename ch_intt_redu_params::template PipeAt<
-                                COREID, engid>;
-                        temp_pipe::write(moduli.data[engid]);
-                    });
-
-                    sycl::ulong4 ms_params = moduli.data[decomp_index];
-                    ms_params.s1() = decomp_index;
-
-                    Unroller<0, MAX_KEY_COMPONENT_SIZE>::Step([&](auto engid) {
-                        using temp_pipe =
-                            typename ch_ms_params::template PipeAt<COREID,
-                                                                   engid>;
-                        temp_pipe::write(ms_params);
-                    });
-
-                    sycl::ulong4 intt2_redu_params = moduli.data[decomp_index];
-                    intt2_redu_params.s2() =
-                        ((moduli.data[MAX_KEY_MODULUS_SIZE - 1].s0() &
-                          MODULUS_BIT_MASK)
-                         << 4) |
-                        decomp_index;
-
-                    Unroller<0, MAX_KEY_COMPONENT_SIZE>::Step([&](auto engid) {
-                        using temp_pipe =
-                            typename ch_intt2_redu_params::template PipeAt<
-                                COREID, engid>;
-                        temp_pipe::write(intt2_redu_params);
-                    });
-
-                    sycl::ulong4 dyadmult_params;
-                    Unroller<0, MAX_RNS_MODULUS_SIZE>::Step([&](auto engid) {
-                        dyadmult_params = moduli.data[engid];
-                        dyadmult_params.s1() =
-                            (decomp_modulus_size << 4) | decomp_index;
-                        dyadmult_params.s2() = inv_n.data[engid].s0();
-                        using temp_pipe =
-                            typename ch_dyadmult_params::template PipeAt<COREID,
-                                                                         engid>;
-                        temp_pipe::write(dyadmult_params);
-                    });
-
-                    sycl::ulong4 cur_moduli = moduli.data[decomp_index];
-                    cur_moduli.s2() = inv_n.data[decomp_index].s0();
-                    using temp_pipe =
-                        typename ch_intt_modulus::template PipeAt<COREID, 0>;
-
-                    temp_pipe::write(cur_moduli);
-                });
+                load_params(moduli, inv_n, decomp_index, coeff_count,
+                            decomp_modulus_size);
                 STEP(decomp_index, decomp_modulus_size);
                 uint coeff_count_tmp = coeff_count;
                 for (uint n = 0; n < coeff_count_tmp; n++) {
@@ -133,4 +138,75 @@ sycl::event load(sycl::queue& q, sycl::event* inDepsEv,
     return event;
 }
 
+// load reading every frame from device memory where an earlier kernel left
+// it, instead of from a buffer staged by the host: t_target_iter_ptrs holds
+// the device address of each of the num_batch frames. The kernel starts
+// once the num_deps events that write the frames completed.
+template <int id = 22787>
+class load_usm_kernelNameClass;
+template <class tt_kernelNameClass = load_usm_kernelNameClass<>>
+sycl::event load_usm(sycl::queue& q, sycl::event* inDepsEv, unsigned num_deps,
+                     uint64_t** t_target_iter_ptrs, moduli_t moduli_in,
+                     uint64_t coeff_count, uint64_t decomp_modulus_size,
+                     uint64_t num_batch, invn_t inv_n, unsigned rmem) {
+    auto qSubLambda = [&](sycl::handler& h) {
+        for (unsigned evn = 0; evn < num_deps; evn++) {
+            h.depends_on(inDepsEv[evn]);
+        }
+        auto kernelLambda = [=]()
+            [[intel::kernel_args_restrict]] [[intel::max_global_work_dim(0)]] {
+            moduli_t moduli = load_moduli(moduli_in, coeff_count);
+            sycl::host_ptr<uint64_t*> frames(t_target_iter_ptrs);
+            unsigned frame_index[NUM_CORES];
+            unsigned num_batch_per_core = (num_batch - 1) / NUM_CORES + 1;
+#pragma unroll
+            for (int i = 0; i < NUM_CORES; i++) {
+                frame_index[i] = num_batch_per_core * i;
+            }
+            unsigned decomp_index = 0;
+
+            [[intel::disable_loop_pipelining]] for (unsigned j = 0;
+                                                    j < decomp_modulus_size *
+                                                            num_batch_per_core;
+                                                    j++) {
+                load_params(moduli, inv_n, decomp_index, coeff_count,
+                            decomp_modulus_size);
+                // the polynomial of modulus decomp_index of the frame of
+                // each core, none past the last frame.
+                uint64_t* poly[NUM_CORES];
+                Unroller<0, NUM_CORES>::Step([&](auto COREID) {
+                    poly[COREID] =
+                        (frame_index[COREID] < num_batch)
+                            ? frames[frame_index[COREID]] +
+                                  decomp_index * coeff_count
+                            : nullptr;
+                });
+                STEP(decomp_index, decomp_modulus_size);
+                if (decomp_index == 0) {
+                    Unroller<0, NUM_CORES>::Step(
+                        [&](auto COREID) { frame_index[COREID]++; });
+                }
+                uint coeff_count_tmp = coeff_count;
+                for (uint n = 0; n < coeff_count_tmp; n++) {
+                    Unroller<0, NUM_CORES>::Step([&](auto COREID) {
+                        using temp_pipe =
+                            typename ch_intt_elements_in::template PipeAt<
+                                COREID, 0>;
+                        uint64_t toWrite = 0;
+                        if (poly[COREID]) {
+                            sycl::device_ptr<uint64_t> t_target_iter_ptr(
+                                poly[COREID]);
+                            toWrite = t_target_iter_ptr[n];
+                        }
+                        temp_pipe::write(toWrite);
+                    });
+                }
+            }
+        };
+        h.single_task<tt_kernelNameClass>(kernelLambda);
+    };
+    auto event = q.submit(qSubLambda);
+    return event;
+}
+
 #endif
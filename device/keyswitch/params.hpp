@@ -16,19 +16,32 @@
 #define FPGA_NTT_SIZE (1 << FPGA_NTT_SIZE_LOG)
 #endif
 
+// the width of the moduli, overridden by the configuration of the
+// keyswitch_60 bitstream.
+#ifndef MAX_MODULUS_BITS
 #define MAX_MODULUS_BITS 52
-#define MAX_MODULUS (1UL << MAX_MODULUS_BITS)
-
-#define MAX_MODULUS_BITS 52
+#endif
 #define MAX_MODULUS (1UL << MAX_MODULUS_BITS)
 #define MAX_KEY (1UL << MAX_MODULUS_BITS)
 
 #define BIT_MASK(BITS) ((1UL << BITS) - 1)
-#define BIT_MASK_52 (uint256_t) BIT_MASK(52)
-#define BIT_MASK_4 (uint256_t) BIT_MASK(4)
-#define BIT_MASK_8 BIT_MASK(8)
-#define MODULUS_BIT_MASK BIT_MASK(52)
-#define GET_COEFF_COUNT(mod) ((mod >> MAX_MODULUS_BITS) << 10)
+#define MODULUS_BIT_MASK BIT_MASK(MAX_MODULUS_BITS)
+
+// the bits above the modulus carry the coefficient count, in units of
+// 1 << COEFF_COUNT_SHIFT. 60-bit moduli leave 4 bits, enough for n >> 12.
+#if MAX_MODULUS_BITS > 52
+#define COEFF_COUNT_SHIFT 12
+#else
+#define COEFF_COUNT_SHIFT 10
+#endif
+#define GET_COEFF_COUNT(mod) ((mod >> MAX_MODULUS_BITS) << COEFF_COUNT_SHIFT)
+
+// the switch keys of a coefficient are packed back to back in KEY_WORDS
+// 256-bit words. word w is read from key buffer w % 3 at row w / 3.
+#define KEY_BITS \
+    (MAX_KEY_MODULUS_SIZE * MAX_KEY_COMPONENT_SIZE * MAX_MODULUS_BITS)
+#define KEY_WORDS ((KEY_BITS + 255) / 256)
+#define KEY_ROWS ((KEY_WORDS + 2) / 3)
 
 #define MAX_KEY_MODULUS_SIZE 7
 #define MAX_DECOMP_MODULUS_SIZE 6
@@ -37,7 +50,11 @@
 
 #define INTT_INS 3
 #define NTT_ENGINES (MAX_RNS_MODULUS_SIZE + MAX_KEY_COMPONENT_SIZE)
+// the largest polynomial the on-chip buffers hold, overridden by the
+// configuration of the keyswitch_32k bitstream.
+#ifndef MAX_COFF_COUNT
 #define MAX_COFF_COUNT 16384
+#endif
 #define DEFAULT_DEPTH 8
 
 #define STEP(n, max) n = n == (max - 1) ? 0 : n + 1
@@ -0,0 +1,6 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+// keyswitch for polynomials of up to 32768 coefficients, MAX_COFF_COUNT is
+// set by config_keyswitch_32k.
+#include "keyswitch.cpp"  // NOLINT
@@ -0,0 +1,6 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dyadic_multiply.cpp"  // NOLINT
+#include "inv_ntt.cpp"          // NOLINT
+#include "fwd_ntt.cpp"          // NOLINT
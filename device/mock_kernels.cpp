@@ -0,0 +1,282 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @brief mock bitstream, exporting the kernel interfaces of all the
+ * bitstreams with host tasks that leave the data untouched. Each input
+ * kernel completes after env(FPGA_MOCK_DELAY_US) microseconds per frame, 0
+ * by default, and the matching output kernel completes after it, so that
+ * the host runtime can be timed without the device or the emulator.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <CL/sycl.hpp>
+#include "../common/types.hpp"
+
+#ifndef MOCK_MAX_COEFF_COUNT
+#define MOCK_MAX_COEFF_COUNT 16384
+#endif
+
+#ifndef MOCK_MAX_MODULUS_BITS
+#define MOCK_MAX_MODULUS_BITS 52
+#endif
+
+#ifndef MOCK_COMPUTE_UNITS
+#define MOCK_COMPUTE_UNITS 1
+#endif
+
+namespace {
+
+/**
+ * @brief the last input of each kernel family of a device, the context of
+ * its queues, that the next output waits for.
+ */
+struct MockDevice {
+    sycl::event ntt_input;
+    sycl::event intt_input;
+    sycl::event keyswitch_load;
+    // tags and events of the dyadic multiply inputs not yet read back
+    std::deque<std::pair<int, sycl::event>> dyadic_inputs;
+};
+
+std::mutex g_mu;
+std::unordered_map<sycl::context, MockDevice> g_devices;
+
+uint64_t get_mock_delay() {
+    char* env = getenv("FPGA_MOCK_DELAY_US");
+    return env ? strtoul(env, NULL, 10) : 0;
+}
+
+void mock_delay(uint64_t frames) {
+    static const uint64_t delay = get_mock_delay();
+    if ((delay == 0) || (frames == 0)) {
+        return;
+    }
+    // spins, sleeping is too coarse for the microsecond delays of a kernel
+    auto end = std::chrono::steady_clock::now() +
+               std::chrono::microseconds(delay * frames);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+sycl::event mock_task(sycl::queue& q, const sycl::event& dep,
+                      uint64_t frames) {
+    return q.submit([&](sycl::handler& h) {
+        h.depends_on(dep);
+        h.host_task([=]() { mock_delay(frames); });
+    });
+}
+
+sycl::event dyadic_input(sycl::queue& q, int tag, uint64_t n_batch) {
+    sycl::event e = mock_task(q, sycl::event(), n_batch);
+    std::lock_guard<std::mutex> locker(g_mu);
+    g_devices[q.get_context()].dyadic_inputs.emplace_back(tag, e);
+    return e;
+}
+
+}  // namespace
+
+extern "C" {
+
+// NTT
+
+void fwd_ntt(sycl::queue& q) {}
+
+sycl::event ntt_input(sycl::queue& q, unsigned int numFrames, uint64_t* inData,
+                      uint64_t* inData2, uint64_t* moduli,
+                      uint64_t* twiddleFactors,
+                      uint64_t* barrettTwiddleFactors, unsigned int n,
+                      unsigned int* tableIds, unsigned int* tableSlots) {
+    sycl::event e = mock_task(q, sycl::event(), numFrames);
+    std::lock_guard<std::mutex> locker(g_mu);
+    g_devices[q.get_context()].ntt_input = e;
+    return e;
+}
+
+sycl::event ntt_output(sycl::queue& q, int numFrames,
+                       uint64_t* outData_in_svm, unsigned int n) {
+    sycl::event input;
+    {
+        std::lock_guard<std::mutex> locker(g_mu);
+        input = g_devices[q.get_context()].ntt_input;
+    }
+    return mock_task(q, input, 0);
+}
+
+uint64_t ntt_max_coeff_count() { return MOCK_MAX_COEFF_COUNT; }
+
+uint64_t ntt_compute_units() { return MOCK_COMPUTE_UNITS; }
+
+// INTT
+
+void inv_ntt(sycl::queue& q) {}
+
+sycl::event intt_input(sycl::queue& q, unsigned int numFrames,
+                       uint64_t* inData, uint64_t* moduli, uint64_t* inv_n,
+                       uint64_t* inv_n_w, uint64_t* twiddleFactors,
+                       uint64_t* barrettTwiddleFactors, unsigned int n,
+                       unsigned int* tableIds, unsigned int* tableSlots) {
+    sycl::event e = mock_task(q, sycl::event(), numFrames);
+    std::lock_guard<std::mutex> locker(g_mu);
+    g_devices[q.get_context()].intt_input = e;
+    return e;
+}
+
+sycl::event intt_output(sycl::queue& q, unsigned int numFrames,
+                        unsigned long* outData_in_svm, unsigned int n) {
+    sycl::event input;
+    {
+        std::lock_guard<std::mutex> locker(g_mu);
+        input = g_devices[q.get_context()].intt_input;
+    }
+    return mock_task(q, input, 0);
+}
+
+uint64_t intt_max_coeff_count() { return MOCK_MAX_COEFF_COUNT; }
+
+uint64_t intt_compute_units() { return MOCK_COMPUTE_UNITS; }
+
+// dyadic multiply
+
+sycl::event input_fifo_usm(sycl::queue& q, uint64_t* operand1_in_svm,
+                           uint64_t* operand2_in_svm, uint64_t n,
+                           moduli_info_t* moduli_info, uint64_t n_moduli,
+                           int tag, uint64_t* operands_in_ddr,
+                           uint64_t* results_ddr, uint64_t n_batch) {
+    return dyadic_input(q, tag, n_batch);
+}
+
+sycl::event input_fifo_plain_usm(sycl::queue& q, uint64_t* ciphertext_in_svm,
+                                 uint64_t* plaintext_in_svm, uint64_t n,
+                                 moduli_info_t* moduli_info, uint64_t n_moduli,
+                                 int tag, uint64_t* operands_in_ddr,
+                                 uint64_t* results_ddr, uint64_t n_batch) {
+    return dyadic_input(q, tag, n_batch);
+}
+
+sycl::event input_fifo_accumulate_usm(sycl::queue& q,
+                                      uint64_t* operand1_in_svm,
+                                      uint64_t* operand2_in_svm, uint64_t n,
+                                      moduli_info_t* moduli_info,
+                                      uint64_t n_moduli, int tag,
+                                      uint64_t* operands_in_ddr,
+                                      uint64_t* results_ddr, uint64_t n_batch,
+                                      uint64_t plain) {
+    return dyadic_input(q, tag, n_batch);
+}
+
+sycl::event input_fifo_accumulate_keys_usm(sycl::queue& q,
+                                           uint64_t* keys_in_ddr,
+                                           uint64_t* operand2_in_svm,
+                                           uint64_t n,
+                                           moduli_info_t* moduli_info,
+                                           uint64_t n_moduli, int tag,
+                                           uint64_t* operands_in_ddr,
+                                           uint64_t* results_ddr,
+                                           uint64_t n_batch) {
+    return dyadic_input(q, tag, n_batch);
+}
+
+// as the output pipe of the bitstream, returns the batches in submission
+// order, each once its input completed.
+sycl::event output_nb_fifo_usm(sycl::queue& q, uint64_t* results_in_svm,
+                               int* tag, int* output_valid) {
+    std::pair<int, sycl::event> input(-1, sycl::event());
+    {
+        std::lock_guard<std::mutex> locker(g_mu);
+        auto& inputs = g_devices[q.get_context()].dyadic_inputs;
+        if (!inputs.empty()) {
+            input = inputs.front();
+            inputs.pop_front();
+        }
+    }
+    return q.submit([&](sycl::handler& h) {
+        h.depends_on(input.second);
+        h.host_task([=]() {
+            *tag = input.first;
+            *output_valid = (input.first >= 0) ? 1 : 0;
+        });
+    });
+}
+
+void submit_autorun_kernels(sycl::queue& q) {}
+
+// KeySwitch
+
+sycl::event load(sycl::queue& q, sycl::event* inDepsEv,
+                 sycl::buffer<uint64_t>& t_target_iter_ptr, moduli_t moduli,
+                 uint64_t coeff_count, uint64_t decomp_modulus_size,
+                 uint64_t num_batch, invn_t inv_n, unsigned rmem) {
+    sycl::event e = q.submit([&](sycl::handler& h) {
+        if (inDepsEv) {
+            for (size_t evn = 0; evn < num_batch; evn++) {
+                inDepsEv[evn].wait();
+            }
+        }
+        sycl::accessor input(t_target_iter_ptr, h, sycl::read_only);
+        h.host_task([=]() { mock_delay(num_batch); });
+    });
+    std::lock_guard<std::mutex> locker(g_mu);
+    g_devices[q.get_context()].keyswitch_load = e;
+    return e;
+}
+
+sycl::event load_usm(sycl::queue& q, sycl::event* inDepsEv, unsigned num_deps,
+                     uint64_t** t_target_iter_ptrs, moduli_t moduli,
+                     uint64_t coeff_count, uint64_t decomp_modulus_size,
+                     uint64_t num_batch, invn_t inv_n, unsigned rmem) {
+    sycl::event e = q.submit([&](sycl::handler& h) {
+        for (unsigned evn = 0; evn < num_deps; evn++) {
+            h.depends_on(inDepsEv[evn]);
+        }
+        h.host_task([=]() { mock_delay(num_batch); });
+    });
+    std::lock_guard<std::mutex> locker(g_mu);
+    g_devices[q.get_context()].keyswitch_load = e;
+    return e;
+}
+
+sycl::event store(sycl::queue& q, sycl::event* inDepsEv,
+                  sycl::buffer<sycl::ulong2>& dp_results, uint64_t num_batch,
+                  uint64_t coeff_count, uint64_t decomp_modulus_size,
+                  moduli_t moduli, unsigned rmem, unsigned wmem) {
+    sycl::event input;
+    {
+        std::lock_guard<std::mutex> locker(g_mu);
+        input = g_devices[q.get_context()].keyswitch_load;
+    }
+    return q.submit([&](sycl::handler& h) {
+        if (inDepsEv) {
+            for (size_t evn = 0; evn < num_batch; evn++) {
+                inDepsEv[evn].wait();
+            }
+        }
+        h.depends_on(input);
+        sycl::accessor results(dp_results, h, sycl::write_only);
+        h.host_task([=]() {});
+    });
+}
+
+void launchConfigurableKernels(sycl::queue& q,
+                               sycl::buffer<uint64_t>* buff_twiddles,
+                               unsigned coeff_count,
+                               bool load_twiddle_factors) {}
+
+void launchStoreSwitchKeys(sycl::queue& q,
+                           sycl::buffer<uint256_t>& buff_k_switch_keys1,
+                           sycl::buffer<uint256_t>& buff_k_switch_keys2,
+                           sycl::buffer<uint256_t>& buff_k_switch_keys3,
+                           int batch_size) {}
+
+void launchAllAutoRunKernels(sycl::queue& q) {}
+
+uint64_t keyswitch_max_coeff_count() { return MOCK_MAX_COEFF_COUNT; }
+
+uint64_t keyswitch_max_modulus_bits() { return MOCK_MAX_MODULUS_BITS; }
+
+}  // end of extern "C"
@@ -10,6 +10,12 @@
 #include "utils/kernel_assert.hpp"
 typedef unsigned long ubitwidth_t;
 
+// the width of the moduli reduced by MultiplyUIntMod, 60 with the
+// configuration of the keyswitch_60 bitstream.
+#ifndef MAX_MODULUS_BITS
+#define MAX_MODULUS_BITS 52
+#endif
+
 constexpr unsigned int BITWIDTH = 64;
 constexpr unsigned int BITWIDTHp1 = 1 + BITWIDTH;
 constexpr unsigned int BITWIDTH2 = (2 * BITWIDTH);
@@ -104,15 +110,21 @@ void HLS_MultiplyUInt52(ubitwidth_t x, ubitwidth_t y, ubitwidth_t* prod_hi,
     return HLS_MultiplyUInt<52>(x, y, prod_hi, prod_lo);
 }
 
+void HLS_MultiplyUInt60(ubitwidth_t x, ubitwidth_t y, ubitwidth_t* prod_hi,
+                        ubitwidth_t* prod_lo) {
+    return HLS_MultiplyUInt<60>(x, y, prod_hi, prod_lo);
+}
+
+// r = 2^(2k) / modulus, where k is the number of bits of the modulus
 template <int MIN_K, int MAX_K, int MAX_R_K>
 ubitwidth_t HLS_BarrettReduce(ubitwidth_t input_hi, ubitwidth_t input_lo,
-                              ubitwidth_t modulus, unsigned long rk) {
+                              ubitwidth_t modulus, unsigned long r_in,
+                              unsigned char k) {
     ac_int<MAX_K + MAX_K, false> a =
         ((ubitwidth2_t(input_hi) << BITWIDTH) | ((input_lo)));
     ac_int<MAX_K, false> n = modulus;
 
-    ac_int<MAX_R_K, false> r = rk >> 8;
-    unsigned char k = rk & 0xff;
+    ac_int<MAX_R_K, false> r = r_in;
     ac_int<7, false> k2 = 2 * k - 2 * MIN_K;
 
     ac_int<MAX_K + MAX_K + MAX_R_K, false> d = a * r;
@@ -123,13 +135,23 @@ ubitwidth_t HLS_BarrettReduce(ubitwidth_t input_hi, ubitwidth_t input_lo,
     return c.to_uint64();
 }
 // sabbar
+// rk packs r above the 8 bits of k.
 ubitwidth_t HLS_BarrettReduce104(ubitwidth_t input_hi, ubitwidth_t input_lo,
                                  ubitwidth_t modulus, unsigned long rk) {
-    return HLS_BarrettReduce<16, 52, 53>(input_hi, input_lo, modulus, rk);
+    return HLS_BarrettReduce<16, 52, 53>(input_hi, input_lo, modulus, rk >> 8,
+                                         rk & 0xff);
+}
+// r of a 60-bit modulus takes 61 bits and leaves no room for k, so rk holds
+// r alone. k is the position of the leading bit of r, as 2^k <= r < 2^(k+1).
+ubitwidth_t HLS_BarrettReduce120(ubitwidth_t input_hi, ubitwidth_t input_lo,
+                                 ubitwidth_t modulus, unsigned long rk) {
+    unsigned char k = 63 - ac_int<64, false>(rk).leading_sign();
+    return HLS_BarrettReduce<16, 60, 61>(input_hi, input_lo, modulus, rk, k);
 }
 ubitwidth_t HLS_BarrettReduce128(ubitwidth_t input_hi, ubitwidth_t input_lo,
                                  ubitwidth_t modulus, unsigned long rk) {
-    return HLS_BarrettReduce<16, 64, 64>(input_hi, input_lo, modulus, rk);
+    return HLS_BarrettReduce<16, 64, 64>(input_hi, input_lo, modulus, rk >> 8,
+                                         rk & 0xff);
 }
 
 ubitwidth_t MultiplyUIntModLazy3(ubitwidth_t x, ubitwidth_t y,
@@ -163,7 +185,9 @@ ubitwidth_t MultiplyUIntModLazy4(ubitwidth_t x, ubitwidth_t y_operand,
 
 unsigned get_ntt_log(unsigned size) {
     unsigned log = 14;
-    if (size == 16384) {
+    if (size == 32768) {
+        log = 15;
+    } else if (size == 16384) {
         log = 14;
     } else if (size == 8192) {
         log = 13;
@@ -183,12 +207,20 @@ void MultiplyUInt64(uint64_t x, uint64_t y, uint64_t* prod_hi,
                     uint64_t* prod_lo) {
     ASSERT(x < MAX_MODULUS, "x >= modulus\n");
     ASSERT(y < MAX_MODULUS, "y >= modulus\n");
+#if MAX_MODULUS_BITS > 52
+    HLS_MultiplyUInt60(x, y, prod_hi, prod_lo);
+#else
     HLS_MultiplyUInt52(x, y, prod_hi, prod_lo);
+#endif
 }
 
 uint64_t BarrettReduce128(uint64_t prod_hi, uint64_t prod_lo, uint64_t modulus,
                           uint64_t rk) {
+#if MAX_MODULUS_BITS > 52
+    uint64_t ret = HLS_BarrettReduce120(prod_hi, prod_lo, modulus, rk);
+#else
     uint64_t ret = HLS_BarrettReduce104(prod_hi, prod_lo, modulus, rk);
+#endif
     ASSERT(ret < modulus, "BarrettReduce Failed\n");
     return ret;
 }
@@ -0,0 +1,5 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "inv_ntt.cpp"  // NOLINT
+#include "fwd_ntt.cpp"  // NOLINT
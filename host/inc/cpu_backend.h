@@ -0,0 +1,134 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __CPU_BACKEND_H__
+#define __CPU_BACKEND_H__
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+/// @brief
+/// enum cpu_isa_t
+/// Instruction sets of the built-in CPU backend, in increasing order.
+/// AVX512_IFMA is used for moduli below 2^50, the other moduli take the
+/// AVX2, or scalar, code.
+///
+enum class cpu_isa_t { SCALAR = 0, AVX2 = 1, AVX512_IFMA = 2 };
+
+/// @brief
+/// @function cpu_isa
+/// Returns the instruction set of the built-in CPU backend: the best one the
+/// host supports, capped by env(CPU_ISA)=scalar|avx2|avx512ifma.
+///
+cpu_isa_t cpu_isa();
+
+/// @brief
+/// @function cpu_isa_name
+/// Returns the name of an instruction set of the CPU backend
+/// @param[in] isa instruction set
+///
+const char* cpu_isa_name(cpu_isa_t isa);
+
+/// @brief
+/// @function cpu_num_threads
+/// Returns the number of threads of the CPU backend, env(NUM_CPU_THREADS),
+/// or the number of hardware threads by default.
+///
+uint64_t cpu_num_threads();
+
+/// @brief
+/// @function cpu_parallel_for
+/// Calls fn(i) for i in [0, count) on up to cpu_num_threads() threads.
+/// Nested calls, from fn, run on the calling thread.
+/// @param[in] count number of calls
+/// @param[in] fn function called for each index
+///
+void cpu_parallel_for(uint64_t count, const std::function<void(uint64_t)>& fn);
+
+/// @brief
+/// @function cpu_multiply_mod
+/// results[i] = (operand1[i] * operand2[i]) mod modulus. The operands may
+/// be larger than the modulus. results may alias an operand.
+/// @param[out] results n products
+/// @param[in] operand1 n operands
+/// @param[in] operand2 n operands
+/// @param[in] n number of operands
+/// @param[in] modulus modulus greater than 1
+///
+void cpu_multiply_mod(uint64_t* results, const uint64_t* operand1,
+                      const uint64_t* operand2, uint64_t n, uint64_t modulus);
+
+/// @brief
+/// @function cpu_add_mod
+/// results[i] = (operand1[i] + operand2[i]) mod modulus, for operands
+/// reduced by the modulus. results may alias an operand.
+/// @param[out] results n sums
+/// @param[in] operand1 n operands
+/// @param[in] operand2 n operands
+/// @param[in] n number of operands
+/// @param[in] modulus modulus greater than 1
+///
+void cpu_add_mod(uint64_t* results, const uint64_t* operand1,
+                 const uint64_t* operand2, uint64_t n, uint64_t modulus);
+
+/// @brief
+/// Class CpuNTT
+/// Negacyclic Number Theoretic Transform of the built-in CPU backend, with
+/// the same bit reversed output order as the NTT/INTT kernels. The forward
+/// transform takes coefficients reduced by the modulus, or, for moduli of
+/// 2^62 and above, any 64-bit coefficients.
+/// @param[in] n polynomial size, a power of two
+/// @param[in] modulus prime modulus, 1 modulo 2n
+/// @param[in] root_of_unity primitive 2n-th root of unity, 0 for the minimal
+/// one
+///
+/// @function forward transforms a polynomial in place
+/// @function inverse transforms back a polynomial in place
+///
+class CpuNTT {
+public:
+    CpuNTT(uint64_t n, uint64_t modulus, uint64_t root_of_unity = 0);
+
+    void forward(uint64_t* poly) const;
+    void inverse(uint64_t* poly) const;
+
+    uint64_t n() const { return n_; }
+    uint64_t modulus() const { return modulus_; }
+
+private:
+    uint64_t n_;
+    uint64_t modulus_;
+    uint64_t inv_n_;
+    uint64_t inv_n_precon_;
+    // powers of the root, and of its inverse, in bit reversed order, with
+    // their 64-bit, and for moduli below 2^50 52-bit, Shoup factors.
+    std::vector<uint64_t> roots_;
+    std::vector<uint64_t> roots_precon_;
+    std::vector<uint64_t> roots_precon52_;
+    std::vector<uint64_t> inv_roots_;
+    std::vector<uint64_t> inv_roots_precon_;
+    std::vector<uint64_t> inv_roots_precon52_;
+};
+
+/// @brief
+/// @function cpu_get_ntt
+/// Returns the transform of size n modulo modulus, created on first use and
+/// kept for the lifetime of the process.
+/// @param[in] n polynomial size
+/// @param[in] modulus prime modulus, 1 modulo 2n
+/// @param[in] root_of_unity primitive 2n-th root of unity, 0 for the minimal
+/// one
+///
+const CpuNTT& cpu_get_ntt(uint64_t n, uint64_t modulus,
+                          uint64_t root_of_unity = 0);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
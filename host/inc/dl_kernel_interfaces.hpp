@@ -46,17 +46,35 @@ public:
 
     /**
      * @brief ntt input kernel, help stream input data to the ntt kernel.
+     * The twiddle tables are in device memory. The arguments are the moduli
+     * of the frames, the twiddle table slots, the polynomial size of the
+     * batch, and the id and slot of the twiddle table of every frame.
      */
     sycl::event (*ntt_input)(sycl::queue& q, unsigned int,
                              uint64_t* __restrict__, uint64_t* __restrict__,
                              uint64_t* __restrict__, uint64_t* __restrict__,
-                             uint64_t* __restrict__);
+                             uint64_t* __restrict__, unsigned int,
+                             unsigned int* __restrict__,
+                             unsigned int* __restrict__);
 
     /**
      * @brief ntt output kernel, help get the results of ntt kernel and write
      * to the device memory.
      */
-    sycl::event (*ntt_output)(sycl::queue& q, int, uint64_t* __restrict__);
+    sycl::event (*ntt_output)(sycl::queue& q, int, uint64_t* __restrict__,
+                              unsigned int);
+
+    /**
+     * @brief largest polynomial size of the ntt kernel, nullptr for
+     * outdated bitstreams.
+     */
+    uint64_t (*ntt_max_coeff_count)();
+
+    /**
+     * @brief number of ntt kernel compute units, nullptr for bitstreams
+     * built before the query, which have one.
+     */
+    uint64_t (*ntt_compute_units)();
 };
 
 /// @brief
@@ -83,18 +101,35 @@ public:
      */
     // info: integrated
     sycl::event (*intt_output)(sycl::queue&, unsigned int,
-                               unsigned long* __restrict__);
+                               unsigned long* __restrict__, unsigned int);
 
     /**
      * @brief inverse intt input kernel, help stream input data to the intt
-     * kernel.
+     * kernel. The twiddle tables are in device memory. The arguments are the
+     * moduli and normalization factors of the frames, the twiddle table
+     * slots, the polynomial size of the batch, and the id and slot of the
+     * twiddle table of every frame.
      *
      */
     // info: integrated
     sycl::event (*intt_input)(sycl::queue&, unsigned int,
                               uint64_t* __restrict__, uint64_t* __restrict__,
                               uint64_t* __restrict__, uint64_t* __restrict__,
-                              uint64_t* __restrict__, uint64_t* __restrict__);
+                              uint64_t* __restrict__, uint64_t* __restrict__,
+                              unsigned int, unsigned int* __restrict__,
+                              unsigned int* __restrict__);
+
+    /**
+     * @brief largest polynomial size of the intt kernel, nullptr for
+     * outdated bitstreams.
+     */
+    uint64_t (*intt_max_coeff_count)();
+
+    /**
+     * @brief number of intt kernel compute units, nullptr for bitstreams
+     * built before the query, which have one.
+     */
+    uint64_t (*intt_compute_units)();
 };
 
 /// @brief
@@ -109,6 +144,22 @@ public:
                                   uint64_t* __restrict__, uint64_t,
                                   moduli_info_t* __restrict__, uint64_t, int,
                                   uint64_t*, uint64_t*, uint64_t);
+    // ciphertext x plaintext input, nullptr with older bitstreams
+    sycl::event (*input_fifo_plain_usm)(sycl::queue&, uint64_t* __restrict__,
+                                        uint64_t* __restrict__, uint64_t,
+                                        moduli_info_t* __restrict__, uint64_t,
+                                        int, uint64_t*, uint64_t*, uint64_t);
+    // sums the products of a batch, nullptr with older bitstreams
+    sycl::event (*input_fifo_accumulate_usm)(
+        sycl::queue&, uint64_t* __restrict__, uint64_t* __restrict__, uint64_t,
+        moduli_info_t* __restrict__, uint64_t, int, uint64_t*, uint64_t*,
+        uint64_t, uint64_t);
+    // sums the ciphertext x plaintext products of a batch whose ciphertexts
+    // are read from device memory, nullptr with older bitstreams
+    sycl::event (*input_fifo_accumulate_keys_usm)(
+        sycl::queue&, uint64_t* __restrict__, uint64_t* __restrict__, uint64_t,
+        moduli_info_t* __restrict__, uint64_t, int, uint64_t*, uint64_t*,
+        uint64_t);
 
     sycl::event (*output_nb_fifo_usm)(sycl::queue&, uint64_t*, int*, int*);
     void (*submit_autorun_kernels)(sycl::queue& q);
@@ -125,6 +176,11 @@ public:
     sycl::event (*load)(sycl::queue&, sycl::event*, sycl::buffer<uint64_t>&,
                         moduli_t, uint64_t, uint64_t, uint64_t, invn_t,
                         unsigned);
+    // load reading the frames from device memory, at the addresses of the
+    // table, after the given events, nullptr with older bitstreams
+    sycl::event (*load_usm)(sycl::queue&, sycl::event*, unsigned, uint64_t**,
+                            moduli_t, uint64_t, uint64_t, uint64_t, invn_t,
+                            unsigned);
     sycl::event (*store)(sycl::queue&, sycl::event*,
                          sycl::buffer<sycl::ulong2>&, uint64_t, uint64_t,
                          uint64_t, moduli_t, unsigned, unsigned);
@@ -134,6 +190,10 @@ public:
                                   sycl::buffer<uint256_t>&,
                                   sycl::buffer<uint256_t>&, int batch_size);
     void (*launchAllAutoRunKernels)(sycl::queue&);
+    // largest supported polynomial size, nullptr with older bitstreams
+    uint64_t (*keyswitch_max_coeff_count)();
+    // width of the moduli, nullptr with older bitstreams
+    uint64_t (*keyswitch_max_modulus_bits)();
 };
 
 /// @brief
@@ -153,6 +213,22 @@ public:
                                   uint64_t* __restrict__, uint64_t,
                                   moduli_info_t* __restrict__, uint64_t, int,
                                   uint64_t*, uint64_t*, uint64_t);
+    // ciphertext x plaintext input, nullptr with older bitstreams
+    sycl::event (*input_fifo_plain_usm)(sycl::queue&, uint64_t* __restrict__,
+                                        uint64_t* __restrict__, uint64_t,
+                                        moduli_info_t* __restrict__, uint64_t,
+                                        int, uint64_t*, uint64_t*, uint64_t);
+    // sums the products of a batch, nullptr with older bitstreams
+    sycl::event (*input_fifo_accumulate_usm)(
+        sycl::queue&, uint64_t* __restrict__, uint64_t* __restrict__, uint64_t,
+        moduli_info_t* __restrict__, uint64_t, int, uint64_t*, uint64_t*,
+        uint64_t, uint64_t);
+    // sums the ciphertext x plaintext products of a batch whose ciphertexts
+    // are read from device memory, nullptr with older bitstreams
+    sycl::event (*input_fifo_accumulate_keys_usm)(
+        sycl::queue&, uint64_t* __restrict__, uint64_t* __restrict__, uint64_t,
+        moduli_info_t* __restrict__, uint64_t, int, uint64_t*, uint64_t*,
+        uint64_t);
 
     sycl::event (*output_nb_fifo_usm)(sycl::queue&, uint64_t*, int*, int*);
 
@@ -160,6 +236,11 @@ public:
     sycl::event (*load)(sycl::queue&, sycl::event*, sycl::buffer<uint64_t>&,
                         moduli_t, uint64_t, uint64_t, uint64_t, invn_t,
                         unsigned);
+    // load reading the frames from device memory, at the addresses of the
+    // table, after the given events, nullptr with older bitstreams
+    sycl::event (*load_usm)(sycl::queue&, sycl::event*, unsigned, uint64_t**,
+                            moduli_t, uint64_t, uint64_t, uint64_t, invn_t,
+                            unsigned);
 
     sycl::event (*store)(sycl::queue&, sycl::event*,
                          sycl::buffer<sycl::ulong2>&, uint64_t, uint64_t,
@@ -172,6 +253,10 @@ public:
                                   sycl::buffer<uint256_t>&, int batch_size);
 
     void (*launchAllAutoRunKernels)(sycl::queue&);
+    // largest supported polynomial size, nullptr with older bitstreams
+    uint64_t (*keyswitch_max_coeff_count)();
+    // width of the moduli, nullptr with older bitstreams
+    uint64_t (*keyswitch_max_modulus_bits)();
 };
 
 }  // namespace fpga
@@ -28,6 +28,87 @@ void DyadicMultiply(uint64_t* results, const uint64_t* operand1,
                     const uint64_t* operand2, uint64_t n,
                     const uint64_t* moduli, uint64_t n_moduli);
 /// @brief
+/// function DyadicMultiplyBatch
+/// Implements count multiplications of two ciphertexts sharing the same
+/// moduli. The parameters are validated once and the multiplications are
+/// submitted to the FPGA in batches of BATCH_SIZE_DYADIC_MULTIPLY. Without a
+/// prior call to set_worksize_DyadicMultiply the call returns once all the
+/// results are available.
+/// @param[out] results count pointers to the results of the multiplications
+/// @param[in] operand1 count pointers to the first operands
+/// @param[in] operand2 count pointers to the second operands
+/// @param[in] count number of multiplications
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of modulus shared by the batch
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void DyadicMultiplyBatch(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         const uint64_t* moduli, uint64_t n_moduli);
+/// @brief
+/// function MultiplyPlain
+/// Implements the multiplication of a ciphertext by a plaintext. The
+/// plaintext is streamed once per modulus and only the two product
+/// polynomials are returned.
+/// @param[out] results stores the 2 polynomials of the multiplication
+/// @param[in] ciphertext vector of 2 polynomials per modulus
+/// @param[in] plaintext vector of 1 polynomial per modulus
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of modulus
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void MultiplyPlain(uint64_t* results, const uint64_t* ciphertext,
+                   const uint64_t* plaintext, uint64_t n,
+                   const uint64_t* moduli, uint64_t n_moduli);
+/// @brief
+/// function MultiplyPlainBatch
+/// Implements count ciphertext plaintext multiplications sharing the same
+/// moduli, batched like DyadicMultiplyBatch.
+/// @param[out] results count pointers to the results of the multiplications
+/// @param[in] ciphertext count pointers to the ciphertexts
+/// @param[in] plaintext count pointers to the plaintexts
+/// @param[in] count number of multiplications
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of modulus shared by the batch
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void MultiplyPlainBatch(uint64_t** results, const uint64_t** ciphertext,
+                        const uint64_t** plaintext, uint64_t count,
+                        uint64_t n, const uint64_t* moduli, uint64_t n_moduli);
+/// @brief
+/// function DyadicMultiplyAccumulate
+/// Computes the inner product of count pairs of ciphertexts sharing the same
+/// moduli. The products of a device batch are summed on the FPGA and only the
+/// sum is read back.
+/// @param[out] results stores the 3 polynomials of the sum of the products
+/// @param[in] operand1 count pointers to the first operands
+/// @param[in] operand2 count pointers to the second operands
+/// @param[in] count number of products
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of modulus shared by the products
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void DyadicMultiplyAccumulate(uint64_t* results, const uint64_t** operand1,
+                              const uint64_t** operand2, uint64_t count,
+                              uint64_t n, const uint64_t* moduli,
+                              uint64_t n_moduli);
+/// @brief
+/// function MultiplyPlainAccumulate
+/// Computes the inner product of count ciphertexts with count plaintexts,
+/// summed on the FPGA like DyadicMultiplyAccumulate.
+/// @param[out] results stores the 2 polynomials of the sum of the products
+/// @param[in] ciphertext count pointers to the ciphertexts
+/// @param[in] plaintext count pointers to the plaintexts
+/// @param[in] count number of products
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of modulus shared by the products
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void MultiplyPlainAccumulate(uint64_t* results, const uint64_t** ciphertext,
+                             const uint64_t** plaintext, uint64_t count,
+                             uint64_t n, const uint64_t* moduli,
+                             uint64_t n_moduli);
+/// @brief
 /// @function DyadicMultiplyCompleted
 /// Executed after the multiplication to wrap up the operation
 ///
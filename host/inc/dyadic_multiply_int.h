@@ -29,6 +29,66 @@ void DyadicMultiply_int(uint64_t* results, const uint64_t* operand1,
                         const uint64_t* operand2, uint64_t n,
                         const uint64_t* moduli, uint64_t n_moduli);
 /// @brief
+/// @function DyadicMultiplyBatch_int
+/// Internal implementation of the DyadicMultiplyBatch function call
+/// @param[out] results count pointers to the outputs of the multiplications
+/// @param[in] operand1 count pointers to the first operands
+/// @param[in] operand2 count pointers to the second operands
+/// @param[in] count number of multiplications
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of coefficient modulus shared by the batch
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void DyadicMultiplyBatch_int(uint64_t** results, const uint64_t** operand1,
+                             const uint64_t** operand2, uint64_t count,
+                             uint64_t n, const uint64_t* moduli,
+                             uint64_t n_moduli);
+/// @brief
+/// @function MultiplyPlain_int
+/// Internal implementation of the MultiplyPlain function call
+/// @param[out] results stores the output of the multiplication
+/// @param[in] ciphertext vector of 2 polynomials per modulus
+/// @param[in] plaintext vector of 1 polynomial per modulus
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of coefficient modulus
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void MultiplyPlain_int(uint64_t* results, const uint64_t* ciphertext,
+                       const uint64_t* plaintext, uint64_t n,
+                       const uint64_t* moduli, uint64_t n_moduli);
+/// @brief
+/// @function MultiplyPlainBatch_int
+/// Internal implementation of the MultiplyPlainBatch function call
+/// @param[out] results count pointers to the outputs of the multiplications
+/// @param[in] ciphertext count pointers to the ciphertexts
+/// @param[in] plaintext count pointers to the plaintexts
+/// @param[in] count number of multiplications
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of coefficient modulus shared by the batch
+/// @param[in] n_moduli number of modulus in the vector of modulus
+///
+void MultiplyPlainBatch_int(uint64_t** results, const uint64_t** ciphertext,
+                            const uint64_t** plaintext, uint64_t count,
+                            uint64_t n, const uint64_t* moduli,
+                            uint64_t n_moduli);
+/// @brief
+/// @function DyadicMultiplyAccumulate_int
+/// Internal implementation of the DyadicMultiplyAccumulate and
+/// MultiplyPlainAccumulate function calls
+/// @param[out] results stores the sum of the products
+/// @param[in] operand1 count pointers to the ciphertexts
+/// @param[in] operand2 count pointers to the ciphertexts or plaintexts
+/// @param[in] count number of products
+/// @param[in] n polynomial size
+/// @param[in] moduli vector of coefficient modulus shared by the products
+/// @param[in] n_moduli number of modulus in the vector of modulus
+/// @param[in] plain operand2 holds plaintexts
+///
+void DyadicMultiplyAccumulate_int(uint64_t* results, const uint64_t** operand1,
+                                  const uint64_t** operand2, uint64_t count,
+                                  uint64_t n, const uint64_t* moduli,
+                                  uint64_t n_moduli, bool plain);
+/// @brief
 /// @function DyadicMultiplyCompleted_int
 /// Internal implementation of the DyadicMultiplyCompleted function.
 /// Called after completion of the multiplication operation
@@ -7,10 +7,13 @@
 #include <condition_variable>
 #include <deque>
 #include <future>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <ostream>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 #include <CL/sycl.hpp>
@@ -32,43 +35,18 @@ namespace fpga {
 
 __extension__ typedef unsigned __int128 fpga_uint128_t;
 
-/// @brief
-/// Struct DyadmultKeys1_t
-/// @param[in] key1-5 stores the bits of compressed switch key data
-typedef struct {
-    uint64_t key1 : 52;
-    uint64_t key2 : 52;
-    uint64_t key3 : 52;
-    uint64_t key4 : 52;
-    uint64_t key5 : 48;
-} __attribute__((packed)) DyadmultKeys1_t;
-
-/// @brief
-/// Struct DyadmultKeys2_t
-/// @param[in] key1-6 stores the bits of compressed switch key data
-typedef struct {
-    uint64_t key1 : 4;
-    uint64_t key2 : 52;
-    uint64_t key3 : 52;
-    uint64_t key4 : 52;
-    uint64_t key5 : 52;
-    uint64_t key6 : 44;
-} __attribute__((packed)) DyadmultKeys2_t;
-
-/// @brief
-/// Struct DyadmultKeys3_t
-/// @param[in] key1-5 stores the bits of compressed switch key data
-typedef struct {
-    uint64_t key1 : 8;
-    uint64_t key2 : 52;
-    uint64_t key3 : 52;
-    uint64_t key4 : 52;
-    uint64_t key5 : 52;
-    uint64_t NOT_USED : 40;
-} __attribute__((packed)) DyadmultKeys3_t;
-
 #define BIT_MASK(BITS) ((1UL << BITS) - 1)
+// the switch keys of a coefficient are packed back to back, each on the
+// modulus width of the bitstream, in 256-bit words spread over the three key
+// buffers: word w goes to buffer w % 3.
+#define KEYSWITCH_KEY_BUFFERS 3
 #define MAX_RNS_MODULUS_SIZE 7
+// twiddle tables of the NTT, and of the INTT, kept in device memory. A batch
+// mixes at most as many moduli.
+#define NTT_MAX_TWIDDLE_TABLES 64
+// packed keys of KeySwitch tiles kept by the host, and by the device in its
+// memory, before the least recently used ones are evicted.
+#define DYADIC_MAX_TILE_KEYS 64
 #define RWMEM_FLAG 1
 
 enum KeySwitch_Kernels {
@@ -83,7 +61,9 @@ enum class kernel_t {
     NTT,
     INTT,
     KEYSWITCH,
-    DYADIC_MULTIPLY_KEYSWITCH
+    DYADIC_MULTIPLY_KEYSWITCH,
+    RESCALE,
+    KEYSWITCH_TILED
 };
 
 /// @brief
@@ -160,6 +140,19 @@ public:
     uint64_t inv_n_w_;
     uint64_t n_;
 };
+/// @brief
+/// struct TileKeys stores the switch keys of the key moduli of a tiled
+/// KeySwitch, packed as the ciphertext operands of the dyadic kernel. The
+/// device uploads them once and keeps them resident under id_.
+///
+/// id_ identifier of the packed keys, never 0 and never reused
+/// keys_ packed keys
+///
+struct TileKeys {
+    uint64_t id_;
+    std::vector<uint64_t> keys_;
+};
+
 /// @brief
 /// class Object_DyadicMultiply
 /// Stores the parameters for the multiplication
@@ -169,13 +162,24 @@ public:
 /// @param[in] n polynomial size
 /// @param[in] moduli vector of moduli
 /// @param[in] n_moduli size of the vector of moduli
+/// @param[in] plain operand2 is a plaintext of one polynomial per modulus and
+/// results hold the two polynomials of the ciphertext x plaintext product
+/// @param[in] accumulate the product is added into results, which are shared
+/// by all the objects of the accumulation
+/// @param[in] tile_keys the keys operand1 points into, when it can be read
+/// from device memory instead of being staged, nullptr otherwise
+/// @param[in] relinearize the third polynomial of the product is the input of
+/// a KeySwitch queued after it, which reads it from device memory
 ///
 class Object_DyadicMultiply : public Object {
 public:
     explicit Object_DyadicMultiply(uint64_t* results, const uint64_t* operand1,
                                    const uint64_t* operand2, uint64_t n,
                                    const uint64_t* moduli, uint64_t n_moduli,
-                                   bool fence = false);
+                                   bool fence = false, bool plain = false,
+                                   bool accumulate = false,
+                                   const TileKeys* tile_keys = nullptr,
+                                   bool relinearize = false);
 
     uint64_t* results_;
     const uint64_t* operand1_;
@@ -183,6 +187,10 @@ public:
     uint64_t n_;
     const uint64_t* moduli_;
     uint64_t n_moduli_;
+    bool plain_;
+    bool accumulate_;
+    const TileKeys* tile_keys_;
+    bool relinearize_;
 };
 
 /// @brief
@@ -200,6 +208,11 @@ public:
 /// @param[in]  modswitch_factors stores the factors for modular switch
 /// @param[in]  twiddle_factors stores the twiddle factors
 /// @param[in]  fence indicates whether the object is a fenced object or not
+/// @param[in]  galois_table permutation applied to t_target_iter_ptr while it
+/// is staged for the device, nullptr for none
+/// @param[in]  source the relinearized product whose third polynomial is
+/// t_target_iter_ptr, read from device memory when the product is still
+/// there, nullptr for none
 ///
 class Object_KeySwitch : public Object {
 public:
@@ -209,7 +222,8 @@ public:
         uint64_t rns_modulus_size, uint64_t key_component_count,
         const uint64_t* moduli, const uint64_t** k_switch_keys,
         const uint64_t* modswitch_factors, const uint64_t* twiddle_factors,
-        bool fence = false);
+        bool fence = false, const uint32_t* galois_table = nullptr,
+        const Object_DyadicMultiply* source = nullptr);
 
     uint64_t* result_;
     const uint64_t* t_target_iter_ptr_;
@@ -222,6 +236,8 @@ public:
     const uint64_t** k_switch_keys_;
     const uint64_t* modswitch_factors_;
     const uint64_t* twiddle_factors_;
+    const uint32_t* galois_table_;
+    const Object_DyadicMultiply* source_;
 };
 
 /// @brief
@@ -244,6 +260,7 @@ public:
 /// @param[in] total_worksize_KeySwitch stores the worksize for the keyswitch
 /// @param[in] num_KeySwitch stores the number of keyswitch to be performed
 /// @function push pushes an Object in the structure
+/// @function push_batch pushes a vector of Objects taking the lock once
 /// @function front returns the front Object of the structure
 /// @function back returns the last Object of the structure
 /// @function pop pops the front Object out of the structure
@@ -256,6 +273,16 @@ public:
 /// @function set_worksize_NTT sets the worksize of NTT
 /// @function set_worksize_INTT sets the worksize of INTT
 /// @function set_worksize_KeySwitch sets the worksize of KeySwitch
+/// @function get_pending_KeySwitch returns the keyswitches of the worksize
+/// that are not popped yet
+/// @function get_worksize returns the worksize of a kernel
+/// @function set_worksize sets the worksize of a kernel
+/// @function cancel_work takes ws objects off the worksize of a kernel, which
+/// the caller runs elsewhere instead of pushing them
+/// @function fit_batch_size_NTT rounds the NTT batch size up to a multiple
+/// of the compute units of the kernel and returns it
+/// @function fit_batch_size_INTT rounds the INTT batch size up to a multiple
+/// of the compute units of the kernel and returns it
 ///
 class Buffer {
 public:
@@ -277,6 +304,7 @@ public:
           num_KeySwitch_(0) {}
 
     void push(Object* obj);
+    void push_batch(const std::vector<Object*>& objs);
     Object* front() const;
     Object* back() const;
     std::vector<Object*> pop();
@@ -309,6 +337,15 @@ public:
         num_KeySwitch_ = total_worksize_KeySwitch_;
     }
 
+    uint64_t get_pending_KeySwitch() const { return num_KeySwitch_; }
+
+    uint64_t get_worksize(kernel_t type) const;
+    void set_worksize(kernel_t type, uint64_t ws);
+    void cancel_work(kernel_t type, uint64_t ws);
+
+    uint64_t fit_batch_size_NTT(uint64_t units);
+    uint64_t fit_batch_size_INTT(uint64_t units);
+
 private:
     uint64_t get_worksize_int_DyadicMultiply() const {
         return ((num_DyadicMultiply_ > n_batch_dyadic_multiply_)
@@ -329,6 +366,9 @@ private:
                                                       : num_KeySwitch_);
     }
 
+    uint64_t get_worksize_int(kernel_t type) const;
+    void update_work_size(kernel_t type, uint64_t ws);
+
     void update_DyadicMultiply_work_size(uint64_t ws) {
         num_DyadicMultiply_ -= ws;
     }
@@ -342,8 +382,8 @@ private:
     std::deque<Object*> buffer_;
     const uint64_t capacity_;
     const uint64_t n_batch_dyadic_multiply_;
-    const uint64_t n_batch_ntt_;
-    const uint64_t n_batch_intt_;
+    uint64_t n_batch_ntt_;
+    uint64_t n_batch_intt_;
     const uint64_t n_batch_KeySwitch_;
 
     uint64_t total_worksize_DyadicMultiply_;
@@ -404,15 +444,16 @@ public:
 /// @param[out] vector of polynomial coefficients
 ///
 /// coeff_poly_in_svm vector of polynomial coefficients
-/// root_of_unity_powers_in_svm twiddle factors
-/// precon_root_of_unity_powers_in_svm inverse twiddle factors
-/// coeff_modulus_in_svm_ polynomial coefficients modulus
+/// coeff_modulus_in_svm_ polynomial coefficients modulus of each frame
+/// table_id_in_svm_ twiddle table id of each frame
+/// table_slot_in_svm_ device memory slot of the twiddle table of each frame
 /// n polynomial size
+/// numa_node NUMA node preferred for the staging buffers, -1 for none
 ///
 class FPGAObject_NTT : public FPGAObject {
 public:
     explicit FPGAObject_NTT(sycl::queue& p_q, uint64_t coeff_count,
-                            uint64_t batch_size);
+                            uint64_t batch_size, int numa_node = -1);
     ~FPGAObject_NTT();
 
     FPGAObject_NTT(const FPGAObject_NTT&) = delete;
@@ -422,9 +463,9 @@ public:
     void fill_out_data(uint64_t* coeff_poly) override;
 
     uint64_t* coeff_poly_in_svm_;
-    uint64_t* root_of_unity_powers_in_svm_;
-    uint64_t* precon_root_of_unity_powers_in_svm_;
     uint64_t* coeff_modulus_in_svm_;
+    unsigned int* table_id_in_svm_;
+    unsigned int* table_slot_in_svm_;
     uint64_t n_;
 };
 
@@ -438,17 +479,20 @@ public:
 /// @param[out] vector of polynomial coefficients
 ///
 /// coeff_poly_in_svm vector of polynomial coefficients
-/// inv_root_of_unity_powers_in_svm twiddle factors
-/// precon_inv_root_of_unity_powers_in_svm inverse twiddle factors
-/// coeff_modulus_in_svm_ polynomial coefficients modulus
-/// inv_n_in_svm_  normalization factor 1/n for the polynomial coefficients
-/// inv_n_w_in_svm_  normalization factor 1/n for the constant coefficient
+/// coeff_modulus_in_svm_ polynomial coefficients modulus of each frame
+/// inv_n_in_svm_  normalization factor 1/n for the polynomial coefficients,
+/// of each frame
+/// inv_n_w_in_svm_  normalization factor 1/n for the constant coefficient, of
+/// each frame
+/// table_id_in_svm_ twiddle table id of each frame
+/// table_slot_in_svm_ device memory slot of the twiddle table of each frame
 /// n polynomial size
+/// numa_node NUMA node preferred for the staging buffers, -1 for none
 ///
 class FPGAObject_INTT : public FPGAObject {
 public:
     explicit FPGAObject_INTT(sycl::queue& p_q, uint64_t coeff_count,
-                             uint64_t batch_size);
+                             uint64_t batch_size, int numa_node = -1);
     ~FPGAObject_INTT();
     FPGAObject_INTT(const FPGAObject_INTT&) = delete;
     FPGAObject_INTT& operator=(const FPGAObject_INTT&) = delete;
@@ -457,11 +501,11 @@ public:
     void fill_out_data(uint64_t* coeff_poly) override;
 
     uint64_t* coeff_poly_in_svm_;
-    uint64_t* inv_root_of_unity_powers_in_svm_;
-    uint64_t* precon_inv_root_of_unity_powers_in_svm_;
     uint64_t* coeff_modulus_in_svm_;
     uint64_t* inv_n_in_svm_;
     uint64_t* inv_n_w_in_svm_;
+    unsigned int* table_id_in_svm_;
+    unsigned int* table_slot_in_svm_;
     uint64_t n_;
 };
 
@@ -481,12 +525,26 @@ public:
 /// n_moduli number of moduli
 /// operands_in_ddr_ pointer to operands in DDR memory
 /// results_out_ddr_ pointer to multiplication results in DDR
+/// results_out_svm_ host staging buffer the results are read back into
+/// tag_out_svm_ tag of the batch read back into results_out_svm_
+/// results_out_valid_svm_ set by the device once results_out_svm_ is filled
+/// output_event_ event of the readback kernel launched for this batch
+/// numa_node NUMA node preferred for the staging buffers, -1 for none
+/// plain_ the batch is a ciphertext x plaintext multiplication
+/// accumulate_ the products of the batch are summed on the device
+/// keys_resident_ the bitstream reads resident tile keys as operand1
+/// tile_keys_ the resident keys operand1 of the batch is read from, nullptr
+/// when operand1 is staged in operand1_in_svm_
+/// tile_keys_offset_ offset of operand1 of the batch in tile_keys_
+/// relinearize_event_ keyswitch load still reading the products of the
+/// previous batch in results_out_ddr_
 ///
 class FPGAObject_DyadicMultiply : public FPGAObject {
 public:
     explicit FPGAObject_DyadicMultiply(sycl::queue& p_q, uint64_t coeff_size,
                                        uint32_t modulus_size,
-                                       uint64_t batch_size);
+                                       uint64_t batch_size, int numa_node = -1,
+                                       bool keys_resident = false);
     ~FPGAObject_DyadicMultiply();
     FPGAObject_DyadicMultiply(const FPGAObject_DyadicMultiply&) = delete;
     FPGAObject_DyadicMultiply& operator=(const FPGAObject_DyadicMultiply&) =
@@ -502,6 +560,16 @@ public:
     uint64_t n_moduli_;
     uint64_t* operands_in_ddr_;
     uint64_t* results_out_ddr_;
+    uint64_t* results_out_svm_;
+    int* tag_out_svm_;
+    int* results_out_valid_svm_;
+    sycl::event output_event_;
+    bool plain_;
+    bool accumulate_;
+    bool keys_resident_;
+    const TileKeys* tile_keys_;
+    uint64_t tile_keys_offset_;
+    sycl::event relinearize_event_;
 };
 
 /// @brief
@@ -523,10 +591,16 @@ public:
 /// k_switch_keys stores the keys for keyswitch operation
 /// modswitch_factors stores the factors for modular switch
 /// twiddle_factors stores the twiddle factors
+/// max_coeff_count largest polynomial size supported by the bitstream
+/// numa_node NUMA node preferred for the staging buffers, -1 for none
+/// t_target_iter_ptrs_svm_ device addresses of the inputs of a batch read from
+/// device memory
 ///
 class FPGAObject_KeySwitch : public FPGAObject {
 public:
-    explicit FPGAObject_KeySwitch(sycl::queue& p_q, uint64_t batch_size);
+    explicit FPGAObject_KeySwitch(sycl::queue& p_q, uint64_t batch_size,
+                                  uint64_t max_coeff_count = 16384,
+                                  int numa_node = -1);
 
     ~FPGAObject_KeySwitch();
 
@@ -551,13 +625,10 @@ public:
 
     sycl::buffer<uint64_t>* mem_t_target_iter_ptr_;
     sycl::buffer<sycl::ulong2>* mem_KeySwitch_results_;
+    uint64_t** t_target_iter_ptrs_svm_;
 
 private:
-    enum {
-        H_MAX_KEY_MODULUS_SIZE = 7,
-        H_MAX_KEY_COMPONENT_SIZE = 2,
-        H_MAX_COEFF_COUNT = 16384
-    };
+    enum { H_MAX_KEY_MODULUS_SIZE = 7, H_MAX_KEY_COMPONENT_SIZE = 2 };
 };
 
 template <class t_type = uint256_t>
@@ -578,6 +649,130 @@ struct KeySwitchMemKeys {
     t_type* host_k_switch_keys_3_;
 };
 
+/// @brief
+/// struct NTTMemTwiddles stores a twiddle table of the NTT, or INTT, kernel
+/// in device memory, with a host copy to confirm a cache hit.
+///
+/// slot_ index of the table in the device memory of the NTTTwiddlesCache
+/// host_roots_ host copy of the twiddle factors
+/// host_precons_ host copy of the inverse twiddle factors
+/// id_ table id sent to the kernel with every frame, never 0
+/// last_use_ for the eviction of the least recently used table
+///
+struct NTTMemTwiddles {
+    uint32_t slot_;
+    std::vector<uint64_t> host_roots_;
+    std::vector<uint64_t> host_precons_;
+    uint32_t id_;
+    uint64_t last_use_;
+};
+
+/// @brief
+/// Twiddle tables are keyed by (n, modulus, root), with the root identified
+/// by the last twiddle factor of the table.
+typedef std::tuple<uint64_t, uint64_t, uint64_t> NTTTwiddlesKey;
+typedef std::map<NTTTwiddlesKey, NTTMemTwiddles*> NTTTwiddlesMap;
+
+/// @brief
+/// struct NTTTwiddlesCache stores the twiddle tables of the NTT, or INTT,
+/// kernel in NTT_MAX_TWIDDLE_TABLES slots of device memory, so that the
+/// frames of a batch can use different tables.
+///
+/// tables_ tables in use, by key
+/// roots_ twiddle factors of all the slots, device memory
+/// precons_ inverse twiddle factors of all the slots, device memory
+/// slot_size_ size of a slot, the largest transform size of the kernel
+///
+struct NTTTwiddlesCache {
+    NTTTwiddlesMap tables_;
+    uint64_t* roots_;
+    uint64_t* precons_;
+    uint64_t slot_size_;
+};
+
+/// @brief
+/// struct DyadicMemKeys stores the TileKeys of a tiled KeySwitch in device
+/// memory.
+///
+/// keys_ packed keys, device memory
+/// last_use_ for the eviction of the least recently used keys
+///
+struct DyadicMemKeys {
+    uint64_t* keys_;
+    uint64_t last_use_;
+};
+
+/// @brief
+/// struct DyadicMemProduct locates in device memory the third polynomial of
+/// a relinearized product, until its KeySwitch reads it.
+///
+/// fpga_obj_ batch whose results_out_ddr_ holds the product
+/// c2_ third polynomial of the product, device memory
+///
+struct DyadicMemProduct {
+    FPGAObject_DyadicMultiply* fpga_obj_;
+    uint64_t* c2_;
+};
+
+/// @brief
+/// struct ComputeUnitStats counts the frames sent to each compute unit of the
+/// NTT, or INTT, kernel. The frames of a batch go round-robin to the units,
+/// so the counts follow from the batch sizes: they show how evenly the
+/// batches are dealt, not the measured busy time of the units.
+///
+/// @function record accounts for a batch of n_batch frames
+/// @function report prints the frames and the frame share of every unit
+/// frames_ frames sent to each unit
+/// total_frames_ frames sent to all the units
+///
+struct ComputeUnitStats {
+    void record(uint64_t n_batch);
+    void report(std::ostream& os, const std::string& kernel,
+                int device_id) const;
+
+    std::vector<uint64_t> frames_;
+    uint64_t total_frames_;
+};
+
+/// @brief
+/// struct HostOverheadStats accumulates the time the device runner spends on
+/// the host side of each kernel, with env(FPGA_DEBUG)=3: packing a batch and
+/// enqueuing its kernels on input, and unpacking its results on output, the
+/// waits for the kernels and for the transfers of the tables excluded. The
+/// API side, timed on the calling threads, is the creation of the operation
+/// objects and their push to the buffer, with its locks. With the mock
+/// bitstream, whose kernels complete at once, both sides are the whole
+/// overhead of the host runtime.
+///
+/// @function record_input accounts for a batch of n_batch operations
+/// @function record_output accounts for the results of a batch
+/// @function record_api accounts for the queuing of ops operations
+/// @function report prints the time per batch and per operation of every
+/// kernel on the device side
+/// @function report_api prints the time per operation of every kernel on the
+/// API side
+/// kernels_ counters, by kernel name
+///
+struct HostOverheadStats {
+    struct Counters {
+        uint64_t batches;
+        uint64_t ops;
+        double input_seconds;
+        double output_seconds;
+        uint64_t api_ops;
+        double api_seconds;
+    };
+
+    void record_input(const std::string& kernel, uint64_t n_batch,
+                      double seconds);
+    void record_output(const std::string& kernel, double seconds);
+    void record_api(const std::string& kernel, uint64_t ops, double seconds);
+    void report(std::ostream& os, int device_id) const;
+    void report_api(std::ostream& os) const;
+
+    std::map<std::string, Counters> kernels_;
+};
+
 /// @brief
 /// enum DEV_TYPE
 /// Lists the available device mode: CPU, EMU, FPGA
@@ -599,7 +794,9 @@ typedef enum { NONE = -1, CPU = 0, EMU, FPGA } DEV_TYPE;
 /// @param[in] batch_size_KeySwitch batch size for the KeySwitch operation
 /// @param[in] debug flag indicating debug mode
 ///
-/// @function run function to launch the operation on the FPGA
+/// @function run function to launch the operation on the FPGA. The calling
+/// thread is pinned to the NUMA node local to the card, which is detected
+/// from the PCIe bus or overridden by env(FPGA_NUMA_NODES).
 ///
 class Device {
 public:
@@ -621,7 +818,7 @@ private:
     bool process_input(int index);
     bool process_output();
 
-    bool process_output_dyadic_multiply();
+    bool process_output_dyadic_multiply(bool blocking);
     bool process_output_NTT();
     bool process_output_INTT();
     bool process_output_KeySwitch();
@@ -642,27 +839,53 @@ private:
     void build_modulus_meta(FPGAObject_KeySwitch* fpga_obj);
     void build_invn_meta(FPGAObject_KeySwitch* fpga_obj);
     void KeySwitch_read_output();
+    void alloc_twiddles(NTTTwiddlesCache& cache, sycl::queue& q,
+                        uint64_t slot_size);
+    NTTMemTwiddles* get_twiddles(NTTTwiddlesCache& cache, sycl::queue& q,
+                                 uint64_t n, uint64_t modulus,
+                                 const uint64_t* roots,
+                                 const uint64_t* precons,
+                                 uint64_t batch_start);
+    void free_twiddles(NTTTwiddlesCache& cache, sycl::queue& q);
+    uint64_t* get_tile_keys(const TileKeys* tile_keys);
+    bool KeySwitch_products_resident(FPGAObject_KeySwitch* fpga_obj);
+    void KeySwitch_load_products(FPGAObject_KeySwitch* fpga_obj, int obj_id,
+                                 unsigned rmem);
+    void wait_input(sycl::queue& q);
+    void wait_input(sycl::event e);
     uint64_t precompute_modulus_k(uint64_t modulus);
+    uint64_t precompute_modulus_rk(uint64_t modulus);
     void copyKeySwitchBatch(FPGAObject_KeySwitch* fpga_obj, int obj_id);
     kernel_t get_kernel_type();
     std::string get_bitstream_name();
     void load_kernel_symbols();
+    int get_numa_node();
 
     sycl::device device_;
     Buffer& buffer_;
     unsigned int credit_;
     std::shared_future<bool> future_exit_;
-    uint64_t* dyadic_multiply_results_out_svm_;
-    int* dyadic_multiply_tag_out_svm_;
-    int* dyadic_multiply_results_out_valid_svm_;
     uint64_t* NTT_coeff_poly_svm_;
     uint64_t* INTT_coeff_poly_svm_;
+    uint64_t NTT_max_coeff_count_;
+    uint64_t INTT_max_coeff_count_;
+    NTTTwiddlesCache NTT_twiddles_;
+    NTTTwiddlesCache INTT_twiddles_;
+    ComputeUnitStats NTT_units_;
+    ComputeUnitStats INTT_units_;
+    HostOverheadStats host_overhead_;
+    double input_wait_seconds_;
+    uint32_t twiddle_table_id_;
+    uint64_t twiddle_table_use_;
     sycl::buffer<uint64_t>* KeySwitch_mem_root_of_unity_powers_;
     bool KeySwitch_load_once_;
+    uint64_t KeySwitch_max_coeff_count_;
+    uint64_t KeySwitch_max_modulus_bits_;
     uint64_t* root_of_unity_powers_ptr_;
     moduli_t modulus_meta_;
     invn_t invn_;
     uint64_t KeySwitch_id_;
+    uint64_t KeySwitch_num_ops_;
     std::unordered_map<uint64_t**, KeySwitchMemKeys<uint256_t>*>::iterator
         keys_map_iter_;
     uint32_t debug_;
@@ -688,8 +911,12 @@ private:
     sycl::event KeySwitch_events_write_[2][1024];
     sycl::event KeySwitch_events_enqueue_[2][2];
     std::unordered_map<uint64_t**, KeySwitchMemKeys<uint256_t>*> keys_map_;
+    std::unordered_map<uint64_t, DyadicMemKeys> tile_keys_map_;
+    std::unordered_map<const Object*, DyadicMemProduct> products_map_;
+    uint64_t tile_keys_use_;
     static int device_id_;
     int id_;
+    int numa_node_;
     kernel_t kernel_type_;
     std::vector<FPGAObject*> fpga_objects_;
     static const std::unordered_map<std::string, kernel_t> kernels_;
@@ -710,6 +937,7 @@ private:
 /// @param[in] batch_size_intt batch size for the INTT operation
 /// @param[in] batch_size_KeySwitch batch size for the KeySwitch operation
 /// @param[in] debug flag indicating debug mode
+/// @function device_count returns the number of devices sharing the buffer
 ///
 class DevicePool {
 public:
@@ -719,6 +947,7 @@ public:
                uint64_t batch_size_intt, uint64_t batch_size_KeySwitch,
                uint32_t debug);
     ~DevicePool();
+    unsigned int device_count() const { return device_count_; }
 
 private:
     DevicePool(const DevicePool& d) = delete;
@@ -42,6 +42,95 @@ void DyadicMultiply(uint64_t* results, const uint64_t* operand1,
                     const uint64_t* operand2, uint64_t n,
                     const uint64_t* moduli, uint64_t n_moduli);
 
+/// @brief
+///
+/// Function DyadicMultiplyBatch
+/// Executes count ciphertext ciphertext multiplications sharing the same
+/// moduli. The parameters are validated once and the multiplications are
+/// submitted to the FPGA in batches of BATCH_SIZE_DYADIC_MULTIPLY. Without a
+/// prior call to set_worksize_DyadicMultiply the call returns once all the
+/// results are available.
+/// @param[out] results count pointers to the multiplication results
+/// @param[in]  operand1 count pointers to the input ciphertexts 1
+/// @param[in]  operand2 count pointers to the input ciphertexts 2
+/// @param[in]  count number of multiplications
+/// @param[in]  n stores polynomial size
+/// @param[in]  moduli stores the moduli shared by the batch
+/// @param[in]  n_moduli stores the number of moduli
+///
+void DyadicMultiplyBatch(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         const uint64_t* moduli, uint64_t n_moduli);
+
+/// @brief
+///
+/// Function MultiplyPlain
+/// Executes ciphertext plaintext multiplication. It shares the worksize and
+/// the completion of DyadicMultiply.
+/// @param[out] results stores the 2 polynomials of the multiplication results
+/// @param[in]  ciphertext stores the input ciphertext of 2 polynomials
+/// @param[in]  plaintext stores the input plaintext of 1 polynomial
+/// @param[in]  n stores polynomial size
+/// @param[in]  moduli stores the moduli
+/// @param[in]  n_moduli stores the number of moduli
+///
+void MultiplyPlain(uint64_t* results, const uint64_t* ciphertext,
+                   const uint64_t* plaintext, uint64_t n,
+                   const uint64_t* moduli, uint64_t n_moduli);
+
+/// @brief
+///
+/// Function MultiplyPlainBatch
+/// Executes count ciphertext plaintext multiplications sharing the same
+/// moduli, with the batching of DyadicMultiplyBatch.
+/// @param[out] results count pointers to the multiplication results
+/// @param[in]  ciphertext count pointers to the input ciphertexts
+/// @param[in]  plaintext count pointers to the input plaintexts
+/// @param[in]  count number of multiplications
+/// @param[in]  n stores polynomial size
+/// @param[in]  moduli stores the moduli shared by the batch
+/// @param[in]  n_moduli stores the number of moduli
+///
+void MultiplyPlainBatch(uint64_t** results, const uint64_t** ciphertext,
+                        const uint64_t** plaintext, uint64_t count,
+                        uint64_t n, const uint64_t* moduli, uint64_t n_moduli);
+
+/// @brief
+///
+/// Function DyadicMultiplyAccumulate
+/// Executes the inner product of count pairs of ciphertexts. The products
+/// are summed on the FPGA, and only the sum is transfered back.
+/// @param[out] results stores the 3 polynomials of the sum of the products
+/// @param[in]  operand1 count pointers to the input ciphertexts 1
+/// @param[in]  operand2 count pointers to the input ciphertexts 2
+/// @param[in]  count number of products
+/// @param[in]  n stores polynomial size
+/// @param[in]  moduli stores the moduli shared by the products
+/// @param[in]  n_moduli stores the number of moduli
+///
+void DyadicMultiplyAccumulate(uint64_t* results, const uint64_t** operand1,
+                              const uint64_t** operand2, uint64_t count,
+                              uint64_t n, const uint64_t* moduli,
+                              uint64_t n_moduli);
+
+/// @brief
+///
+/// Function MultiplyPlainAccumulate
+/// Executes the inner product of count ciphertexts with count plaintexts,
+/// summed on the FPGA.
+/// @param[out] results stores the 2 polynomials of the sum of the products
+/// @param[in]  ciphertext count pointers to the input ciphertexts
+/// @param[in]  plaintext count pointers to the input plaintexts
+/// @param[in]  count number of products
+/// @param[in]  n stores polynomial size
+/// @param[in]  moduli stores the moduli shared by the products
+/// @param[in]  n_moduli stores the number of moduli
+///
+void MultiplyPlainAccumulate(uint64_t* results, const uint64_t** ciphertext,
+                             const uint64_t** plaintext, uint64_t count,
+                             uint64_t n, const uint64_t* moduli,
+                             uint64_t n_moduli);
+
 /// @brief
 ///
 /// Function DyadicMultiplyCompleted
@@ -60,6 +149,13 @@ void set_worksize_KeySwitch(uint64_t ws);
 ///
 /// Function KeySwitch
 /// Executes KeySwitch operation
+/// Modulus chains of more than 7 key moduli, n = 16384 only, are tiled over
+/// the NTT/INTT and dyadic multiplication kernels of the KEYSWITCH_TILED
+/// bitstream, in groups of up to 7 moduli. The call then returns once the
+/// result is available. That bitstream has no keyswitch kernel, so with it
+/// every keyswitch is tiled and requires n = 16384.
+/// Moduli wider than 52 bits, of up to 60 bits, need the keyswitch_60 or
+/// dyadic_multiply_keyswitch_60 bitstream and n >= 4096.
 /// @param[out] results stores the keyswitch results
 /// @param[in]  t_target_iter_ptr stores the input ciphertext data
 /// @param[in]  n stores polynomial size
@@ -79,12 +175,303 @@ void KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr, uint64_t n,
                const uint64_t* modswitch_factors,
                const uint64_t* twiddle_factors = nullptr);
 
+/// @brief
+///
+/// Function KeySwitchBatch
+/// Executes count KeySwitch operations sharing the same parameters and keys.
+/// The parameters are validated once and the operations are submitted to the
+/// FPGA in batches of BATCH_SIZE_KEYSWITCH. Without a prior call to
+/// set_worksize_KeySwitch the call returns once all the results are available.
+/// @param[out] results count pointers to the keyswitch results
+/// @param[in]  t_target_iter_ptrs count pointers to the input ciphertext data
+/// @param[in]  count number of keyswitch operations
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size stores modulus size
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_size stores the key component size
+/// @param[in]  moduli stores the moduli
+/// @param[in]  k_switch_keys stores the keys for keyswitch operation
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void KeySwitchBatch(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                    uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                    uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                    uint64_t key_component_count, const uint64_t* moduli,
+                    const uint64_t** k_switch_keys,
+                    const uint64_t* modswitch_factors,
+                    const uint64_t* twiddle_factors = nullptr);
+
+/// @brief
+///
+/// Function KeySwitchHybrid
+/// Executes count hybrid KeySwitch operations sharing the same parameters and
+/// keys: the input is decomposed into dnum digits of several moduli, and the
+/// keys carry special_modulus_size special moduli. The transforms and the
+/// products run on the KEYSWITCH_TILED bitstream. Runs synchronously.
+/// dnum = key_modulus_size - 1 with one special modulus is the decomposition
+/// of KeySwitch.
+/// @param[out] results count pointers to the keyswitch results, to which
+/// the keyswitched components are added
+/// @param[in]  t_target_iter_ptrs count pointers to the input ciphertext data
+/// @param[in]  count number of keyswitch operations
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the input
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  special_modulus_size number of special moduli, the last ones
+/// of the key moduli
+/// @param[in]  dnum number of digits of the keys, each covering
+/// ceil((key_modulus_size - special_modulus_size) / dnum) moduli
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores dnum keys of key_component_count *
+/// key_modulus_size polynomials in NTT form
+///
+void KeySwitchHybrid(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                     uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                     uint64_t key_modulus_size, uint64_t special_modulus_size,
+                     uint64_t dnum, uint64_t key_component_count,
+                     const uint64_t* moduli, const uint64_t** k_switch_keys);
+
 /// @brief
 ///
 /// Function KeySwitchCompleted
 /// Executed after KeySwitch to sync up the outstanding KeySwitch tasks
 bool KeySwitchCompleted();
 
+// MultiplyRelinearize Section
+/// @brief
+///
+/// Function MultiplyRelinearize
+/// Multiplies count pairs of ciphertexts and relinearizes the products with
+/// the DYADIC_MULTIPLY_KEYSWITCH bitstream. Runs synchronously. The third
+/// components of the products stay in device memory, where the keyswitch
+/// reads them.
+/// @param[out] results count pointers to buffers of 3 * decomp_modulus_size * n
+/// words. On return the first two components hold the relinearized ciphertext
+/// and the third one is scratch.
+/// @param[in]  operand1 count pointers to the first input ciphertexts
+/// @param[in]  operand2 count pointers to the second input ciphertexts
+/// @param[in]  count number of ciphertext pairs
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertexts
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores the relinearization keys
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void MultiplyRelinearize(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         uint64_t decomp_modulus_size,
+                         uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                         uint64_t key_component_count, const uint64_t* moduli,
+                         const uint64_t** k_switch_keys,
+                         const uint64_t* modswitch_factors,
+                         const uint64_t* twiddle_factors = nullptr);
+
+// Rotate Section
+/// @brief
+///
+/// Function Rotate
+/// Rotates count ciphertexts: applies the Galois automorphism of galois_elt
+/// and key switches with the matching Galois keys. Runs synchronously.
+/// @param[out] results count pointers to buffers of 2 * decomp_modulus_size * n
+/// words, distinct from the ciphertexts
+/// @param[in]  ciphertexts count pointers to the input ciphertexts in NTT form
+/// @param[in]  count number of ciphertexts
+/// @param[in]  galois_elt odd Galois element in [1, 2n)
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertexts
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores the Galois keys of galois_elt
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void Rotate(uint64_t** results, const uint64_t** ciphertexts, uint64_t count,
+            uint64_t galois_elt, uint64_t n, uint64_t decomp_modulus_size,
+            uint64_t key_modulus_size, uint64_t rns_modulus_size,
+            uint64_t key_component_count, const uint64_t* moduli,
+            const uint64_t** k_switch_keys, const uint64_t* modswitch_factors,
+            const uint64_t* twiddle_factors = nullptr);
+
+/// @brief
+///
+/// Function RotateSteps
+/// Rotates one ciphertext by several steps with a single synchronous call.
+/// The second component is decomposed once for all the steps where the
+/// keyswitch allows it, so the results are hoisted keyswitches.
+/// @param[out] results steps pointers to buffers of 2 * decomp_modulus_size * n
+/// words, distinct from the ciphertext
+/// @param[in]  ciphertext input ciphertext in NTT form
+/// @param[in]  steps number of rotations
+/// @param[in]  galois_elts steps odd Galois elements in [1, 2n)
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertext
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys steps Galois keys, one per Galois element
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void RotateSteps(uint64_t** results, const uint64_t* ciphertext, uint64_t steps,
+                 const uint64_t* galois_elts, uint64_t n,
+                 uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                 uint64_t rns_modulus_size, uint64_t key_component_count,
+                 const uint64_t* moduli, const uint64_t*** k_switch_keys,
+                 const uint64_t* modswitch_factors,
+                 const uint64_t* twiddle_factors = nullptr);
+
+// Rescale Section
+/// @brief
+///
+/// Function Rescale
+/// Divides count ciphertexts in NTT form by their last modulus and rounds,
+/// the CKKS rescale, with the transforms offloaded to the RESCALE bitstream.
+/// Runs synchronously.
+/// @param[out] results count pointers to buffers of
+/// num_components * (num_moduli - 1) * n words, distinct from the operands
+/// @param[in]  operands count pointers to the input ciphertexts, each made of
+/// num_components polynomials of num_moduli * n words
+/// @param[in]  count number of ciphertexts
+/// @param[in]  n stores polynomial size
+/// @param[in]  num_components number of polynomials of each ciphertext
+/// @param[in]  num_moduli number of moduli of the input ciphertexts
+/// @param[in]  moduli stores the num_moduli moduli, the dropped one last
+///
+void Rescale(uint64_t** results, const uint64_t** operands, uint64_t count,
+             uint64_t n, uint64_t num_components, uint64_t num_moduli,
+             const uint64_t* moduli);
+
+// RNS transforms Section
+/// @brief
+///
+/// Function NTTRns
+/// Executes in place the Number Theoretic Transform of the num_moduli limbs
+/// of an RNS polynomial, e.g. one component of a ciphertext, in one device
+/// batch. The twiddle factors of each modulus, for the minimal primitive
+/// 2n-th root of unity, are computed and cached by the library.
+/// Runs synchronously.
+/// @param[in] coeff_poly num_moduli limbs of n coefficients, limb i reduced
+/// by moduli[i]
+/// @param[out] coeff_poly transformed limbs, in place
+/// @param[in] moduli stores the num_moduli moduli
+/// @param[in] num_moduli number of limbs
+/// @param[in] n stores the size of the Number Theoretic Transform,
+/// 1024/2048/4096/8192/16384 up to the maximum of the bitstream
+///
+void NTTRns(uint64_t* coeff_poly, const uint64_t* moduli, uint64_t num_moduli,
+            uint64_t n);
+
+/// @brief
+///
+/// Function INTTRns
+/// Executes in place the inverse Number Theoretic Transform of the num_moduli
+/// limbs of an RNS polynomial in one device batch. See NTTRns.
+/// Runs synchronously.
+/// @param[in] coeff_poly num_moduli limbs of n coefficients, limb i reduced
+/// by moduli[i]
+/// @param[out] coeff_poly transformed limbs, in place
+/// @param[in] moduli stores the num_moduli moduli
+/// @param[in] num_moduli number of limbs
+/// @param[in] n stores the size of the inverse Number Theoretic Transform,
+/// 1024/2048/4096/8192/16384 up to the maximum of the bitstream
+///
+void INTTRns(uint64_t* coeff_poly, const uint64_t* moduli, uint64_t num_moduli,
+             uint64_t n);
+
+// Transform Section
+/// @brief
+///
+/// Function CreateTransformPlan
+/// Registers the forward and inverse negacyclic Number Theoretic Transforms
+/// of size n modulo modulus. The twiddle factors are computed once, here,
+/// and shared by all the ForwardTransform and InverseTransform calls of the
+/// plan. Plans live until DestroyTransformPlan.
+/// @param[in] n stores the size of the transforms,
+/// 1024/2048/4096/8192/16384 up to the maximum of the bitstream
+/// @param[in] modulus stores the prime coefficient modulus, 1 modulo 2n
+/// @param[in] root_of_unity primitive 2n-th root of unity modulo modulus, or
+/// 0 for the minimal one
+/// @return the id of the plan
+///
+uint64_t CreateTransformPlan(uint64_t n, uint64_t modulus,
+                             uint64_t root_of_unity = 0);
+
+/// @brief
+///
+/// Function DestroyTransformPlan
+/// Releases a plan. Its transforms must have completed.
+/// @param[in] plan id returned by CreateTransformPlan
+///
+void DestroyTransformPlan(uint64_t plan);
+
+/// @brief
+/// Function set_worksize_ForwardTransform
+/// Reserves software resources for ws forward transforms, which then return
+/// without waiting for their results until ForwardTransformCompleted
+/// @param ws integer storing the worksize
+///
+void set_worksize_ForwardTransform(uint64_t ws);
+
+/// @brief
+///
+/// Function ForwardTransform
+/// Executes in place the forward Number Theoretic Transform of count
+/// polynomials with the plan. The polynomials are submitted to the FPGA in
+/// batches of BATCH_SIZE_NTT. Without a prior call to
+/// set_worksize_ForwardTransform the call returns once all the results are
+/// available.
+/// @param[in] coeff_polys count pointers to polynomials of n coefficients
+/// reduced by the modulus of the plan
+/// @param[out] coeff_polys transformed polynomials, in place
+/// @param[in] count number of polynomials
+/// @param[in] plan id returned by CreateTransformPlan
+///
+void ForwardTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan);
+
+/// @brief
+///
+/// Function ForwardTransformCompleted
+/// Waits for the outstanding forward transforms
+bool ForwardTransformCompleted();
+
+/// @brief
+/// Function set_worksize_InverseTransform
+/// Reserves software resources for ws inverse transforms, which then return
+/// without waiting for their results until InverseTransformCompleted
+/// @param ws integer storing the worksize
+///
+void set_worksize_InverseTransform(uint64_t ws);
+
+/// @brief
+///
+/// Function InverseTransform
+/// Executes in place the inverse Number Theoretic Transform of count
+/// polynomials with the plan, in batches of BATCH_SIZE_INTT. See
+/// ForwardTransform.
+/// @param[in] coeff_polys count pointers to polynomials of n coefficients
+/// reduced by the modulus of the plan
+/// @param[out] coeff_polys transformed polynomials, in place
+/// @param[in] count number of polynomials
+/// @param[in] plan id returned by CreateTransformPlan
+///
+void InverseTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan);
+
+/// @brief
+///
+/// Function InverseTransformCompleted
+/// Waits for the outstanding inverse transforms
+bool InverseTransformCompleted();
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 // WARNING: The following NTT and INTT related APIs are deprecated since
@@ -110,7 +497,8 @@ bool KeySwitchCompleted();
 /// @param[in] precon_root_of_unity_powers vector of precomputed inverse twiddle
 /// factors
 /// @param[in] coeff_modulus stores the modulus
-/// @param[in] n stores the size of the Number Theoretic Transform
+/// @param[in] n stores the size of the Number Theoretic Transform,
+/// 1024/2048/4096/8192/16384 up to the maximum of the bitstream
 ///
 [[deprecated]] void _NTT(uint64_t* operand,
                          const uint64_t* root_of_unity_powers,
@@ -145,7 +533,8 @@ bool KeySwitchCompleted();
 /// @param[in] inv_n  stores the normalization factor for the inverse transform.
 /// Inverse of the polynomial size ( 1/n)
 /// @param[in] inv_n_w  stores the  normalization factor for the constant.
-/// @param[in] n stores the size of the Number Theoretic Transform
+/// @param[in] n stores the size of the Number Theoretic Transform,
+/// 1024/2048/4096/8192/16384 up to the maximum of the bitstream
 ///
 [[deprecated]] void _INTT(uint64_t* operand,
                           const uint64_t* inv_root_of_unity_powers,
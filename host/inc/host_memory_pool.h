@@ -0,0 +1,94 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __HOST_MEMORY_POOL_H__
+#define __HOST_MEMORY_POOL_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+/// @brief
+/// Struct HostMemoryPoolStats
+/// @param[in] huge_1g_blocks blocks backed by 1 GB huge pages
+/// @param[in] huge_2m_blocks blocks backed by 2 MB huge pages
+/// @param[in] fallback_blocks blocks backed by default (or transparent huge)
+/// pages because no huge page was available
+/// @param[in] reused_blocks allocations served from a released block
+/// @param[in] bytes_mapped total bytes mapped by the pool
+///
+struct HostMemoryPoolStats {
+    uint64_t huge_1g_blocks;
+    uint64_t huge_2m_blocks;
+    uint64_t fallback_blocks;
+    uint64_t reused_blocks;
+    uint64_t bytes_mapped;
+};
+
+/// @brief
+/// Class HostMemoryPool
+/// Process wide pool of host staging memory. Blocks are mapped with 1 GB or
+/// 2 MB huge pages when available, and fall back on default pages advised for
+/// transparent huge pages. Released blocks are kept and reused by later
+/// allocations, including the ones of other Device objects.
+/// Huge pages are not requested when env(FPGA_HUGEPAGES) is 0.
+///
+/// @function instance returns the pool
+/// @function allocate returns a block of at least size bytes
+/// @param[in] size size in bytes
+/// @param[in] numa_node preferred NUMA node of the block, -1 for none
+/// @function release returns a block to the pool
+/// @param[in] ptr pointer returned by allocate
+/// @function stats returns the huge page statistics of the pool
+/// @function report prints the statistics of the pool
+/// @function advise_huge_pages asks the kernel to back an existing range,
+/// e.g. a USM allocation, with transparent huge pages
+///
+class HostMemoryPool {
+public:
+    static HostMemoryPool& instance();
+    ~HostMemoryPool();
+
+    void* allocate(size_t size, int numa_node = -1);
+    void release(void* ptr);
+
+    HostMemoryPoolStats stats();
+    void report(std::ostream& os);
+
+    static void advise_huge_pages(void* ptr, size_t size);
+
+private:
+    enum page_t { PAGE_1G, PAGE_2M, PAGE_DEFAULT };
+
+    struct Block {
+        void* ptr;
+        size_t capacity;
+        int numa_node;
+        page_t page;
+    };
+
+    HostMemoryPool();
+    HostMemoryPool(const HostMemoryPool&) = delete;
+    HostMemoryPool& operator=(const HostMemoryPool&) = delete;
+
+    Block map_block(size_t size, int numa_node);
+
+    std::mutex mu_;
+    bool use_huge_pages_;
+    std::multimap<size_t, Block> free_blocks_;
+    std::unordered_map<void*, Block> used_blocks_;
+    HostMemoryPoolStats stats_;
+};
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
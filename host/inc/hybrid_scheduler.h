@@ -0,0 +1,103 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __HYBRID_SCHEDULER_H__
+#define __HYBRID_SCHEDULER_H__
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+/// @brief
+/// Struct HybridCounters
+/// @param[in] ops operations run by a backend
+/// @param[in] batches batches the backend took part in
+/// @param[in] seconds time spent by the backend on its share of the batches
+///
+struct HybridCounters {
+    uint64_t ops;
+    uint64_t batches;
+    double seconds;
+};
+
+/// @brief
+/// Struct HybridStats
+/// @param[in] cpu counters of the CPU backend
+/// @param[in] fpga counters of the FPGA device
+/// @param[in] cpu_share fraction of the next batch given to the CPU backend
+///
+struct HybridStats {
+    HybridCounters cpu;
+    HybridCounters fpga;
+    double cpu_share;
+};
+
+/// @brief
+/// Class HybridScheduler
+/// Process wide scheduler of the hybrid CPU+FPGA mode, enabled by
+/// env(FPGA_HYBRID)=1 with RUN_CHOICE 1 or 2. Each batch of an operation,
+/// synchronous or queued under a worksize, is split between the device and
+/// the CPU backend, which run it at the same time, in proportion to the
+/// throughput each side measured on the previous batches of the operation,
+/// so that both finish together. The device is only measured on the
+/// synchronous batches. Until both sides are measured the CPU backend gets
+/// an eighth of a batch, and each side at least one input of a batch of two
+/// or more.
+///
+/// @function instance returns the scheduler
+/// @function enabled returns whether the hybrid mode is on
+/// @function cpu_count returns how many of count inputs the CPU backend runs
+/// @param[in] op operation name
+/// @param[in] count inputs in the batch
+/// @function record updates the throughput and the counters of op
+/// @param[in] cpu_ops inputs run by the CPU backend
+/// @param[in] cpu_seconds time the CPU backend took on them
+/// @param[in] fpga_ops inputs run by the device
+/// @param[in] fpga_seconds time the device took on them
+/// @function stats returns the counters of op
+/// @function report prints the counters of all the operations
+///
+class HybridScheduler {
+public:
+    static HybridScheduler& instance();
+
+    bool enabled() const { return enabled_; }
+
+    uint64_t cpu_count(const std::string& op, uint64_t count);
+    void record(const std::string& op, uint64_t cpu_ops, double cpu_seconds,
+                uint64_t fpga_ops, double fpga_seconds);
+
+    HybridStats stats(const std::string& op);
+    void report(std::ostream& os);
+
+private:
+    struct Stream {
+        // operations per second, 0 until measured
+        double cpu_rate;
+        double fpga_rate;
+        HybridCounters cpu;
+        HybridCounters fpga;
+    };
+
+    HybridScheduler();
+    HybridScheduler(const HybridScheduler&) = delete;
+    HybridScheduler& operator=(const HybridScheduler&) = delete;
+
+    static double share(const Stream& s);
+
+    std::mutex mu_;
+    bool enabled_;
+    std::map<std::string, Stream> streams_;
+};
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
@@ -40,6 +40,20 @@ void INTT_int(uint64_t* coeff_poly, const uint64_t* inv_root_of_unity_powers,
 
 bool INTTCompleted_int();
 
+/// @brief
+/// @function INTTRns_int
+/// Calls the inverse Number Theoretic Transform of all the limbs of an RNS
+/// polynomial in one batch. Internal implementation.
+/// @param[in] coeff_poly num_moduli limbs of n coefficients, limb i reduced
+/// by moduli[i]
+/// @param[out] coeff_poly transformed limbs
+/// @param[in] moduli stores the num_moduli coefficient moduli
+/// @param[in] num_moduli stores the number of limbs
+/// @param[in] n stores the polynomial size
+///
+void INTTRns_int(uint64_t* coeff_poly, const uint64_t* moduli,
+                 uint64_t num_moduli, uint64_t n);
+
 }  // namespace fpga
 }  // namespace hexl
 }  // namespace intel
@@ -38,6 +38,65 @@ void KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr, uint64_t n,
                const uint64_t* modswitch_factors,
                const uint64_t* twiddle_factors = nullptr);
 
+/// @brief
+///
+/// Function KeySwitchBatch
+/// Executes count KeySwitch operations sharing the same parameters and keys.
+/// The parameters are validated once and the operations are submitted to the
+/// FPGA in batches of BATCH_SIZE_KEYSWITCH. Without a prior call to
+/// set_worksize_KeySwitch the call returns once all the results are available.
+/// @param[out] results count pointers to the keyswitch results
+/// @param[in]  t_target_iter_ptrs count pointers to the input ciphertext data
+/// @param[in]  count number of keyswitch operations
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size stores modulus size
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_size stores the key component size
+/// @param[in]  moduli stores the moduli
+/// @param[in]  k_switch_keys stores the keys for keyswitch operation
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void KeySwitchBatch(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                    uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                    uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                    uint64_t key_component_count, const uint64_t* moduli,
+                    const uint64_t** k_switch_keys,
+                    const uint64_t* modswitch_factors,
+                    const uint64_t* twiddle_factors = nullptr);
+
+/// @brief
+///
+/// Function KeySwitchHybrid
+/// Executes count hybrid KeySwitch operations sharing the same parameters and
+/// keys: the input is decomposed into dnum digits of several moduli, and the
+/// keys carry special_modulus_size special moduli. The transforms and the
+/// products run on the KEYSWITCH_TILED bitstream. Runs synchronously.
+/// dnum = key_modulus_size - 1 with one special modulus is the decomposition
+/// of KeySwitch.
+/// @param[out] results count pointers to the keyswitch results, to which
+/// the keyswitched components are added
+/// @param[in]  t_target_iter_ptrs count pointers to the input ciphertext data
+/// @param[in]  count number of keyswitch operations
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the input
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  special_modulus_size number of special moduli, the last ones
+/// of the key moduli
+/// @param[in]  dnum number of digits of the keys, each covering
+/// ceil((key_modulus_size - special_modulus_size) / dnum) moduli
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores dnum keys of key_component_count *
+/// key_modulus_size polynomials in NTT form
+///
+void KeySwitchHybrid(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                     uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                     uint64_t key_modulus_size, uint64_t special_modulus_size,
+                     uint64_t dnum, uint64_t key_component_count,
+                     const uint64_t* moduli, const uint64_t** k_switch_keys);
+
 /// @brief
 ///
 /// Function KeySwitchCompleted
@@ -0,0 +1,50 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __MULTIPLY_RELINEARIZE_H__
+#define __MULTIPLY_RELINEARIZE_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function MultiplyRelinearize
+/// Multiplies count pairs of ciphertexts and relinearizes the products. The
+/// third component of each product is key switched back into the first two,
+/// without the caller handling the intermediate ciphertext: on a single
+/// device the keyswitch kernel reads it from the device memory the dyadic
+/// kernel wrote it to, and it is staged from the host otherwise. Requires the
+/// DYADIC_MULTIPLY_KEYSWITCH bitstream and synchronous execution, i.e. no
+/// pending set_worksize_DyadicMultiply/set_worksize_KeySwitch.
+/// @param[out] results count pointers to buffers of 3 * decomp_modulus_size * n
+/// words. On return the first two components hold the relinearized ciphertext
+/// and the third one is scratch.
+/// @param[in]  operand1 count pointers to the first input ciphertexts
+/// @param[in]  operand2 count pointers to the second input ciphertexts
+/// @param[in]  count number of ciphertext pairs
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertexts
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores the relinearization keys
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void MultiplyRelinearize(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         uint64_t decomp_modulus_size,
+                         uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                         uint64_t key_component_count, const uint64_t* moduli,
+                         const uint64_t** k_switch_keys,
+                         const uint64_t* modswitch_factors,
+                         const uint64_t* twiddle_factors = nullptr);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
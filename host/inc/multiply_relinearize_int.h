@@ -0,0 +1,41 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __MULTIPLY_RELINEARIZE_INT_H__
+#define __MULTIPLY_RELINEARIZE_INT_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function MultiplyRelinearize_int
+/// Internal implementation of the MultiplyRelinearize function call
+/// @param[out] results count pointers to the products, 3 components each
+/// @param[in]  operand1 count pointers to the first input ciphertexts
+/// @param[in]  operand2 count pointers to the second input ciphertexts
+/// @param[in]  count number of ciphertext pairs
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertexts
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores the relinearization keys
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void MultiplyRelinearize_int(
+    uint64_t** results, const uint64_t** operand1, const uint64_t** operand2,
+    uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+    uint64_t key_modulus_size, uint64_t rns_modulus_size,
+    uint64_t key_component_count, const uint64_t* moduli,
+    const uint64_t** k_switch_keys, const uint64_t* modswitch_factors,
+    const uint64_t* twiddle_factors = nullptr);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
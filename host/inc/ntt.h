@@ -35,6 +35,21 @@ void NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
 ///
 bool NTTCompleted();
 
+/// @brief
+/// @function NTTRns
+/// Calls the forward Number Theoretic Transform of all the limbs of an RNS
+/// polynomial in one batch. The twiddle factors of each modulus are computed,
+/// and cached, by the library.
+/// @param[in] coeff_poly num_moduli limbs of n coefficients, limb i reduced
+/// by moduli[i]
+/// @param[out] coeff_poly transformed limbs
+/// @param[in] moduli stores the num_moduli coefficient moduli
+/// @param[in] num_moduli stores the number of limbs
+/// @param[in] n stores the polynomial size
+///
+void NTTRns(uint64_t* coeff_poly, const uint64_t* moduli,
+            uint64_t num_moduli, uint64_t n);
+
 }  // namespace fpga
 }  // namespace hexl
 }  // namespace intel
@@ -0,0 +1,59 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __NUMA_UTIL_H__
+#define __NUMA_UTIL_H__
+
+#include <cstddef>
+#include <string>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+/// @brief
+/// @function host_numa_node_of_device
+/// Looks up the NUMA node local to the PCIe root of an FPGA card.
+/// The PCI functions of the cards are found through the devices of the
+/// fpga and fpga_region classes in sysfs, and the numa_node of the
+/// device_index'th one, in the order of their PCI addresses, is returned.
+/// @param[in] device_index index of the card among the FPGA devices
+/// @return the NUMA node, or -1 if it cannot be determined
+///
+int host_numa_node_of_device(int device_index);
+
+/// @brief
+/// @function host_numa_node_override
+/// Returns the NUMA node requested for a device through env(FPGA_NUMA_NODES),
+/// a comma separated list indexed by device id, e.g. FPGA_NUMA_NODES=1,0.
+/// An entry of -1 disables the NUMA binding of that device.
+/// @param[in] device_id index of the device in the DevicePool
+/// @param[out] node requested NUMA node
+/// @return true if an override exists for the device
+///
+bool host_numa_node_override(int device_id, int* node);
+
+/// @brief
+/// @function host_bind_thread_to_node
+/// Pins the calling thread to the cpus of a NUMA node
+/// @param[in] node NUMA node, no-op if negative
+/// @return true on success
+///
+bool host_bind_thread_to_node(int node);
+
+/// @brief
+/// @function host_bind_memory_to_node
+/// Sets the preferred NUMA node of the pages fully covered by [ptr, ptr+size)
+/// and migrates the pages already touched. Best effort.
+/// @param[in] ptr start of the memory range
+/// @param[in] size size in bytes of the memory range
+/// @param[in] node NUMA node, no-op if negative
+/// @return true on success
+///
+bool host_bind_memory_to_node(void* ptr, size_t size, int node);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
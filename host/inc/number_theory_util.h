@@ -268,6 +268,20 @@ void ComputeRootOfUnityPowers(uint64_t m_q, uint64_t m_degree,
                               uint64_t* precon64_inv_root_of_unity_powers,
                               uint64_t* root_of_unity_powers,
                               uint64_t* precon64_root_of_unity_powers);
+
+// Computes the permutation applying the Galois automorphism X -> X^galois_elt
+// to a polynomial in bit-reversed NTT form, i.e. out[i] = in[table[i]].
+// @param n polynomial size, a power of two
+// @param galois_elt odd Galois element in [1, 2n)
+// @param table stores the n permuted indices
+void ComputeGaloisPermutationNTT(uint64_t n, uint64_t galois_elt,
+                                 std::vector<uint32_t>* table);
+
+// Applies a permutation computed by ComputeGaloisPermutationNTT to the
+// num_moduli RNS polynomials of size n stored contiguously in input.
+void ApplyGaloisPermutation(const uint64_t* input, uint64_t n,
+                            uint64_t num_moduli, const uint32_t* table,
+                            uint64_t* output);
 }  // namespace fpga
 }  // namespace hexl
 }  // namespace intel
@@ -0,0 +1,36 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __RESCALE_H__
+#define __RESCALE_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function Rescale
+/// Divides count ciphertexts in NTT form by their last modulus and rounds,
+/// i.e. the CKKS rescale: c_i <- (c_i - NTT_i(INTT_last(c_last))) / q_last.
+/// The INTT of the last polynomials and the NTT of the reduced ones run as
+/// batches on the RESCALE bitstream. Runs synchronously.
+/// @param[out] results count pointers to buffers of
+/// num_components * (num_moduli - 1) * n words, distinct from the operands
+/// @param[in]  operands count pointers to the input ciphertexts, each made of
+/// num_components polynomials of num_moduli * n words
+/// @param[in]  count number of ciphertexts
+/// @param[in]  n stores polynomial size
+/// @param[in]  num_components number of polynomials of each ciphertext
+/// @param[in]  num_moduli number of moduli of the input ciphertexts
+/// @param[in]  moduli stores the num_moduli moduli, the dropped one last
+///
+void Rescale(uint64_t** results, const uint64_t** operands, uint64_t count,
+             uint64_t n, uint64_t num_components, uint64_t num_moduli,
+             const uint64_t* moduli);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
@@ -0,0 +1,31 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __RESCALE_INT_H__
+#define __RESCALE_INT_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function Rescale_int
+/// Internal implementation of the Rescale function call
+/// @param[out] results count pointers to the rescaled ciphertexts
+/// @param[in]  operands count pointers to the input ciphertexts
+/// @param[in]  count number of ciphertexts
+/// @param[in]  n stores polynomial size
+/// @param[in]  num_components number of polynomials of each ciphertext
+/// @param[in]  num_moduli number of moduli of the input ciphertexts
+/// @param[in]  moduli stores the num_moduli moduli, the dropped one last
+///
+void Rescale_int(uint64_t** results, const uint64_t** operands,
+                 uint64_t count, uint64_t n, uint64_t num_components,
+                 uint64_t num_moduli, const uint64_t* moduli);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __ROTATE_H__
+#define __ROTATE_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function Rotate
+/// Applies the Galois automorphism X -> X^galois_elt to count ciphertexts and
+/// key switches the result back to the original secret key, i.e. a rotation
+/// of the slots. The automorphism of the second component is applied while
+/// the keyswitch input is staged, so no permuted copy of the ciphertext is
+/// kept by the caller. Runs synchronously.
+/// @param[out] results count pointers to buffers of 2 * decomp_modulus_size * n
+/// words, distinct from the ciphertexts
+/// @param[in]  ciphertexts count pointers to the input ciphertexts, two
+/// components of decomp_modulus_size * n words in NTT form
+/// @param[in]  count number of ciphertexts
+/// @param[in]  galois_elt odd Galois element in [1, 2n)
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertexts
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores the Galois keys of galois_elt
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void Rotate(uint64_t** results, const uint64_t** ciphertexts, uint64_t count,
+            uint64_t galois_elt, uint64_t n, uint64_t decomp_modulus_size,
+            uint64_t key_modulus_size, uint64_t rns_modulus_size,
+            uint64_t key_component_count, const uint64_t* moduli,
+            const uint64_t** k_switch_keys, const uint64_t* modswitch_factors,
+            const uint64_t* twiddle_factors = nullptr);
+
+/// @brief
+/// Function RotateSteps
+/// Rotates one ciphertext by several steps, e.g. the baby steps of a BSGS
+/// matrix product. On the CPU and with the tiled keyswitch the second
+/// component is decomposed once, and every step permutes its raised digits
+/// before the products with its keys and the division by the special
+/// modulus: a hoisted keyswitch, which may differ from the one of Rotate by
+/// a multiple of a ciphertext modulus in the lift of the digits. The
+/// keyswitch kernel decomposes inside its pipeline, so there every step is a
+/// full keyswitch, all queued before waiting. Runs synchronously.
+/// @param[out] results steps pointers to buffers of 2 * decomp_modulus_size * n
+/// words, distinct from the ciphertext
+/// @param[in]  ciphertext input ciphertext, two components of
+/// decomp_modulus_size * n words in NTT form
+/// @param[in]  steps number of rotations
+/// @param[in]  galois_elts steps odd Galois elements in [1, 2n)
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertext
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys steps Galois keys, one per Galois element
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void RotateSteps(uint64_t** results, const uint64_t* ciphertext, uint64_t steps,
+                 const uint64_t* galois_elts, uint64_t n,
+                 uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                 uint64_t rns_modulus_size, uint64_t key_component_count,
+                 const uint64_t* moduli, const uint64_t*** k_switch_keys,
+                 const uint64_t* modswitch_factors,
+                 const uint64_t* twiddle_factors = nullptr);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
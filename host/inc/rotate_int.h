@@ -0,0 +1,66 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __ROTATE_INT_H__
+#define __ROTATE_INT_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function Rotate_int
+/// Internal implementation of the Rotate function call
+/// @param[out] results count pointers to the rotated ciphertexts
+/// @param[in]  ciphertexts count pointers to the input ciphertexts
+/// @param[in]  count number of ciphertexts
+/// @param[in]  galois_elt odd Galois element in [1, 2n)
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertexts
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys stores the Galois keys of galois_elt
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void Rotate_int(uint64_t** results, const uint64_t** ciphertexts,
+                uint64_t count, uint64_t galois_elt, uint64_t n,
+                uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                uint64_t rns_modulus_size, uint64_t key_component_count,
+                const uint64_t* moduli, const uint64_t** k_switch_keys,
+                const uint64_t* modswitch_factors,
+                const uint64_t* twiddle_factors = nullptr);
+
+/// @brief
+/// Function RotateSteps_int
+/// Internal implementation of the RotateSteps function call
+/// @param[out] results steps pointers to the rotated ciphertexts
+/// @param[in]  ciphertext input ciphertext
+/// @param[in]  steps number of rotations
+/// @param[in]  galois_elts steps odd Galois elements in [1, 2n)
+/// @param[in]  n stores polynomial size
+/// @param[in]  decomp_modulus_size number of moduli of the ciphertext
+/// @param[in]  key_modulus_size stores key modulus size
+/// @param[in]  rns_modulus_size stores the rns modulus size
+/// @param[in]  key_component_count stores the key component size
+/// @param[in]  moduli stores the key moduli, the ciphertext moduli first
+/// @param[in]  k_switch_keys steps Galois keys, one per Galois element
+/// @param[in]  modswitch_factors stores the factors for modular switch
+/// @param[in]  twiddle_factors stores the twiddle factors
+///
+void RotateSteps_int(uint64_t** results, const uint64_t* ciphertext,
+                     uint64_t steps, const uint64_t* galois_elts, uint64_t n,
+                     uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                     uint64_t rns_modulus_size, uint64_t key_component_count,
+                     const uint64_t* moduli, const uint64_t*** k_switch_keys,
+                     const uint64_t* modswitch_factors,
+                     const uint64_t* twiddle_factors = nullptr);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
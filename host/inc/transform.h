@@ -0,0 +1,85 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __TRANSFORM_H__
+#define __TRANSFORM_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function CreateTransformPlan
+/// Registers the transforms of size n modulo modulus, and computes their
+/// twiddle factors once for all the ForwardTransform and InverseTransform
+/// calls of the plan.
+/// @param[in] n stores the polynomial size
+/// @param[in] modulus stores the coefficient modulus, 1 modulo 2n
+/// @param[in] root_of_unity primitive 2n-th root of unity, 0 for the minimal
+/// one
+/// @return the id of the plan
+///
+uint64_t CreateTransformPlan(uint64_t n, uint64_t modulus,
+                             uint64_t root_of_unity);
+
+/// @brief
+/// Function DestroyTransformPlan
+/// Releases a plan once its transforms have completed
+/// @param[in] plan id returned by CreateTransformPlan
+///
+void DestroyTransformPlan(uint64_t plan);
+
+/// @brief
+/// Function set_worksize_ForwardTransform
+/// Sets the work size of the forward transforms, shared with the NTT
+/// @param[in] ws stores the worksize
+///
+void set_worksize_ForwardTransform(uint64_t ws);
+
+/// @brief
+/// Function ForwardTransform
+/// Calls in place the forward Number Theoretic Transform of count polynomials
+/// with the twiddle factors of a plan
+/// @param[in] coeff_polys count pointers to polynomials of n coefficients
+/// @param[out] coeff_polys transformed polynomials
+/// @param[in] count number of polynomials
+/// @param[in] plan id returned by CreateTransformPlan
+///
+void ForwardTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan);
+
+/// @brief
+/// Function ForwardTransformCompleted
+/// Waits for the outstanding forward transforms
+///
+bool ForwardTransformCompleted();
+
+/// @brief
+/// Function set_worksize_InverseTransform
+/// Sets the work size of the inverse transforms, shared with the INTT
+/// @param[in] ws stores the worksize
+///
+void set_worksize_InverseTransform(uint64_t ws);
+
+/// @brief
+/// Function InverseTransform
+/// Calls in place the inverse Number Theoretic Transform of count polynomials
+/// with the twiddle factors of a plan
+/// @param[in] coeff_polys count pointers to polynomials of n coefficients
+/// @param[out] coeff_polys transformed polynomials
+/// @param[in] count number of polynomials
+/// @param[in] plan id returned by CreateTransformPlan
+///
+void InverseTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan);
+
+/// @brief
+/// Function InverseTransformCompleted
+/// Waits for the outstanding inverse transforms
+///
+bool InverseTransformCompleted();
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __TRANSFORM_INT_H__
+#define __TRANSFORM_INT_H__
+
+#include <cstdint>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+/// @brief
+/// Function CreateTransformPlan_int
+/// Internal implementation of the CreateTransformPlan function call
+/// @param[in] n stores the polynomial size
+/// @param[in] modulus stores the coefficient modulus
+/// @param[in] root_of_unity primitive 2n-th root of unity, 0 for the minimal
+/// one
+/// @return the id of the plan
+///
+uint64_t CreateTransformPlan_int(uint64_t n, uint64_t modulus,
+                                 uint64_t root_of_unity);
+
+/// @brief
+/// Function DestroyTransformPlan_int
+/// Internal implementation of the DestroyTransformPlan function call
+/// @param[in] plan id of the plan
+///
+void DestroyTransformPlan_int(uint64_t plan);
+
+/// @brief
+/// Function ForwardTransform_int
+/// Internal implementation of the ForwardTransform function call
+/// @param[in] coeff_polys count pointers to polynomials of n coefficients
+/// @param[out] coeff_polys transformed polynomials
+/// @param[in] count number of polynomials
+/// @param[in] plan id of the plan
+///
+void ForwardTransform_int(uint64_t** coeff_polys, uint64_t count,
+                          uint64_t plan);
+
+/// @brief
+/// Function InverseTransform_int
+/// Internal implementation of the InverseTransform function call
+/// @param[in] coeff_polys count pointers to polynomials of n coefficients
+/// @param[out] coeff_polys transformed polynomials
+/// @param[in] count number of polynomials
+/// @param[in] plan id of the plan
+///
+void InverseTransform_int(uint64_t** coeff_polys, uint64_t count,
+                          uint64_t plan);
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
+
+#endif
@@ -0,0 +1,663 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "cpu_backend.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#include "fpga_assert.h"
+#include "number_theory_util.h"
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+// the 52-bit multipliers hold the lazy [0, 4q) values of moduli below 2^50,
+// and the 64-bit Shoup and Barrett products the ones of moduli below 2^62.
+static const uint64_t kIfmaMaxModulus = 1UL << 50;
+static const uint64_t kLazyMaxModulus = 1UL << 62;
+static const uint64_t kMask52 = (1UL << 52) - 1;
+
+static cpu_isa_t detect_cpu_isa() {
+    cpu_isa_t isa = cpu_isa_t::SCALAR;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        isa = cpu_isa_t::AVX2;
+    }
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512ifma")) {
+        isa = cpu_isa_t::AVX512_IFMA;
+    }
+
+    const char* env = getenv("CPU_ISA");
+    if (env) {
+        std::string name(env);
+        cpu_isa_t cap = isa;
+        if (name == "scalar") {
+            cap = cpu_isa_t::SCALAR;
+        } else if (name == "avx2") {
+            cap = cpu_isa_t::AVX2;
+        } else if (name == "avx512ifma") {
+            cap = cpu_isa_t::AVX512_IFMA;
+        }
+        isa = std::min(isa, cap);
+    }
+    return isa;
+}
+
+cpu_isa_t cpu_isa() {
+    static cpu_isa_t isa = detect_cpu_isa();
+    return isa;
+}
+
+const char* cpu_isa_name(cpu_isa_t isa) {
+    switch (isa) {
+    case cpu_isa_t::AVX512_IFMA:
+        return "avx512ifma";
+    case cpu_isa_t::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+static uint64_t get_num_cpu_threads() {
+    const char* env = getenv("NUM_CPU_THREADS");
+    uint64_t threads =
+        env ? strtoul(env, nullptr, 10) : std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
+
+uint64_t cpu_num_threads() {
+    static uint64_t threads = get_num_cpu_threads();
+    return threads;
+}
+
+void cpu_parallel_for(uint64_t count,
+                      const std::function<void(uint64_t)>& fn) {
+    static thread_local bool in_parallel = false;
+    uint64_t threads = std::min(cpu_num_threads(), count);
+    if (in_parallel || (threads <= 1)) {
+        for (uint64_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<uint64_t> next(0);
+    auto worker = [&]() {
+        in_parallel = true;
+        for (uint64_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+        in_parallel = false;
+    };
+    std::vector<std::thread> pool;
+    for (uint64_t t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar code
+////////////////////////////////////////////////////////////////////////////////
+
+// Barrett reduction of the products of operands reduced by q: with
+// s = bits(q) - 1 and factor = floor(2^(s + w) / q), the quotient of
+// x * y is within 2 of ((x * y) >> s) * factor >> w, w = 64 or 52.
+struct BarrettFactor {
+    uint64_t shift;
+    uint64_t factor;
+};
+
+static BarrettFactor barrett_factor(uint64_t modulus, uint64_t width) {
+    uint64_t shift = 63 - __builtin_clzll(modulus);
+    uint64_t exponent = shift + width;
+    uint64_t hi = (exponent >= 64) ? (1UL << (exponent - 64)) : 0;
+    uint64_t lo = (exponent >= 64) ? 0 : (1UL << exponent);
+    return {shift, DivideUInt128UInt64Lo(hi, lo, modulus)};
+}
+
+// the Barrett factors overflow for powers of two
+static bool barrett_supported(uint64_t modulus) {
+    return (modulus < kLazyMaxModulus) && !IsPowerOfTwo(modulus);
+}
+
+static inline uint64_t reduce_operand(uint64_t x, uint64_t modulus) {
+    return (x >= modulus) ? x % modulus : x;
+}
+
+static inline uint64_t multiply_mod_barrett(uint64_t x, uint64_t y,
+                                            uint64_t modulus,
+                                            const BarrettFactor& b) {
+    uint128_t prod = MultiplyUInt64(x, y);
+    uint64_t c1 = static_cast<uint64_t>(prod >> b.shift);
+    uint64_t c3 = MultiplyUInt64Hi<64>(c1, b.factor);
+    uint64_t r = static_cast<uint64_t>(prod) - c3 * modulus;
+    r = (r >= modulus) ? r - modulus : r;
+    return (r >= modulus) ? r - modulus : r;
+}
+
+static void multiply_mod_scalar(uint64_t* results, const uint64_t* operand1,
+                                const uint64_t* operand2, uint64_t n,
+                                uint64_t modulus) {
+    if (!barrett_supported(modulus)) {
+        for (uint64_t i = 0; i < n; i++) {
+            results[i] = MultiplyUIntMod(reduce_operand(operand1[i], modulus),
+                                         reduce_operand(operand2[i], modulus),
+                                         modulus);
+        }
+        return;
+    }
+    BarrettFactor b = barrett_factor(modulus, 64);
+    for (uint64_t i = 0; i < n; i++) {
+        results[i] = multiply_mod_barrett(reduce_operand(operand1[i], modulus),
+                                          reduce_operand(operand2[i], modulus),
+                                          modulus, b);
+    }
+}
+
+static inline uint64_t add_mod(uint64_t x, uint64_t y, uint64_t modulus) {
+    return (x >= modulus - y) ? x - (modulus - y) : x + y;
+}
+
+static inline uint64_t sub_mod(uint64_t x, uint64_t y, uint64_t modulus) {
+    return (x >= y) ? x - y : x + (modulus - y);
+}
+
+static void add_mod_scalar(uint64_t* results, const uint64_t* operand1,
+                           const uint64_t* operand2, uint64_t n,
+                           uint64_t modulus) {
+    for (uint64_t i = 0; i < n; i++) {
+        results[i] = add_mod(operand1[i], operand2[i], modulus);
+    }
+}
+
+// y * w mod q in [0, 2q), w_precon = floor(w * 2^64 / q)
+static inline uint64_t shoup_lazy(uint64_t y, uint64_t w, uint64_t w_precon,
+                                  uint64_t modulus) {
+    uint64_t q = MultiplyUInt64Hi<64>(y, w_precon);
+    return y * w - q * modulus;
+}
+
+// Harvey butterflies: the forward values stay in [0, 4q), the inverse ones
+// in [0, 2q).
+static inline void fwd_butterfly(uint64_t* x, uint64_t* y, uint64_t w,
+                                 uint64_t w_precon, uint64_t modulus) {
+    uint64_t twice = modulus << 1;
+    uint64_t tx = (*x >= twice) ? *x - twice : *x;
+    uint64_t t = shoup_lazy(*y, w, w_precon, modulus);
+    *x = tx + t;
+    *y = tx - t + twice;
+}
+
+static inline void inv_butterfly(uint64_t* x, uint64_t* y, uint64_t w,
+                                 uint64_t w_precon, uint64_t modulus) {
+    uint64_t twice = modulus << 1;
+    uint64_t tx = *x + *y;
+    uint64_t ty = *x + twice - *y;
+    *x = (tx >= twice) ? tx - twice : tx;
+    *y = shoup_lazy(ty, w, w_precon, modulus);
+}
+
+static inline uint64_t reduce_from_4q(uint64_t x, uint64_t modulus) {
+    uint64_t twice = modulus << 1;
+    x = (x >= twice) ? x - twice : x;
+    return (x >= modulus) ? x - modulus : x;
+}
+
+// butterflies of moduli too wide for the lazy reduction
+static inline void fwd_butterfly_exact(uint64_t* x, uint64_t* y, uint64_t w,
+                                       uint64_t modulus) {
+    uint64_t t = MultiplyUIntMod(*y, w, modulus);
+    uint64_t tx = *x;
+    *x = add_mod(tx, t, modulus);
+    *y = sub_mod(tx, t, modulus);
+}
+
+static inline void inv_butterfly_exact(uint64_t* x, uint64_t* y, uint64_t w,
+                                       uint64_t modulus) {
+    uint64_t tx = *x;
+    uint64_t ty = *y;
+    *x = add_mod(tx, ty, modulus);
+    *y = MultiplyUIntMod(sub_mod(tx, ty, modulus), w, modulus);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2 code
+////////////////////////////////////////////////////////////////////////////////
+
+// 64-bit products from the 32-bit multiplier
+__attribute__((target("avx2"))) static inline __m256i avx2_mullo64(
+    __m256i x, __m256i y) {
+    __m256i lo = _mm256_mul_epu32(x, y);
+    __m256i cross = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(x, 32), y),
+        _mm256_mul_epu32(x, _mm256_srli_epi64(y, 32)));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2_mulhi64(
+    __m256i x, __m256i y) {
+    const __m256i mask32 = _mm256_set1_epi64x(0xffffffffUL);
+    __m256i x_hi = _mm256_srli_epi64(x, 32);
+    __m256i y_hi = _mm256_srli_epi64(y, 32);
+    __m256i lo_lo = _mm256_mul_epu32(x, y);
+    __m256i hi_lo = _mm256_mul_epu32(x_hi, y);
+    __m256i lo_hi = _mm256_mul_epu32(x, y_hi);
+    __m256i hi_hi = _mm256_mul_epu32(x_hi, y_hi);
+    __m256i mid = _mm256_add_epi64(hi_lo, _mm256_srli_epi64(lo_lo, 32));
+    __m256i mid2 = _mm256_add_epi64(lo_hi, _mm256_and_si256(mid, mask32));
+    return _mm256_add_epi64(
+        hi_hi, _mm256_add_epi64(_mm256_srli_epi64(mid, 32),
+                                _mm256_srli_epi64(mid2, 32)));
+}
+
+// all ones where x > y, for unsigned lanes
+__attribute__((target("avx2"))) static inline __m256i avx2_cmpgt_epu64(
+    __m256i x, __m256i y) {
+    const __m256i sign = _mm256_set1_epi64x(1UL << 63);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(x, sign),
+                              _mm256_xor_si256(y, sign));
+}
+
+// x - y where x >= y, x otherwise, for unsigned lanes
+__attribute__((target("avx2"))) static inline __m256i avx2_sub_if_ge(
+    __m256i x, __m256i y) {
+    return _mm256_sub_epi64(x, _mm256_andnot_si256(avx2_cmpgt_epu64(y, x), y));
+}
+
+__attribute__((target("avx2"))) static void multiply_mod_avx2(
+    uint64_t* results, const uint64_t* operand1, const uint64_t* operand2,
+    uint64_t n, uint64_t modulus) {
+    BarrettFactor b = barrett_factor(modulus, 64);
+    const __m256i vq = _mm256_set1_epi64x(modulus);
+    const __m256i vq_minus_1 = _mm256_set1_epi64x(modulus - 1);
+    const __m256i vfactor = _mm256_set1_epi64x(b.factor);
+    const __m128i vshift = _mm_cvtsi64_si128(b.shift);
+    const __m128i vshift_hi = _mm_cvtsi64_si128(64 - b.shift);
+    uint64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(operand1 + i));
+        __m256i y = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(operand2 + i));
+        __m256i big = _mm256_or_si256(avx2_cmpgt_epu64(x, vq_minus_1),
+                                      avx2_cmpgt_epu64(y, vq_minus_1));
+        if (!_mm256_testz_si256(big, big)) {
+            multiply_mod_scalar(results + i, operand1 + i, operand2 + i, 4,
+                                modulus);
+            continue;
+        }
+        __m256i lo = avx2_mullo64(x, y);
+        __m256i hi = avx2_mulhi64(x, y);
+        __m256i c1 = _mm256_or_si256(_mm256_srl_epi64(lo, vshift),
+                                     _mm256_sll_epi64(hi, vshift_hi));
+        __m256i c3 = avx2_mulhi64(c1, vfactor);
+        __m256i r = _mm256_sub_epi64(lo, avx2_mullo64(c3, vq));
+        r = avx2_sub_if_ge(r, vq);
+        r = avx2_sub_if_ge(r, vq);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i), r);
+    }
+    multiply_mod_scalar(results + i, operand1 + i, operand2 + i, n - i,
+                        modulus);
+}
+
+__attribute__((target("avx2"))) static void add_mod_avx2(
+    uint64_t* results, const uint64_t* operand1, const uint64_t* operand2,
+    uint64_t n, uint64_t modulus) {
+    const __m256i vq = _mm256_set1_epi64x(modulus);
+    uint64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(operand1 + i));
+        __m256i y = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(operand2 + i));
+        __m256i r = avx2_sub_if_ge(_mm256_add_epi64(x, y), vq);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i), r);
+    }
+    add_mod_scalar(results + i, operand1 + i, operand2 + i, n - i, modulus);
+}
+
+// y * w mod q in [0, 2q) for 4 values of y
+__attribute__((target("avx2"))) static inline __m256i avx2_shoup_lazy(
+    __m256i y, __m256i w, __m256i w_precon, __m256i vq) {
+    __m256i q = avx2_mulhi64(y, w_precon);
+    return _mm256_sub_epi64(avx2_mullo64(y, w), avx2_mullo64(q, vq));
+}
+
+__attribute__((target("avx2"))) static void fwd_stage_avx2(
+    uint64_t* x, uint64_t* y, uint64_t t, uint64_t w, uint64_t w_precon,
+    uint64_t modulus) {
+    const __m256i vq = _mm256_set1_epi64x(modulus);
+    const __m256i vtwice = _mm256_set1_epi64x(modulus << 1);
+    const __m256i vw = _mm256_set1_epi64x(w);
+    const __m256i vw_precon = _mm256_set1_epi64x(w_precon);
+    for (uint64_t j = 0; j < t; j += 4) {
+        __m256i vx = _mm256_loadu_si256(reinterpret_cast<__m256i*>(x + j));
+        __m256i vy = _mm256_loadu_si256(reinterpret_cast<__m256i*>(y + j));
+        __m256i tx = avx2_sub_if_ge(vx, vtwice);
+        __m256i ty = avx2_shoup_lazy(vy, vw, vw_precon, vq);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + j),
+                            _mm256_add_epi64(tx, ty));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(y + j),
+            _mm256_add_epi64(_mm256_sub_epi64(tx, ty), vtwice));
+    }
+}
+
+__attribute__((target("avx2"))) static void inv_stage_avx2(
+    uint64_t* x, uint64_t* y, uint64_t t, uint64_t w, uint64_t w_precon,
+    uint64_t modulus) {
+    const __m256i vq = _mm256_set1_epi64x(modulus);
+    const __m256i vtwice = _mm256_set1_epi64x(modulus << 1);
+    const __m256i vw = _mm256_set1_epi64x(w);
+    const __m256i vw_precon = _mm256_set1_epi64x(w_precon);
+    for (uint64_t j = 0; j < t; j += 4) {
+        __m256i vx = _mm256_loadu_si256(reinterpret_cast<__m256i*>(x + j));
+        __m256i vy = _mm256_loadu_si256(reinterpret_cast<__m256i*>(y + j));
+        __m256i tx = avx2_sub_if_ge(_mm256_add_epi64(vx, vy), vtwice);
+        __m256i ty = _mm256_sub_epi64(_mm256_add_epi64(vx, vtwice), vy);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + j), tx);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j),
+                            avx2_shoup_lazy(ty, vw, vw_precon, vq));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX512 IFMA code, for moduli below 2^50
+////////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx512f,avx512ifma"))) static void multiply_mod_ifma(
+    uint64_t* results, const uint64_t* operand1, const uint64_t* operand2,
+    uint64_t n, uint64_t modulus) {
+    BarrettFactor b = barrett_factor(modulus, 52);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i vq = _mm512_set1_epi64(modulus);
+    const __m512i vmask = _mm512_set1_epi64(kMask52);
+    const __m512i vfactor = _mm512_set1_epi64(b.factor);
+    const __m512i vshift = _mm512_set1_epi64(b.shift);
+    const __m512i vshift_hi = _mm512_set1_epi64(52 - b.shift);
+    uint64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i x = _mm512_loadu_si512(operand1 + i);
+        __m512i y = _mm512_loadu_si512(operand2 + i);
+        if (_mm512_cmpge_epu64_mask(x, vq) | _mm512_cmpge_epu64_mask(y, vq)) {
+            multiply_mod_scalar(results + i, operand1 + i, operand2 + i, 8,
+                                modulus);
+            continue;
+        }
+        __m512i lo = _mm512_madd52lo_epu64(zero, x, y);
+        __m512i hi = _mm512_madd52hi_epu64(zero, x, y);
+        __m512i c1 = _mm512_or_si512(_mm512_srlv_epi64(lo, vshift),
+                                     _mm512_sllv_epi64(hi, vshift_hi));
+        __m512i c3 = _mm512_madd52hi_epu64(zero, c1, vfactor);
+        __m512i r = _mm512_sub_epi64(lo, _mm512_madd52lo_epu64(zero, c3, vq));
+        r = _mm512_and_si512(r, vmask);
+        r = _mm512_min_epu64(r, _mm512_sub_epi64(r, vq));
+        r = _mm512_min_epu64(r, _mm512_sub_epi64(r, vq));
+        _mm512_storeu_si512(results + i, r);
+    }
+    multiply_mod_scalar(results + i, operand1 + i, operand2 + i, n - i,
+                        modulus);
+}
+
+__attribute__((target("avx512f"))) static void add_mod_avx512(
+    uint64_t* results, const uint64_t* operand1, const uint64_t* operand2,
+    uint64_t n, uint64_t modulus) {
+    const __m512i vq = _mm512_set1_epi64(modulus);
+    uint64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i r = _mm512_add_epi64(_mm512_loadu_si512(operand1 + i),
+                                     _mm512_loadu_si512(operand2 + i));
+        r = _mm512_min_epu64(r, _mm512_sub_epi64(r, vq));
+        _mm512_storeu_si512(results + i, r);
+    }
+    add_mod_scalar(results + i, operand1 + i, operand2 + i, n - i, modulus);
+}
+
+// y * w mod q in [0, 2q) for 8 values of y below 2^52,
+// w_precon = floor(w * 2^52 / q)
+__attribute__((target("avx512f,avx512ifma"))) static inline __m512i
+ifma_shoup_lazy(__m512i y, __m512i w, __m512i w_precon, __m512i vq) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i vmask = _mm512_set1_epi64(kMask52);
+    __m512i q = _mm512_madd52hi_epu64(zero, y, w_precon);
+    __m512i r = _mm512_sub_epi64(_mm512_madd52lo_epu64(zero, y, w),
+                                 _mm512_madd52lo_epu64(zero, q, vq));
+    return _mm512_and_si512(r, vmask);
+}
+
+__attribute__((target("avx512f,avx512ifma"))) static void fwd_stage_ifma(
+    uint64_t* x, uint64_t* y, uint64_t t, uint64_t w, uint64_t w_precon,
+    uint64_t modulus) {
+    const __m512i vq = _mm512_set1_epi64(modulus);
+    const __m512i vtwice = _mm512_set1_epi64(modulus << 1);
+    const __m512i vw = _mm512_set1_epi64(w);
+    const __m512i vw_precon = _mm512_set1_epi64(w_precon);
+    for (uint64_t j = 0; j < t; j += 8) {
+        __m512i vx = _mm512_loadu_si512(x + j);
+        __m512i vy = _mm512_loadu_si512(y + j);
+        __m512i tx = _mm512_min_epu64(vx, _mm512_sub_epi64(vx, vtwice));
+        __m512i ty = ifma_shoup_lazy(vy, vw, vw_precon, vq);
+        _mm512_storeu_si512(x + j, _mm512_add_epi64(tx, ty));
+        _mm512_storeu_si512(
+            y + j, _mm512_add_epi64(_mm512_sub_epi64(tx, ty), vtwice));
+    }
+}
+
+__attribute__((target("avx512f,avx512ifma"))) static void inv_stage_ifma(
+    uint64_t* x, uint64_t* y, uint64_t t, uint64_t w, uint64_t w_precon,
+    uint64_t modulus) {
+    const __m512i vq = _mm512_set1_epi64(modulus);
+    const __m512i vtwice = _mm512_set1_epi64(modulus << 1);
+    const __m512i vw = _mm512_set1_epi64(w);
+    const __m512i vw_precon = _mm512_set1_epi64(w_precon);
+    for (uint64_t j = 0; j < t; j += 8) {
+        __m512i vx = _mm512_loadu_si512(x + j);
+        __m512i vy = _mm512_loadu_si512(y + j);
+        __m512i tx = _mm512_add_epi64(vx, vy);
+        tx = _mm512_min_epu64(tx, _mm512_sub_epi64(tx, vtwice));
+        __m512i ty = _mm512_sub_epi64(_mm512_add_epi64(vx, vtwice), vy);
+        _mm512_storeu_si512(x + j, tx);
+        _mm512_storeu_si512(y + j, ifma_shoup_lazy(ty, vw, vw_precon, vq));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Dispatch
+////////////////////////////////////////////////////////////////////////////////
+
+void cpu_multiply_mod(uint64_t* results, const uint64_t* operand1,
+                      const uint64_t* operand2, uint64_t n, uint64_t modulus) {
+    FPGA_ASSERT(modulus > 1, "modulus must be an integer greater than 1");
+    cpu_isa_t isa = cpu_isa();
+    if ((isa >= cpu_isa_t::AVX512_IFMA) && (modulus < kIfmaMaxModulus) &&
+        !IsPowerOfTwo(modulus)) {
+        multiply_mod_ifma(results, operand1, operand2, n, modulus);
+    } else if ((isa >= cpu_isa_t::AVX2) && barrett_supported(modulus)) {
+        multiply_mod_avx2(results, operand1, operand2, n, modulus);
+    } else {
+        multiply_mod_scalar(results, operand1, operand2, n, modulus);
+    }
+}
+
+void cpu_add_mod(uint64_t* results, const uint64_t* operand1,
+                 const uint64_t* operand2, uint64_t n, uint64_t modulus) {
+    FPGA_ASSERT(modulus > 1, "modulus must be an integer greater than 1");
+    cpu_isa_t isa = cpu_isa();
+    // the vector sums must not wrap around
+    if ((isa >= cpu_isa_t::AVX512_IFMA) && (modulus < (1UL << 63))) {
+        add_mod_avx512(results, operand1, operand2, n, modulus);
+    } else if ((isa >= cpu_isa_t::AVX2) && (modulus < (1UL << 63))) {
+        add_mod_avx2(results, operand1, operand2, n, modulus);
+    } else {
+        add_mod_scalar(results, operand1, operand2, n, modulus);
+    }
+}
+
+CpuNTT::CpuNTT(uint64_t n, uint64_t modulus, uint64_t root_of_unity)
+    : n_(n), modulus_(modulus) {
+    FPGA_ASSERT(IsPowerOfTwo(n), "n must be a power of two");
+    FPGA_ASSERT((modulus - 1) % (2 * n) == 0, "requires modulus = 1 mod 2n");
+    uint64_t root = root_of_unity ? root_of_unity
+                                  : MinimalPrimitiveRoot(2 * n, modulus);
+    uint64_t inv_root = InverseUIntMod(root, modulus);
+    uint64_t bits = Log2(n);
+
+    roots_.resize(n);
+    inv_roots_.resize(n);
+    roots_[0] = 1;
+    inv_roots_[0] = 1;
+    uint64_t prev = 0;
+    for (uint64_t i = 1; i < n; i++) {
+        uint64_t idx = ReverseBitsUInt(i, bits);
+        roots_[idx] = MultiplyUIntMod(roots_[prev], root, modulus);
+        inv_roots_[idx] = MultiplyUIntMod(inv_roots_[prev], inv_root, modulus);
+        prev = idx;
+    }
+
+    roots_precon_.resize(n);
+    inv_roots_precon_.resize(n);
+    for (uint64_t i = 0; i < n; i++) {
+        roots_precon_[i] =
+            MultiplyFactor(roots_[i], 64, modulus).BarrettFactor();
+        inv_roots_precon_[i] =
+            MultiplyFactor(inv_roots_[i], 64, modulus).BarrettFactor();
+    }
+    if (modulus < kIfmaMaxModulus) {
+        roots_precon52_.resize(n);
+        inv_roots_precon52_.resize(n);
+        for (uint64_t i = 0; i < n; i++) {
+            roots_precon52_[i] =
+                MultiplyFactor(roots_[i], 52, modulus).BarrettFactor();
+            inv_roots_precon52_[i] =
+                MultiplyFactor(inv_roots_[i], 52, modulus).BarrettFactor();
+        }
+    }
+
+    inv_n_ = InverseUIntMod(n, modulus);
+    inv_n_precon_ = MultiplyFactor(inv_n_, 64, modulus).BarrettFactor();
+}
+
+void CpuNTT::forward(uint64_t* poly) const {
+    uint64_t q = modulus_;
+    if (q >= kLazyMaxModulus) {
+        // the exact butterflies take reduced operands
+        for (uint64_t j = 0; j < n_; j++) {
+            poly[j] %= q;
+        }
+        for (uint64_t m = 1, t = n_ >> 1; m < n_; m <<= 1, t >>= 1) {
+            for (uint64_t i = 0; i < m; i++) {
+                uint64_t* x = poly + 2 * i * t;
+                for (uint64_t j = 0; j < t; j++) {
+                    fwd_butterfly_exact(x + j, x + j + t, roots_[m + i], q);
+                }
+            }
+        }
+        return;
+    }
+
+    cpu_isa_t isa = cpu_isa();
+    bool ifma = (isa >= cpu_isa_t::AVX512_IFMA) && (q < kIfmaMaxModulus);
+    bool avx2 = (isa >= cpu_isa_t::AVX2);
+    for (uint64_t m = 1, t = n_ >> 1; m < n_; m <<= 1, t >>= 1) {
+        for (uint64_t i = 0; i < m; i++) {
+            uint64_t* x = poly + 2 * i * t;
+            if (ifma && (t >= 8)) {
+                fwd_stage_ifma(x, x + t, t, roots_[m + i],
+                               roots_precon52_[m + i], q);
+            } else if (avx2 && (t >= 4)) {
+                fwd_stage_avx2(x, x + t, t, roots_[m + i],
+                               roots_precon_[m + i], q);
+            } else {
+                for (uint64_t j = 0; j < t; j++) {
+                    fwd_butterfly(x + j, x + j + t, roots_[m + i],
+                                  roots_precon_[m + i], q);
+                }
+            }
+        }
+    }
+    for (uint64_t j = 0; j < n_; j++) {
+        poly[j] = reduce_from_4q(poly[j], q);
+    }
+}
+
+void CpuNTT::inverse(uint64_t* poly) const {
+    uint64_t q = modulus_;
+    if (q >= kLazyMaxModulus) {
+        for (uint64_t j = 0; j < n_; j++) {
+            poly[j] %= q;
+        }
+        for (uint64_t m = n_ >> 1, t = 1; m >= 1; m >>= 1, t <<= 1) {
+            for (uint64_t i = 0; i < m; i++) {
+                uint64_t* x = poly + 2 * i * t;
+                for (uint64_t j = 0; j < t; j++) {
+                    inv_butterfly_exact(x + j, x + j + t, inv_roots_[m + i],
+                                        q);
+                }
+            }
+        }
+        for (uint64_t j = 0; j < n_; j++) {
+            poly[j] = MultiplyUIntMod(poly[j], inv_n_, q);
+        }
+        return;
+    }
+
+    cpu_isa_t isa = cpu_isa();
+    bool ifma = (isa >= cpu_isa_t::AVX512_IFMA) && (q < kIfmaMaxModulus);
+    bool avx2 = (isa >= cpu_isa_t::AVX2);
+    for (uint64_t m = n_ >> 1, t = 1; m >= 1; m >>= 1, t <<= 1) {
+        for (uint64_t i = 0; i < m; i++) {
+            uint64_t* x = poly + 2 * i * t;
+            if (ifma && (t >= 8)) {
+                inv_stage_ifma(x, x + t, t, inv_roots_[m + i],
+                               inv_roots_precon52_[m + i], q);
+            } else if (avx2 && (t >= 4)) {
+                inv_stage_avx2(x, x + t, t, inv_roots_[m + i],
+                               inv_roots_precon_[m + i], q);
+            } else {
+                for (uint64_t j = 0; j < t; j++) {
+                    inv_butterfly(x + j, x + j + t, inv_roots_[m + i],
+                                  inv_roots_precon_[m + i], q);
+                }
+            }
+        }
+    }
+    for (uint64_t j = 0; j < n_; j++) {
+        uint64_t x = shoup_lazy(poly[j], inv_n_, inv_n_precon_, q);
+        poly[j] = (x >= q) ? x - q : x;
+    }
+}
+
+const CpuNTT& cpu_get_ntt(uint64_t n, uint64_t modulus,
+                          uint64_t root_of_unity) {
+    static std::mutex mu;
+    static std::map<std::tuple<uint64_t, uint64_t, uint64_t>,
+                    std::unique_ptr<CpuNTT>>
+        transforms;
+    std::lock_guard<std::mutex> locker(mu);
+    auto& ntt = transforms[std::make_tuple(n, modulus, root_of_unity)];
+    if (!ntt) {
+        ntt.reset(new CpuNTT(n, modulus, root_of_unity));
+    }
+    return *ntt;
+}
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
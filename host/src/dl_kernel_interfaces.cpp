@@ -41,26 +41,36 @@ NTTDynamicIF::NTTDynamicIF(const std::string& lib)
     : DynamicIF(lib),
       fwd_ntt(nullptr),
       ntt_input(nullptr),
-      ntt_output(nullptr) {
+      ntt_output(nullptr),
+      ntt_max_coeff_count(nullptr),
+      ntt_compute_units(nullptr) {
     fwd_ntt = (void (*)(sycl::queue&))loadKernel("fwd_ntt");
     ntt_input = (sycl::event(*)(sycl::queue&, unsigned int, uint64_t*,
-                                uint64_t*, uint64_t*, uint64_t*,
-                                uint64_t*))loadKernel("ntt_input");
-    ntt_output =
-        (sycl::event(*)(sycl::queue&, int, uint64_t*))loadKernel("ntt_output");
+                                uint64_t*, uint64_t*, uint64_t*, uint64_t*,
+                                unsigned int, unsigned int*,
+                                unsigned int*))loadKernel("ntt_input");
+    ntt_output = (sycl::event(*)(sycl::queue&, int, uint64_t*,
+                                 unsigned int))loadKernel("ntt_output");
+    ntt_max_coeff_count = (uint64_t(*)())loadKernel("ntt_max_coeff_count");
+    ntt_compute_units = (uint64_t(*)())loadKernel("ntt_compute_units");
 }
 
 INTTDynamicIF::INTTDynamicIF(std::string& lib) : DynamicIF(lib) {
     inv_ntt = (void (*)(sycl::queue&))loadKernel("inv_ntt");
-    intt_output =
-        (sycl::event(*)(sycl::queue&, unsigned int,
-                        unsigned long* __restrict__))loadKernel("intt_output");
+    intt_output = (sycl::event(*)(sycl::queue&, unsigned int,
+                                  unsigned long* __restrict__,
+                                  unsigned int))loadKernel("intt_output");
 
     intt_input =
         (sycl::event(*)(sycl::queue&, unsigned int, uint64_t* __restrict__,
                         uint64_t* __restrict__, uint64_t* __restrict__,
                         uint64_t* __restrict__, uint64_t* __restrict__,
-                        uint64_t* __restrict__))loadKernel("intt_input");
+                        uint64_t* __restrict__, unsigned int,
+                        unsigned int* __restrict__,
+                        unsigned int* __restrict__))loadKernel("intt_input");
+    intt_max_coeff_count =
+        (uint64_t(*)())loadKernel("intt_max_coeff_count");
+    intt_compute_units = (uint64_t(*)())loadKernel("intt_compute_units");
 }
 
 DyadicMultDynamicIF::DyadicMultDynamicIF(std::string& lib) : DynamicIF(lib) {
@@ -68,6 +78,19 @@ DyadicMultDynamicIF::DyadicMultDynamicIF(std::string& lib) : DynamicIF(lib) {
         sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
         uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
         uint64_t*, uint64_t)) loadKernel("input_fifo_usm");
+    input_fifo_plain_usm = (sycl::event(*)(
+        sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
+        uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
+        uint64_t*, uint64_t)) loadKernel("input_fifo_plain_usm");
+    input_fifo_accumulate_usm = (sycl::event(*)(
+        sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
+        uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
+        uint64_t*, uint64_t,
+        uint64_t)) loadKernel("input_fifo_accumulate_usm");
+    input_fifo_accumulate_keys_usm = (sycl::event(*)(
+        sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
+        uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
+        uint64_t*, uint64_t)) loadKernel("input_fifo_accumulate_keys_usm");
 
     output_nb_fifo_usm = (sycl::event(*)(sycl::queue&, uint64_t*, int*,
                                          int*))loadKernel("output_nb_fifo_usm");
@@ -79,6 +102,9 @@ KeySwitchDynamicIF::KeySwitchDynamicIF(std::string& lib) : DynamicIF(lib) {
     load = (sycl::event(*)(sycl::queue&, sycl::event*, sycl::buffer<uint64_t>&,
                            moduli_t, uint64_t, uint64_t, uint64_t, invn_t,
                            unsigned))loadKernel("load");
+    load_usm = (sycl::event(*)(
+        sycl::queue&, sycl::event*, unsigned, uint64_t**, moduli_t, uint64_t,
+        uint64_t, uint64_t, invn_t, unsigned))loadKernel("load_usm");
 
     store = (sycl::event(*)(
         sycl::queue&, sycl::event*, sycl::buffer<sycl::ulong2>&, uint64_t,
@@ -94,6 +120,10 @@ KeySwitchDynamicIF::KeySwitchDynamicIF(std::string& lib) : DynamicIF(lib) {
 
     launchAllAutoRunKernels =
         (void (*)(sycl::queue&))loadKernel("launchAllAutoRunKernels");
+    keyswitch_max_coeff_count =
+        (uint64_t(*)())loadKernel("keyswitch_max_coeff_count");
+    keyswitch_max_modulus_bits =
+        (uint64_t(*)())loadKernel("keyswitch_max_modulus_bits");
 }
 
 DyadicMultKeySwitchDynamicIF::DyadicMultKeySwitchDynamicIF(std::string& lib)
@@ -102,6 +132,19 @@ DyadicMultKeySwitchDynamicIF::DyadicMultKeySwitchDynamicIF(std::string& lib)
         sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
         uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
         uint64_t*, uint64_t)) loadKernel("input_fifo_usm");
+    input_fifo_plain_usm = (sycl::event(*)(
+        sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
+        uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
+        uint64_t*, uint64_t)) loadKernel("input_fifo_plain_usm");
+    input_fifo_accumulate_usm = (sycl::event(*)(
+        sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
+        uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
+        uint64_t*, uint64_t,
+        uint64_t)) loadKernel("input_fifo_accumulate_usm");
+    input_fifo_accumulate_keys_usm = (sycl::event(*)(
+        sycl::queue&, uint64_t * __restrict__, uint64_t * __restrict__,
+        uint64_t, moduli_info_t * __restrict__, uint64_t, int, uint64_t*,
+        uint64_t*, uint64_t)) loadKernel("input_fifo_accumulate_keys_usm");
 
     output_nb_fifo_usm = (sycl::event(*)(sycl::queue&, uint64_t*, int*,
                                          int*))loadKernel("output_nb_fifo_usm");
@@ -112,6 +155,9 @@ DyadicMultKeySwitchDynamicIF::DyadicMultKeySwitchDynamicIF(std::string& lib)
     load = (sycl::event(*)(sycl::queue&, sycl::event*, sycl::buffer<uint64_t>&,
                            moduli_t, uint64_t, uint64_t, uint64_t, invn_t,
                            unsigned))loadKernel("load");
+    load_usm = (sycl::event(*)(
+        sycl::queue&, sycl::event*, unsigned, uint64_t**, moduli_t, uint64_t,
+        uint64_t, uint64_t, invn_t, unsigned))loadKernel("load_usm");
 
     store = (sycl::event(*)(
         sycl::queue&, sycl::event*, sycl::buffer<sycl::ulong2>&, uint64_t,
@@ -127,6 +173,10 @@ DyadicMultKeySwitchDynamicIF::DyadicMultKeySwitchDynamicIF(std::string& lib)
 
     launchAllAutoRunKernels =
         (void (*)(sycl::queue&))loadKernel("launchAllAutoRunKernels");
+    keyswitch_max_coeff_count =
+        (uint64_t(*)())loadKernel("keyswitch_max_coeff_count");
+    keyswitch_max_modulus_bits =
+        (uint64_t(*)())loadKernel("keyswitch_max_modulus_bits");
 }
 
 }  // namespace fpga
@@ -25,6 +25,97 @@ void DyadicMultiply(uint64_t* results, const uint64_t* operand1,
     DyadicMultiply_int(results, operand1, operand2, n, moduli, n_moduli);
 }
 
+void DyadicMultiplyBatch(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         const uint64_t* moduli, uint64_t n_moduli) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(operand1, "requires operand1 != nullptr");
+    FPGA_ASSERT(operand2, "requires operand2 != nullptr");
+    FPGA_ASSERT(n > 0, "n must be positive integer");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    FPGA_ASSERT(n_moduli > 0, "n_moduli must be positive integer");
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(results[i] && operand1[i] && operand2[i],
+                    "requires results[i], operand1[i], operand2[i] != nullptr");
+    }
+
+    DyadicMultiplyBatch_int(results, operand1, operand2, count, n, moduli,
+                            n_moduli);
+}
+
+void MultiplyPlain(uint64_t* results, const uint64_t* ciphertext,
+                   const uint64_t* plaintext, uint64_t n,
+                   const uint64_t* moduli, uint64_t n_moduli) {
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(ciphertext, "requires ciphertext != nullptr");
+    FPGA_ASSERT(plaintext, "requires plaintext != nullptr");
+    FPGA_ASSERT(n > 0, "n must be positive integer");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    FPGA_ASSERT(n_moduli > 0, "n_moduli must be positive integer");
+
+    MultiplyPlain_int(results, ciphertext, plaintext, n, moduli, n_moduli);
+}
+
+void MultiplyPlainBatch(uint64_t** results, const uint64_t** ciphertext,
+                        const uint64_t** plaintext, uint64_t count,
+                        uint64_t n, const uint64_t* moduli,
+                        uint64_t n_moduli) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(ciphertext, "requires ciphertext != nullptr");
+    FPGA_ASSERT(plaintext, "requires plaintext != nullptr");
+    FPGA_ASSERT(n > 0, "n must be positive integer");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    FPGA_ASSERT(n_moduli > 0, "n_moduli must be positive integer");
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(
+            results[i] && ciphertext[i] && plaintext[i],
+            "requires results[i], ciphertext[i], plaintext[i] != nullptr");
+    }
+
+    MultiplyPlainBatch_int(results, ciphertext, plaintext, count, n, moduli,
+                           n_moduli);
+}
+
+static void check_accumulate(uint64_t* results, const uint64_t** operand1,
+                             const uint64_t** operand2, uint64_t count,
+                             uint64_t n, const uint64_t* moduli,
+                             uint64_t n_moduli) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(operand1, "requires operand1 != nullptr");
+    FPGA_ASSERT(operand2, "requires operand2 != nullptr");
+    FPGA_ASSERT(n > 0, "n must be positive integer");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    FPGA_ASSERT(n_moduli > 0, "n_moduli must be positive integer");
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(operand1[i] && operand2[i],
+                    "requires operand1[i], operand2[i] != nullptr");
+    }
+}
+
+void DyadicMultiplyAccumulate(uint64_t* results, const uint64_t** operand1,
+                              const uint64_t** operand2, uint64_t count,
+                              uint64_t n, const uint64_t* moduli,
+                              uint64_t n_moduli) {
+    check_accumulate(results, operand1, operand2, count, n, moduli, n_moduli);
+
+    DyadicMultiplyAccumulate_int(results, operand1, operand2, count, n, moduli,
+                                 n_moduli, false);
+}
+
+void MultiplyPlainAccumulate(uint64_t* results, const uint64_t** ciphertext,
+                             const uint64_t** plaintext, uint64_t count,
+                             uint64_t n, const uint64_t* moduli,
+                             uint64_t n_moduli) {
+    check_accumulate(results, ciphertext, plaintext, count, n, moduli,
+                     n_moduli);
+
+    DyadicMultiplyAccumulate_int(results, ciphertext, plaintext, count, n,
+                                 moduli, n_moduli, true);
+}
+
 bool DyadicMultiplyCompleted() { return DyadicMultiplyCompleted_int(); }
 
 void set_worksize_DyadicMultiply(uint64_t n) {
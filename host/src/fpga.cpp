@@ -4,13 +4,16 @@
 #include <dlfcn.h>
 #include <string.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <unordered_map>
 #include "fpga.h"
 #include "fpga_assert.h"
+#include "host_memory_pool.h"
 #include "number_theory_util.h"
+#include "numa_util.h"
 namespace intel {
 namespace hexl {
 namespace fpga {
@@ -27,6 +30,10 @@ static sycl::event copy_buffer_to_device(sycl::queue& q,
     return e;
 }
 
+// serializes the host side sums of accumulated batches, which may
+// complete on different devices.
+static std::mutex muAccumulate;
+
 // utility function for copying input data batch for KeySwitch
 
 const char* keyswitch_kernel_name[] = {"load", "store"};
@@ -39,14 +46,21 @@ Object_DyadicMultiply::Object_DyadicMultiply(uint64_t* results,
                                              const uint64_t* operand1,
                                              const uint64_t* operand2,
                                              uint64_t n, const uint64_t* moduli,
-                                             uint64_t n_moduli, bool fence)
+                                             uint64_t n_moduli, bool fence,
+                                             bool plain, bool accumulate,
+                                             const TileKeys* tile_keys,
+                                             bool relinearize)
     : Object(kernel_t::DYADIC_MULTIPLY, fence),
       results_(results),
       operand1_(operand1),
       operand2_(operand2),
       n_(n),
       moduli_(moduli),
-      n_moduli_(n_moduli) {}
+      n_moduli_(n_moduli),
+      plain_(plain),
+      accumulate_(accumulate),
+      tile_keys_(tile_keys),
+      relinearize_(relinearize) {}
 Object_NTT::Object_NTT(uint64_t* coeff_poly,
                        const uint64_t* root_of_unity_powers,
                        const uint64_t* precon_root_of_unity_powers,
@@ -76,7 +90,8 @@ Object_KeySwitch::Object_KeySwitch(
     uint64_t rns_modulus_size, uint64_t key_component_count,
     const uint64_t* moduli, const uint64_t** k_switch_keys,
     const uint64_t* modswitch_factors, const uint64_t* twiddle_factors,
-    bool fence)
+    bool fence, const uint32_t* galois_table,
+    const Object_DyadicMultiply* source)
     : Object(kernel_t::KEYSWITCH, fence),
       result_(result),
       t_target_iter_ptr_(t_target_iter_ptr),
@@ -88,7 +103,9 @@ Object_KeySwitch::Object_KeySwitch(
       moduli_(moduli),
       k_switch_keys_(k_switch_keys),
       modswitch_factors_(modswitch_factors),
-      twiddle_factors_(twiddle_factors) {}
+      twiddle_factors_(twiddle_factors),
+      galois_table_(galois_table),
+      source_(source) {}
 Object* Buffer::front() const {
     Object* obj = buffer_.front();
     return obj;
@@ -104,53 +121,31 @@ void Buffer::push(Object* obj) {
     locker.unlock();
     cond_.notify_all();
 }
+void Buffer::push_batch(const std::vector<Object*>& objs) {
+    std::unique_lock<std::mutex> locker(mu_);
+    size_t i = 0;
+    while (i < objs.size()) {
+        // only give the lock back when the buffer is full.
+        cond_.wait(locker, [this]() { return buffer_.size() < capacity_; });
+        while ((i < objs.size()) && (buffer_.size() < capacity_)) {
+            buffer_.push_back(objs[i++]);
+        }
+        cond_.notify_all();
+    }
+}
 std::vector<Object*> Buffer::pop() {
     std::unique_lock<std::mutex> locker(mu_);
 
+    // the worksize of the front object is read again on every wake up, since
+    // cancel_work can shrink it while the batch is filling.
     uint64_t work_size = 1;
-
-    Object_DyadicMultiply* obj_dyadic_multiply = nullptr;
-    Object_NTT* obj_ntt = nullptr;
-    Object_INTT* obj_intt = nullptr;
-    Object_KeySwitch* obj_KeySwitch = nullptr;
-
-    if (buffer_.size() > 0) {
-        Object* object = buffer_.front();
-        if (object) {
-            switch (object->type_) {
-            case kernel_t::DYADIC_MULTIPLY:
-                obj_dyadic_multiply =
-                    dynamic_cast<Object_DyadicMultiply*>(object);
-                if (obj_dyadic_multiply) {
-                    work_size = get_worksize_int_DyadicMultiply();
-                }
-                break;
-            case kernel_t::INTT:
-                obj_intt = dynamic_cast<Object_INTT*>(object);
-                if (obj_intt) {
-                    work_size = get_worksize_int_INTT();
-                }
-                break;
-            case kernel_t::NTT:
-                obj_ntt = dynamic_cast<Object_NTT*>(object);
-                if (obj_ntt) {
-                    work_size = get_worksize_int_NTT();
-                }
-                break;
-            case kernel_t::KEYSWITCH:
-                obj_KeySwitch = dynamic_cast<Object_KeySwitch*>(object);
-                if (obj_KeySwitch) {
-                    work_size = get_worksize_int_KeySwitch();
-                }
-                break;
-            default:
-                FPGA_ASSERT(0, "Invalid kernel!")
-                break;
-            }
-        }
-    }
-    cond_.wait(locker,
-               [this, &work_size]() { return buffer_.size() >= work_size; });
+    kernel_t type = kernel_t::NONE;
+    cond_.wait(locker, [this, &work_size, &type]() {
+        Object* object = buffer_.empty() ? nullptr : buffer_.front();
+        type = object ? object->type_ : kernel_t::NONE;
+        work_size = get_worksize_int(type);
+        return buffer_.size() >= work_size;
+    });
     FPGA_ASSERT(work_size > 0);
     std::vector<Object*> objs;
     uint64_t batch = 0;
@@ -163,15 +158,7 @@ std::vector<Object*> Buffer::pop() {
         buffer_.pop_front();
         batch++;
     }
-    if (obj_dyadic_multiply) {
-        update_DyadicMultiply_work_size(batch);
-    } else if (obj_ntt) {
-        update_NTT_work_size(batch);
-    } else if (obj_intt) {
-        update_INTT_work_size(batch);
-    } else if (obj_KeySwitch) {
-        update_KeySwitch_work_size(batch);
-    }
+    update_work_size(type, batch);
 
     locker.unlock();
     cond_.notify_all();
@@ -179,6 +166,88 @@ std::vector<Object*> Buffer::pop() {
     return objs;
 }
 
+uint64_t Buffer::get_worksize_int(kernel_t type) const {
+    switch (type) {
+    case kernel_t::NONE:
+        return 1;
+    case kernel_t::DYADIC_MULTIPLY:
+        return get_worksize_int_DyadicMultiply();
+    case kernel_t::INTT:
+        return get_worksize_int_INTT();
+    case kernel_t::NTT:
+        return get_worksize_int_NTT();
+    case kernel_t::KEYSWITCH:
+        return get_worksize_int_KeySwitch();
+    default:
+        FPGA_ASSERT(0, "Invalid kernel!")
+        return 1;
+    }
+}
+
+void Buffer::update_work_size(kernel_t type, uint64_t ws) {
+    switch (type) {
+    case kernel_t::DYADIC_MULTIPLY:
+        update_DyadicMultiply_work_size(ws);
+        break;
+    case kernel_t::INTT:
+        update_INTT_work_size(ws);
+        break;
+    case kernel_t::NTT:
+        update_NTT_work_size(ws);
+        break;
+    case kernel_t::KEYSWITCH:
+        update_KeySwitch_work_size(ws);
+        break;
+    default:
+        break;
+    }
+}
+
+uint64_t Buffer::get_worksize(kernel_t type) const {
+    switch (type) {
+    case kernel_t::DYADIC_MULTIPLY:
+        return get_worksize_DyadicMultiply();
+    case kernel_t::INTT:
+        return get_worksize_INTT();
+    case kernel_t::NTT:
+        return get_worksize_NTT();
+    case kernel_t::KEYSWITCH:
+        return get_worksize_KeySwitch();
+    default:
+        FPGA_ASSERT(0, "Invalid kernel!")
+        return 1;
+    }
+}
+
+void Buffer::set_worksize(kernel_t type, uint64_t ws) {
+    switch (type) {
+    case kernel_t::DYADIC_MULTIPLY:
+        set_worksize_DyadicMultiply(ws);
+        break;
+    case kernel_t::INTT:
+        set_worksize_INTT(ws);
+        break;
+    case kernel_t::NTT:
+        set_worksize_NTT(ws);
+        break;
+    case kernel_t::KEYSWITCH:
+        set_worksize_KeySwitch(ws);
+        break;
+    default:
+        FPGA_ASSERT(0, "Invalid kernel!")
+        break;
+    }
+}
+
+// the objects of the worksize that are never pushed: the batch being
+// filled, or the last one, is cut to the objects that are.
+void Buffer::cancel_work(kernel_t type, uint64_t ws) {
+    std::unique_lock<std::mutex> locker(mu_);
+    update_work_size(type, ws);
+    locker.unlock();
+    cond_.notify_all();
+}
+
 uint64_t Buffer::size() {
     std::unique_lock<std::mutex> locker(mu_size_);
 
@@ -189,6 +258,106 @@ uint64_t Buffer::size() {
     return buf_size;
 }
 
+uint64_t Buffer::fit_batch_size_NTT(uint64_t units) {
+    std::unique_lock<std::mutex> locker(mu_);
+    n_batch_ntt_ = (n_batch_ntt_ + units - 1) / units * units;
+    return n_batch_ntt_;
+}
+
+uint64_t Buffer::fit_batch_size_INTT(uint64_t units) {
+    std::unique_lock<std::mutex> locker(mu_);
+    n_batch_intt_ = (n_batch_intt_ + units - 1) / units * units;
+    return n_batch_intt_;
+}
+
+void ComputeUnitStats::record(uint64_t n_batch) {
+    uint64_t units = frames_.size();
+    // unit u gets the frames b of the batch with b % units == u
+    for (uint64_t u = 0; u < units; u++) {
+        frames_[u] += (n_batch + units - 1 - u) / units;
+    }
+    total_frames_ += n_batch;
+}
+
+void ComputeUnitStats::report(std::ostream& os, const std::string& kernel,
+                              int device_id) const {
+    if (total_frames_ == 0) {
+        return;
+    }
+    for (size_t u = 0; u < frames_.size(); u++) {
+        os << "   [INFO] Device " << device_id << " " << kernel
+           << " compute unit " << u << ": " << frames_[u] << " frame(s), "
+           << std::fixed << std::setprecision(1)
+           << 100.0 * frames_[u] / total_frames_ << "% frame share"
+           << std::endl;
+    }
+}
+
+void HostOverheadStats::record_input(const std::string& kernel,
+                                     uint64_t n_batch, double seconds) {
+    Counters& c = kernels_[kernel];
+    c.batches++;
+    c.ops += n_batch;
+    c.input_seconds += seconds;
+}
+
+void HostOverheadStats::record_output(const std::string& kernel,
+                                      double seconds) {
+    kernels_[kernel].output_seconds += seconds;
+}
+
+void HostOverheadStats::record_api(const std::string& kernel, uint64_t ops,
+                                   double seconds) {
+    Counters& c = kernels_[kernel];
+    c.api_ops += ops;
+    c.api_seconds += seconds;
+}
+
+void HostOverheadStats::report(std::ostream& os, int device_id) const {
+    double unit = 1.0e+6;  // microseconds
+    for (const auto& iter : kernels_) {
+        const Counters& c = iter.second;
+        if (c.batches == 0) {
+            continue;
+        }
+        double total = c.input_seconds + c.output_seconds;
+        os << "   [INFO] Device " << device_id << " " << iter.first
+           << " host overhead: " << c.batches << " batch(es), " << c.ops
+           << " op(s), " << std::fixed << std::setprecision(3)
+           << c.input_seconds / c.batches * unit << " us in + "
+           << c.output_seconds / c.batches * unit << " us out per batch, "
+           << total / c.ops * unit << " us per op" << std::endl;
+    }
+}
+
+void HostOverheadStats::report_api(std::ostream& os) const {
+    double unit = 1.0e+6;  // microseconds
+    for (const auto& iter : kernels_) {
+        const Counters& c = iter.second;
+        if (c.api_ops == 0) {
+            continue;
+        }
+        os << "   [INFO] Host API " << iter.first << " overhead: " << c.api_ops
+           << " op(s), " << std::fixed << std::setprecision(3)
+           << c.api_seconds / c.api_ops * unit << " us per op" << std::endl;
+    }
+}
+
+static const char* kernel_name(kernel_t type) {
+    switch (type) {
+    case kernel_t::DYADIC_MULTIPLY:
+        return "DYADIC_MULTIPLY";
+    case kernel_t::NTT:
+        return "NTT";
+    case kernel_t::INTT:
+        return "INTT";
+    case kernel_t::KEYSWITCH:
+        return "KEYSWITCH";
+    default:
+        return "NONE";
+    }
+}
+
 std::atomic<int> FPGAObject::g_tag_(0);
 
 FPGAObject::FPGAObject(sycl::queue& p_q, uint64_t n_batch, kernel_t type,
@@ -207,53 +376,73 @@ void FPGAObject::recycle() {
 }
 
 FPGAObject_NTT::FPGAObject_NTT(sycl::queue& p_q, uint64_t coeff_count,
-                               uint64_t batch_size)
-    : FPGAObject(p_q, batch_size, kernel_t::NTT),
-
-      n_(coeff_count) {
+                               uint64_t batch_size, int numa_node)
+    : FPGAObject(p_q, batch_size, kernel_t::NTT), n_(coeff_count) {
     uint64_t data_size = batch_size * coeff_count;
     coeff_poly_in_svm_ = sycl::malloc_shared<uint64_t>(data_size, m_q);
-    root_of_unity_powers_in_svm_ =
-        sycl::malloc_shared<uint64_t>(coeff_count, m_q);
-    precon_root_of_unity_powers_in_svm_ =
-        sycl::malloc_shared<uint64_t>(coeff_count, m_q);
-    coeff_modulus_in_svm_ = sycl::malloc_shared<uint64_t>(1, m_q);
+    host_bind_memory_to_node(coeff_poly_in_svm_, data_size * sizeof(uint64_t),
+                             numa_node);
+    coeff_modulus_in_svm_ = sycl::malloc_shared<uint64_t>(batch_size, m_q);
+    table_id_in_svm_ = sycl::malloc_shared<unsigned int>(batch_size, m_q);
+    table_slot_in_svm_ = sycl::malloc_shared<unsigned int>(batch_size, m_q);
 }
 
 FPGAObject_INTT::FPGAObject_INTT(sycl::queue& p_q, uint64_t coeff_count,
-                                 uint64_t batch_size)
-    : FPGAObject(p_q, batch_size, kernel_t::INTT),
-
-      n_(coeff_count) {
+                                 uint64_t batch_size, int numa_node)
+    : FPGAObject(p_q, batch_size, kernel_t::INTT), n_(coeff_count) {
     uint64_t data_size = batch_size * coeff_count;
     coeff_poly_in_svm_ = sycl::malloc_shared<uint64_t>(data_size, m_q);
-    inv_n_in_svm_ = sycl::malloc_shared<uint64_t>(1, m_q);
-    inv_n_w_in_svm_ = sycl::malloc_shared<uint64_t>(1, m_q);
-    inv_root_of_unity_powers_in_svm_ =
-        sycl::malloc_shared<uint64_t>(coeff_count, m_q);
-    precon_inv_root_of_unity_powers_in_svm_ =
-        sycl::malloc_shared<uint64_t>(coeff_count, m_q);
-    coeff_modulus_in_svm_ = sycl::malloc_shared<uint64_t>(1, m_q);
+    host_bind_memory_to_node(coeff_poly_in_svm_, data_size * sizeof(uint64_t),
+                             numa_node);
+    inv_n_in_svm_ = sycl::malloc_shared<uint64_t>(batch_size, m_q);
+    inv_n_w_in_svm_ = sycl::malloc_shared<uint64_t>(batch_size, m_q);
+    coeff_modulus_in_svm_ = sycl::malloc_shared<uint64_t>(batch_size, m_q);
+    table_id_in_svm_ = sycl::malloc_shared<unsigned int>(batch_size, m_q);
+    table_slot_in_svm_ = sycl::malloc_shared<unsigned int>(batch_size, m_q);
 }
 
 FPGAObject_DyadicMultiply::FPGAObject_DyadicMultiply(sycl::queue& p_q,
                                                      uint64_t coeff_size,
                                                      uint32_t modulus_size,
-                                                     uint64_t batch_size)
+                                                     uint64_t batch_size,
+                                                     int numa_node,
+                                                     bool keys_resident)
     : FPGAObject(p_q, batch_size, kernel_t::DYADIC_MULTIPLY),
       n_(coeff_size),
-      n_moduli_(0) {
+      n_moduli_(0),
+      plain_(false),
+      accumulate_(false),
+      keys_resident_(keys_resident),
+      tile_keys_(nullptr),
+      tile_keys_offset_(0) {
     uint64_t n = batch_size * modulus_size * coeff_size;
     operand1_in_svm_ = sycl::malloc_shared<uint64_t>(n * 2, m_q);
     operand2_in_svm_ = sycl::malloc_shared<uint64_t>(n * 2, m_q);
+    host_bind_memory_to_node(operand1_in_svm_, n * 2 * sizeof(uint64_t),
+                             numa_node);
+    host_bind_memory_to_node(operand2_in_svm_, n * 2 * sizeof(uint64_t),
+                             numa_node);
+    HostMemoryPool::advise_huge_pages(operand1_in_svm_,
+                                      n * 2 * sizeof(uint64_t));
+    HostMemoryPool::advise_huge_pages(operand2_in_svm_,
+                                      n * 2 * sizeof(uint64_t));
     moduli_info_ =
         sycl::malloc_shared<moduli_info_t>(batch_size * modulus_size, m_q);
     operands_in_ddr_ = sycl::malloc_device<uint64_t>(n * 4, m_q);
     results_out_ddr_ = sycl::malloc_device<uint64_t>(n * 3, m_q);
+    results_out_svm_ = sycl::malloc_shared<uint64_t>(n * 3, m_q);
+    host_bind_memory_to_node(results_out_svm_, n * 3 * sizeof(uint64_t),
+                             numa_node);
+    HostMemoryPool::advise_huge_pages(results_out_svm_,
+                                      n * 3 * sizeof(uint64_t));
+    tag_out_svm_ = sycl::malloc_shared<int>(1, m_q);
+    results_out_valid_svm_ = sycl::malloc_shared<int>(1, m_q);
 }
 
 FPGAObject_KeySwitch::FPGAObject_KeySwitch(sycl::queue& p_q,
-                                           uint64_t batch_size)
+                                           uint64_t batch_size,
+                                           uint64_t max_coeff_count,
+                                           int numa_node)
     : FPGAObject(p_q, batch_size, kernel_t::KEYSWITCH),
       n_(0),
       decomp_modulus_size_(0),
@@ -264,10 +453,10 @@ FPGAObject_KeySwitch::FPGAObject_KeySwitch(sycl::queue& p_q,
       k_switch_keys_(nullptr),
       modswitch_factors_(nullptr),
       twiddle_factors_(nullptr) {
-    size_t size_in = batch_size * H_MAX_COEFF_COUNT * H_MAX_KEY_MODULUS_SIZE;
+    size_t size_in = batch_size * max_coeff_count * H_MAX_KEY_MODULUS_SIZE;
     size_t size_out = size_in * H_MAX_KEY_COMPONENT_SIZE;
-    ms_output_ = static_cast<uint64_t*>(
-        aligned_alloc(HOST_MEM_ALIGNMENT, size_out * sizeof(uint64_t)));
+    ms_output_ = static_cast<uint64_t*>(HostMemoryPool::instance().allocate(
+        size_out * sizeof(uint64_t), numa_node));
     mem_t_target_iter_ptr_ = new sycl::buffer<uint64_t>(
         sycl::range(size_in),
         {sycl::property::buffer::mem_channel{MEM_CHANNEL_K1}});
@@ -276,17 +465,26 @@ FPGAObject_KeySwitch::FPGAObject_KeySwitch(sycl::queue& p_q,
         {sycl::property::buffer::mem_channel{MEM_CHANNEL_K1}});
     mem_t_target_iter_ptr_->set_write_back(false);
     mem_KeySwitch_results_->set_write_back(false);
+    t_target_iter_ptrs_svm_ = sycl::malloc_shared<uint64_t*>(batch_size, m_q);
 }
 
 FPGAObject_KeySwitch::~FPGAObject_KeySwitch() {
     if (ms_output_) {
-        free(ms_output_);
+        HostMemoryPool::instance().release(ms_output_);
     }
     if (mem_KeySwitch_results_) {
         delete mem_KeySwitch_results_;
     }
+    free(t_target_iter_ptrs_svm_, m_q);
+    t_target_iter_ptrs_svm_ = nullptr;
 }
 FPGAObject_DyadicMultiply::~FPGAObject_DyadicMultiply() {
+    // the readback of a batch still in flight writes results_out_svm_, and
+    // the batch reads the operands, so it has to end before they are freed.
+    // So does a keyswitch load reading the products.
+    output_event_.wait();
+    relinearize_event_.wait();
+
     free(operand1_in_svm_, m_q);
     operand1_in_svm_ = nullptr;
     free(operand2_in_svm_, m_q);
@@ -299,31 +497,37 @@ FPGAObject_DyadicMultiply::~FPGAObject_DyadicMultiply() {
     if (results_out_ddr_) {
         free(results_out_ddr_, m_q);
     }
+    free(results_out_svm_, m_q);
+    results_out_svm_ = nullptr;
+    free(tag_out_svm_, m_q);
+    tag_out_svm_ = nullptr;
+    free(results_out_valid_svm_, m_q);
+    results_out_valid_svm_ = nullptr;
 }
 FPGAObject_NTT::~FPGAObject_NTT() {
     free(coeff_poly_in_svm_, m_q);
     coeff_poly_in_svm_ = nullptr;
-    free(root_of_unity_powers_in_svm_, m_q);
-    root_of_unity_powers_in_svm_ = nullptr;
-    free(precon_root_of_unity_powers_in_svm_, m_q);
-    precon_root_of_unity_powers_in_svm_ = nullptr;
     free(coeff_modulus_in_svm_, m_q);
     coeff_modulus_in_svm_ = nullptr;
+    free(table_id_in_svm_, m_q);
+    table_id_in_svm_ = nullptr;
+    free(table_slot_in_svm_, m_q);
+    table_slot_in_svm_ = nullptr;
 }
 
 FPGAObject_INTT::~FPGAObject_INTT() {
     free(coeff_poly_in_svm_, m_q);
     coeff_poly_in_svm_ = nullptr;
-    free(inv_root_of_unity_powers_in_svm_, m_q);
-    inv_root_of_unity_powers_in_svm_ = nullptr;
-    free(precon_inv_root_of_unity_powers_in_svm_, m_q);
-    precon_inv_root_of_unity_powers_in_svm_ = nullptr;
     free(coeff_modulus_in_svm_, m_q);
     coeff_modulus_in_svm_ = nullptr;
     free(inv_n_in_svm_, m_q);
     inv_n_in_svm_ = nullptr;
     free(inv_n_w_in_svm_, m_q);
     inv_n_w_in_svm_ = nullptr;
+    free(table_id_in_svm_, m_q);
+    table_id_in_svm_ = nullptr;
+    free(table_slot_in_svm_, m_q);
+    table_slot_in_svm_ = nullptr;
 }
 
 void FPGAObject_KeySwitch::fill_in_data(const std::vector<Object*>& objs) {
@@ -362,6 +566,8 @@ void FPGAObject_DyadicMultiply::fill_in_data(const std::vector<Object*>& objs) {
 
         n_moduli_ = obj->n_moduli_;
         n_ = obj->n_;
+        plain_ = obj->plain_;
+        accumulate_ = obj->accumulate_;
 
         for (uint64_t i = 0; i < n_moduli_; i++) {
             uint64_t modulus = obj->moduli_[i];
@@ -376,16 +582,40 @@ void FPGAObject_DyadicMultiply::fill_in_data(const std::vector<Object*>& objs) {
 
     n_batch_ = batch;
 
-    // assuming the batch of operand1s and operand2s are in contiguous space
-    // respectively
+    // the operands of a batch are gathered one object at a time, since
+    // DyadicMultiplyBatch callers may pass non contiguous operands.
+    // a plaintext operand holds a single polynomial per modulus.
     uint64_t n_data = n_moduli_ * n_ * 2;
-    Object_DyadicMultiply* obj =
+    uint64_t n_data2 = plain_ ? n_moduli_ * n_ : n_data;
+
+    // the keys of a tiled KeySwitch are consecutive in their TileKeys, which
+    // the kernel reads from device memory instead.
+    Object_DyadicMultiply* front =
         dynamic_cast<Object_DyadicMultiply*>(in_objs_.front());
-    FPGA_ASSERT(obj);
-    memcpy(operand1_in_svm_, obj->operand1_,
-           n_batch_ * n_data * sizeof(uint64_t));
-    memcpy(operand2_in_svm_, obj->operand2_,
-           n_batch_ * n_data * sizeof(uint64_t));
+    FPGA_ASSERT(front);
+    tile_keys_ = keys_resident_ ? front->tile_keys_ : nullptr;
+    if (tile_keys_) {
+        tile_keys_offset_ = front->operand1_ - tile_keys_->keys_.data();
+    }
+
+    uint64_t frame_number = 0;
+    for (const auto& obj_in : in_objs_) {
+        Object_DyadicMultiply* obj =
+            dynamic_cast<Object_DyadicMultiply*>(obj_in);
+        FPGA_ASSERT(obj);
+        if (tile_keys_) {
+            FPGA_ASSERT((obj->tile_keys_ == tile_keys_) &&
+                            (obj->operand1_ ==
+                             front->operand1_ + frame_number * n_data),
+                        "the resident keys of a batch are not consecutive");
+        } else {
+            memcpy(operand1_in_svm_ + frame_number * n_data, obj->operand1_,
+                   n_data * sizeof(uint64_t));
+        }
+        memcpy(operand2_in_svm_ + frame_number * n_data2, obj->operand2_,
+               n_data2 * sizeof(uint64_t));
+        frame_number++;
+    }
 
     tag_ = g_tag_++;
 }
@@ -396,19 +626,14 @@ void FPGAObject_NTT::fill_in_data(const std::vector<Object*>& objs) {
         FPGA_ASSERT(obj);
         in_objs_.emplace_back(obj);
         n_ = obj->n_;
+        // the frames of a batch may use different moduli, the Device
+        // resolves the twiddle table of each frame
+        memcpy(coeff_poly_in_svm_ + batch * n_, obj->coeff_poly_,
+               n_ * sizeof(uint64_t));
+        coeff_modulus_in_svm_[batch] = obj->coeff_modulus_;
         batch++;
     }
     n_batch_ = batch;
-    uint64_t coeff_count = n_;
-    Object_NTT* obj = dynamic_cast<Object_NTT*>(in_objs_.front());
-    FPGA_ASSERT(obj);
-    memcpy(coeff_poly_in_svm_, obj->coeff_poly_,
-           n_batch_ * coeff_count * sizeof(uint64_t));
-    coeff_modulus_in_svm_[0] = obj->coeff_modulus_;
-    memcpy(root_of_unity_powers_in_svm_, obj->root_of_unity_powers_,
-           coeff_count * sizeof(uint64_t));
-    memcpy(precon_root_of_unity_powers_in_svm_,
-           obj->precon_root_of_unity_powers_, coeff_count * sizeof(uint64_t));
     tag_ = g_tag_++;
 }
 
@@ -419,22 +644,16 @@ void FPGAObject_INTT::fill_in_data(const std::vector<Object*>& objs) {
         FPGA_ASSERT(obj);
         in_objs_.emplace_back(obj);
         n_ = obj->n_;
+        // the frames of a batch may use different moduli, the Device
+        // resolves the twiddle table of each frame
+        memcpy(coeff_poly_in_svm_ + batch * n_, obj->coeff_poly_,
+               n_ * sizeof(uint64_t));
+        coeff_modulus_in_svm_[batch] = obj->coeff_modulus_;
+        inv_n_in_svm_[batch] = obj->inv_n_;
+        inv_n_w_in_svm_[batch] = obj->inv_n_w_;
         batch++;
     }
     n_batch_ = batch;
-    uint64_t coeff_count = n_;
-    Object_INTT* obj = dynamic_cast<Object_INTT*>(in_objs_.front());
-    FPGA_ASSERT(obj);
-    memcpy(coeff_poly_in_svm_, obj->coeff_poly_,
-           n_batch_ * coeff_count * sizeof(uint64_t));
-    coeff_modulus_in_svm_[0] = obj->coeff_modulus_;
-    memcpy(inv_root_of_unity_powers_in_svm_, obj->inv_root_of_unity_powers_,
-           coeff_count * sizeof(uint64_t));
-    memcpy(precon_inv_root_of_unity_powers_in_svm_,
-           obj->precon_inv_root_of_unity_powers_,
-           coeff_count * sizeof(uint64_t));
-    *inv_n_in_svm_ = obj->inv_n_;
-    *inv_n_w_in_svm_ = obj->inv_n_w_;
     tag_ = g_tag_++;
 }
 
@@ -475,14 +694,38 @@ void FPGAObject_KeySwitch::fill_out_data(uint64_t* output) {
 }
 
 void FPGAObject_DyadicMultiply::fill_out_data(uint64_t* results_in_svm) {
-    uint64_t n_data = n_moduli_ * n_ * 3;
-    Object_DyadicMultiply* obj_dyadic_multiply =
-        dynamic_cast<Object_DyadicMultiply*>(in_objs_.front());
-    FPGA_ASSERT(obj_dyadic_multiply);
-    memcpy(obj_dyadic_multiply->results_, results_in_svm,
-           n_batch_ * n_data * sizeof(uint64_t));
+    uint64_t n_data = n_moduli_ * n_ * (plain_ ? 2 : 3);
+    if (accumulate_) {
+        // the device returns the sum of the batch, which is added into the
+        // results shared by the objects of the accumulation.
+        Object_DyadicMultiply* front =
+            dynamic_cast<Object_DyadicMultiply*>(in_objs_.front());
+        FPGA_ASSERT(front);
+        {
+            std::lock_guard<std::mutex> locker(muAccumulate);
+            for (uint64_t p = 0; p < n_data / n_; p++) {
+                uint64_t modulus = front->moduli_[p % n_moduli_];
+                uint64_t* r = front->results_ + p * n_;
+                const uint64_t* s = results_in_svm + p * n_;
+                for (uint64_t i = 0; i < n_; i++) {
+                    uint64_t sum = r[i] + s[i];
+                    r[i] = (sum >= modulus) ? sum - modulus : sum;
+                }
+            }
+        }
+        for (auto& obj : in_objs_) {
+            obj->ready_ = true;
+        }
+        return;
+    }
     uint64_t frame_number = 0;
     for (auto& obj : in_objs_) {
+        Object_DyadicMultiply* obj_dyadic_multiply =
+            dynamic_cast<Object_DyadicMultiply*>(obj);
+        FPGA_ASSERT(obj_dyadic_multiply);
+        memcpy(obj_dyadic_multiply->results_,
+               results_in_svm + frame_number * n_data,
+               n_data * sizeof(uint64_t));
         obj->ready_ = true;
         frame_number++;
     }
@@ -490,13 +733,12 @@ void FPGAObject_DyadicMultiply::fill_out_data(uint64_t* results_in_svm) {
 }
 
 void FPGAObject_NTT::fill_out_data(uint64_t* results_in_svm_) {
-    uint64_t coeff_count = n_;
-    Object_NTT* obj_NTT = dynamic_cast<Object_NTT*>(in_objs_.front());
-    FPGA_ASSERT(obj_NTT);
-    memcpy(obj_NTT->coeff_poly_, results_in_svm_,
-           n_batch_ * coeff_count * sizeof(uint64_t));
     uint64_t batch = 0;
     for (auto& obj : in_objs_) {
+        Object_NTT* obj_NTT = dynamic_cast<Object_NTT*>(obj);
+        FPGA_ASSERT(obj_NTT);
+        memcpy(obj_NTT->coeff_poly_, results_in_svm_ + batch * n_,
+               n_ * sizeof(uint64_t));
         obj->ready_ = true;
         batch++;
     }
@@ -504,13 +746,12 @@ void FPGAObject_NTT::fill_out_data(uint64_t* results_in_svm_) {
 }
 
 void FPGAObject_INTT::fill_out_data(uint64_t* results_in_svm_) {
-    uint64_t coeff_count = n_;
-    Object_INTT* obj_INTT = dynamic_cast<Object_INTT*>(in_objs_.front());
-    FPGA_ASSERT(obj_INTT);
-    memcpy(obj_INTT->coeff_poly_, results_in_svm_,
-           n_batch_ * coeff_count * sizeof(uint64_t));
     uint64_t batch = 0;
     for (auto& obj : in_objs_) {
+        Object_INTT* obj_INTT = dynamic_cast<Object_INTT*>(obj);
+        FPGA_ASSERT(obj_INTT);
+        memcpy(obj_INTT->coeff_poly_, results_in_svm_ + batch * n_,
+               n_ * sizeof(uint64_t));
         obj->ready_ = true;
         batch++;
     }
@@ -525,7 +766,9 @@ const std::unordered_map<std::string, kernel_t> Device::kernels_ =
         {"NTT", kernel_t::NTT},
         {"INTT", kernel_t::INTT},
         {"KEYSWITCH", kernel_t::KEYSWITCH},
-        {"DYADIC_MULTIPLY_KEYSWITCH", kernel_t::DYADIC_MULTIPLY_KEYSWITCH}};
+        {"DYADIC_MULTIPLY_KEYSWITCH", kernel_t::DYADIC_MULTIPLY_KEYSWITCH},
+        {"RESCALE", kernel_t::RESCALE},
+        {"KEYSWITCH_TILED", kernel_t::KEYSWITCH_TILED}};
 
 kernel_t Device::get_kernel_type() {
     kernel_t kernel = kernel_t::DYADIC_MULTIPLY_KEYSWITCH;  // default
@@ -539,6 +782,67 @@ kernel_t Device::get_kernel_type() {
     return kernel;
 }
 
+// the inputs of a batch of relinearizations are read from the device memory
+// the dyadic kernel left them in. It takes the bitstream load kernel for
+// device memory, and all the products of the batch still in place, the
+// batch is staged from the host otherwise.
+bool Device::KeySwitch_products_resident(FPGAObject_KeySwitch* fpga_obj) {
+    bool resident = (KeySwitch_kernel_container_->load_usm != nullptr);
+    for (const auto& obj : fpga_obj->in_objs_) {
+        Object_KeySwitch* obj_KeySwitch = dynamic_cast<Object_KeySwitch*>(obj);
+        FPGA_ASSERT(obj_KeySwitch);
+        resident &= (obj_KeySwitch->source_ != nullptr) &&
+                    (products_map_.count(obj_KeySwitch->source_) > 0);
+    }
+
+    if (!resident) {
+        // the products were read back with the multiplication, whose batch
+        // the run loop completes ahead of any keyswitch.
+        for (const auto& obj : fpga_obj->in_objs_) {
+            Object_KeySwitch* obj_KeySwitch =
+                dynamic_cast<Object_KeySwitch*>(obj);
+            FPGA_ASSERT(obj_KeySwitch);
+            if (obj_KeySwitch->source_) {
+                FPGA_ASSERT(obj_KeySwitch->source_->ready_);
+                products_map_.erase(obj_KeySwitch->source_);
+            }
+        }
+    }
+    return resident;
+}
+
+void Device::KeySwitch_load_products(FPGAObject_KeySwitch* fpga_obj,
+                                     int obj_id, unsigned rmem) {
+    std::vector<FPGAObject_DyadicMultiply*> batches;
+    std::vector<sycl::event> deps;
+    uint64_t frame_number = 0;
+    for (const auto& obj : fpga_obj->in_objs_) {
+        Object_KeySwitch* obj_KeySwitch = dynamic_cast<Object_KeySwitch*>(obj);
+        FPGA_ASSERT(obj_KeySwitch);
+        auto iter = products_map_.find(obj_KeySwitch->source_);
+        FPGA_ASSERT(iter != products_map_.end());
+        fpga_obj->t_target_iter_ptrs_svm_[frame_number++] = iter->second.c2_;
+        if (std::find(batches.begin(), batches.end(), iter->second.fpga_obj_) ==
+            batches.end()) {
+            batches.push_back(iter->second.fpga_obj_);
+            deps.push_back(iter->second.fpga_obj_->output_event_);
+        }
+        products_map_.erase(iter);
+    }
+
+    KeySwitch_events_enqueue_[obj_id][0] =
+        (*(KeySwitch_kernel_container_->load_usm))(
+            keyswitch_queues_[KEYSWITCH_LOAD], deps.data(),
+            static_cast<unsigned>(deps.size()),
+            fpga_obj->t_target_iter_ptrs_svm_, modulus_meta_, fpga_obj->n_,
+            fpga_obj->decomp_modulus_size_, fpga_obj->n_batch_,
+            (*(invn_t*)(void*)&invn_), rmem);
+    // the batches are not overwritten before the kernel read them.
+    for (auto& batch : batches) {
+        batch->relinearize_event_ = KeySwitch_events_enqueue_[obj_id][0];
+    }
+}
+
 void Device::copyKeySwitchBatch(FPGAObject_KeySwitch* fpga_obj, int obj_id) {
     size_t size_in = fpga_obj->n_ * fpga_obj->decomp_modulus_size_;
     uint64_t frame_number = 0;
@@ -547,9 +851,18 @@ void Device::copyKeySwitchBatch(FPGAObject_KeySwitch* fpga_obj, int obj_id) {
     for (const auto& obj : fpga_obj->in_objs_) {
         Object_KeySwitch* obj_KeySwitch = dynamic_cast<Object_KeySwitch*>(obj);
         FPGA_ASSERT(obj_KeySwitch);
-        memcpy(host_access_t_target_iter_ptr_.get_pointer() +
-                   (frame_number * size_in),
-               obj_KeySwitch->t_target_iter_ptr_, size_in * sizeof(uint64_t));
+        uint64_t* dst = host_access_t_target_iter_ptr_.get_pointer() +
+                        (frame_number * size_in);
+        if (obj_KeySwitch->galois_table_) {
+            // rotations permute the input while staging it, so the
+            // automorphism does not take a memory pass of its own.
+            ApplyGaloisPermutation(obj_KeySwitch->t_target_iter_ptr_,
+                                   fpga_obj->n_, fpga_obj->decomp_modulus_size_,
+                                   obj_KeySwitch->galois_table_, dst);
+        } else {
+            memcpy(dst, obj_KeySwitch->t_target_iter_ptr_,
+                   size_in * sizeof(uint64_t));
+        }
         frame_number++;
     }
 }
@@ -572,6 +885,10 @@ std::string Device::get_bitstream_name() {
         return std::string("libkeyswitch.so");
     case kernel_t::DYADIC_MULTIPLY_KEYSWITCH:
         return std::string("libdyadic_multiply_keyswitch.so");
+    case kernel_t::RESCALE:
+        return std::string("librescale.so");
+    case kernel_t::KEYSWITCH_TILED:
+        return std::string("libkeyswitch_tiled.so");
     default:
         FPGA_ASSERT(0);
         return std::string("bad");
@@ -587,33 +904,46 @@ Device::Device(sycl::device& p_device, Buffer& buffer,
       buffer_(buffer),
       credit_(CREDIT),
       future_exit_(exit_signal),
-      dyadic_multiply_results_out_svm_(nullptr),
-      dyadic_multiply_tag_out_svm_(nullptr),
-      dyadic_multiply_results_out_valid_svm_(nullptr),
       NTT_coeff_poly_svm_(nullptr),
       INTT_coeff_poly_svm_(nullptr),
+      NTT_max_coeff_count_(16384),
+      INTT_max_coeff_count_(16384),
+      NTT_twiddles_{},
+      INTT_twiddles_{},
+      NTT_units_{},
+      INTT_units_{},
+      input_wait_seconds_(0),
+      twiddle_table_id_(0),
+      twiddle_table_use_(0),
       KeySwitch_mem_root_of_unity_powers_(nullptr),
       KeySwitch_load_once_(false),
+      KeySwitch_max_coeff_count_(16384),
+      KeySwitch_max_modulus_bits_(52),
       root_of_unity_powers_ptr_(nullptr),
       modulus_meta_{},
       invn_{},
       KeySwitch_id_(0),
+      KeySwitch_num_ops_(0),
       keys_map_iter_{},
       debug_(debug),
       ntt_kernel_container_(nullptr),
       intt_kernel_container_(nullptr),
       dyadicmult_kernel_container_(nullptr),
-      KeySwitch_kernel_container_(nullptr) {
+      KeySwitch_kernel_container_(nullptr),
+      tile_keys_use_(0),
+      numa_node_(-1) {
     id_ = device_id_++;
     context_ = sycl::context(p_device);
     std::cout << "Creating Command Qs/Acquiring Device ... " << id_
               << std::endl;
+    numa_node_ = get_numa_node();
     kernel_type_ = get_kernel_type();
     FPGA_ASSERT(kernel_type_ != kernel_t::NONE,
                 "Invalid value of env(FPGA_KERNEL)");
     load_kernel_symbols();
     if ((kernel_type_ == kernel_t::DYADIC_MULTIPLY_KEYSWITCH) ||
-        (kernel_type_ == kernel_t::DYADIC_MULTIPLY)) {
+        (kernel_type_ == kernel_t::DYADIC_MULTIPLY) ||
+        (kernel_type_ == kernel_t::KEYSWITCH_TILED)) {
 #ifdef SYCL_DISABLE_PROFILING
         auto cl_queue_properties = sycl::property_list{};
 #else
@@ -624,19 +954,13 @@ Device::Device(sycl::device& p_device, Buffer& buffer,
             sycl::queue(context_, device_, cl_queue_properties);
         dyadic_multiply_output_queue_ =
             sycl::queue(context_, device_, cl_queue_properties);
-        uint64_t size =
-            batch_size_dyadic_multiply * 3 * modulus_size * coeff_size;
-        dyadic_multiply_results_out_svm_ =
-            sycl::malloc_shared<uint64_t>(size, dyadic_multiply_output_queue_);
-        dyadic_multiply_tag_out_svm_ =
-            sycl::malloc_shared<int>(1, dyadic_multiply_output_queue_);
-        dyadic_multiply_results_out_valid_svm_ =
-            sycl::malloc_shared<int>(1, dyadic_multiply_output_queue_);
         (*(dyadicmult_kernel_container_->submit_autorun_kernels))(
             dyadic_multiply_input_queue_);
     }
 
-    if (kernel_type_ == kernel_t::INTT) {
+    if ((kernel_type_ == kernel_t::INTT) ||
+        (kernel_type_ == kernel_t::RESCALE) ||
+        (kernel_type_ == kernel_t::KEYSWITCH_TILED)) {
 #ifdef SYCL_ENABLE_PROFILING
         auto cl_queue_properties =
             sycl::property_list{sycl::property::queue::enable_profiling()};
@@ -647,12 +971,35 @@ Device::Device(sycl::device& p_device, Buffer& buffer,
                                        cl_queue_properties);
         intt_store_queue_ = sycl::queue(context_, context_.get_devices()[0],
                                         cl_queue_properties);
-        uint64_t size = batch_size_intt * 16834;
+        FPGA_ASSERT(intt_kernel_container_->intt_max_coeff_count,
+                    "the INTT bitstream is outdated, rebuild it");
+        INTT_max_coeff_count_ =
+            (*(intt_kernel_container_->intt_max_coeff_count))();
+        // bitstreams without the query have a single compute unit.
+        uint64_t units = 1;
+        if (intt_kernel_container_->intt_compute_units) {
+            units = (*(intt_kernel_container_->intt_compute_units))();
+        }
+        INTT_units_.frames_.assign(units, 0);
+        // full batches give the same number of frames to every unit
+        uint64_t batch = buffer_.fit_batch_size_INTT(units);
+        if (batch != batch_size_intt) {
+            std::cout << "   [INFO] Device " << id_ << " INTT batch size "
+                      << batch << " for " << units << " compute unit(s)"
+                      << std::endl;
+            batch_size_intt = batch;
+        }
+        uint64_t size = batch_size_intt * INTT_max_coeff_count_;
         INTT_coeff_poly_svm_ =
             sycl::malloc_shared<uint64_t>(size, intt_load_queue_);
+        host_bind_memory_to_node(INTT_coeff_poly_svm_, size * sizeof(uint64_t),
+                                 numa_node_);
+        alloc_twiddles(INTT_twiddles_, intt_load_queue_, INTT_max_coeff_count_);
         (*(intt_kernel_container_->inv_ntt))(intt_load_queue_);
     }
-    if (kernel_type_ == kernel_t::NTT) {
+    if ((kernel_type_ == kernel_t::NTT) ||
+        (kernel_type_ == kernel_t::RESCALE) ||
+        (kernel_type_ == kernel_t::KEYSWITCH_TILED)) {
 #ifdef SYCL_ENABLE_PROFILING
         auto cl_queue_properties =
             sycl::property_list{sycl::property::queue::enable_profiling()};
@@ -663,9 +1010,30 @@ Device::Device(sycl::device& p_device, Buffer& buffer,
                                       cl_queue_properties);
         ntt_store_queue_ = sycl::queue(context_, context_.get_devices()[0],
                                        cl_queue_properties);
-        uint64_t size = batch_size_ntt * 16834;
+        FPGA_ASSERT(ntt_kernel_container_->ntt_max_coeff_count,
+                    "the NTT bitstream is outdated, rebuild it");
+        NTT_max_coeff_count_ =
+            (*(ntt_kernel_container_->ntt_max_coeff_count))();
+        // bitstreams without the query have a single compute unit.
+        uint64_t units = 1;
+        if (ntt_kernel_container_->ntt_compute_units) {
+            units = (*(ntt_kernel_container_->ntt_compute_units))();
+        }
+        NTT_units_.frames_.assign(units, 0);
+        // full batches give the same number of frames to every unit
+        uint64_t batch = buffer_.fit_batch_size_NTT(units);
+        if (batch != batch_size_ntt) {
+            std::cout << "   [INFO] Device " << id_ << " NTT batch size "
+                      << batch << " for " << units << " compute unit(s)"
+                      << std::endl;
+            batch_size_ntt = batch;
+        }
+        uint64_t size = batch_size_ntt * NTT_max_coeff_count_;
         NTT_coeff_poly_svm_ =
             (uint64_t*)sycl::malloc_shared<uint64_t>(size, ntt_load_queue_);
+        host_bind_memory_to_node(NTT_coeff_poly_svm_, size * sizeof(uint64_t),
+                                 numa_node_);
+        alloc_twiddles(NTT_twiddles_, ntt_load_queue_, NTT_max_coeff_count_);
         (*(ntt_kernel_container_->fwd_ntt))(ntt_load_queue_);
     }
 
@@ -685,24 +1053,56 @@ Device::Device(sycl::device& p_device, Buffer& buffer,
 
         (*(KeySwitch_kernel_container_->launchAllAutoRunKernels))(
             keyswitch_queues_[KEYSWITCH_LOAD]);
+
+        // bitstreams without the query are limited to 16384 coefficients.
+        if (KeySwitch_kernel_container_->keyswitch_max_coeff_count) {
+            KeySwitch_max_coeff_count_ =
+                (*(KeySwitch_kernel_container_->keyswitch_max_coeff_count))();
+        }
+        // and to 52-bit moduli.
+        if (KeySwitch_kernel_container_->keyswitch_max_modulus_bits) {
+            KeySwitch_max_modulus_bits_ =
+                (*(KeySwitch_kernel_container_->keyswitch_max_modulus_bits))();
+        }
     }
     // DYADIC_MULTIPLY: [0, CREDIT)
+    bool keys_resident =
+        dyadicmult_kernel_container_ &&
+        dyadicmult_kernel_container_->input_fifo_accumulate_keys_usm;
     for (int i = 0; i < CREDIT; i++) {
         fpga_objects_.emplace_back(new FPGAObject_DyadicMultiply(
             dyadic_multiply_input_queue_, coeff_size, modulus_size,
-            batch_size_dyadic_multiply));
+            batch_size_dyadic_multiply, numa_node_, keys_resident));
     }
     // INTT: CREDIT
     fpga_objects_.emplace_back(
-        new FPGAObject_INTT(intt_load_queue_, 16384, batch_size_intt));
+        new FPGAObject_INTT(intt_load_queue_, INTT_max_coeff_count_,
+                            batch_size_intt, numa_node_));
     // NTT:  CREDIT + 1
     fpga_objects_.emplace_back(
-        new FPGAObject_NTT(ntt_load_queue_, 16384, batch_size_ntt));
+        new FPGAObject_NTT(ntt_load_queue_, NTT_max_coeff_count_,
+                           batch_size_ntt, numa_node_));
     // KEYSWITCH: CREDIT + 2 and CREDIT + 2 + 1
     for (size_t i = 0; i < 2; i++) {
         fpga_objects_.emplace_back(new FPGAObject_KeySwitch(
-            keyswitch_queues_[KEYSWITCH_LOAD], batch_size_KeySwitch));
+            keyswitch_queues_[KEYSWITCH_LOAD], batch_size_KeySwitch,
+            KeySwitch_max_coeff_count_, numa_node_));
+    }
+}
+
+int Device::get_numa_node() {
+    int node = -1;
+    if (host_numa_node_override(id_, &node)) {
+        std::cout << "   [INFO] Device " << id_ << " NUMA node " << node
+                  << " set by env(FPGA_NUMA_NODES)" << std::endl;
+        return node;
+    }
+    node = host_numa_node_of_device(id_);
+    if (node >= 0) {
+        std::cout << "   [INFO] Device " << id_ << " is local to NUMA node "
+                  << node << std::endl;
     }
+    return node;
 }
 
 void Device::load_kernel_symbols() {
@@ -719,6 +1119,13 @@ void Device::load_kernel_symbols() {
     } else if (kernel_type_ == kernel_t::DYADIC_MULTIPLY_KEYSWITCH) {
         dyadicmult_kernel_container_ = new DyadicMultDynamicIF(bitstream);
         KeySwitch_kernel_container_ = new KeySwitchDynamicIF(bitstream);
+    } else if (kernel_type_ == kernel_t::RESCALE) {
+        intt_kernel_container_ = new INTTDynamicIF(bitstream);
+        ntt_kernel_container_ = new NTTDynamicIF(bitstream);
+    } else if (kernel_type_ == kernel_t::KEYSWITCH_TILED) {
+        dyadicmult_kernel_container_ = new DyadicMultDynamicIF(bitstream);
+        intt_kernel_container_ = new INTTDynamicIF(bitstream);
+        ntt_kernel_container_ = new NTTDynamicIF(bitstream);
     }
 }
 
@@ -740,34 +1147,36 @@ Device::~Device() {
         delete km.second;
     }
     keys_map_.clear();
-
-    // DYADIC_MULTIPLY section
-    if ((kernel_type_ == kernel_t::DYADIC_MULTIPLY_KEYSWITCH) ||
-        (kernel_type_ == kernel_t::DYADIC_MULTIPLY)) {
-        free(dyadic_multiply_results_out_valid_svm_,
-             dyadic_multiply_output_queue_);
-        dyadic_multiply_results_out_valid_svm_ = nullptr;
-        free(dyadic_multiply_tag_out_svm_, dyadic_multiply_output_queue_);
-        dyadic_multiply_tag_out_svm_ = nullptr;
-        free(dyadic_multiply_results_out_svm_, dyadic_multiply_output_queue_);
-        dyadic_multiply_results_out_svm_ = nullptr;
+    for (auto& tk : tile_keys_map_) {
+        free(tk.second.keys_, dyadic_multiply_input_queue_);
     }
+    tile_keys_map_.clear();
+
+    host_overhead_.report(std::cout, id_);
+
     // NTT section
-    if (kernel_type_ == kernel_t::NTT) {
+    if ((kernel_type_ == kernel_t::NTT) ||
+        (kernel_type_ == kernel_t::RESCALE) ||
+        (kernel_type_ == kernel_t::KEYSWITCH_TILED)) {
+        NTT_units_.report(std::cout, "NTT", id_);
         free(NTT_coeff_poly_svm_, ntt_load_queue_);
         NTT_coeff_poly_svm_ = nullptr;
+        free_twiddles(NTT_twiddles_, ntt_load_queue_);
     }
     // INTT section
-    if (kernel_type_ == kernel_t::INTT) {
+    if ((kernel_type_ == kernel_t::INTT) ||
+        (kernel_type_ == kernel_t::RESCALE) ||
+        (kernel_type_ == kernel_t::KEYSWITCH_TILED)) {
+        INTT_units_.report(std::cout, "INTT", id_);
         free(INTT_coeff_poly_svm_, context_);
         INTT_coeff_poly_svm_ = nullptr;
+        free_twiddles(INTT_twiddles_, intt_load_queue_);
     }
 
     if ((kernel_type_ == kernel_t::DYADIC_MULTIPLY_KEYSWITCH) ||
         (kernel_type_ == kernel_t::KEYSWITCH)) {
         if (root_of_unity_powers_ptr_) {
-            // free(root_of_unity_powers_ptr_, context_);
-            free(root_of_unity_powers_ptr_);
+            HostMemoryPool::instance().release(root_of_unity_powers_ptr_);
         }
     }
 }
@@ -780,6 +1189,13 @@ void Device::process_blocking_api() {
 void Device::run() {
     kernel_t processed_type = kernel_t::NONE;
 
+    // staging buffers allocated by this thread from now on are first-touched
+    // on the NUMA node local to the card.
+    if ((numa_node_ >= 0) && !host_bind_thread_to_node(numa_node_)) {
+        std::cout << "   [WARN] Failed to pin Device " << id_
+                  << " runner to NUMA node " << numa_node_ << std::endl;
+    }
+
     while (future_exit_.wait_for(std::chrono::milliseconds(0)) ==
            std::future_status::timeout) {
         if (buffer_.size()) {
@@ -803,6 +1219,12 @@ void Device::run() {
                 process_output_NTT();
                 break;
             case kernel_t::KEYSWITCH:
+                // the multiplications in flight complete first: the
+                // keyswitches of a relinearization add into their results.
+                while ((credit_ < CREDIT) &&
+                       process_output_dyadic_multiply(true)) {
+                    credit_ += 1;
+                }
 #ifdef __DEBUG_KS_RUNTIME
                 uint64_t lat_start =
                     std::chrono::duration_cast<std::chrono::nanoseconds>(
@@ -810,7 +1232,11 @@ void Device::run() {
                         .count();
 #endif
 
-                process_input(CREDIT + 2 + KeySwitch_id_ % 2);
+                if (process_input(CREDIT + 2 + KeySwitch_id_ % 2)) {
+                    KeySwitch_num_ops_ +=
+                        fpga_objects_[CREDIT + 2 + KeySwitch_id_ % 2]
+                            ->n_batch_;
+                }
 
 #ifdef __DEBUG_KS_RUNTIME
                 uint64_t lat_in =
@@ -844,17 +1270,16 @@ void Device::run() {
                 }
                 break;
             case kernel_t::KEYSWITCH:
-                if (KeySwitch_id_ > 0) {
-                    FPGAObject* obj = fpga_objects_[CREDIT + 2];
-                    FPGAObject_KeySwitch* fpga_obj =
-                        dynamic_cast<FPGAObject_KeySwitch*>(obj);
-                    uint64_t batch = (buffer_.get_worksize_KeySwitch() +
-                                      fpga_obj->batch_size_ - 1) /
-                                     fpga_obj->batch_size_;
-                    if (batch == KeySwitch_id_) {
-                        KeySwitch_read_output();
-                        KeySwitch_id_ = 0;
-                    }
+                // the last batch of the work is read once all its
+                // keyswitches went in. Fences can split the work into more
+                // batches than worksize / batch_size, and the hybrid mode
+                // can take keyswitches off it, so the keyswitches still
+                // pending are counted rather than the batches.
+                if ((KeySwitch_id_ > 0) &&
+                    (buffer_.get_pending_KeySwitch() == 0)) {
+                    KeySwitch_read_output();
+                    KeySwitch_id_ = 0;
+                    KeySwitch_num_ops_ = 0;
                 }
                 break;
             default:
@@ -873,12 +1298,23 @@ bool Device::process_input(int credit_id) {
 
     FPGAObject* fpga_obj = fpga_objects_[credit_id];
 
+    input_wait_seconds_ = 0;
     const auto& start_io = std::chrono::high_resolution_clock::now();
     fpga_obj->fill_in_data(objs);  // poylmorphic call
     const auto& end_io = std::chrono::high_resolution_clock::now();
 
     enqueue_input_data(fpga_obj);
 
+    if (debug_ == 3) {
+        const auto& end_api = std::chrono::high_resolution_clock::now();
+        const auto& duration_api =
+            std::chrono::duration_cast<std::chrono::duration<double>>(end_api -
+                                                                      start_io);
+        host_overhead_.record_input(
+            kernel_name(fpga_obj->type_), fpga_obj->n_batch_,
+            duration_api.count() - input_wait_seconds_);
+    }
+
     if (debug_ == 2) {
         const auto& end_api = std::chrono::high_resolution_clock::now();
         const auto& duration_io =
@@ -958,12 +1394,80 @@ void Device::enqueue_input_data(FPGAObject* fpga_obj) {
 
 void Device::enqueue_input_data_dyadic_multiply(
     FPGAObject_DyadicMultiply* fpga_obj) {
+    // the products of the previous batch of the object are overwritten, so
+    // the keyswitch still reading them has to end first, and the ones not
+    // read by now are read back from the host instead.
+    wait_input(fpga_obj->relinearize_event_);
+    for (auto it = products_map_.begin(); it != products_map_.end();) {
+        if (it->second.fpga_obj_ == fpga_obj) {
+            it = products_map_.erase(it);
+        } else {
+            it++;
+        }
+    }
+
     const auto& start_ocl = std::chrono::high_resolution_clock::now();
-    auto tempEvent = (*(dyadicmult_kernel_container_->input_fifo_usm))(
-        dyadic_multiply_input_queue_, fpga_obj->operand1_in_svm_,
-        fpga_obj->operand2_in_svm_, fpga_obj->n_, fpga_obj->moduli_info_,
-        fpga_obj->n_moduli_, fpga_obj->tag_, fpga_obj->operands_in_ddr_,
-        fpga_obj->results_out_ddr_, fpga_obj->n_batch_);
+    sycl::event tempEvent;
+    if (fpga_obj->tile_keys_) {
+        FPGA_ASSERT(fpga_obj->accumulate_ && fpga_obj->plain_,
+                    "resident keys are only read by tiled KeySwitch");
+        uint64_t* keys = get_tile_keys(fpga_obj->tile_keys_);
+        tempEvent = (*(dyadicmult_kernel_container_
+                           ->input_fifo_accumulate_keys_usm))(
+            dyadic_multiply_input_queue_, keys + fpga_obj->tile_keys_offset_,
+            fpga_obj->operand2_in_svm_, fpga_obj->n_, fpga_obj->moduli_info_,
+            fpga_obj->n_moduli_, fpga_obj->tag_, fpga_obj->operands_in_ddr_,
+            fpga_obj->results_out_ddr_, fpga_obj->n_batch_);
+    } else if (fpga_obj->accumulate_) {
+        auto input_fifo =
+            dyadicmult_kernel_container_->input_fifo_accumulate_usm;
+        FPGA_ASSERT(input_fifo, "the bitstream has no accumulate kernel");
+        tempEvent = (*input_fifo)(
+            dyadic_multiply_input_queue_, fpga_obj->operand1_in_svm_,
+            fpga_obj->operand2_in_svm_, fpga_obj->n_, fpga_obj->moduli_info_,
+            fpga_obj->n_moduli_, fpga_obj->tag_, fpga_obj->operands_in_ddr_,
+            fpga_obj->results_out_ddr_, fpga_obj->n_batch_, fpga_obj->plain_);
+    } else {
+        auto input_fifo = dyadicmult_kernel_container_->input_fifo_usm;
+        if (fpga_obj->plain_) {
+            input_fifo = dyadicmult_kernel_container_->input_fifo_plain_usm;
+            FPGA_ASSERT(input_fifo,
+                        "the bitstream has no ciphertext x plaintext kernel");
+        }
+        tempEvent = (*input_fifo)(
+            dyadic_multiply_input_queue_, fpga_obj->operand1_in_svm_,
+            fpga_obj->operand2_in_svm_, fpga_obj->n_, fpga_obj->moduli_info_,
+            fpga_obj->n_moduli_, fpga_obj->tag_, fpga_obj->operands_in_ddr_,
+            fpga_obj->results_out_ddr_, fpga_obj->n_batch_);
+    }
+
+    // each batch yields exactly one entry of the output pipe, so its readback
+    // is queued right away and completes once the results are in the host
+    // staging buffer of the object.
+    fpga_obj->tag_out_svm_[0] = -1;
+    fpga_obj->results_out_valid_svm_[0] = 0;
+    fpga_obj->output_event_ =
+        (*(dyadicmult_kernel_container_->output_nb_fifo_usm))(
+            dyadic_multiply_output_queue_, fpga_obj->results_out_svm_,
+            fpga_obj->tag_out_svm_, fpga_obj->results_out_valid_svm_);
+
+    // the third polynomials of relinearized products stay where the kernel
+    // wrote them, for the keyswitch that follows.
+    uint64_t frame_number = 0;
+    for (const auto& obj : fpga_obj->in_objs_) {
+        Object_DyadicMultiply* obj_dyadic_multiply =
+            dynamic_cast<Object_DyadicMultiply*>(obj);
+        FPGA_ASSERT(obj_dyadic_multiply);
+        if (obj_dyadic_multiply->relinearize_) {
+            FPGA_ASSERT(!fpga_obj->plain_ && !fpga_obj->accumulate_,
+                        "only ciphertext x ciphertext products relinearize");
+            uint64_t* c2 = fpga_obj->results_out_ddr_ +
+                           (frame_number * 3 + 2) * fpga_obj->n_moduli_ *
+                               fpga_obj->n_;
+            products_map_[obj] = DyadicMemProduct{fpga_obj, c2};
+        }
+        frame_number++;
+    }
 
     if (debug_ == 1) {
         const auto& end_ocl = std::chrono::high_resolution_clock::now();
@@ -983,21 +1487,173 @@ void Device::enqueue_input_data_dyadic_multiply(
     }
 }
 
+// the keys are uploaded on first use and then stay in device memory, like
+// the keys of the keyswitch kernel, up to DYADIC_MAX_TILE_KEYS of them.
+uint64_t* Device::get_tile_keys(const TileKeys* tile_keys) {
+    auto iter = tile_keys_map_.find(tile_keys->id_);
+    if (iter != tile_keys_map_.end()) {
+        iter->second.last_use_ = ++tile_keys_use_;
+        return iter->second.keys_;
+    }
+
+    if (tile_keys_map_.size() >= DYADIC_MAX_TILE_KEYS) {
+        auto lru = tile_keys_map_.begin();
+        for (auto it = tile_keys_map_.begin(); it != tile_keys_map_.end();
+             it++) {
+            if (it->second.last_use_ < lru->second.last_use_) {
+                lru = it;
+            }
+        }
+        // the input kernel of a previous batch may still read the keys.
+        wait_input(dyadic_multiply_input_queue_);
+        free(lru->second.keys_, dyadic_multiply_input_queue_);
+        tile_keys_map_.erase(lru);
+    }
+
+    size_t size = tile_keys->keys_.size();
+    uint64_t* keys =
+        sycl::malloc_device<uint64_t>(size, dyadic_multiply_input_queue_);
+    FPGA_ASSERT(keys, "tile keys device memory allocation failed");
+    wait_input(dyadic_multiply_input_queue_.memcpy(
+        keys, tile_keys->keys_.data(), size * sizeof(uint64_t)));
+    tile_keys_map_.emplace(tile_keys->id_,
+                           DyadicMemKeys{keys, ++tile_keys_use_});
+    return keys;
+}
+
+// the waits of the enqueue path are left out of the host overhead.
+void Device::wait_input(sycl::queue& q) {
+    const auto& start = std::chrono::high_resolution_clock::now();
+    q.wait();
+    input_wait_seconds_ += std::chrono::duration<double>(
+                               std::chrono::high_resolution_clock::now() -
+                               start)
+                               .count();
+}
+
+void Device::wait_input(sycl::event e) {
+    const auto& start = std::chrono::high_resolution_clock::now();
+    e.wait();
+    input_wait_seconds_ += std::chrono::duration<double>(
+                               std::chrono::high_resolution_clock::now() -
+                               start)
+                               .count();
+}
+
+void Device::alloc_twiddles(NTTTwiddlesCache& cache, sycl::queue& q,
+                            uint64_t slot_size) {
+    uint64_t size = NTT_MAX_TWIDDLE_TABLES * slot_size;
+    cache.roots_ = sycl::malloc_device<uint64_t>(size, q);
+    cache.precons_ = sycl::malloc_device<uint64_t>(size, q);
+    FPGA_ASSERT(cache.roots_ && cache.precons_,
+                "twiddle tables device memory allocation failed");
+    cache.slot_size_ = slot_size;
+}
+
+NTTMemTwiddles* Device::get_twiddles(NTTTwiddlesCache& cache, sycl::queue& q,
+                                     uint64_t n, uint64_t modulus,
+                                     const uint64_t* roots,
+                                     const uint64_t* precons,
+                                     uint64_t batch_start) {
+    size_t size = n * sizeof(uint64_t);
+    NTTTwiddlesKey key = std::make_tuple(n, modulus, roots[n - 1]);
+    NTTMemTwiddles* tw = nullptr;
+    auto iter = cache.tables_.find(key);
+    if (iter != cache.tables_.end()) {
+        tw = iter->second;
+        if ((memcmp(tw->host_roots_.data(), roots, size) == 0) &&
+            (memcmp(tw->host_precons_.data(), precons, size) == 0)) {
+            tw->last_use_ = ++twiddle_table_use_;
+            return tw;
+        }
+        FPGA_ASSERT(tw->last_use_ <= batch_start,
+                    "two twiddle tables of the same modulus in one batch");
+    }
+
+    // the input kernel of a previous batch may still read the slot.
+    wait_input(q);
+    if (!tw) {
+        uint32_t slot = static_cast<uint32_t>(cache.tables_.size());
+        if (cache.tables_.size() >= NTT_MAX_TWIDDLE_TABLES) {
+            auto lru = cache.tables_.begin();
+            for (auto it = cache.tables_.begin(); it != cache.tables_.end();
+                 it++) {
+                if (it->second->last_use_ < lru->second->last_use_) {
+                    lru = it;
+                }
+            }
+            FPGA_ASSERT(lru->second->last_use_ <= batch_start,
+                        "too many twiddle tables in one batch");
+            slot = lru->second->slot_;
+            delete lru->second;
+            cache.tables_.erase(lru);
+        }
+        tw = new NTTMemTwiddles();
+        tw->slot_ = slot;
+        cache.tables_.emplace(key, tw);
+    }
+
+    // a new table, or another table under the same key, gets a new id so
+    // that the kernels reload it.
+    uint64_t offset = tw->slot_ * cache.slot_size_;
+    tw->host_roots_.assign(roots, roots + n);
+    tw->host_precons_.assign(precons, precons + n);
+    q.memcpy(cache.roots_ + offset, roots, size);
+    q.memcpy(cache.precons_ + offset, precons, size);
+    wait_input(q);
+    tw->id_ = ++twiddle_table_id_;
+    if (tw->id_ == 0) {
+        tw->id_ = ++twiddle_table_id_;
+    }
+    tw->last_use_ = ++twiddle_table_use_;
+    return tw;
+}
+
+void Device::free_twiddles(NTTTwiddlesCache& cache, sycl::queue& q) {
+    for (auto& t : cache.tables_) {
+        delete t.second;
+    }
+    cache.tables_.clear();
+    free(cache.roots_, q);
+    cache.roots_ = nullptr;
+    free(cache.precons_, q);
+    cache.precons_ = nullptr;
+}
+
 void Device::enqueue_input_data_INTT(FPGAObject_INTT* fpga_obj) {
     unsigned int batch = fpga_obj->n_batch_;
+    FPGA_ASSERT(fpga_obj->n_ <= INTT_max_coeff_count_,
+                "polynomial size exceeds the INTT bitstream maximum");
     const auto& start_ocl = std::chrono::high_resolution_clock::now();
+    // resolve the twiddle table of every frame, the tables of the batch
+    // must stay resident until its input kernel is done.
+    uint64_t batch_start = twiddle_table_use_;
+    uint64_t frame = 0;
+    for (auto& obj : fpga_obj->in_objs_) {
+        Object_INTT* obj_INTT = dynamic_cast<Object_INTT*>(obj);
+        FPGA_ASSERT(obj_INTT);
+        NTTMemTwiddles* tw = get_twiddles(
+            INTT_twiddles_, intt_load_queue_, fpga_obj->n_,
+            obj_INTT->coeff_modulus_, obj_INTT->inv_root_of_unity_powers_,
+            obj_INTT->precon_inv_root_of_unity_powers_, batch_start);
+        fpga_obj->table_id_in_svm_[frame] = tw->id_;
+        fpga_obj->table_slot_in_svm_[frame] = tw->slot_;
+        frame++;
+    }
+    INTT_units_.record(batch);
     auto inttLoadEvent = (*(intt_kernel_container_->intt_input))(
         intt_load_queue_, batch, fpga_obj->coeff_poly_in_svm_,
         fpga_obj->coeff_modulus_in_svm_, fpga_obj->inv_n_in_svm_,
-        fpga_obj->inv_n_w_in_svm_, fpga_obj->inv_root_of_unity_powers_in_svm_,
-        fpga_obj->precon_inv_root_of_unity_powers_in_svm_);
+        fpga_obj->inv_n_w_in_svm_, INTT_twiddles_.roots_,
+        INTT_twiddles_.precons_, fpga_obj->n_, fpga_obj->table_id_in_svm_,
+        fpga_obj->table_slot_in_svm_);
     {
         const auto& end_ocl = std::chrono::high_resolution_clock::now();
         const auto& duration_ocl =
             std::chrono::duration_cast<std::chrono::duration<double>>(
                 end_ocl - start_ocl);
         double unit = 1.0e+6;  // microseconds
-        if (debug_) {
+        if (debug_ == 1) {
             std::cout << "INTT"
                       << " OCL-in      time taken: " << std::fixed
                       << std::setprecision(8) << duration_ocl.count() * unit
@@ -1013,12 +1669,30 @@ void Device::enqueue_input_data_INTT(FPGAObject_INTT* fpga_obj) {
 
 void Device::enqueue_input_data_NTT(FPGAObject_NTT* fpga_obj) {
     unsigned int batch = fpga_obj->n_batch_;
+    FPGA_ASSERT(fpga_obj->n_ <= NTT_max_coeff_count_,
+                "polynomial size exceeds the NTT bitstream maximum");
     const auto& start_ocl = std::chrono::high_resolution_clock::now();
+    // resolve the twiddle table of every frame, the tables of the batch
+    // must stay resident until its input kernel is done.
+    uint64_t batch_start = twiddle_table_use_;
+    uint64_t frame = 0;
+    for (auto& obj : fpga_obj->in_objs_) {
+        Object_NTT* obj_NTT = dynamic_cast<Object_NTT*>(obj);
+        FPGA_ASSERT(obj_NTT);
+        NTTMemTwiddles* tw = get_twiddles(
+            NTT_twiddles_, ntt_load_queue_, fpga_obj->n_,
+            obj_NTT->coeff_modulus_, obj_NTT->root_of_unity_powers_,
+            obj_NTT->precon_root_of_unity_powers_, batch_start);
+        fpga_obj->table_id_in_svm_[frame] = tw->id_;
+        fpga_obj->table_slot_in_svm_[frame] = tw->slot_;
+        frame++;
+    }
+    NTT_units_.record(batch);
     auto nttLoadEvent = (*(ntt_kernel_container_->ntt_input))(
         ntt_load_queue_, batch, fpga_obj->coeff_poly_in_svm_,
         fpga_obj->coeff_poly_in_svm_, fpga_obj->coeff_modulus_in_svm_,
-        fpga_obj->root_of_unity_powers_in_svm_,
-        fpga_obj->precon_root_of_unity_powers_in_svm_);
+        NTT_twiddles_.roots_, NTT_twiddles_.precons_, fpga_obj->n_,
+        fpga_obj->table_id_in_svm_, fpga_obj->table_slot_in_svm_);
     if (debug_ == 1) {
         const auto& end_ocl = std::chrono::high_resolution_clock::now();
         const auto& duration_ocl =
@@ -1046,6 +1720,19 @@ uint64_t Device::precompute_modulus_k(uint64_t modulus) {
     return k;
 }
 
+// r = 2^(2k) / modulus is packed above k, unless the bitstream handles moduli
+// wider than 52 bits: r alone fills the word then, and the device recovers k
+// from its leading bit.
+uint64_t Device::precompute_modulus_rk(uint64_t modulus) {
+    uint64_t k = precompute_modulus_k(modulus);
+    __int128 a = 1;
+    uint64_t r = (a << (2 * k)) / modulus;
+    if (KeySwitch_max_modulus_bits_ > 52) {
+        return r;
+    }
+    return (r << 8) | k;
+}
+
 void Device::build_modulus_meta(FPGAObject_KeySwitch* obj) {
     for (uint64_t i = 0; i < obj->key_modulus_size_; i++) {
         sycl::ulong4 m;
@@ -1059,10 +1746,7 @@ void Device::build_modulus_meta(FPGAObject_KeySwitch* obj) {
         arg2 = ReduceMod<InputModFactor>(arg2, modulus, &twice_modulus,
                                          &four_times_modulus);
         m.s2() = arg2;
-        uint64_t k = precompute_modulus_k(obj->moduli_[i]);
-        __int128 a = 1;
-        uint64_t r = (a << (2 * k)) / obj->moduli_[i];
-        m.s3() = (r << 8) | k;
+        m.s3() = precompute_modulus_rk(obj->moduli_[i]);
         modulus_meta_.data[i] = m;
     }
 }
@@ -1078,10 +1762,7 @@ void Device::build_invn_meta(FPGAObject_KeySwitch* obj) {
         uint64_t y_barrett_nw =
             DivideUInt128UInt64Lo(inv_nw, 0, obj->moduli_[i]);
         invn.s0() = inv_n;
-        unsigned long k = precompute_modulus_k(obj->moduli_[i]);
-        __int128 a = 1;
-        unsigned long r = (a << (2 * k)) / obj->moduli_[i];
-        invn.s1() = (r << 8) | k;
+        invn.s1() = precompute_modulus_rk(obj->moduli_[i]);
         invn.s2() = y_barrett_n;
         invn.s3() = y_barrett_nw;
         invn_.data[i] = invn;
@@ -1090,8 +1771,8 @@ void Device::build_invn_meta(FPGAObject_KeySwitch* obj) {
 
 void Device::KeySwitch_load_twiddles(FPGAObject_KeySwitch* obj) {
     size_t roots_size = obj->n_ * obj->key_modulus_size_ * 4 * sizeof(uint64_t);
-    root_of_unity_powers_ptr_ =
-        (uint64_t*)aligned_alloc(HOST_MEM_ALIGNMENT, roots_size);
+    root_of_unity_powers_ptr_ = static_cast<uint64_t*>(
+        HostMemoryPool::instance().allocate(roots_size, numa_node_));
     if (obj->twiddle_factors_) {
         memcpy(root_of_unity_powers_ptr_, obj->twiddle_factors_, roots_size);
     } else {
@@ -1145,13 +1826,13 @@ KeySwitchMemKeys<t_type>::~KeySwitchMemKeys() {
         // delete k_switch_keys_3_;
     }
     if (host_k_switch_keys_1_) {
-        delete host_k_switch_keys_1_;
+        HostMemoryPool::instance().release(host_k_switch_keys_1_);
     }
     if (host_k_switch_keys_2_) {
-        delete host_k_switch_keys_2_;
+        HostMemoryPool::instance().release(host_k_switch_keys_2_);
     }
     if (host_k_switch_keys_3_) {
-        delete host_k_switch_keys_3_;
+        HostMemoryPool::instance().release(host_k_switch_keys_3_);
     }
 }
 
@@ -1166,88 +1847,93 @@ KeySwitchMemKeys<uint256_t>* Device::KeySwitch_check_keys(uint64_t** keys) {
 
 KeySwitchMemKeys<uint256_t>* Device::KeySwitch_load_keys(
     FPGAObject_KeySwitch* obj) {
-    uint256_t* key_vector1 = (uint256_t*)aligned_alloc(
-        HOST_MEM_ALIGNMENT,
-        sizeof(uint256_t) * obj->decomp_modulus_size_ * obj->n_);
-    uint256_t* key_vector2 = (uint256_t*)aligned_alloc(
-        HOST_MEM_ALIGNMENT,
-        sizeof(uint256_t) * obj->decomp_modulus_size_ * obj->n_);
-    uint256_t* key_vector3 = (uint256_t*)aligned_alloc(
-        HOST_MEM_ALIGNMENT,
-        sizeof(uint256_t) * obj->decomp_modulus_size_ * obj->n_);
-
+    const uint64_t key_bits = KeySwitch_max_modulus_bits_;
+    const uint64_t limb_bits = 64;
+    const uint64_t word_limbs = sizeof(uint256_t) / sizeof(uint64_t);
+    const uint64_t n_keys = MAX_RNS_MODULUS_SIZE * 2;
+    const uint64_t n_words =
+        (n_keys * key_bits + word_limbs * limb_bits - 1) /
+        (word_limbs * limb_bits);
+    const uint64_t n_rows =
+        (n_words + KEYSWITCH_KEY_BUFFERS - 1) / KEYSWITCH_KEY_BUFFERS;
+
+    size_t key_size = obj->decomp_modulus_size_ * obj->n_ * n_rows;
+    size_t key_vector_size = sizeof(uint256_t) * key_size;
+    HostMemoryPool& pool = HostMemoryPool::instance();
+    uint256_t* key_vectors[KEYSWITCH_KEY_BUFFERS];
+    for (int b = 0; b < KEYSWITCH_KEY_BUFFERS; b++) {
+        key_vectors[b] =
+            (uint256_t*)pool.allocate(key_vector_size, numa_node_);
+        memset(static_cast<void*>(key_vectors[b]), 0, key_vector_size);
+    }
+
+    std::vector<uint64_t> limbs(n_words * word_limbs);
     size_t key_vector_index = 0;
     for (uint64_t k = 0; k < obj->decomp_modulus_size_; k++) {
         for (uint64_t j = 0; j < obj->n_; j++) {
-            DyadmultKeys1_t k1 = {};
-            DyadmultKeys2_t k2 = {};
-            DyadmultKeys3_t k3 = {};
+            std::fill(limbs.begin(), limbs.end(), 0);
+            // the two key components of a modulus are adjacent
             for (uint64_t i = 0; i < obj->key_modulus_size_; i++) {
-                uint64_t key1 = obj->k_switch_keys_[k][i * obj->n_ + j];
-                uint64_t key2 =
-                    obj->k_switch_keys_[k]
-                                       [(i + obj->key_modulus_size_) * obj->n_ +
-                                        j];
-                if (i == 0) {
-                    k1.key1 = key1;
-                    k1.key2 = key2;
-                } else if (i == 1) {
-                    k1.key3 = key1;
-                    k1.key4 = key2;
-                } else if (i == 2) {
-                    k1.key5 = key1 & BIT_MASK(48);
-                    k2.key1 = (key1 >> 48) & BIT_MASK(4);
-                    k2.key2 = key2;
-                } else if (i == 3) {
-                    k2.key3 = key1;
-                    k2.key4 = key2;
-                } else if (i == 4) {
-                    k2.key5 = key1;
-                    k2.key6 = key2 & BIT_MASK(44);
-                    k3.key1 = (key2 >> 44) & BIT_MASK(8);
-                } else if (i == 5) {
-                    k3.key2 = key1;
-                    k3.key3 = key2;
-                } else if (i == 6) {
-                    k3.key4 = key1;
-                    k3.key5 = key2;
-                    k3.NOT_USED = 0;
-                } else {
-                    FPGA_ASSERT(0, "NOT SUPPORTED KEYS");
+                for (uint64_t c = 0; c < 2; c++) {
+                    uint64_t key =
+                        obj->k_switch_keys_[k]
+                                           [(i + c * obj->key_modulus_size_) *
+                                                obj->n_ +
+                                            j];
+                    uint64_t pos = (i * 2 + c) * key_bits;
+                    uint64_t shift = pos % limb_bits;
+                    limbs[pos / limb_bits] |= key << shift;
+                    if (shift + key_bits > limb_bits) {
+                        limbs[pos / limb_bits + 1] |=
+                            key >> (limb_bits - shift);
+                    }
                 }
             }
-            key_vector1[key_vector_index] = *((uint256_t*)(&k1));
-            key_vector2[key_vector_index] = *((uint256_t*)(&k2));
-            key_vector3[key_vector_index] = *((uint256_t*)(&k3));
+            for (uint64_t w = 0; w < n_words; w++) {
+                uint64_t row = key_vector_index * n_rows +
+                               w / KEYSWITCH_KEY_BUFFERS;
+                memcpy(static_cast<void*>(
+                           &key_vectors[w % KEYSWITCH_KEY_BUFFERS][row]),
+                       &limbs[w * word_limbs], sizeof(uint256_t));
+            }
             key_vector_index++;
         }
     }
-    size_t key_size = obj->decomp_modulus_size_ * obj->n_;
     sycl::buffer<uint256_t>* k_switch_keys_1 =
-        new sycl::buffer(key_vector1, sycl::range(key_size),
+        new sycl::buffer(key_vectors[0], sycl::range(key_size),
                          {sycl::property::buffer::use_host_ptr{},
                           sycl::property::buffer::mem_channel{MEM_CHANNEL_K2}});
     k_switch_keys_1->set_write_back(false);
     sycl::buffer<uint256_t>* k_switch_keys_2 =
-        new sycl::buffer(key_vector2, sycl::range(key_size),
+        new sycl::buffer(key_vectors[1], sycl::range(key_size),
                          {sycl::property::buffer::use_host_ptr{},
                           sycl::property::buffer::mem_channel{MEM_CHANNEL_K3}});
     k_switch_keys_2->set_write_back(false);
     sycl::buffer<uint256_t>* k_switch_keys_3 =
-        new sycl::buffer(key_vector3, sycl::range(key_size),
+        new sycl::buffer(key_vectors[2], sycl::range(key_size),
                          {sycl::property::buffer::use_host_ptr{},
                           sycl::property::buffer::mem_channel{MEM_CHANNEL_K4}});
     k_switch_keys_3->set_write_back(false);
 
     KeySwitchMemKeys<uint256_t>* keys = new KeySwitchMemKeys<uint256_t>(
-        k_switch_keys_1, k_switch_keys_2, k_switch_keys_3, key_vector1,
-        key_vector2, key_vector3);
+        k_switch_keys_1, k_switch_keys_2, k_switch_keys_3, key_vectors[0],
+        key_vectors[1], key_vectors[2]);
 
     keys_map_.emplace(obj->k_switch_keys_, keys);
     return keys;
 }
 
 void Device::enqueue_input_data_KeySwitch(FPGAObject_KeySwitch* fpga_obj) {
+    FPGA_ASSERT(fpga_obj->n_ <= KeySwitch_max_coeff_count_,
+                "n is larger than the keyswitch bitstream supports, use "
+                "libkeyswitch_32k.so for n = 32768");
+    for (uint64_t i = 0; i < fpga_obj->key_modulus_size_; i++) {
+        FPGA_ASSERT(fpga_obj->moduli_[i] < (1UL << KeySwitch_max_modulus_bits_),
+                    "moduli are wider than the keyswitch bitstream supports, "
+                    "use libkeyswitch_60.so for moduli of up to 60 bits");
+    }
+    FPGA_ASSERT((KeySwitch_max_modulus_bits_ <= 52) || (fpga_obj->n_ >= 4096),
+                "the 60-bit keyswitch bitstream requires n >= 4096");
     if (!KeySwitch_load_once_) {
         // info: compute and store roots of unity in a table
         // info: also create a sycl buffer
@@ -1276,7 +1962,10 @@ void Device::enqueue_input_data_KeySwitch(FPGAObject_KeySwitch* fpga_obj) {
         fpga_obj->in_objs_.size());
 
     int obj_id = KeySwitch_id_ % 2;
-    copyKeySwitchBatch(fpga_obj, obj_id);
+    bool resident = KeySwitch_products_resident(fpga_obj);
+    if (!resident) {
+        copyKeySwitchBatch(fpga_obj, obj_id);
+    }
 
     // copy_buffer_to_device() and wait() is a utility to force blocked write,
     // and to facilitate performance measure on FPGA.
@@ -1293,12 +1982,16 @@ void Device::enqueue_input_data_KeySwitch(FPGAObject_KeySwitch* fpga_obj) {
         rmem = 1;
     }
     const auto& start_ocl = std::chrono::high_resolution_clock::now();
-    KeySwitch_events_enqueue_[obj_id][0] =
-        (*(KeySwitch_kernel_container_->load))(
-            keyswitch_queues_[KEYSWITCH_LOAD], nullptr,
-            *(fpga_obj->mem_t_target_iter_ptr_), modulus_meta_, fpga_obj->n_,
-            fpga_obj->decomp_modulus_size_, fpga_obj->n_batch_,
-            (*(invn_t*)(void*)&invn_), rmem);
+    if (resident) {
+        KeySwitch_load_products(fpga_obj, obj_id, rmem);
+    } else {
+        KeySwitch_events_enqueue_[obj_id][0] =
+            (*(KeySwitch_kernel_container_->load))(
+                keyswitch_queues_[KEYSWITCH_LOAD], nullptr,
+                *(fpga_obj->mem_t_target_iter_ptr_), modulus_meta_,
+                fpga_obj->n_, fpga_obj->decomp_modulus_size_,
+                fpga_obj->n_batch_, (*(invn_t*)(void*)&invn_), rmem);
+    }
 
     if (debug_ == 1) {
         const auto& end_ocl = std::chrono::high_resolution_clock::now();
@@ -1320,37 +2013,46 @@ void Device::enqueue_input_data_KeySwitch(FPGAObject_KeySwitch* fpga_obj) {
 
 bool Device::process_output() {
     bool rsl = false;
-    rsl |= process_output_dyadic_multiply();
+    // without credit left nothing else can be submitted, so block on the
+    // oldest batch instead of spinning.
+    rsl |= process_output_dyadic_multiply(credit_ == 0);
     return rsl;
 }
 
-bool Device::process_output_dyadic_multiply() {
+bool Device::process_output_dyadic_multiply(bool blocking) {
     bool rsl = false;
 
-    dyadic_multiply_tag_out_svm_[0] = -1;
-    dyadic_multiply_results_out_valid_svm_[0] = 0;
+    // the oldest batch in flight always sits in the first slot, and the
+    // output pipe returns the batches in submission order.
+    FPGAObject_DyadicMultiply* oldest =
+        dynamic_cast<FPGAObject_DyadicMultiply*>(fpga_objects_[0]);
+    FPGA_ASSERT(oldest);
+
     const auto& start_ocl = std::chrono::high_resolution_clock::now();
-    auto tempEvent = (*(dyadicmult_kernel_container_->output_nb_fifo_usm))(
-        dyadic_multiply_output_queue_, dyadic_multiply_results_out_svm_,
-        dyadic_multiply_tag_out_svm_, dyadic_multiply_results_out_valid_svm_);
-    dyadic_multiply_output_queue_.wait();
+    if (blocking) {
+        oldest->output_event_.wait();
+    } else if (oldest->output_event_.get_info<
+                   sycl::info::event::command_execution_status>() !=
+               sycl::info::event_command_status::complete) {
+        return rsl;
+    }
     const auto& end_ocl = std::chrono::high_resolution_clock::now();
 
-    if (*dyadic_multiply_results_out_valid_svm_ == 1) {
-        FPGA_ASSERT(dyadic_multiply_tag_out_svm_[0] >= 0);
+    if (*oldest->results_out_valid_svm_ == 1) {
+        FPGA_ASSERT(oldest->tag_out_svm_[0] >= 0);
 
         const auto& start_io = std::chrono::high_resolution_clock::now();
-        FPGAObject* completed = nullptr;
+        FPGAObject_DyadicMultiply* completed = nullptr;
         for (int credit = 0; credit < CREDIT; credit++) {
-            if (fpga_objects_[credit]->tag_ ==
-                dyadic_multiply_tag_out_svm_[0]) {
-                completed = fpga_objects_[credit];
+            if (fpga_objects_[credit]->tag_ == oldest->tag_out_svm_[0]) {
+                completed = dynamic_cast<FPGAObject_DyadicMultiply*>(
+                    fpga_objects_[credit]);
                 break;
             }
         }
 
         if (completed) {
-            completed->fill_out_data(dyadic_multiply_results_out_svm_);
+            completed->fill_out_data(oldest->results_out_svm_);
             completed->recycle();
             rsl = true;
 
@@ -1372,6 +2074,10 @@ bool Device::process_output_dyadic_multiply() {
                         end_io - start_ocl);
 
                 double unit = 1.0e+6;  // microseconds
+                if (debug_ == 3) {
+                    host_overhead_.record_output("DYADIC_MULTIPLY",
+                                                 duration_io.count());
+                }
                 if (debug_ == 1) {
                     std::cout << "DYADIC_MULTIPLY OCL-out     time taken: "
                               << std::fixed << std::setprecision(8)
@@ -1413,7 +2119,7 @@ bool Device::process_output_NTT() {
 
     const auto& start_ocl = std::chrono::high_resolution_clock::now();
     auto nttStoreEvent = (*(ntt_kernel_container_->ntt_output))(
-        ntt_store_queue_, batch, NTT_coeff_poly_svm_);
+        ntt_store_queue_, batch, NTT_coeff_poly_svm_, kernel_inf->n_);
 
     ntt_store_queue_.wait();
     const auto& end_ocl = std::chrono::high_resolution_clock::now();
@@ -1435,6 +2141,9 @@ bool Device::process_output_NTT() {
                 end_io - start_ocl);
 
         double unit = 1.0e+6;  // microseconds
+        if (debug_ == 3) {
+            host_overhead_.record_output("NTT", duration_io.count());
+        }
         if (debug_ == 1) {
             std::cout << "NTT OCL-out     time taken: " << std::fixed
                       << std::setprecision(8) << duration_ocl.count() * unit
@@ -1472,7 +2181,7 @@ bool Device::process_output_INTT() {
     const auto& start_ocl = std::chrono::high_resolution_clock::now();
 
     auto inttLoadEvent = (*(intt_kernel_container_->intt_output))(
-        intt_store_queue_, batch, INTT_coeff_poly_svm_);
+        intt_store_queue_, batch, INTT_coeff_poly_svm_, kernel_inf->n_);
     intt_store_queue_.wait();
     const auto& end_ocl = std::chrono::high_resolution_clock::now();
     const auto& start_io = std::chrono::high_resolution_clock::now();
@@ -1491,6 +2200,9 @@ bool Device::process_output_INTT() {
                 end_io - start_ocl);
 
         double unit = 1.0e+6;  // microseconds
+        if (debug_ == 3) {
+            host_overhead_.record_output("INTT", duration_io.count());
+        }
         if (debug_ == 1) {
             std::cout << "INTT OCL-out     time taken: " << std::fixed
                       << std::setprecision(8) << duration_ocl.count() * unit
@@ -1538,10 +2250,21 @@ void Device::KeySwitch_read_output() {
     std::cout << "KeySwitch KeySwitch_read_output latency: "
               << (lat_end - lat_start) / 1e6 << std::endl;
 #endif
+    // the accessor waits for the kernel, which is not host overhead
     sycl::host_accessor result_access(*(peer_obj->mem_KeySwitch_results_));
+    const auto& start_io = std::chrono::high_resolution_clock::now();
     memcpy(peer_obj->ms_output_, result_access.get_pointer(), result_size);
     peer->fill_out_data(peer_obj->ms_output_);
     peer->recycle();
+    // the last batch of a call is read from the run loop, so that the time
+    // is accounted for here rather than in process_output_KeySwitch.
+    if (debug_ == 3) {
+        const auto& end_io = std::chrono::high_resolution_clock::now();
+        const auto& duration_io =
+            std::chrono::duration_cast<std::chrono::duration<double>>(end_io -
+                                                                      start_io);
+        host_overhead_.record_output("KEYSWITCH", duration_io.count());
+    }
 }
 bool Device::process_output_KeySwitch() {
     int obj_id = KeySwitch_id_ % 2;
@@ -1682,6 +2405,7 @@ DevicePool::~DevicePool() {
     }
     delete[] devices_;
     devices_ = nullptr;
+    HostMemoryPool::instance().report(std::cout);
 }
 
 }  // namespace fpga
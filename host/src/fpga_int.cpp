@@ -1,26 +1,36 @@
 // Copyright (C) 2020-2021 Intel Corporation
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <future>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
+#include "cpu_backend.h"
 #include "dyadic_multiply_int.h"
 #include "fpga.h"
 #include "fpga_assert.h"
+#include "hybrid_scheduler.h"
 #include "intt_int.h"
 #include "keyswitch_int.h"
+#include "multiply_relinearize_int.h"
 #include "ntt_int.h"
-
-#ifdef FPGA_USE_INTEL_HEXL
-#include "hexl/hexl.hpp"
-#endif
+#include "number_theory_util.h"
+#include "rescale_int.h"
+#include "rotate_int.h"
+#include "transform_int.h"
 
 namespace intel {
 namespace hexl {
@@ -30,10 +40,22 @@ static std::mutex muNTT;
 static std::mutex muINTT;
 static std::mutex muDyadicMultiply;
 static std::mutex muKeySwitch;
+static std::mutex muGalois;
+static std::mutex muTwiddles;
+static std::mutex muTileKeys;
+static std::mutex muTransformPlans;
+// guards the outstanding objects below, which a Completed function scans
+// while other threads queue more. A synchronous caller holds the mutex of
+// its kernel from the worksize check through the Completed call.
+static std::mutex muOutstanding;
 static std::unordered_set<Object*> outstanding_objects_DyadicMultiply;
 static std::unordered_set<Object*> outstanding_objects_NTT;
 static std::unordered_set<Object*> outstanding_objects_INTT;
 static std::unordered_set<Object*> outstanding_objects_KeySwitch;
+// twiddle tables, keyed by modulus and last twiddle factor like the device
+// cache, of the NTT, and INTT, batch being queued
+static std::set<std::pair<uint64_t, uint64_t>> batch_tables_NTT;
+static std::set<std::pair<uint64_t, uint64_t>> batch_tables_INTT;
 static DevicePool* pool;
 static std::promise<bool> exit_signal;
 
@@ -47,7 +69,8 @@ static DEV_TYPE get_device() {
     }
     switch (d) {
     case CPU:
-        std::cout << "Running using HEXL CPU ..." << std::endl;
+        std::cout << "Running using CPU (" << cpu_isa_name(cpu_isa()) << ", "
+                  << cpu_num_threads() << " threads) ..." << std::endl;
         break;
     case EMU:
         std::cout << "Running using FPGA Emulator ..." << std::endl;
@@ -120,6 +143,14 @@ static uint64_t get_batch_size_KeySwitch() {
 
 static uint64_t g_batch_size_KeySwitch = get_batch_size_KeySwitch();
 
+static bool get_keyswitch_tiled() {
+    char* env = getenv("FPGA_KERNEL");
+    bool tiled = env && (strcmp(env, "KEYSWITCH_TILED") == 0);
+    return tiled;
+}
+
+static bool g_keyswitch_tiled = get_keyswitch_tiled();
+
 static uint32_t get_fpga_debug() {
     char* env = getenv("FPGA_DEBUG");
     uint32_t debug = env ? atoi(env) : 0;
@@ -128,6 +159,44 @@ static uint32_t get_fpga_debug() {
 
 static uint32_t g_fpga_debug = get_fpga_debug();
 
+// the API side of the host overhead, with env(FPGA_DEBUG)=3, from every
+// calling thread
+static std::mutex muApiOverhead;
+static HostOverheadStats api_overhead;
+
+// times the queuing of ops objects of kernel with env(FPGA_DEBUG)=3: their
+// creation and fence checks, and their push to the buffer and to the
+// outstanding objects, with the locks of both. The time ends at stop(), or
+// when the timer goes out of scope.
+class ApiOverheadTimer {
+public:
+    ApiOverheadTimer(const char* kernel, uint64_t ops)
+        : kernel_(kernel), ops_(ops), running_(g_fpga_debug == 3) {
+        if (running_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~ApiOverheadTimer() { stop(); }
+
+    void stop() {
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start_)
+                             .count();
+        std::lock_guard<std::mutex> locker(muApiOverhead);
+        api_overhead.record_api(kernel_, ops_, seconds);
+    }
+
+private:
+    const char* kernel_;
+    uint64_t ops_;
+    bool running_;
+    std::chrono::steady_clock::time_point start_;
+};
+
 static uint32_t get_fpga_bufsize() {
     char* env = getenv("FPGA_BUFSIZE");
     uint32_t bufsize = env ? atoi(env) : 1024;
@@ -147,6 +216,11 @@ void attach_fpga_pooling() {
     }
     std::cout << "Running on FPGA: Creating Static FPGA Device Context ... "
               << std::endl;
+    if (HybridScheduler::instance().enabled()) {
+        std::cout << "Hybrid mode: sharing the batches with the CPU ("
+                  << cpu_isa_name(cpu_isa()) << ", " << cpu_num_threads()
+                  << " threads) ..." << std::endl;
+    }
     exit_signal = std::promise<bool>();
     auto f = exit_signal.get_future();
     pool =
@@ -162,69 +236,282 @@ void detach_fpga_pooling() {
     exit_signal.set_value(true);
     delete pool;
     pool = nullptr;
+    if (g_fpga_debug == 3) {
+        std::lock_guard<std::mutex> locker(muApiOverhead);
+        api_overhead.report_api(std::cout);
+    }
+    if (HybridScheduler::instance().enabled()) {
+        HybridScheduler::instance().report(std::cout);
+    }
+}
+
+// Hybrid mode: a batch of count inputs is split between the device, which
+// runs inputs [0, device_count) queued by device(device_count), and the cpu
+// backend, which runs the others through cpu(i) on its own threads at the
+// same time. A synchronous batch sets the worksize of kernel to the device
+// share and waits for it with wait(); the time of each side is recorded for
+// the next split. With an asynchronous worksize set by the caller, the cpu
+// share is taken off that worksize and run before returning, while the
+// device works through its share in the background, to be waited for by the
+// Completed call of the caller; only the time of the cpu is known then.
+// Returns false, having run nothing, when the hybrid mode is off. mu, the
+// mutex of the kernel, is held while the device share is queued, so that
+// device() queues without locking it.
+template <typename DeviceFn, typename CpuFn, typename WaitFn>
+static bool run_hybrid(const char* op, kernel_t kernel, uint64_t count,
+                       std::mutex& mu, DeviceFn device, CpuFn cpu,
+                       WaitFn wait) {
+    HybridScheduler& scheduler = HybridScheduler::instance();
+    if (!scheduler.enabled() || (count == 0)) {
+        return false;
+    }
+    auto run_cpu = [&](uint64_t device_count, uint64_t cpu_count) {
+        auto start = std::chrono::steady_clock::now();
+        cpu_parallel_for(cpu_count, [&](uint64_t i) { cpu(device_count + i); });
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+            .count();
+    };
+
+    std::unique_lock<std::mutex> locker(mu);
+    uint64_t cpu_count = scheduler.cpu_count(op, count);
+    uint64_t device_count = count - cpu_count;
+
+    if (fpga_buffer.get_worksize(kernel) != 1) {
+        fpga_buffer.cancel_work(kernel, cpu_count);
+        if (device_count) {
+            device(device_count);
+        }
+        locker.unlock();
+        double cpu_seconds = cpu_count ? run_cpu(device_count, cpu_count) : 0;
+        scheduler.record(op, cpu_count, cpu_seconds, 0, 0);
+        return true;
+    }
+
+    std::future<double> cpu_seconds;
+    if (cpu_count) {
+        cpu_seconds = std::async(std::launch::async, run_cpu, device_count,
+                                 cpu_count);
+    }
+    double device_seconds = 0;
+    if (device_count) {
+        auto start = std::chrono::steady_clock::now();
+        fpga_buffer.set_worksize(kernel, device_count);
+        device(device_count);
+        wait();
+        device_seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    }
+
+    scheduler.record(op, cpu_count, cpu_count ? cpu_seconds.get() : 0,
+                     device_count, device_seconds);
+    return true;
+}
+
+// deletes the outstanding objects as they get ready, until none is left.
+// muOutstanding is released between the scans, so that other threads can
+// queue objects meanwhile.
+static bool wait_outstanding(std::unordered_set<Object*>& outstanding) {
+    bool all_done = false;
+    while (!all_done) {
+        std::lock_guard<std::mutex> locker(muOutstanding);
+        bool done = true;
+        auto iter = outstanding.begin();
+        while (iter != outstanding.end()) {
+            Object* obj = *iter;
+            if (obj->ready_) {
+                delete obj;
+                obj = nullptr;
+                iter = outstanding.erase(iter);
+            } else {
+                done = false;
+                iter++;
+            }
+        }
+        all_done = done;
+    }
+    return all_done;
 }
 
 void set_worksize_DyadicMultiply_int(uint64_t n) {
     fpga_buffer.set_worksize_DyadicMultiply(n);
 }
 
-static void fpga_DyadicMultiply(uint64_t* results, const uint64_t* operand1,
-                                const uint64_t* operand2, uint64_t n,
-                                const uint64_t* moduli, uint64_t n_moduli) {
-    std::lock_guard<std::mutex> locker(muDyadicMultiply);
-
-    bool fence = (fpga_buffer.size() == 0);
+// ciphertext x ciphertext and ciphertext x plaintext objects are staged
+// differently, so they never share a device batch. An accumulation starts a
+// new device batch, and so does the first object after it.
+static bool fence_DyadicMultiply(bool plain, bool accumulate) {
+    bool fence = (fpga_buffer.size() == 0) || accumulate;
 
     if (!fence) {
         Object* obj = fpga_buffer.back();
         fence |= (obj->type_ != kernel_t::DYADIC_MULTIPLY);
+        if (!fence) {
+            Object_DyadicMultiply* obj_dyadic_multiply =
+                dynamic_cast<Object_DyadicMultiply*>(obj);
+            fence |= (obj_dyadic_multiply->plain_ != plain) ||
+                     obj_dyadic_multiply->accumulate_;
+        }
     }
+    return fence;
+}
+
+static void fpga_DyadicMultiply(uint64_t* results, const uint64_t* operand1,
+                                const uint64_t* operand2, uint64_t n,
+                                const uint64_t* moduli, uint64_t n_moduli,
+                                bool plain = false) {
+    ApiOverheadTimer timer("DYADIC_MULTIPLY", 1);
+    std::lock_guard<std::mutex> locker(muDyadicMultiply);
+
+    bool fence = fence_DyadicMultiply(plain, false);
 
     Object* obj = new Object_DyadicMultiply(results, operand1, operand2, n,
-                                            moduli, n_moduli, fence);
+                                            moduli, n_moduli, fence, plain);
 
     fpga_buffer.push(obj);
 
-    outstanding_objects_DyadicMultiply.insert(obj);
+    {
+        std::lock_guard<std::mutex> outstanding_locker(muOutstanding);
+        outstanding_objects_DyadicMultiply.insert(obj);
+    }
 
+    timer.stop();
     if (fpga_buffer.get_worksize_DyadicMultiply() == 1) {
         DyadicMultiplyCompleted_int();
     }
 }
 
+// queues count multiplications, with muDyadicMultiply held by the caller.
+static void push_DyadicMultiplyBatch(
+    uint64_t** results, const uint64_t** operand1, const uint64_t** operand2,
+    uint64_t count, uint64_t n, const uint64_t* moduli, uint64_t n_moduli,
+    bool plain = false, bool accumulate = false,
+    const TileKeys* tile_keys = nullptr,
+    const Object_DyadicMultiply** relinearized = nullptr) {
+    ApiOverheadTimer timer("DYADIC_MULTIPLY", count);
+    bool fence = fence_DyadicMultiply(plain, accumulate);
+
+    // the objects of relinearized products are returned in relinearized, for
+    // the keyswitches reading their third polynomials.
+    std::vector<Object*> objs;
+    objs.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        Object_DyadicMultiply* obj = new Object_DyadicMultiply(
+            results[i], operand1[i], operand2[i], n, moduli, n_moduli,
+            fence && (i == 0), plain, accumulate, tile_keys,
+            relinearized != nullptr);
+        if (relinearized) {
+            relinearized[i] = obj;
+        }
+        objs.push_back(obj);
+    }
+
+    fpga_buffer.push_batch(objs);
+
+    std::lock_guard<std::mutex> outstanding_locker(muOutstanding);
+    outstanding_objects_DyadicMultiply.insert(objs.begin(), objs.end());
+}
+
+static void fpga_DyadicMultiplyBatch(uint64_t** results,
+                                     const uint64_t** operand1,
+                                     const uint64_t** operand2,
+                                     uint64_t count, uint64_t n,
+                                     const uint64_t* moduli,
+                                     uint64_t n_moduli, bool plain = false,
+                                     bool accumulate = false) {
+    std::lock_guard<std::mutex> locker(muDyadicMultiply);
+
+    // a synchronous caller gets the whole batch grouped into device batches
+    // of n_batch_ multiplications instead of one launch per multiplication.
+    bool sync = (fpga_buffer.get_worksize_DyadicMultiply() == 1);
+    if (sync) {
+        fpga_buffer.set_worksize_DyadicMultiply(count);
+    }
+
+    push_DyadicMultiplyBatch(results, operand1, operand2, count, n, moduli,
+                             n_moduli, plain, accumulate);
+
+    if (sync) {
+        DyadicMultiplyCompleted_int();
+    }
+}
+
+// products of the polynomials of one modulus: the polynomials of the
+// operands are stride words apart, the ones of results results_stride words
+// apart. A plaintext operand2 has a single polynomial.
+static void cpu_dyadic_multiply_modulus(uint64_t* results,
+                                        const uint64_t* operand1,
+                                        const uint64_t* operand2, uint64_t n,
+                                        uint64_t stride,
+                                        uint64_t results_stride,
+                                        uint64_t modulus, bool plain) {
+    const uint64_t* a0 = operand1;
+    const uint64_t* a1 = operand1 + stride;
+    uint64_t* r0 = results;
+    uint64_t* r1 = results + results_stride;
+
+    if (plain) {
+        cpu_multiply_mod(r0, a0, operand2, n, modulus);
+        cpu_multiply_mod(r1, a1, operand2, n, modulus);
+        return;
+    }
+
+    const uint64_t* b0 = operand2;
+    const uint64_t* b1 = operand2 + stride;
+    uint64_t* r2 = results + 2 * results_stride;
+    std::vector<uint64_t> cross(n);
+    cpu_multiply_mod(r0, a0, b0, n, modulus);
+    cpu_multiply_mod(r1, a0, b1, n, modulus);
+    cpu_multiply_mod(cross.data(), a1, b0, n, modulus);
+    cpu_add_mod(r1, r1, cross.data(), n, modulus);
+    cpu_multiply_mod(r2, a1, b1, n, modulus);
+}
+
 static void cpu_DyadicMultiply(uint64_t* results, const uint64_t* operand1,
                                const uint64_t* operand2, uint64_t n,
                                const uint64_t* moduli, uint64_t n_moduli) {
-    FPGA_ASSERT(g_choice == CPU);
+    for (uint64_t m = 0; m < n_moduli; m++) {
+        cpu_dyadic_multiply_modulus(results + m * n, operand1 + m * n,
+                                    operand2 + m * n, n, n_moduli * n,
+                                    n_moduli * n, moduli[m], false);
+    }
+}
 
-#ifdef FPGA_USE_INTEL_HEXL
-    namespace ns = intel::hexl::internal;
-    ns::DyadicMultiply(results, operand1, operand2, n, moduli, n_moduli);
-#else
-    std::cerr << "HEXL CPU version not supported" << std::endl;
-    exit(1);
-#endif
+static void cpu_MultiplyPlain(uint64_t* results, const uint64_t* ciphertext,
+                              const uint64_t* plaintext, uint64_t n,
+                              const uint64_t* moduli, uint64_t n_moduli) {
+    for (uint64_t m = 0; m < n_moduli; m++) {
+        cpu_dyadic_multiply_modulus(results + m * n, ciphertext + m * n,
+                                    plaintext + m * n, n, n_moduli * n,
+                                    n_moduli * n, moduli[m], true);
+    }
 }
 
-bool DyadicMultiplyCompleted_int() {
-    bool all_done = false;
-    while (!all_done) {
-        bool done = true;
-        auto iter = outstanding_objects_DyadicMultiply.begin();
-        while (iter != outstanding_objects_DyadicMultiply.end()) {
-            Object* obj = *iter;
-            if (obj->ready_) {
-                delete obj;
-                obj = nullptr;
-                iter = outstanding_objects_DyadicMultiply.erase(iter);
-            } else {
-                done = false;
-                iter++;
+// the moduli are summed on separate threads.
+static void cpu_DyadicMultiplyAccumulate(uint64_t* results,
+                                         const uint64_t** operand1,
+                                         const uint64_t** operand2,
+                                         uint64_t count, uint64_t n,
+                                         const uint64_t* moduli,
+                                         uint64_t n_moduli, bool plain) {
+    uint64_t n_polys = plain ? 2 : 3;
+    cpu_parallel_for(n_moduli, [&](uint64_t m) {
+        std::vector<uint64_t> product(n_polys * n);
+        for (uint64_t i = 0; i < count; i++) {
+            cpu_dyadic_multiply_modulus(product.data(), operand1[i] + m * n,
+                                        operand2[i] + m * n, n, n_moduli * n,
+                                        n, moduli[m], plain);
+            for (uint64_t p = 0; p < n_polys; p++) {
+                uint64_t* sum = results + (p * n_moduli + m) * n;
+                cpu_add_mod(sum, sum, product.data() + p * n, n, moduli[m]);
             }
         }
-        all_done = done;
-    }
-    outstanding_objects_DyadicMultiply.clear();
+    });
+}
+
+bool DyadicMultiplyCompleted_int() {
+    bool all_done = wait_outstanding(outstanding_objects_DyadicMultiply);
 
     fpga_buffer.set_worksize_DyadicMultiply(1);
 
@@ -251,15 +538,153 @@ void DyadicMultiply_int(uint64_t* results, const uint64_t* operand1,
     }
 }
 
+void DyadicMultiplyBatch_int(uint64_t** results, const uint64_t** operand1,
+                             const uint64_t** operand2, uint64_t count,
+                             uint64_t n, const uint64_t* moduli,
+                             uint64_t n_moduli) {
+    switch (g_choice) {
+    case CPU:
+        cpu_parallel_for(count, [&](uint64_t i) {
+            cpu_DyadicMultiply(results[i], operand1[i], operand2[i], n, moduli,
+                               n_moduli);
+        });
+        break;
+    case EMU:
+    case FPGA:
+        if (run_hybrid(
+                "DyadicMultiply", kernel_t::DYADIC_MULTIPLY, count,
+                muDyadicMultiply,
+                [&](uint64_t m) {
+                    push_DyadicMultiplyBatch(results, operand1, operand2, m, n,
+                                             moduli, n_moduli);
+                },
+                [&](uint64_t i) {
+                    cpu_DyadicMultiply(results[i], operand1[i], operand2[i], n,
+                                       moduli, n_moduli);
+                },
+                DyadicMultiplyCompleted_int)) {
+            break;
+        }
+        fpga_DyadicMultiplyBatch(results, operand1, operand2, count, n, moduli,
+                                 n_moduli);
+        break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void MultiplyPlain_int(uint64_t* results, const uint64_t* ciphertext,
+                       const uint64_t* plaintext, uint64_t n,
+                       const uint64_t* moduli, uint64_t n_moduli) {
+    switch (g_choice) {
+    case CPU:
+        cpu_MultiplyPlain(results, ciphertext, plaintext, n, moduli, n_moduli);
+        break;
+    case EMU:
+    case FPGA:
+        fpga_DyadicMultiply(results, ciphertext, plaintext, n, moduli,
+                            n_moduli, true);
+        break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void MultiplyPlainBatch_int(uint64_t** results, const uint64_t** ciphertext,
+                            const uint64_t** plaintext, uint64_t count,
+                            uint64_t n, const uint64_t* moduli,
+                            uint64_t n_moduli) {
+    switch (g_choice) {
+    case CPU:
+        cpu_parallel_for(count, [&](uint64_t i) {
+            cpu_MultiplyPlain(results[i], ciphertext[i], plaintext[i], n,
+                              moduli, n_moduli);
+        });
+        break;
+    case EMU:
+    case FPGA:
+        if (run_hybrid(
+                "MultiplyPlain", kernel_t::DYADIC_MULTIPLY, count,
+                muDyadicMultiply,
+                [&](uint64_t m) {
+                    push_DyadicMultiplyBatch(results, ciphertext, plaintext, m,
+                                             n, moduli, n_moduli, true);
+                },
+                [&](uint64_t i) {
+                    cpu_MultiplyPlain(results[i], ciphertext[i], plaintext[i],
+                                      n, moduli, n_moduli);
+                },
+                DyadicMultiplyCompleted_int)) {
+            break;
+        }
+        fpga_DyadicMultiplyBatch(results, ciphertext, plaintext, count, n,
+                                 moduli, n_moduli, true);
+        break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+static void dyadic_multiply_accumulate(int device, uint64_t* results,
+                                       const uint64_t** operand1,
+                                       const uint64_t** operand2,
+                                       uint64_t count, uint64_t n,
+                                       const uint64_t* moduli,
+                                       uint64_t n_moduli, bool plain) {
+    // every partial sum, from the device or the cpu, is added into results.
+    memset(results, 0, (plain ? 2 : 3) * n_moduli * n * sizeof(uint64_t));
+
+    switch (device) {
+    case CPU:
+        cpu_DyadicMultiplyAccumulate(results, operand1, operand2, count, n,
+                                     moduli, n_moduli, plain);
+        break;
+    case EMU:
+    case FPGA: {
+        std::vector<uint64_t*> shared_results(count, results);
+        fpga_DyadicMultiplyBatch(shared_results.data(), operand1, operand2,
+                                 count, n, moduli, n_moduli, plain, true);
+        break;
+    }
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void DyadicMultiplyAccumulate_int(uint64_t* results, const uint64_t** operand1,
+                                  const uint64_t** operand2, uint64_t count,
+                                  uint64_t n, const uint64_t* moduli,
+                                  uint64_t n_moduli, bool plain) {
+    dyadic_multiply_accumulate(g_choice, results, operand1, operand2, count, n,
+                               moduli, n_moduli, plain);
+}
+
 void set_worksize_INTT_int(uint64_t n) { fpga_buffer.set_worksize_INTT(n); }
 
-static void fpga_INTT(uint64_t* coeff_poly,
+// queues an inverse transform, with muINTT held by the caller.
+static void push_INTT(uint64_t* coeff_poly,
                       const uint64_t* inv_root_of_unity_powers,
                       const uint64_t* precon_inv_root_of_unity_powers,
                       uint64_t coeff_modulus, uint64_t inv_n, uint64_t inv_n_w,
                       uint64_t n) {
-    std::lock_guard<std::mutex> locker(muINTT);
-
+    ApiOverheadTimer timer("INTT", 1);
+    auto table = std::make_pair(coeff_modulus, inv_root_of_unity_powers[n - 1]);
     bool fence = (fpga_buffer.size() == 0);
 
     if (!fence) {
@@ -268,9 +693,17 @@ static void fpga_INTT(uint64_t* coeff_poly,
         if (!fence) {
             FPGA_ASSERT(obj->type_ == kernel_t::INTT);
             Object_INTT* obj_INTT = dynamic_cast<Object_INTT*>(obj);
-            fence |= (coeff_modulus != obj_INTT->coeff_modulus_);
+            fence |= (n != obj_INTT->n_);
+            // the frames of a batch may use different twiddle tables, up
+            // to the number of tables the device keeps.
+            fence |= ((batch_tables_INTT.count(table) == 0) &&
+                      (batch_tables_INTT.size() >= NTT_MAX_TWIDDLE_TABLES));
         }
     }
+    if (fence) {
+        batch_tables_INTT.clear();
+    }
+    batch_tables_INTT.insert(table);
 
     Object* obj = new Object_INTT(coeff_poly, inv_root_of_unity_powers,
                                   precon_inv_root_of_unity_powers,
@@ -278,7 +711,22 @@ static void fpga_INTT(uint64_t* coeff_poly,
 
     fpga_buffer.push(obj);
 
-    outstanding_objects_INTT.insert(obj);
+    {
+        std::lock_guard<std::mutex> outstanding_locker(muOutstanding);
+        outstanding_objects_INTT.insert(obj);
+    }
+}
+
+static void fpga_INTT(uint64_t* coeff_poly,
+                      const uint64_t* inv_root_of_unity_powers,
+                      const uint64_t* precon_inv_root_of_unity_powers,
+                      uint64_t coeff_modulus, uint64_t inv_n, uint64_t inv_n_w,
+                      uint64_t n) {
+    std::lock_guard<std::mutex> locker(muINTT);
+
+    push_INTT(coeff_poly, inv_root_of_unity_powers,
+              precon_inv_root_of_unity_powers, coeff_modulus, inv_n, inv_n_w,
+              n);
 
     if (fpga_buffer.get_worksize_INTT() == 1) {
         INTTCompleted_int();
@@ -286,24 +734,7 @@ static void fpga_INTT(uint64_t* coeff_poly,
 }
 
 bool INTTCompleted_int() {
-    bool all_done = false;
-    while (!all_done) {
-        bool done = true;
-        auto iter = outstanding_objects_INTT.begin();
-        while (iter != outstanding_objects_INTT.end()) {
-            Object* obj = *iter;
-            if (obj->ready_) {
-                delete obj;
-                obj = nullptr;
-                iter = outstanding_objects_INTT.erase(iter);
-            } else {
-                done = false;
-                iter++;
-            }
-        }
-        all_done = done;
-    }
-    outstanding_objects_INTT.clear();
+    bool all_done = wait_outstanding(outstanding_objects_INTT);
 
     fpga_buffer.set_worksize_INTT(1);
 
@@ -315,10 +746,12 @@ void INTT_int(uint64_t* coeff_poly, const uint64_t* inv_root_of_unity_powers,
               uint64_t coeff_modulus, uint64_t inv_n, uint64_t inv_n_w,
               uint64_t n) {
     switch (g_choice) {
-    case CPU:
-        std::cerr << "HEXL CPU version not supported" << std::endl;
-        FPGA_ASSERT(0);
-        break;
+    case CPU: {
+        // the root follows the leading 1 of the shifted inverse powers
+        uint64_t root =
+            InverseUIntMod(inv_root_of_unity_powers[1], coeff_modulus);
+        cpu_get_ntt(n, coeff_modulus, root).inverse(coeff_poly);
+    } break;
     case EMU:
     case FPGA:
         fpga_INTT(coeff_poly, inv_root_of_unity_powers,
@@ -336,11 +769,12 @@ void INTT_int(uint64_t* coeff_poly, const uint64_t* inv_root_of_unity_powers,
 
 void set_worksize_NTT_int(uint64_t n) { fpga_buffer.set_worksize_NTT(n); }
 
-static void fpga_NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
+// queues a forward transform, with muNTT held by the caller.
+static void push_NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
                      const uint64_t* precon_root_of_unity_powers,
                      uint64_t coeff_modulus, uint64_t n) {
-    std::lock_guard<std::mutex> locker(muNTT);
-
+    ApiOverheadTimer timer("NTT", 1);
+    auto table = std::make_pair(coeff_modulus, root_of_unity_powers[n - 1]);
     bool fence = (fpga_buffer.size() == 0);
 
     if (!fence) {
@@ -349,9 +783,17 @@ static void fpga_NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
         if (!fence) {
             FPGA_ASSERT(obj->type_ == kernel_t::NTT);
             Object_NTT* obj_NTT = dynamic_cast<Object_NTT*>(obj);
-            fence |= (coeff_modulus != obj_NTT->coeff_modulus_);
+            fence |= (n != obj_NTT->n_);
+            // the frames of a batch may use different twiddle tables, up
+            // to the number of tables the device keeps.
+            fence |= ((batch_tables_NTT.count(table) == 0) &&
+                      (batch_tables_NTT.size() >= NTT_MAX_TWIDDLE_TABLES));
         }
     }
+    if (fence) {
+        batch_tables_NTT.clear();
+    }
+    batch_tables_NTT.insert(table);
 
     Object* obj =
         new Object_NTT(coeff_poly, root_of_unity_powers,
@@ -359,7 +801,19 @@ static void fpga_NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
 
     fpga_buffer.push(obj);
 
-    outstanding_objects_NTT.insert(obj);
+    {
+        std::lock_guard<std::mutex> outstanding_locker(muOutstanding);
+        outstanding_objects_NTT.insert(obj);
+    }
+}
+
+static void fpga_NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
+                     const uint64_t* precon_root_of_unity_powers,
+                     uint64_t coeff_modulus, uint64_t n) {
+    std::lock_guard<std::mutex> locker(muNTT);
+
+    push_NTT(coeff_poly, root_of_unity_powers, precon_root_of_unity_powers,
+             coeff_modulus, n);
 
     if (fpga_buffer.get_worksize_NTT() == 1) {
         NTTCompleted_int();
@@ -367,24 +821,7 @@ static void fpga_NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
 }
 
 bool NTTCompleted_int() {
-    bool all_done = false;
-    while (!all_done) {
-        bool done = true;
-        auto iter = outstanding_objects_NTT.begin();
-        while (iter != outstanding_objects_NTT.end()) {
-            Object* obj = *iter;
-            if (obj->ready_) {
-                delete obj;
-                obj = nullptr;
-                iter = outstanding_objects_NTT.erase(iter);
-            } else {
-                done = false;
-                iter++;
-            }
-        }
-        all_done = done;
-    }
-    outstanding_objects_NTT.clear();
+    bool all_done = wait_outstanding(outstanding_objects_NTT);
 
     fpga_buffer.set_worksize_NTT(1);
 
@@ -396,8 +833,9 @@ void NTT_int(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
              uint64_t coeff_modulus, uint64_t n) {
     switch (g_choice) {
     case CPU:
-        std::cerr << "HEXL CPU version not supported" << std::endl;
-        FPGA_ASSERT(0);
+        // the root is the power of bit reversed index n / 2
+        cpu_get_ntt(n, coeff_modulus, root_of_unity_powers[n >> 1])
+            .forward(coeff_poly);
         break;
     case EMU:
     case FPGA:
@@ -413,99 +851,945 @@ void NTT_int(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
     }
 }
 
-void set_worksize_KeySwitch_int(uint64_t n) {
-    fpga_buffer.set_worksize_KeySwitch(n);
+// twiddle factors of the standalone NTT/INTT kernels for one modulus
+struct NTTTwiddles {
+    std::vector<uint64_t> root_of_unity_powers;
+    std::vector<uint64_t> precon_root_of_unity_powers;
+    std::vector<uint64_t> inv_root_of_unity_powers;
+    std::vector<uint64_t> precon_inv_root_of_unity_powers;
+    uint64_t inv_n;
+    uint64_t inv_n_w;
+};
+
+// twiddle factors of the transforms of size n modulo modulus for the
+// primitive 2n-th root of unity root_of_unity
+static void compute_ntt_twiddles(NTTTwiddles& t, uint64_t n, uint64_t modulus,
+                                 uint64_t root_of_unity) {
+    t.root_of_unity_powers.resize(n);
+    t.precon_root_of_unity_powers.resize(n);
+    std::vector<uint64_t> inv(n);
+    std::vector<uint64_t> precon_inv(n);
+    ComputeRootOfUnityPowers(modulus, n, Log2(n), root_of_unity, inv.data(),
+                             precon_inv.data(), t.root_of_unity_powers.data(),
+                             t.precon_root_of_unity_powers.data());
+
+    // the standalone INTT kernel takes the inverse powers shifted by one,
+    // with a leading 1 and the last stage root in the last slot.
+    t.inv_root_of_unity_powers.resize(n);
+    t.precon_inv_root_of_unity_powers.resize(n);
+    t.inv_root_of_unity_powers[0] = 1;
+    for (uint64_t i = 1; i < n; i++) {
+        t.inv_root_of_unity_powers[i] = inv[i - 1];
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        t.precon_inv_root_of_unity_powers[i] =
+            MultiplyFactor(t.inv_root_of_unity_powers[i], 64, modulus)
+                .BarrettFactor();
+    }
+    t.inv_n = InverseUIntMod(n, modulus);
+    t.inv_n_w =
+        MultiplyUIntMod(t.inv_n, t.inv_root_of_unity_powers[n - 1], modulus);
 }
 
-static void fpga_KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr,
-                           uint64_t n, uint64_t decomp_modulus_size,
-                           uint64_t key_modulus_size, uint64_t rns_modulus_size,
-                           uint64_t key_component_count, const uint64_t* moduli,
-                           const uint64_t** k_switch_keys,
-                           const uint64_t* modswitch_factors,
-                           const uint64_t* twiddle_factors) {
-    std::lock_guard<std::mutex> locker(muKeySwitch);
-
-    bool fence = (fpga_buffer.size() == 0);
-
-    if (!fence) {
-        Object* obj = fpga_buffer.back();
-        FPGA_ASSERT(obj);
-        fence |= (obj->type_ != kernel_t::KEYSWITCH);
-        if (!fence) {
-            FPGA_ASSERT(obj->type_ == kernel_t::KEYSWITCH);
-            Object_KeySwitch* obj_KeySwitch =
-                dynamic_cast<Object_KeySwitch*>(obj);
-            fence |= (n != obj_KeySwitch->n_);
-            fence |=
-                (decomp_modulus_size != obj_KeySwitch->decomp_modulus_size_);
-            fence |= (key_modulus_size != obj_KeySwitch->key_modulus_size_);
-            fence |= (rns_modulus_size != obj_KeySwitch->rns_modulus_size_);
-            fence |=
-                (key_component_count != obj_KeySwitch->key_component_count_);
-            fence |= (k_switch_keys != obj_KeySwitch->k_switch_keys_);
-        }
+static const NTTTwiddles& get_ntt_twiddles(uint64_t n, uint64_t modulus) {
+    static std::map<std::pair<uint64_t, uint64_t>, NTTTwiddles> tables;
+    std::lock_guard<std::mutex> locker(muTwiddles);
+    auto key = std::make_pair(n, modulus);
+    auto iter = tables.find(key);
+    if (iter != tables.end()) {
+        return iter->second;
     }
 
-    Object* obj = new Object_KeySwitch(
-        result, t_target_iter_ptr, n, decomp_modulus_size, key_modulus_size,
-        rns_modulus_size, key_component_count, moduli, k_switch_keys,
-        modswitch_factors, twiddle_factors, fence);
-
-    fpga_buffer.push(obj);
+    NTTTwiddles& t = tables[key];
+    compute_ntt_twiddles(t, n, modulus, MinimalPrimitiveRoot(2 * n, modulus));
+    return t;
+}
 
-    outstanding_objects_KeySwitch.insert(obj);
+// forward, or inverse, transforms of polys[p] for the modulus poly_moduli[p]
+// with the CpuNTT on the cpu and on the NTT, or INTT, kernel otherwise. The
+// polynomials of all the moduli are sent in one device batch. While the
+// caller queues asynchronous transforms of its own, the worksize is theirs,
+// so the polynomials are transformed on the cpu instead of disturbing it.
+static void transform_polys(int device, const std::vector<uint64_t*>& polys,
+                            const std::vector<uint64_t>& poly_moduli,
+                            uint64_t n, bool inverse) {
+    if (polys.empty()) {
+        return;
+    }
 
+    switch (device) {
+    case CPU:
+        cpu_parallel_for(polys.size(), [&](uint64_t p) {
+            const CpuNTT& ntt = cpu_get_ntt(n, poly_moduli[p]);
+            if (inverse) {
+                ntt.inverse(polys[p]);
+            } else {
+                ntt.forward(polys[p]);
+            }
+        });
+        break;
+    case EMU:
+    case FPGA:
+        if (inverse) {
+            std::unique_lock<std::mutex> locker(muINTT);
+            if (fpga_buffer.get_worksize_INTT() != 1) {
+                locker.unlock();
+                transform_polys(CPU, polys, poly_moduli, n, inverse);
+                break;
+            }
+            fpga_buffer.set_worksize_INTT(polys.size());
+            for (size_t p = 0; p < polys.size(); p++) {
+                const NTTTwiddles& tw = get_ntt_twiddles(n, poly_moduli[p]);
+                push_INTT(polys[p], tw.inv_root_of_unity_powers.data(),
+                          tw.precon_inv_root_of_unity_powers.data(),
+                          poly_moduli[p], tw.inv_n, tw.inv_n_w, n);
+            }
+            INTTCompleted_int();
+        } else {
+            std::unique_lock<std::mutex> locker(muNTT);
+            if (fpga_buffer.get_worksize_NTT() != 1) {
+                locker.unlock();
+                transform_polys(CPU, polys, poly_moduli, n, inverse);
+                break;
+            }
+            fpga_buffer.set_worksize_NTT(polys.size());
+            for (size_t p = 0; p < polys.size(); p++) {
+                const NTTTwiddles& tw = get_ntt_twiddles(n, poly_moduli[p]);
+                push_NTT(polys[p], tw.root_of_unity_powers.data(),
+                         tw.precon_root_of_unity_powers.data(), poly_moduli[p],
+                         n);
+            }
+            NTTCompleted_int();
+        }
+        break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void NTTRns_int(uint64_t* coeff_poly, const uint64_t* moduli,
+                uint64_t num_moduli, uint64_t n) {
+    std::vector<uint64_t*> polys(num_moduli);
+    std::vector<uint64_t> poly_moduli(moduli, moduli + num_moduli);
+    for (uint64_t i = 0; i < num_moduli; i++) {
+        polys[i] = coeff_poly + i * n;
+    }
+    transform_polys(g_choice, polys, poly_moduli, n, false);
+}
+
+void INTTRns_int(uint64_t* coeff_poly, const uint64_t* moduli,
+                 uint64_t num_moduli, uint64_t n) {
+    std::vector<uint64_t*> polys(num_moduli);
+    std::vector<uint64_t> poly_moduli(moduli, moduli + num_moduli);
+    for (uint64_t i = 0; i < num_moduli; i++) {
+        polys[i] = coeff_poly + i * n;
+    }
+    transform_polys(g_choice, polys, poly_moduli, n, true);
+}
+
+// transform plans registered by CreateTransformPlan
+struct TransformPlan {
+    uint64_t n;
+    uint64_t modulus;
+    uint64_t root_of_unity;
+    NTTTwiddles twiddles;
+};
+
+static std::map<uint64_t, std::unique_ptr<TransformPlan>> transform_plans;
+static uint64_t next_transform_plan = 1;
+
+uint64_t CreateTransformPlan_int(uint64_t n, uint64_t modulus,
+                                 uint64_t root_of_unity) {
+    std::unique_ptr<TransformPlan> plan(new TransformPlan());
+    plan->n = n;
+    plan->modulus = modulus;
+    plan->root_of_unity = root_of_unity
+                              ? root_of_unity
+                              : MinimalPrimitiveRoot(2 * n, modulus);
+    compute_ntt_twiddles(plan->twiddles, n, modulus, plan->root_of_unity);
+
+    std::lock_guard<std::mutex> locker(muTransformPlans);
+    uint64_t id = next_transform_plan++;
+    transform_plans.emplace(id, std::move(plan));
+    return id;
+}
+
+void DestroyTransformPlan_int(uint64_t plan) {
+    std::lock_guard<std::mutex> locker(muTransformPlans);
+    auto iter = transform_plans.find(plan);
+    FPGA_ASSERT(iter != transform_plans.end(), "unknown transform plan");
+    if (iter != transform_plans.end()) {
+        transform_plans.erase(iter);
+    }
+}
+
+static const TransformPlan* get_transform_plan(uint64_t plan) {
+    std::lock_guard<std::mutex> locker(muTransformPlans);
+    auto iter = transform_plans.find(plan);
+    return (iter != transform_plans.end()) ? iter->second.get() : nullptr;
+}
+
+// queues the forward, or inverse, transforms of count polynomials with the
+// twiddle factors of a plan, with muNTT, or muINTT, held by the caller.
+static void push_Transform(uint64_t** coeff_polys, uint64_t count,
+                           const TransformPlan& plan, bool inverse) {
+    const NTTTwiddles& tw = plan.twiddles;
+    for (uint64_t i = 0; i < count; i++) {
+        if (inverse) {
+            push_INTT(coeff_polys[i], tw.inv_root_of_unity_powers.data(),
+                      tw.precon_inv_root_of_unity_powers.data(), plan.modulus,
+                      tw.inv_n, tw.inv_n_w, plan.n);
+        } else {
+            push_NTT(coeff_polys[i], tw.root_of_unity_powers.data(),
+                     tw.precon_root_of_unity_powers.data(), plan.modulus,
+                     plan.n);
+        }
+    }
+}
+
+// Like KeySwitchBatch, a caller without a worksize gets the polynomials in
+// one device batch and returns once they are done.
+static void fpga_Transform(uint64_t** coeff_polys, uint64_t count,
+                           const TransformPlan& plan, bool inverse) {
+    if (inverse) {
+        std::lock_guard<std::mutex> locker(muINTT);
+        bool sync = (fpga_buffer.get_worksize_INTT() == 1);
+        if (sync) {
+            fpga_buffer.set_worksize_INTT(count);
+        }
+        push_Transform(coeff_polys, count, plan, inverse);
+        if (sync) {
+            INTTCompleted_int();
+        }
+    } else {
+        std::lock_guard<std::mutex> locker(muNTT);
+        bool sync = (fpga_buffer.get_worksize_NTT() == 1);
+        if (sync) {
+            fpga_buffer.set_worksize_NTT(count);
+        }
+        push_Transform(coeff_polys, count, plan, inverse);
+        if (sync) {
+            NTTCompleted_int();
+        }
+    }
+}
+
+static void cpu_Transform(uint64_t** coeff_polys, uint64_t count,
+                          const TransformPlan& plan, bool inverse) {
+    const CpuNTT& ntt = cpu_get_ntt(plan.n, plan.modulus, plan.root_of_unity);
+    cpu_parallel_for(count, [&](uint64_t i) {
+        if (inverse) {
+            ntt.inverse(coeff_polys[i]);
+        } else {
+            ntt.forward(coeff_polys[i]);
+        }
+    });
+}
+
+static void Transform_int(uint64_t** coeff_polys, uint64_t count,
+                          uint64_t plan, bool inverse) {
+    const TransformPlan* p = get_transform_plan(plan);
+    FPGA_ASSERT(p, "unknown transform plan");
+    if (!p) {
+        return;
+    }
+    switch (g_choice) {
+    case CPU:
+        cpu_Transform(coeff_polys, count, *p, inverse);
+        break;
+    case EMU:
+    case FPGA: {
+        if (run_hybrid(
+                inverse ? "INTT" : "NTT",
+                inverse ? kernel_t::INTT : kernel_t::NTT, count,
+                inverse ? muINTT : muNTT,
+                [&](uint64_t m) {
+                    push_Transform(coeff_polys, m, *p, inverse);
+                },
+                [&](uint64_t i) {
+                    const CpuNTT& ntt =
+                        cpu_get_ntt(p->n, p->modulus, p->root_of_unity);
+                    if (inverse) {
+                        ntt.inverse(coeff_polys[i]);
+                    } else {
+                        ntt.forward(coeff_polys[i]);
+                    }
+                },
+                [&]() {
+                    if (inverse) {
+                        INTTCompleted_int();
+                    } else {
+                        NTTCompleted_int();
+                    }
+                })) {
+            break;
+        }
+        fpga_Transform(coeff_polys, count, *p, inverse);
+    } break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void ForwardTransform_int(uint64_t** coeff_polys, uint64_t count,
+                          uint64_t plan) {
+    Transform_int(coeff_polys, count, plan, false);
+}
+
+void InverseTransform_int(uint64_t** coeff_polys, uint64_t count,
+                          uint64_t plan) {
+    Transform_int(coeff_polys, count, plan, true);
+}
+
+void set_worksize_KeySwitch_int(uint64_t n) {
+    fpga_buffer.set_worksize_KeySwitch(n);
+}
+
+static void fpga_KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr,
+                           uint64_t n, uint64_t decomp_modulus_size,
+                           uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                           uint64_t key_component_count, const uint64_t* moduli,
+                           const uint64_t** k_switch_keys,
+                           const uint64_t* modswitch_factors,
+                           const uint64_t* twiddle_factors) {
+    ApiOverheadTimer timer("KEYSWITCH", 1);
+    std::lock_guard<std::mutex> locker(muKeySwitch);
+
+    bool fence = (fpga_buffer.size() == 0);
+
+    if (!fence) {
+        Object* obj = fpga_buffer.back();
+        FPGA_ASSERT(obj);
+        fence |= (obj->type_ != kernel_t::KEYSWITCH);
+        if (!fence) {
+            FPGA_ASSERT(obj->type_ == kernel_t::KEYSWITCH);
+            Object_KeySwitch* obj_KeySwitch =
+                dynamic_cast<Object_KeySwitch*>(obj);
+            fence |= (n != obj_KeySwitch->n_);
+            fence |=
+                (decomp_modulus_size != obj_KeySwitch->decomp_modulus_size_);
+            fence |= (key_modulus_size != obj_KeySwitch->key_modulus_size_);
+            fence |= (rns_modulus_size != obj_KeySwitch->rns_modulus_size_);
+            fence |=
+                (key_component_count != obj_KeySwitch->key_component_count_);
+            fence |= (k_switch_keys != obj_KeySwitch->k_switch_keys_);
+        }
+    }
+
+    Object* obj = new Object_KeySwitch(
+        result, t_target_iter_ptr, n, decomp_modulus_size, key_modulus_size,
+        rns_modulus_size, key_component_count, moduli, k_switch_keys,
+        modswitch_factors, twiddle_factors, fence);
+
+    fpga_buffer.push(obj);
+
+    {
+        std::lock_guard<std::mutex> outstanding_locker(muOutstanding);
+        outstanding_objects_KeySwitch.insert(obj);
+    }
+
+    timer.stop();
     if (fpga_buffer.get_worksize_KeySwitch() == 1) {
         KeySwitchCompleted_int();
     }
 }
 
-static void cpu_KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr,
-                          uint64_t n, uint64_t decomp_modulus_size,
-                          uint64_t key_modulus_size, uint64_t rns_modulus_size,
-                          uint64_t key_component_count, const uint64_t* moduli,
-                          const uint64_t** k_switch_keys,
-                          const uint64_t* modswitch_factors,
-                          const uint64_t* twiddle_factors) {
-    FPGA_ASSERT(g_choice == CPU);
+// queues count keyswitches sharing their parameters, with muKeySwitch held
+// by the caller.
+static void push_KeySwitchBatch(
+    uint64_t** results, const uint64_t** t_target_iter_ptrs, uint64_t count,
+    uint64_t n, uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+    uint64_t rns_modulus_size, uint64_t key_component_count,
+    const uint64_t* moduli, const uint64_t** k_switch_keys,
+    const uint64_t* modswitch_factors, const uint64_t* twiddle_factors,
+    const uint32_t* galois_table,
+    const Object_DyadicMultiply* const* sources = nullptr) {
+    ApiOverheadTimer timer("KEYSWITCH", count);
+    bool fence = (fpga_buffer.size() == 0);
 
-#ifdef FPGA_USE_INTEL_HEXL
-    namespace ns = intel::hexl::internal;
-    ns::KeySwitch(result, t_target_iter_ptr, n, decomp_modulus_size,
-                  key_modulus_size, rns_modulus_size, key_component_count,
-                  moduli, k_switch_keys, modswitch_factors, twiddle_factors);
-#else
-    std::cerr << "HEXL CPU version not supported" << std::endl;
-    exit(1);
-#endif
+    if (!fence) {
+        Object* obj = fpga_buffer.back();
+        FPGA_ASSERT(obj);
+        fence |= (obj->type_ != kernel_t::KEYSWITCH);
+        if (!fence) {
+            Object_KeySwitch* obj_KeySwitch =
+                dynamic_cast<Object_KeySwitch*>(obj);
+            fence |= (n != obj_KeySwitch->n_);
+            fence |=
+                (decomp_modulus_size != obj_KeySwitch->decomp_modulus_size_);
+            fence |= (key_modulus_size != obj_KeySwitch->key_modulus_size_);
+            fence |= (rns_modulus_size != obj_KeySwitch->rns_modulus_size_);
+            fence |=
+                (key_component_count != obj_KeySwitch->key_component_count_);
+            fence |= (k_switch_keys != obj_KeySwitch->k_switch_keys_);
+            // a device batch reads all its inputs from one place.
+            fence |= ((sources != nullptr) !=
+                      (obj_KeySwitch->source_ != nullptr));
+        }
+    }
+
+    // the parameters are shared, so only the first object can be a fence.
+    std::vector<Object*> objs;
+    objs.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        objs.push_back(new Object_KeySwitch(
+            results[i], t_target_iter_ptrs[i], n, decomp_modulus_size,
+            key_modulus_size, rns_modulus_size, key_component_count, moduli,
+            k_switch_keys, modswitch_factors, twiddle_factors,
+            fence && (i == 0), galois_table,
+            sources ? sources[i] : nullptr));
+    }
+
+    fpga_buffer.push_batch(objs);
+
+    std::lock_guard<std::mutex> outstanding_locker(muOutstanding);
+    outstanding_objects_KeySwitch.insert(objs.begin(), objs.end());
 }
 
-bool KeySwitchCompleted_int() {
-    bool all_done = false;
-    while (!all_done) {
-        bool done = true;
-        auto iter = outstanding_objects_KeySwitch.begin();
-        while (iter != outstanding_objects_KeySwitch.end()) {
-            Object* obj = *iter;
-            if (obj->ready_) {
-                delete obj;
-                obj = nullptr;
-                iter = outstanding_objects_KeySwitch.erase(iter);
-            } else {
-                done = false;
-                iter++;
+static void fpga_KeySwitchBatch(
+    uint64_t** results, const uint64_t** t_target_iter_ptrs, uint64_t count,
+    uint64_t n, uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+    uint64_t rns_modulus_size, uint64_t key_component_count,
+    const uint64_t* moduli, const uint64_t** k_switch_keys,
+    const uint64_t* modswitch_factors, const uint64_t* twiddle_factors,
+    const uint32_t* galois_table = nullptr) {
+    std::lock_guard<std::mutex> locker(muKeySwitch);
+
+    // a synchronous caller gets the whole batch grouped into device batches
+    // of n_batch_ keyswitches instead of one launch per keyswitch.
+    bool sync = (fpga_buffer.get_worksize_KeySwitch() == 1);
+    if (sync) {
+        fpga_buffer.set_worksize_KeySwitch(count);
+    }
+
+    push_KeySwitchBatch(results, t_target_iter_ptrs, count, n,
+                        decomp_modulus_size, key_modulus_size, rns_modulus_size,
+                        key_component_count, moduli, k_switch_keys,
+                        modswitch_factors, twiddle_factors, galois_table);
+
+    if (sync) {
+        KeySwitchCompleted_int();
+    }
+}
+
+// the keyswitch kernel holds the keys of at most 7 key moduli. Wider modulus
+// chains, and hybrid keyswitching, are tiled over the NTT/INTT and dyadic
+// kernels of the KEYSWITCH_TILED bitstream instead.
+static const uint64_t kKeySwitchMaxKeyModulusSize = 7;
+
+// the device a keyswitch runs on: g_choice, tiled under the KEYSWITCH_TILED
+// bitstream, which has no keyswitch kernel. A keyswitch the loaded bitstream
+// cannot run is reported, asserted in debug builds, and run on the cpu.
+static int keyswitch_device(uint64_t n, uint64_t key_modulus_size) {
+    if ((g_choice != EMU) && (g_choice != FPGA)) {
+        return g_choice;
+    }
+    if (g_keyswitch_tiled && (n != 16384)) {
+        std::cerr << "ERROR: FPGA_KERNEL=KEYSWITCH_TILED runs KeySwitch "
+                     "for n = 16384 only."
+                  << std::endl;
+        FPGA_ASSERT(0, "KeySwitch size not supported by the bitstream");
+        return CPU;
+    }
+    if (!g_keyswitch_tiled &&
+        (key_modulus_size > kKeySwitchMaxKeyModulusSize)) {
+        std::cerr << "ERROR: KeySwitch of more than "
+                  << kKeySwitchMaxKeyModulusSize
+                  << " key moduli requires FPGA_KERNEL=KEYSWITCH_TILED."
+                  << std::endl;
+        FPGA_ASSERT(0, "KeySwitch key moduli not supported by the bitstream");
+        return CPU;
+    }
+    return g_choice;
+}
+
+// the keys of the key moduli of one tile, packed as the ciphertext operands
+// of the dyadic kernel: for each of the num_keys keys, component 0 then
+// component 1 over the moduli of the tile. The device keeps them resident.
+// The last DYADIC_MAX_TILE_KEYS packings are cached, a keyswitch holding on
+// to the ones it uses.
+static std::shared_ptr<const TileKeys> get_tile_keys(
+    const uint64_t** k_switch_keys, uint64_t n, uint64_t num_keys,
+    uint64_t key_modulus_size, const std::vector<uint64_t>& key_indices) {
+    typedef std::tuple<const uint64_t**, uint64_t, uint64_t, uint64_t,
+                       std::vector<uint64_t>>
+        TileKeysKey;
+    static std::map<TileKeysKey,
+                    std::pair<std::shared_ptr<const TileKeys>, uint64_t>>
+        tiles;
+    static uint64_t next_id = 1;
+    static uint64_t use = 0;
+    std::lock_guard<std::mutex> locker(muTileKeys);
+    TileKeysKey key = std::make_tuple(k_switch_keys, n, num_keys,
+                                      key_modulus_size, key_indices);
+    auto iter = tiles.find(key);
+    if (iter != tiles.end()) {
+        iter->second.second = ++use;
+        return iter->second.first;
+    }
+
+    if (tiles.size() >= DYADIC_MAX_TILE_KEYS) {
+        auto lru = tiles.begin();
+        for (auto it = tiles.begin(); it != tiles.end(); it++) {
+            if (it->second.second < lru->second.second) {
+                lru = it;
             }
         }
-        all_done = done;
+        tiles.erase(lru);
+    }
+
+    std::shared_ptr<TileKeys> keys = std::make_shared<TileKeys>();
+    keys->id_ = next_id++;
+    uint64_t tile = key_indices.size();
+    keys->keys_.resize(num_keys * 2 * tile * n);
+    for (uint64_t d = 0; d < num_keys; d++) {
+        for (uint64_t k = 0; k < 2; k++) {
+            for (uint64_t s = 0; s < tile; s++) {
+                const uint64_t* src =
+                    k_switch_keys[d] +
+                    (k * key_modulus_size + key_indices[s]) * n;
+                std::copy(src, src + n,
+                          keys->keys_.data() + ((d * 2 + k) * tile + s) * n);
+            }
+        }
+    }
+    tiles.emplace(key, std::make_pair(keys, ++use));
+    return keys;
+}
+
+// results = sum_d keys_d * operand2[d] over the count keys of a tile, on the
+// dyadic kernel, which reads the keys from device memory. Like
+// transform_polys, on the cpu while the caller queues asynchronous
+// multiplications of its own.
+static void tile_multiply_accumulate(int device, uint64_t* results,
+                                     const TileKeys& keys,
+                                     const uint64_t** operand2,
+                                     uint64_t count, uint64_t n,
+                                     const uint64_t* moduli,
+                                     uint64_t n_moduli) {
+    std::vector<const uint64_t*> operand1(count);
+    for (uint64_t d = 0; d < count; d++) {
+        operand1[d] = keys.keys_.data() + d * 2 * n_moduli * n;
+    }
+    memset(results, 0, 2 * n_moduli * n * sizeof(uint64_t));
+
+    if ((device == EMU) || (device == FPGA)) {
+        std::lock_guard<std::mutex> locker(muDyadicMultiply);
+        if (fpga_buffer.get_worksize_DyadicMultiply() == 1) {
+            fpga_buffer.set_worksize_DyadicMultiply(count);
+            std::vector<uint64_t*> shared_results(count, results);
+            push_DyadicMultiplyBatch(shared_results.data(), operand1.data(),
+                                     operand2, count, n, moduli, n_moduli,
+                                     true, true, &keys);
+            DyadicMultiplyCompleted_int();
+            return;
+        }
+    }
+    cpu_DyadicMultiplyAccumulate(results, operand1.data(), operand2, count, n,
+                                 moduli, n_moduli, true);
+}
+
+// returns prod_{j in [begin, end), j != skip} moduli[j] mod modulus
+static uint64_t product_mod(const uint64_t* moduli, uint64_t begin,
+                            uint64_t end, uint64_t skip, uint64_t modulus) {
+    uint64_t prod = 1 % modulus;
+    for (uint64_t j = begin; j < end; j++) {
+        if (j != skip) {
+            prod = MultiplyUIntMod(prod, moduli[j] % modulus, modulus);
+        }
+    }
+    return prod;
+}
+
+// y[l] = sum_j x_j[l] * (Q / q_j) mod modulus, the fast base conversion of
+// the scaled residues x_j = [a_j * (Q / q_j)^-1]_q_j of Q = prod_j q_j, for
+// j in [begin, end). x holds the residues from x_begin on.
+static void base_convert(uint64_t* y, const uint64_t* x,
+                         const uint64_t* moduli, uint64_t begin, uint64_t end,
+                         uint64_t modulus, uint64_t n) {
+    std::vector<uint64_t> factors(end - begin);
+    for (uint64_t j = begin; j < end; j++) {
+        factors[j - begin] = product_mod(moduli, begin, end, j, modulus);
+    }
+    for (uint64_t l = 0; l < n; l++) {
+        uint128_t sum = 0;
+        for (uint64_t j = begin; j < end; j++) {
+            sum += MultiplyUInt64(x[(j - begin) * n + l], factors[j - begin]);
+        }
+        y[l] = static_cast<uint64_t>(sum % modulus);
+    }
+}
+
+// x_j <- [x_j * (Q / q_j)^-1]_q_j for j in [begin, end), Q = prod_j q_j.
+// x holds the residues from x_begin on.
+static void scale_residues(uint64_t* x, const uint64_t* moduli, uint64_t begin,
+                           uint64_t end, uint64_t n) {
+    for (uint64_t j = begin; j < end; j++) {
+        uint64_t qj = moduli[j];
+        uint64_t inv =
+            InverseUIntMod(product_mod(moduli, begin, end, j, qj), qj);
+        uint64_t inv_precon = MultiplyFactor(inv, 64, qj).BarrettFactor();
+        uint64_t* xj = x + (j - begin) * n;
+        for (uint64_t l = 0; l < n; l++) {
+            xj[l] = MultiplyMod(xj[l], inv, inv_precon, qj);
+        }
     }
-    outstanding_objects_KeySwitch.clear();
+}
+
+// Hybrid keyswitching: the decomp_modulus_size limbs of the input are split
+// into digits of alpha = ceil((key_modulus_size - special_modulus_size) /
+// dnum) limbs. Each digit is raised to the ciphertext and special moduli by
+// fast base conversion, multiplied with its key and accumulated, tile by tile
+// of up to 7 moduli. The special moduli are then divided out with rounding.
+// dnum = key_modulus_size - 1 and special_modulus_size = 1 is the per-limb
+// decomposition of KeySwitch. The transforms and products run on device.
+struct HybridParams {
+    HybridParams(uint64_t n, uint64_t decomp_modulus_size,
+                 uint64_t key_modulus_size, uint64_t special_modulus_size,
+                 uint64_t dnum)
+        : n(n),
+          decomp_modulus_size(decomp_modulus_size),
+          key_modulus_size(key_modulus_size),
+          special_modulus_size(special_modulus_size),
+          special_begin(key_modulus_size - special_modulus_size),
+          alpha((special_begin + dnum - 1) / dnum),
+          digits((decomp_modulus_size + alpha - 1) / alpha),
+          rns_size(decomp_modulus_size + special_modulus_size) {}
+
+    // the key modulus of the output limb i: the ciphertext moduli, then the
+    // special moduli.
+    uint64_t key_index(uint64_t i) const {
+        return (i < decomp_modulus_size) ? i
+                                         : special_begin + i -
+                                               decomp_modulus_size;
+    }
+
+    uint64_t n;
+    uint64_t decomp_modulus_size;
+    uint64_t key_modulus_size;
+    uint64_t special_modulus_size;
+    uint64_t special_begin;
+    uint64_t alpha;
+    uint64_t digits;
+    uint64_t rns_size;
+};
+
+// the first phase of a hybrid keyswitch: each digit of the count inputs
+// raised to the moduli of the output limbs, in NTT form, the limb i of the
+// digit d at (d * rns_size + i) * n of raised[c]. It does not depend on the
+// keys, so the rotations of one ciphertext share it. The transforms of all
+// the inputs are one device batch each way, and the base conversions run on
+// separate threads.
+static void hybrid_decompose(int device, uint64_t* const* raised,
+                             const uint64_t* const* t_target_iter_ptrs,
+                             uint64_t count, const HybridParams& hp,
+                             const uint64_t* moduli) {
+    uint64_t n = hp.n;
+    uint64_t size = hp.decomp_modulus_size * n;
+
+    // the input limbs in coefficient form, scaled for the base conversion
+    // of their digit.
+    std::vector<uint64_t> t_target(count * size);
+    std::vector<uint64_t*> polys;
+    std::vector<uint64_t> poly_moduli;
+    for (uint64_t c = 0; c < count; c++) {
+        std::copy(t_target_iter_ptrs[c], t_target_iter_ptrs[c] + size,
+                  t_target.data() + c * size);
+        for (uint64_t j = 0; j < hp.decomp_modulus_size; j++) {
+            polys.push_back(t_target.data() + c * size + j * n);
+            poly_moduli.push_back(moduli[j]);
+        }
+    }
+    transform_polys(device, polys, poly_moduli, n, true);
+    cpu_parallel_for(count * hp.digits, [&](uint64_t id) {
+        uint64_t begin = (id % hp.digits) * hp.alpha;
+        uint64_t end = std::min(begin + hp.alpha, hp.decomp_modulus_size);
+        scale_residues(t_target.data() + (id / hp.digits) * size + begin * n,
+                       moduli, begin, end, n);
+    });
+
+    // a digit is already in NTT form for its own moduli.
+    polys.clear();
+    poly_moduli.clear();
+    std::vector<uint64_t> converted;
+    for (uint64_t c = 0; c < count; c++) {
+        for (uint64_t d = 0; d < hp.digits; d++) {
+            uint64_t begin = d * hp.alpha;
+            uint64_t end = std::min(begin + hp.alpha, hp.decomp_modulus_size);
+            for (uint64_t i = 0; i < hp.rns_size; i++) {
+                uint64_t* dst = raised[c] + (d * hp.rns_size + i) * n;
+                if ((i >= begin) && (i < end)) {
+                    std::copy(t_target_iter_ptrs[c] + i * n,
+                              t_target_iter_ptrs[c] + (i + 1) * n, dst);
+                    continue;
+                }
+                converted.push_back((c * hp.digits + d) * hp.rns_size + i);
+                polys.push_back(dst);
+                poly_moduli.push_back(moduli[hp.key_index(i)]);
+            }
+        }
+    }
+    cpu_parallel_for(converted.size(), [&](uint64_t p) {
+        uint64_t c = converted[p] / (hp.digits * hp.rns_size);
+        uint64_t begin = (converted[p] / hp.rns_size % hp.digits) * hp.alpha;
+        uint64_t end = std::min(begin + hp.alpha, hp.decomp_modulus_size);
+        base_convert(polys[p], t_target.data() + c * size + begin * n, moduli,
+                     begin, end, poly_moduli[p], n);
+    });
+    transform_polys(device, polys, poly_moduli, n, false);
+}
+
+// the second phase of a hybrid keyswitch: the raised digits of each input
+// multiplied with its keys and accumulated, tile by tile, and the special
+// moduli divided out with rounding. The results are added into results.
+// The ModDown transforms of all the inputs are one device batch each way.
+static void hybrid_key_multiply(int device, uint64_t* const* results,
+                                const uint64_t* const* raised, uint64_t count,
+                                const HybridParams& hp,
+                                uint64_t key_component_count,
+                                const uint64_t* moduli,
+                                const uint64_t** const* k_switch_keys) {
+    uint64_t n = hp.n;
+    uint64_t decomp_modulus_size = hp.decomp_modulus_size;
+    uint64_t key_modulus_size = hp.key_modulus_size;
+    uint64_t special_modulus_size = hp.special_modulus_size;
+    uint64_t special_begin = hp.special_begin;
+    uint64_t rns_size = hp.rns_size;
+
+    // the products accumulated over the digits, for each output limb.
+    uint64_t prod_size = key_component_count * rns_size * n;
+    std::vector<uint64_t> t_poly_prod(count * prod_size);
+
+    auto multiply = [&](uint64_t c) {
+        uint64_t* t_prod = t_poly_prod.data() + c * prod_size;
+        for (uint64_t first = 0; first < rns_size;
+             first += kKeySwitchMaxKeyModulusSize) {
+            uint64_t tile =
+                std::min(kKeySwitchMaxKeyModulusSize, rns_size - first);
+            std::vector<uint64_t> key_indices(tile);
+            std::vector<uint64_t> tile_moduli(tile);
+            for (uint64_t s = 0; s < tile; s++) {
+                key_indices[s] = hp.key_index(first + s);
+                tile_moduli[s] = moduli[key_indices[s]];
+            }
+
+            std::shared_ptr<const TileKeys> keys =
+                get_tile_keys(k_switch_keys[c], n, hp.digits,
+                              key_modulus_size, key_indices);
+            std::vector<const uint64_t*> operand2(hp.digits);
+            for (uint64_t d = 0; d < hp.digits; d++) {
+                operand2[d] = raised[c] + (d * rns_size + first) * n;
+            }
+            std::vector<uint64_t> prod(2 * tile * n);
+            tile_multiply_accumulate(device, prod.data(), *keys,
+                                     operand2.data(), hp.digits, n,
+                                     tile_moduli.data(), tile);
+            for (uint64_t k = 0; k < key_component_count; k++) {
+                std::copy(prod.data() + k * tile * n,
+                          prod.data() + (k + 1) * tile * n,
+                          t_prod + (k * rns_size + first) * n);
+            }
+        }
+    };
+    // the device runs the inputs one at a time, the cpu on separate threads.
+    if (device == CPU) {
+        cpu_parallel_for(count, multiply);
+    } else {
+        for (uint64_t c = 0; c < count; c++) {
+            multiply(c);
+        }
+    }
+
+    // the special limbs in coefficient form, rounded by adding (P - 1) / 2
+    // and scaled for the base conversion, P = prod_t p_t. P is odd, so
+    // [(P - 1) / 2]_m = ([P]_m - 1) / 2 mod m.
+    auto half_p_mod = [&](uint64_t m) {
+        uint64_t p_mod =
+            product_mod(moduli, special_begin, key_modulus_size,
+                        key_modulus_size, m);
+        uint64_t inv2 = InverseUIntMod(2, m);
+        return MultiplyUIntMod((p_mod + m - 1) % m, inv2, m);
+    };
+    uint64_t special_size = special_modulus_size * n;
+    std::vector<uint64_t> t_special(count * key_component_count *
+                                    special_size);
+    std::vector<uint64_t*> polys;
+    std::vector<uint64_t> poly_moduli;
+    for (uint64_t c = 0; c < count; c++) {
+        for (uint64_t k = 0; k < key_component_count; k++) {
+            for (uint64_t t = 0; t < special_modulus_size; t++) {
+                const uint64_t* src =
+                    t_poly_prod.data() + c * prod_size +
+                    (k * rns_size + decomp_modulus_size + t) * n;
+                uint64_t* dst = t_special.data() +
+                                (c * key_component_count + k) * special_size +
+                                t * n;
+                std::copy(src, src + n, dst);
+                polys.push_back(dst);
+                poly_moduli.push_back(moduli[special_begin + t]);
+            }
+        }
+    }
+    transform_polys(device, polys, poly_moduli, n, true);
+    std::vector<uint64_t> half_p(special_modulus_size);
+    for (uint64_t t = 0; t < special_modulus_size; t++) {
+        half_p[t] = half_p_mod(moduli[special_begin + t]);
+    }
+    cpu_parallel_for(count * key_component_count, [&](uint64_t ck) {
+        uint64_t* x = t_special.data() + ck * special_size;
+        for (uint64_t t = 0; t < special_modulus_size; t++) {
+            uint64_t pt = moduli[special_begin + t];
+            for (uint64_t l = 0; l < n; l++) {
+                x[t * n + l] = AddUIntMod(x[t * n + l], half_p[t], pt);
+            }
+        }
+        scale_residues(x, moduli, special_begin, key_modulus_size, n);
+    });
+
+    // the rounded special part converted to each ciphertext modulus, back in
+    // NTT form, the limb i of the component k of the input c at
+    // ((c * decomp_modulus_size + i) * key_component_count + k) * n of t.
+    std::vector<uint64_t> t(count * decomp_modulus_size * key_component_count *
+                            n);
+    polys.clear();
+    poly_moduli.clear();
+    for (uint64_t p = 0; p < count * decomp_modulus_size * key_component_count;
+         p++) {
+        polys.push_back(t.data() + p * n);
+        poly_moduli.push_back(
+            moduli[p / key_component_count % decomp_modulus_size]);
+    }
+    cpu_parallel_for(polys.size(), [&](uint64_t p) {
+        uint64_t c = p / (decomp_modulus_size * key_component_count);
+        uint64_t k = p % key_component_count;
+        uint64_t qi = poly_moduli[p];
+        uint64_t half = half_p_mod(qi);
+        uint64_t* dst = polys[p];
+        base_convert(dst,
+                     t_special.data() +
+                         (c * key_component_count + k) * special_size,
+                     moduli, special_begin, key_modulus_size, qi, n);
+        for (uint64_t l = 0; l < n; l++) {
+            dst[l] = (dst[l] >= half) ? dst[l] - half : dst[l] + qi - half;
+        }
+    });
+    transform_polys(device, polys, poly_moduli, n, false);
+
+    // results += (t_poly_prod_i - t_i) * P^-1 mod q_i
+    cpu_parallel_for(count * decomp_modulus_size, [&](uint64_t ci) {
+        uint64_t c = ci / decomp_modulus_size;
+        uint64_t i = ci % decomp_modulus_size;
+        uint64_t qi = moduli[i];
+        uint64_t factor = InverseUIntMod(
+            product_mod(moduli, special_begin, key_modulus_size,
+                        key_modulus_size, qi),
+            qi);
+        uint64_t factor_precon = MultiplyFactor(factor, 64, qi).BarrettFactor();
+        for (uint64_t k = 0; k < key_component_count; k++) {
+            const uint64_t* x =
+                t_poly_prod.data() + c * prod_size + (k * rns_size + i) * n;
+            const uint64_t* ti = t.data() + (ci * key_component_count + k) * n;
+            uint64_t* r = results[c] + (k * decomp_modulus_size + i) * n;
+            for (uint64_t l = 0; l < n; l++) {
+                uint64_t d = (x[l] >= ti[l]) ? x[l] - ti[l] : x[l] + qi - ti[l];
+                d = MultiplyMod(d, factor, factor_precon, qi);
+                r[l] = AddUIntMod(r[l], d, qi);
+            }
+        }
+    });
+}
+
+// the hybrid keyswitch of count inputs with the same keys
+static void hybrid_KeySwitch(int device, uint64_t* const* results,
+                             const uint64_t* const* t_target_iter_ptrs,
+                             uint64_t count, uint64_t n,
+                             uint64_t decomp_modulus_size,
+                             uint64_t key_modulus_size,
+                             uint64_t special_modulus_size, uint64_t dnum,
+                             uint64_t key_component_count,
+                             const uint64_t* moduli,
+                             const uint64_t** k_switch_keys) {
+    HybridParams hp(n, decomp_modulus_size, key_modulus_size,
+                    special_modulus_size, dnum);
+    uint64_t size = hp.digits * hp.rns_size * n;
+    std::vector<uint64_t> raised(count * size);
+    std::vector<uint64_t*> raised_ptrs(count);
+    for (uint64_t c = 0; c < count; c++) {
+        raised_ptrs[c] = raised.data() + c * size;
+    }
+    hybrid_decompose(device, raised_ptrs.data(), t_target_iter_ptrs, count,
+                     hp, moduli);
+    std::vector<const uint64_t**> keys(count, k_switch_keys);
+    hybrid_key_multiply(device, results, raised_ptrs.data(), count, hp,
+                        key_component_count, moduli, keys.data());
+}
+
+// hoisted rotations of c1 = t_target_iter_ptr by the Galois elements of
+// tables: c1 is decomposed once, and each step permutes the raised digits
+// in NTT form before multiplying them with its keys. The automorphism is
+// applied to the integer lifts of the digits rather than to c1, so a step
+// differs from the keyswitch of the rotated c1 by the lift of the negated
+// coefficients, which is still a keyswitch of it, as in other libraries.
+static void hybrid_RotateSteps(int device, uint64_t** results,
+                               const uint64_t* t_target_iter_ptr,
+                               uint64_t steps, const uint32_t* const* tables,
+                               uint64_t n, uint64_t decomp_modulus_size,
+                               uint64_t key_modulus_size,
+                               uint64_t key_component_count,
+                               const uint64_t* moduli,
+                               const uint64_t*** k_switch_keys) {
+    HybridParams hp(n, decomp_modulus_size, key_modulus_size, 1,
+                    key_modulus_size - 1);
+    uint64_t size = hp.digits * hp.rns_size * n;
+    std::vector<uint64_t> raised(size);
+    uint64_t* raised_ptr = raised.data();
+    hybrid_decompose(device, &raised_ptr, &t_target_iter_ptr, 1, hp, moduli);
+
+    std::vector<uint64_t> rotated(steps * size);
+    std::vector<uint64_t*> rotated_ptrs(steps);
+    for (uint64_t s = 0; s < steps; s++) {
+        rotated_ptrs[s] = rotated.data() + s * size;
+    }
+    cpu_parallel_for(steps, [&](uint64_t s) {
+        ApplyGaloisPermutation(raised_ptr, n, hp.digits * hp.rns_size,
+                               tables[s], rotated_ptrs[s]);
+    });
+    hybrid_key_multiply(device, results, rotated_ptrs.data(), steps, hp,
+                        key_component_count, moduli, k_switch_keys);
+}
+
+bool KeySwitchCompleted_int() {
+    bool all_done = wait_outstanding(outstanding_objects_KeySwitch);
 
     fpga_buffer.set_worksize_KeySwitch(1);
 
     return all_done;
 }
 
+// KeySwitch on the cpu, as the per-limb hybrid keyswitch over the CpuNTT
+// and the cpu dyadic multiply. The modswitch factors and twiddle factors of
+// the keyswitch kernel are not used.
+static void cpu_KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr,
+                          uint64_t n, uint64_t decomp_modulus_size,
+                          uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                          uint64_t key_component_count, const uint64_t* moduli,
+                          const uint64_t** k_switch_keys,
+                          const uint64_t* modswitch_factors,
+                          const uint64_t* twiddle_factors) {
+    hybrid_KeySwitch(CPU, &result, &t_target_iter_ptr, 1, n,
+                     decomp_modulus_size, key_modulus_size, 1,
+                     key_modulus_size - 1, key_component_count, moduli,
+                     k_switch_keys);
+}
+
 void KeySwitch_int(uint64_t* result, const uint64_t* t_target_iter_ptr,
                    uint64_t n, uint64_t decomp_modulus_size,
                    uint64_t key_modulus_size, uint64_t rns_modulus_size,
@@ -513,7 +1797,7 @@ void KeySwitch_int(uint64_t* result, const uint64_t* t_target_iter_ptr,
                    const uint64_t** k_switch_keys,
                    const uint64_t* modswitch_factors,
                    const uint64_t* twiddle_factors) {
-    switch (g_choice) {
+    switch (keyswitch_device(n, key_modulus_size)) {
     case CPU:
         cpu_KeySwitch(result, t_target_iter_ptr, n, decomp_modulus_size,
                       key_modulus_size, rns_modulus_size, key_component_count,
@@ -522,6 +1806,13 @@ void KeySwitch_int(uint64_t* result, const uint64_t* t_target_iter_ptr,
         break;
     case EMU:
     case FPGA:
+        if (g_keyswitch_tiled) {
+            hybrid_KeySwitch(g_choice, &result, &t_target_iter_ptr, 1, n,
+                             decomp_modulus_size, key_modulus_size, 1,
+                             key_modulus_size - 1, key_component_count,
+                             moduli, k_switch_keys);
+            break;
+        }
         fpga_KeySwitch(result, t_target_iter_ptr, n, decomp_modulus_size,
                        key_modulus_size, rns_modulus_size, key_component_count,
                        moduli, k_switch_keys, modswitch_factors,
@@ -536,6 +1827,362 @@ void KeySwitch_int(uint64_t* result, const uint64_t* t_target_iter_ptr,
     }
 }
 
+void KeySwitchBatch_int(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                        uint64_t count, uint64_t n,
+                        uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                        uint64_t rns_modulus_size, uint64_t key_component_count,
+                        const uint64_t* moduli, const uint64_t** k_switch_keys,
+                        const uint64_t* modswitch_factors,
+                        const uint64_t* twiddle_factors) {
+    switch (keyswitch_device(n, key_modulus_size)) {
+    case CPU:
+        hybrid_KeySwitch(CPU, results, t_target_iter_ptrs, count, n,
+                         decomp_modulus_size, key_modulus_size, 1,
+                         key_modulus_size - 1, key_component_count, moduli,
+                         k_switch_keys);
+        break;
+    case EMU:
+    case FPGA:
+        if (g_keyswitch_tiled) {
+            hybrid_KeySwitch(g_choice, results, t_target_iter_ptrs, count, n,
+                             decomp_modulus_size, key_modulus_size, 1,
+                             key_modulus_size - 1, key_component_count,
+                             moduli, k_switch_keys);
+            break;
+        }
+        if (run_hybrid(
+                "KeySwitch", kernel_t::KEYSWITCH, count, muKeySwitch,
+                [&](uint64_t m) {
+                    push_KeySwitchBatch(results, t_target_iter_ptrs, m, n,
+                                        decomp_modulus_size, key_modulus_size,
+                                        rns_modulus_size, key_component_count,
+                                        moduli, k_switch_keys,
+                                        modswitch_factors, twiddle_factors,
+                                        nullptr);
+                },
+                [&](uint64_t i) {
+                    cpu_KeySwitch(results[i], t_target_iter_ptrs[i], n,
+                                  decomp_modulus_size, key_modulus_size,
+                                  rns_modulus_size, key_component_count,
+                                  moduli, k_switch_keys, modswitch_factors,
+                                  twiddle_factors);
+                },
+                KeySwitchCompleted_int)) {
+            break;
+        }
+        fpga_KeySwitchBatch(results, t_target_iter_ptrs, count, n,
+                            decomp_modulus_size, key_modulus_size,
+                            rns_modulus_size, key_component_count, moduli,
+                            k_switch_keys, modswitch_factors, twiddle_factors);
+        break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void KeySwitchHybrid_int(uint64_t** results,
+                         const uint64_t** t_target_iter_ptrs, uint64_t count,
+                         uint64_t n, uint64_t decomp_modulus_size,
+                         uint64_t key_modulus_size,
+                         uint64_t special_modulus_size, uint64_t dnum,
+                         uint64_t key_component_count, const uint64_t* moduli,
+                         const uint64_t** k_switch_keys) {
+    hybrid_KeySwitch(g_choice, results, t_target_iter_ptrs, count, n,
+                     decomp_modulus_size, key_modulus_size,
+                     special_modulus_size, dnum, key_component_count, moduli,
+                     k_switch_keys);
+}
+
+void MultiplyRelinearize_int(
+    uint64_t** results, const uint64_t** operand1, const uint64_t** operand2,
+    uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+    uint64_t key_modulus_size, uint64_t rns_modulus_size,
+    uint64_t key_component_count, const uint64_t* moduli,
+    const uint64_t** k_switch_keys, const uint64_t* modswitch_factors,
+    const uint64_t* twiddle_factors) {
+    // the third component of each product is the keyswitch input, and the
+    // keyswitch results are accumulated into the first two components.
+    std::vector<const uint64_t*> t_target_iter_ptrs;
+    t_target_iter_ptrs.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        t_target_iter_ptrs.push_back(results[i] + 2 * decomp_modulus_size * n);
+    }
+
+    switch (g_choice) {
+    case CPU:
+        cpu_parallel_for(count, [&](uint64_t i) {
+            cpu_DyadicMultiply(results[i], operand1[i], operand2[i], n, moduli,
+                               decomp_modulus_size);
+            cpu_KeySwitch(results[i], t_target_iter_ptrs[i], n,
+                          decomp_modulus_size, key_modulus_size,
+                          rns_modulus_size, key_component_count, moduli,
+                          k_switch_keys, modswitch_factors, twiddle_factors);
+        });
+        break;
+    case EMU:
+    case FPGA: {
+        // the keyswitch kernel reads the third components from the device
+        // memory the dyadic kernel wrote them to, which takes both batches
+        // on the same device. Otherwise they run one after the other.
+        if ((pool->device_count() != 1) || g_keyswitch_tiled ||
+            (keyswitch_device(n, key_modulus_size) != g_choice)) {
+            DyadicMultiplyBatch_int(results, operand1, operand2, count, n,
+                                    moduli, decomp_modulus_size);
+            KeySwitchBatch_int(results, t_target_iter_ptrs.data(), count, n,
+                               decomp_modulus_size, key_modulus_size,
+                               rns_modulus_size, key_component_count, moduli,
+                               k_switch_keys, modswitch_factors,
+                               twiddle_factors);
+            break;
+        }
+
+        std::scoped_lock locker(muDyadicMultiply, muKeySwitch);
+        FPGA_ASSERT((fpga_buffer.get_worksize_DyadicMultiply() == 1) &&
+                        (fpga_buffer.get_worksize_KeySwitch() == 1),
+                    "MultiplyRelinearize requires synchronous execution");
+        fpga_buffer.set_worksize_DyadicMultiply(count);
+        fpga_buffer.set_worksize_KeySwitch(count);
+
+        std::vector<const Object_DyadicMultiply*> relinearized(count);
+        push_DyadicMultiplyBatch(results, operand1, operand2, count, n, moduli,
+                                 decomp_modulus_size, false, false, nullptr,
+                                 relinearized.data());
+        push_KeySwitchBatch(results, t_target_iter_ptrs.data(), count, n,
+                            decomp_modulus_size, key_modulus_size,
+                            rns_modulus_size, key_component_count, moduli,
+                            k_switch_keys, modswitch_factors, twiddle_factors,
+                            nullptr, relinearized.data());
+
+        // the multiplications are released last, the keyswitches read them.
+        KeySwitchCompleted_int();
+        DyadicMultiplyCompleted_int();
+        break;
+    }
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+// the permutation tables are kept for the lifetime of the process, since the
+// objects in flight point to them.
+static const uint32_t* get_galois_table(uint64_t n, uint64_t galois_elt) {
+    static std::unordered_map<uint64_t, std::vector<uint32_t>> tables;
+    std::lock_guard<std::mutex> locker(muGalois);
+    uint64_t key = (n << 32) | galois_elt;
+    auto iter = tables.find(key);
+    if (iter == tables.end()) {
+        iter = tables.emplace(key, std::vector<uint32_t>()).first;
+        ComputeGaloisPermutationNTT(n, galois_elt, &iter->second);
+    }
+    return iter->second.data();
+}
+
+void Rotate_int(uint64_t** results, const uint64_t** ciphertexts,
+                uint64_t count, uint64_t galois_elt, uint64_t n,
+                uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                uint64_t rns_modulus_size, uint64_t key_component_count,
+                const uint64_t* moduli, const uint64_t** k_switch_keys,
+                const uint64_t* modswitch_factors,
+                const uint64_t* twiddle_factors) {
+    const uint32_t* table = get_galois_table(n, galois_elt);
+    uint64_t size = decomp_modulus_size * n;
+
+    // result = (galois(c0), 0) + KeySwitch(galois(c1))
+    std::vector<const uint64_t*> t_target_iter_ptrs;
+    t_target_iter_ptrs.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        ApplyGaloisPermutation(ciphertexts[i], n, decomp_modulus_size, table,
+                               results[i]);
+        std::fill(results[i] + size, results[i] + 2 * size, 0);
+        t_target_iter_ptrs.push_back(ciphertexts[i] + size);
+    }
+
+    switch (keyswitch_device(n, key_modulus_size)) {
+    case CPU:
+        cpu_parallel_for(count, [&](uint64_t i) {
+            std::vector<uint64_t> c1(size);
+            ApplyGaloisPermutation(t_target_iter_ptrs[i], n,
+                                   decomp_modulus_size, table, c1.data());
+            cpu_KeySwitch(results[i], c1.data(), n, decomp_modulus_size,
+                          key_modulus_size, rns_modulus_size,
+                          key_component_count, moduli, k_switch_keys,
+                          modswitch_factors, twiddle_factors);
+        });
+        break;
+    case EMU:
+    case FPGA:
+        if (g_keyswitch_tiled) {
+            std::vector<uint64_t> c1(count * size);
+            std::vector<const uint64_t*> c1_ptrs(count);
+            for (uint64_t i = 0; i < count; i++) {
+                ApplyGaloisPermutation(t_target_iter_ptrs[i], n,
+                                       decomp_modulus_size, table,
+                                       c1.data() + i * size);
+                c1_ptrs[i] = c1.data() + i * size;
+            }
+            hybrid_KeySwitch(g_choice, results, c1_ptrs.data(), count, n,
+                             decomp_modulus_size, key_modulus_size, 1,
+                             key_modulus_size - 1, key_component_count,
+                             moduli, k_switch_keys);
+            break;
+        }
+        // c1 is permuted by the runner while staging the keyswitch input.
+        fpga_KeySwitchBatch(results, t_target_iter_ptrs.data(), count, n,
+                            decomp_modulus_size, key_modulus_size,
+                            rns_modulus_size, key_component_count, moduli,
+                            k_switch_keys, modswitch_factors, twiddle_factors,
+                            table);
+        break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void RotateSteps_int(uint64_t** results, const uint64_t* ciphertext,
+                     uint64_t steps, const uint64_t* galois_elts, uint64_t n,
+                     uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                     uint64_t rns_modulus_size, uint64_t key_component_count,
+                     const uint64_t* moduli, const uint64_t*** k_switch_keys,
+                     const uint64_t* modswitch_factors,
+                     const uint64_t* twiddle_factors) {
+    uint64_t size = decomp_modulus_size * n;
+    const uint64_t* c1 = ciphertext + size;
+
+    std::vector<const uint32_t*> tables(steps);
+    for (uint64_t s = 0; s < steps; s++) {
+        tables[s] = get_galois_table(n, galois_elts[s]);
+        ApplyGaloisPermutation(ciphertext, n, decomp_modulus_size, tables[s],
+                               results[s]);
+        std::fill(results[s] + size, results[s] + 2 * size, 0);
+    }
+
+    switch (keyswitch_device(n, key_modulus_size)) {
+    case CPU:
+        hybrid_RotateSteps(CPU, results, c1, steps, tables.data(), n,
+                           decomp_modulus_size, key_modulus_size,
+                           key_component_count, moduli, k_switch_keys);
+        break;
+    case EMU:
+    case FPGA: {
+        if (g_keyswitch_tiled) {
+            hybrid_RotateSteps(g_choice, results, c1, steps, tables.data(), n,
+                               decomp_modulus_size, key_modulus_size,
+                               key_component_count, moduli, k_switch_keys);
+            break;
+        }
+        // the keyswitch kernel decomposes its input inside its pipeline, so
+        // it cannot be hoisted: all the rotations are queued before waiting,
+        // so the keyswitch of one step overlaps the staging and the readback
+        // of the others. Every step reads c1 in place through its own table.
+        // The keys of the steps differ, so each step is a device batch of
+        // its own.
+        std::lock_guard<std::mutex> locker(muKeySwitch);
+        FPGA_ASSERT(fpga_buffer.get_worksize_KeySwitch() == 1,
+                    "RotateSteps requires synchronous KeySwitch");
+        fpga_buffer.set_worksize_KeySwitch(steps);
+        for (uint64_t s = 0; s < steps; s++) {
+            push_KeySwitchBatch(&results[s], &c1, 1, n, decomp_modulus_size,
+                                key_modulus_size, rns_modulus_size,
+                                key_component_count, moduli, k_switch_keys[s],
+                                modswitch_factors, twiddle_factors, tables[s]);
+        }
+        KeySwitchCompleted_int();
+    } break;
+    default:
+        std::cerr << "ERROR: Invalid RUN_CHOICE envvar. Set to a valid "
+                     "value {0, 1, or 2}, where 0:CPU, 1:EMU, 2:FPGA."
+                  << std::endl;
+        FPGA_ASSERT(0);
+        break;
+    }
+}
+
+void Rescale_int(uint64_t** results, const uint64_t** operands,
+                 uint64_t count, uint64_t n, uint64_t num_components,
+                 uint64_t num_moduli, const uint64_t* moduli) {
+    uint64_t last = num_moduli - 1;
+    uint64_t q_last = moduli[last];
+    uint64_t half = q_last >> 1;
+    uint64_t polys = count * num_components;
+
+    // c_last in coefficient form, rounded: (c_last + q_last / 2) mod q_last
+    std::vector<uint64_t> c_last(polys * n);
+    for (uint64_t p = 0; p < polys; p++) {
+        const uint64_t* src =
+            operands[p / num_components] +
+            ((p % num_components) * num_moduli + last) * n;
+        std::copy(src, src + n, c_last.data() + p * n);
+    }
+
+    // the reduced c_last of each remaining modulus, back in NTT form
+    std::vector<uint64_t> t(polys * last * n);
+
+    // like every transform of transform_polys, on the cpu while the caller
+    // queues asynchronous transforms
+    std::vector<uint64_t*> c_last_polys(polys);
+    for (uint64_t p = 0; p < polys; p++) {
+        c_last_polys[p] = c_last.data() + p * n;
+    }
+    transform_polys(g_choice, c_last_polys,
+                    std::vector<uint64_t>(polys, q_last), n, true);
+
+    for (uint64_t i = 0; i < last; i++) {
+        uint64_t qi = moduli[i];
+        uint64_t half_mod = half % qi;
+        for (uint64_t p = 0; p < polys; p++) {
+            const uint64_t* src = c_last.data() + p * n;
+            uint64_t* dst = t.data() + (i * polys + p) * n;
+            for (uint64_t j = 0; j < n; j++) {
+                uint64_t x = src[j] + half;
+                x = (x >= q_last) ? x - q_last : x;
+                x %= qi;
+                dst[j] = (x >= half_mod) ? x - half_mod : x + qi - half_mod;
+            }
+        }
+    }
+
+    // the polynomials of one modulus are contiguous, so that the kernel
+    // streams each twiddle table once.
+    std::vector<uint64_t*> t_polys(polys * last);
+    std::vector<uint64_t> t_moduli(polys * last);
+    for (uint64_t p = 0; p < polys * last; p++) {
+        t_polys[p] = t.data() + p * n;
+        t_moduli[p] = moduli[p / polys];
+    }
+    transform_polys(g_choice, t_polys, t_moduli, n, false);
+
+    // result = (c_i - t_i) * q_last^-1 mod q_i
+    for (uint64_t i = 0; i < last; i++) {
+        uint64_t qi = moduli[i];
+        uint64_t inv_q_last = InverseUIntMod(q_last % qi, qi);
+        uint64_t inv_q_last_precon =
+            MultiplyFactor(inv_q_last, 64, qi).BarrettFactor();
+        for (uint64_t p = 0; p < polys; p++) {
+            uint64_t k = p % num_components;
+            const uint64_t* c = operands[p / num_components] +
+                                (k * num_moduli + i) * n;
+            const uint64_t* ti = t.data() + (i * polys + p) * n;
+            uint64_t* r = results[p / num_components] + (k * last + i) * n;
+            for (uint64_t j = 0; j < n; j++) {
+                uint64_t d = (c[j] >= ti[j]) ? c[j] - ti[j] : c[j] + qi - ti[j];
+                r[j] = MultiplyMod(d, inv_q_last, inv_q_last_precon, qi);
+            }
+        }
+    }
+}
+
 }  // namespace fpga
 }  // namespace hexl
 }  // namespace intel
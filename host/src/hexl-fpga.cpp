@@ -9,7 +9,11 @@
 #include "fpga_context.h"
 #include "intt.h"
 #include "keyswitch.h"
+#include "multiply_relinearize.h"
 #include "ntt.h"
+#include "rescale.h"
+#include "rotate.h"
+#include "transform.h"
 
 namespace intel {
 namespace hexl {
@@ -31,6 +35,44 @@ void set_worksize_DyadicMultiply(uint64_t ws) {
     intel::hexl::fpga::set_worksize_DyadicMultiply(ws);
 }
 
+void DyadicMultiplyBatch(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         const uint64_t* moduli, uint64_t n_moduli) {
+    intel::hexl::fpga::DyadicMultiplyBatch(results, operand1, operand2, count,
+                                           n, moduli, n_moduli);
+}
+
+void MultiplyPlain(uint64_t* results, const uint64_t* ciphertext,
+                   const uint64_t* plaintext, uint64_t n,
+                   const uint64_t* moduli, uint64_t n_moduli) {
+    intel::hexl::fpga::MultiplyPlain(results, ciphertext, plaintext, n, moduli,
+                                     n_moduli);
+}
+
+void MultiplyPlainBatch(uint64_t** results, const uint64_t** ciphertext,
+                        const uint64_t** plaintext, uint64_t count,
+                        uint64_t n, const uint64_t* moduli,
+                        uint64_t n_moduli) {
+    intel::hexl::fpga::MultiplyPlainBatch(results, ciphertext, plaintext,
+                                          count, n, moduli, n_moduli);
+}
+
+void DyadicMultiplyAccumulate(uint64_t* results, const uint64_t** operand1,
+                              const uint64_t** operand2, uint64_t count,
+                              uint64_t n, const uint64_t* moduli,
+                              uint64_t n_moduli) {
+    intel::hexl::fpga::DyadicMultiplyAccumulate(
+        results, operand1, operand2, count, n, moduli, n_moduli);
+}
+
+void MultiplyPlainAccumulate(uint64_t* results, const uint64_t** ciphertext,
+                             const uint64_t** plaintext, uint64_t count,
+                             uint64_t n, const uint64_t* moduli,
+                             uint64_t n_moduli) {
+    intel::hexl::fpga::MultiplyPlainAccumulate(
+        results, ciphertext, plaintext, count, n, moduli, n_moduli);
+}
+
 bool DyadicMultiplyCompleted() {
     return intel::hexl::fpga::DyadicMultiplyCompleted();
 }
@@ -52,8 +94,127 @@ void set_worksize_KeySwitch(uint64_t ws) {
     intel::hexl::fpga::set_worksize_KeySwitch(ws);
 }
 
+void KeySwitchBatch(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                    uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                    uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                    uint64_t key_component_count, const uint64_t* moduli,
+                    const uint64_t** k_switch_keys,
+                    const uint64_t* modswitch_factors,
+                    const uint64_t* twiddle_factors) {
+    intel::hexl::fpga::KeySwitchBatch(
+        results, t_target_iter_ptrs, count, n, decomp_modulus_size,
+        key_modulus_size, rns_modulus_size, key_component_count, moduli,
+        k_switch_keys, modswitch_factors, twiddle_factors);
+}
+
+void KeySwitchHybrid(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                     uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                     uint64_t key_modulus_size, uint64_t special_modulus_size,
+                     uint64_t dnum, uint64_t key_component_count,
+                     const uint64_t* moduli, const uint64_t** k_switch_keys) {
+    intel::hexl::fpga::KeySwitchHybrid(
+        results, t_target_iter_ptrs, count, n, decomp_modulus_size,
+        key_modulus_size, special_modulus_size, dnum, key_component_count,
+        moduli, k_switch_keys);
+}
+
 bool KeySwitchCompleted() { return intel::hexl::fpga::KeySwitchCompleted(); }
 
+// MultiplyRelinearize Section
+void MultiplyRelinearize(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         uint64_t decomp_modulus_size,
+                         uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                         uint64_t key_component_count, const uint64_t* moduli,
+                         const uint64_t** k_switch_keys,
+                         const uint64_t* modswitch_factors,
+                         const uint64_t* twiddle_factors) {
+    intel::hexl::fpga::MultiplyRelinearize(
+        results, operand1, operand2, count, n, decomp_modulus_size,
+        key_modulus_size, rns_modulus_size, key_component_count, moduli,
+        k_switch_keys, modswitch_factors, twiddle_factors);
+}
+
+// Rotate Section
+void Rotate(uint64_t** results, const uint64_t** ciphertexts, uint64_t count,
+            uint64_t galois_elt, uint64_t n, uint64_t decomp_modulus_size,
+            uint64_t key_modulus_size, uint64_t rns_modulus_size,
+            uint64_t key_component_count, const uint64_t* moduli,
+            const uint64_t** k_switch_keys, const uint64_t* modswitch_factors,
+            const uint64_t* twiddle_factors) {
+    intel::hexl::fpga::Rotate(results, ciphertexts, count, galois_elt, n,
+                              decomp_modulus_size, key_modulus_size,
+                              rns_modulus_size, key_component_count, moduli,
+                              k_switch_keys, modswitch_factors,
+                              twiddle_factors);
+}
+
+void RotateSteps(uint64_t** results, const uint64_t* ciphertext, uint64_t steps,
+                 const uint64_t* galois_elts, uint64_t n,
+                 uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                 uint64_t rns_modulus_size, uint64_t key_component_count,
+                 const uint64_t* moduli, const uint64_t*** k_switch_keys,
+                 const uint64_t* modswitch_factors,
+                 const uint64_t* twiddle_factors) {
+    intel::hexl::fpga::RotateSteps(
+        results, ciphertext, steps, galois_elts, n, decomp_modulus_size,
+        key_modulus_size, rns_modulus_size, key_component_count, moduli,
+        k_switch_keys, modswitch_factors, twiddle_factors);
+}
+
+// Rescale Section
+void Rescale(uint64_t** results, const uint64_t** operands, uint64_t count,
+             uint64_t n, uint64_t num_components, uint64_t num_moduli,
+             const uint64_t* moduli) {
+    intel::hexl::fpga::Rescale(results, operands, count, n, num_components,
+                               num_moduli, moduli);
+}
+
+// RNS transforms Section
+void NTTRns(uint64_t* coeff_poly, const uint64_t* moduli, uint64_t num_moduli,
+            uint64_t n) {
+    intel::hexl::fpga::NTTRns(coeff_poly, moduli, num_moduli, n);
+}
+
+void INTTRns(uint64_t* coeff_poly, const uint64_t* moduli, uint64_t num_moduli,
+             uint64_t n) {
+    intel::hexl::fpga::INTTRns(coeff_poly, moduli, num_moduli, n);
+}
+
+// Transform Section
+uint64_t CreateTransformPlan(uint64_t n, uint64_t modulus,
+                             uint64_t root_of_unity) {
+    return intel::hexl::fpga::CreateTransformPlan(n, modulus, root_of_unity);
+}
+
+void DestroyTransformPlan(uint64_t plan) {
+    intel::hexl::fpga::DestroyTransformPlan(plan);
+}
+
+void set_worksize_ForwardTransform(uint64_t ws) {
+    intel::hexl::fpga::set_worksize_ForwardTransform(ws);
+}
+
+void ForwardTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan) {
+    intel::hexl::fpga::ForwardTransform(coeff_polys, count, plan);
+}
+
+bool ForwardTransformCompleted() {
+    return intel::hexl::fpga::ForwardTransformCompleted();
+}
+
+void set_worksize_InverseTransform(uint64_t ws) {
+    intel::hexl::fpga::set_worksize_InverseTransform(ws);
+}
+
+void InverseTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan) {
+    intel::hexl::fpga::InverseTransform(coeff_polys, count, plan);
+}
+
+bool InverseTransformCompleted() {
+    return intel::hexl::fpga::InverseTransformCompleted();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 //
 // WARNING: The following NTT and INTT related APIs are deprecated since
@@ -0,0 +1,171 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "host_memory_pool.h"
+
+#include <sys/mman.h>
+
+#include <cstdlib>
+#include <iostream>
+
+#include "fpga_assert.h"
+#include "numa_util.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+static const size_t k2MB = size_t(1) << 21;
+static const size_t k1GB = size_t(1) << 30;
+
+static size_t round_up(size_t size, size_t align) {
+    return (size + align - 1) & ~(align - 1);
+}
+
+static bool get_use_huge_pages() {
+    char* env = getenv("FPGA_HUGEPAGES");
+    return env ? (atoi(env) != 0) : true;
+}
+
+HostMemoryPool& HostMemoryPool::instance() {
+    static HostMemoryPool pool;
+    return pool;
+}
+
+HostMemoryPool::HostMemoryPool()
+    : use_huge_pages_(get_use_huge_pages()), stats_{} {}
+
+HostMemoryPool::~HostMemoryPool() {
+    for (auto& b : free_blocks_) {
+        munmap(b.second.ptr, b.second.capacity);
+    }
+    free_blocks_.clear();
+    for (auto& b : used_blocks_) {
+        munmap(b.second.ptr, b.second.capacity);
+    }
+    used_blocks_.clear();
+}
+
+HostMemoryPool::Block HostMemoryPool::map_block(size_t size, int numa_node) {
+    const int prot = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    Block b = {MAP_FAILED, 0, numa_node, PAGE_DEFAULT};
+
+    if (use_huge_pages_ && (size >= k1GB)) {
+        b.capacity = round_up(size, k1GB);
+        b.ptr = mmap(nullptr, b.capacity, prot,
+                     flags | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+        b.page = PAGE_1G;
+    }
+    if (use_huge_pages_ && (b.ptr == MAP_FAILED)) {
+        b.capacity = round_up(size, k2MB);
+        b.ptr = mmap(nullptr, b.capacity, prot,
+                     flags | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        b.page = PAGE_2M;
+    }
+    if (b.ptr == MAP_FAILED) {
+        b.capacity = round_up(size, k2MB);
+        b.ptr = mmap(nullptr, b.capacity, prot, flags, -1, 0);
+        b.page = PAGE_DEFAULT;
+        FPGA_ASSERT(b.ptr != MAP_FAILED, "host staging memory mmap failed");
+        if (use_huge_pages_) {
+            advise_huge_pages(b.ptr, b.capacity);
+        }
+    }
+
+    // set the policy before the first touch so pages land on the node.
+    host_bind_memory_to_node(b.ptr, b.capacity, numa_node);
+
+    switch (b.page) {
+    case PAGE_1G:
+        stats_.huge_1g_blocks++;
+        break;
+    case PAGE_2M:
+        stats_.huge_2m_blocks++;
+        break;
+    default:
+        stats_.fallback_blocks++;
+        break;
+    }
+    stats_.bytes_mapped += b.capacity;
+    return b;
+}
+
+void* HostMemoryPool::allocate(size_t size, int numa_node) {
+    if (size == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> locker(mu_);
+
+    // reuse the smallest released block that fits, without wasting more
+    // than half of it.
+    auto iter = free_blocks_.lower_bound(size);
+    while ((iter != free_blocks_.end()) && (iter->first <= 2 * size + k2MB)) {
+        const Block& b = iter->second;
+        if ((numa_node < 0) || (b.numa_node == numa_node)) {
+            Block reused = b;
+            free_blocks_.erase(iter);
+            used_blocks_.emplace(reused.ptr, reused);
+            stats_.reused_blocks++;
+            return reused.ptr;
+        }
+        iter++;
+    }
+
+    Block b = map_block(size, numa_node);
+    used_blocks_.emplace(b.ptr, b);
+    return b.ptr;
+}
+
+void HostMemoryPool::release(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> locker(mu_);
+    auto iter = used_blocks_.find(ptr);
+    FPGA_ASSERT(iter != used_blocks_.end(),
+                "pointer not allocated by the HostMemoryPool");
+    if (iter != used_blocks_.end()) {
+        free_blocks_.emplace(iter->second.capacity, iter->second);
+        used_blocks_.erase(iter);
+    }
+}
+
+HostMemoryPoolStats HostMemoryPool::stats() {
+    std::lock_guard<std::mutex> locker(mu_);
+    return stats_;
+}
+
+void HostMemoryPool::report(std::ostream& os) {
+    HostMemoryPoolStats s = stats();
+    os << "Host staging memory: " << (s.bytes_mapped >> 20) << " MB mapped, "
+       << s.huge_1g_blocks << " block(s) on 1GB pages, " << s.huge_2m_blocks
+       << " block(s) on 2MB pages, " << s.fallback_blocks
+       << " block(s) on default pages, " << s.reused_blocks
+       << " block(s) reused" << std::endl;
+}
+
+void HostMemoryPool::advise_huge_pages(void* ptr, size_t size) {
+#ifdef MADV_HUGEPAGE
+    uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    uintptr_t begin = round_up(addr, k2MB);
+    uintptr_t end = (addr + size) & ~(k2MB - 1);
+    if (end > begin) {
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+    }
+#endif
+}
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,110 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hybrid_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+// share of the CPU backend until both sides of an operation are measured,
+// an eighth of the batch, at least one input of it
+static const double kInitialCpuShare = 0.125;
+// weight of the latest batch in the throughput of a side
+static const double kRateWeight = 0.25;
+
+static bool get_hybrid() {
+    char* env = getenv("FPGA_HYBRID");
+    return env ? (atoi(env) != 0) : false;
+}
+
+static void update_rate(double* rate, uint64_t ops, double seconds) {
+    if ((ops == 0) || (seconds <= 0)) {
+        return;
+    }
+    double r = ops / seconds;
+    *rate = (*rate > 0) ? (1 - kRateWeight) * *rate + kRateWeight * r : r;
+}
+
+HybridScheduler& HybridScheduler::instance() {
+    static HybridScheduler scheduler;
+    return scheduler;
+}
+
+HybridScheduler::HybridScheduler() : enabled_(get_hybrid()) {}
+
+double HybridScheduler::share(const Stream& s) {
+    if ((s.cpu_rate <= 0) || (s.fpga_rate <= 0)) {
+        return kInitialCpuShare;
+    }
+    return s.cpu_rate / (s.cpu_rate + s.fpga_rate);
+}
+
+uint64_t HybridScheduler::cpu_count(const std::string& op, uint64_t count) {
+    std::lock_guard<std::mutex> locker(mu_);
+    Stream& s = streams_[op];
+    uint64_t n = std::llround(count * share(s));
+    // a side that was never measured gets at least one input to measure it
+    // with, the device first: a single input goes to the device.
+    if ((s.cpu_rate <= 0) && (count > 1)) {
+        n = std::max<uint64_t>(n, 1);
+    }
+    if ((s.fpga_rate <= 0) && (count > 0)) {
+        n = std::min<uint64_t>(n, count - 1);
+    }
+    return std::min(n, count);
+}
+
+void HybridScheduler::record(const std::string& op, uint64_t cpu_ops,
+                             double cpu_seconds, uint64_t fpga_ops,
+                             double fpga_seconds) {
+    std::lock_guard<std::mutex> locker(mu_);
+    Stream& s = streams_[op];
+    update_rate(&s.cpu_rate, cpu_ops, cpu_seconds);
+    update_rate(&s.fpga_rate, fpga_ops, fpga_seconds);
+    if (cpu_ops) {
+        s.cpu.ops += cpu_ops;
+        s.cpu.batches++;
+        s.cpu.seconds += cpu_seconds;
+    }
+    if (fpga_ops) {
+        s.fpga.ops += fpga_ops;
+        s.fpga.batches++;
+        s.fpga.seconds += fpga_seconds;
+    }
+}
+
+HybridStats HybridScheduler::stats(const std::string& op) {
+    std::lock_guard<std::mutex> locker(mu_);
+    const Stream& s = streams_[op];
+    return {s.cpu, s.fpga, share(s)};
+}
+
+static void report_backend(std::ostream& os, const std::string& op,
+                           const char* backend, const HybridCounters& c,
+                           double rate) {
+    os << "   [INFO] Hybrid " << op << " " << backend << ": " << c.ops
+       << " op(s) in " << c.batches << " batch(es), " << std::fixed
+       << std::setprecision(3) << c.seconds << " s, " << std::setprecision(1)
+       << rate << " op/s" << std::endl;
+}
+
+void HybridScheduler::report(std::ostream& os) {
+    std::lock_guard<std::mutex> locker(mu_);
+    for (const auto& iter : streams_) {
+        const Stream& s = iter.second;
+        report_backend(os, iter.first, "CPU", s.cpu, s.cpu_rate);
+        report_backend(os, iter.first, "FPGA", s.fpga, s.fpga_rate);
+        os << "   [INFO] Hybrid " << iter.first << " CPU share: " << std::fixed
+           << std::setprecision(1) << 100.0 * share(s) << "%" << std::endl;
+    }
+}
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
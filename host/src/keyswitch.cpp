@@ -20,17 +20,20 @@ void KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr, uint64_t n,
                const uint64_t* twiddle_factors) {
     FPGA_ASSERT(result, "requires result != nullptr");
     FPGA_ASSERT(t_target_iter_ptr, "requires t_target_iter_ptr != nullptr");
-    FPGA_ASSERT((n == 16384) || (n == 8192) || (n == 4096) || (n == 2048) ||
-                    (n == 1024),
-                "requires n = 16384/8192/4096/2048/1024");
+    FPGA_ASSERT((n == 32768) || (n == 16384) || (n == 8192) || (n == 4096) ||
+                    (n == 2048) || (n == 1024),
+                "requires n = 32768/16384/8192/4096/2048/1024");
     FPGA_ASSERT(decomp_modulus_size > 0, "requires decomp_modulus_size > 0");
-    FPGA_ASSERT(key_modulus_size <= 7, "requires key_modulus_size <= 7");
+    FPGA_ASSERT(decomp_modulus_size < key_modulus_size,
+                "requires decomp_modulus_size < key_modulus_size");
+    FPGA_ASSERT((key_modulus_size <= 7) || (n == 16384),
+                "requires n = 16384 for key_modulus_size > 7");
     FPGA_ASSERT(rns_modulus_size > 0, "requires rns_modulus_size > 0");
     FPGA_ASSERT(key_component_count == 2, "requires key_component_count = 2");
     FPGA_ASSERT(moduli, "requires moduli != nullptr");
     for (uint64_t i = 0; i < decomp_modulus_size; ++i) {
-        FPGA_ASSERT((moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 52)),
-                    "requires each modulus to be in the range of [2^16, 2^52]");
+        FPGA_ASSERT((moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 60)),
+                    "requires each modulus to be in the range of [2^16, 2^60]");
     }
     FPGA_ASSERT(k_switch_keys, "requires k_switch_keys != nullptr");
     FPGA_ASSERT(modswitch_factors, "requires modswitch_factors != nullptr");
@@ -40,6 +43,82 @@ void KeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr, uint64_t n,
                   moduli, k_switch_keys, modswitch_factors, twiddle_factors);
 }
 
+void KeySwitchBatch(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                    uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                    uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                    uint64_t key_component_count, const uint64_t* moduli,
+                    const uint64_t** k_switch_keys,
+                    const uint64_t* modswitch_factors,
+                    const uint64_t* twiddle_factors) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(t_target_iter_ptrs, "requires t_target_iter_ptrs != nullptr");
+    FPGA_ASSERT((n == 32768) || (n == 16384) || (n == 8192) || (n == 4096) ||
+                    (n == 2048) || (n == 1024),
+                "requires n = 32768/16384/8192/4096/2048/1024");
+    FPGA_ASSERT(decomp_modulus_size > 0, "requires decomp_modulus_size > 0");
+    FPGA_ASSERT(decomp_modulus_size < key_modulus_size,
+                "requires decomp_modulus_size < key_modulus_size");
+    FPGA_ASSERT((key_modulus_size <= 7) || (n == 16384),
+                "requires n = 16384 for key_modulus_size > 7");
+    FPGA_ASSERT(rns_modulus_size > 0, "requires rns_modulus_size > 0");
+    FPGA_ASSERT(key_component_count == 2, "requires key_component_count = 2");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    for (uint64_t i = 0; i < decomp_modulus_size; ++i) {
+        FPGA_ASSERT((moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 60)),
+                    "requires each modulus to be in the range of [2^16, 2^60]");
+    }
+    FPGA_ASSERT(k_switch_keys, "requires k_switch_keys != nullptr");
+    FPGA_ASSERT(modswitch_factors, "requires modswitch_factors != nullptr");
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(results[i] && t_target_iter_ptrs[i],
+                    "requires results[i], t_target_iter_ptrs[i] != nullptr");
+    }
+
+    KeySwitchBatch_int(results, t_target_iter_ptrs, count, n,
+                       decomp_modulus_size, key_modulus_size, rns_modulus_size,
+                       key_component_count, moduli, k_switch_keys,
+                       modswitch_factors, twiddle_factors);
+}
+
+void KeySwitchHybrid(uint64_t** results, const uint64_t** t_target_iter_ptrs,
+                     uint64_t count, uint64_t n, uint64_t decomp_modulus_size,
+                     uint64_t key_modulus_size, uint64_t special_modulus_size,
+                     uint64_t dnum, uint64_t key_component_count,
+                     const uint64_t* moduli, const uint64_t** k_switch_keys) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(t_target_iter_ptrs, "requires t_target_iter_ptrs != nullptr");
+    FPGA_ASSERT(n == 16384, "requires n = 16384");
+    FPGA_ASSERT(decomp_modulus_size > 0, "requires decomp_modulus_size > 0");
+    FPGA_ASSERT(special_modulus_size > 0, "requires special_modulus_size > 0");
+    FPGA_ASSERT(decomp_modulus_size + special_modulus_size <= key_modulus_size,
+                "requires decomp_modulus_size + special_modulus_size <= "
+                "key_modulus_size");
+    FPGA_ASSERT((dnum > 0) && (dnum <= key_modulus_size - special_modulus_size),
+                "requires 0 < dnum <= key_modulus_size - special_modulus_size");
+    FPGA_ASSERT(key_component_count == 2, "requires key_component_count = 2");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    for (uint64_t i = 0; i < key_modulus_size; ++i) {
+        if ((i < decomp_modulus_size) ||
+            (i >= key_modulus_size - special_modulus_size)) {
+            FPGA_ASSERT(
+                (moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 60)),
+                "requires each modulus to be in the range of [2^16, 2^60]");
+        }
+    }
+    FPGA_ASSERT(k_switch_keys, "requires k_switch_keys != nullptr");
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(results[i] && t_target_iter_ptrs[i],
+                    "requires results[i], t_target_iter_ptrs[i] != nullptr");
+    }
+
+    KeySwitchHybrid_int(results, t_target_iter_ptrs, count, n,
+                        decomp_modulus_size, key_modulus_size,
+                        special_modulus_size, dnum, key_component_count,
+                        moduli, k_switch_keys);
+}
+
 bool KeySwitchCompleted() { return KeySwitchCompleted_int(); }
 
 void set_worksize_KeySwitch(uint64_t n) {
@@ -0,0 +1,54 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "multiply_relinearize.h"
+
+#include "fpga_assert.h"
+#include "multiply_relinearize_int.h"
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+void MultiplyRelinearize(uint64_t** results, const uint64_t** operand1,
+                         const uint64_t** operand2, uint64_t count, uint64_t n,
+                         uint64_t decomp_modulus_size,
+                         uint64_t key_modulus_size, uint64_t rns_modulus_size,
+                         uint64_t key_component_count, const uint64_t* moduli,
+                         const uint64_t** k_switch_keys,
+                         const uint64_t* modswitch_factors,
+                         const uint64_t* twiddle_factors) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(operand1, "requires operand1 != nullptr");
+    FPGA_ASSERT(operand2, "requires operand2 != nullptr");
+    FPGA_ASSERT((n == 32768) || (n == 16384) || (n == 8192) || (n == 4096) ||
+                    (n == 2048) || (n == 1024),
+                "requires n = 32768/16384/8192/4096/2048/1024");
+    FPGA_ASSERT(decomp_modulus_size > 0, "requires decomp_modulus_size > 0");
+    FPGA_ASSERT(key_modulus_size <= 7, "requires key_modulus_size <= 7");
+    FPGA_ASSERT(decomp_modulus_size < key_modulus_size,
+                "requires decomp_modulus_size < key_modulus_size");
+    FPGA_ASSERT(rns_modulus_size > 0, "requires rns_modulus_size > 0");
+    FPGA_ASSERT(key_component_count == 2, "requires key_component_count = 2");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    for (uint64_t i = 0; i < decomp_modulus_size; ++i) {
+        FPGA_ASSERT((moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 60)),
+                    "requires each modulus to be in the range of [2^16, 2^60]");
+    }
+    FPGA_ASSERT(k_switch_keys, "requires k_switch_keys != nullptr");
+    FPGA_ASSERT(modswitch_factors, "requires modswitch_factors != nullptr");
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(results[i] && operand1[i] && operand2[i],
+                    "requires results[i], operand1[i], operand2[i] != nullptr");
+    }
+
+    MultiplyRelinearize_int(results, operand1, operand2, count, n,
+                            decomp_modulus_size, key_modulus_size,
+                            rns_modulus_size, key_component_count, moduli,
+                            k_switch_keys, modswitch_factors, twiddle_factors);
+}
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
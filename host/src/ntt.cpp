@@ -21,7 +21,9 @@ void NTT(uint64_t* coeff_poly, const uint64_t* root_of_unity_powers,
     FPGA_ASSERT(precon_root_of_unity_powers,
                 "requires precon_root_of_unity_powers != nullptr");
     FPGA_ASSERT(coeff_modulus > 0, "coeff_modulus must be positive integer");
-    FPGA_ASSERT(n == 16384, "requires n = 16384");
+    FPGA_ASSERT((n == 16384) || (n == 8192) || (n == 4096) || (n == 2048) ||
+                    (n == 1024),
+                "requires n = 16384/8192/4096/2048/1024");
 
     NTT_int(coeff_poly, root_of_unity_powers, precon_root_of_unity_powers,
             coeff_modulus, n);
@@ -35,6 +37,21 @@ void set_worksize_NTT(uint64_t n) {
 }
 bool NTTCompleted() { return NTTCompleted_int(); }
 
+void NTTRns(uint64_t* coeff_poly, const uint64_t* moduli,
+            uint64_t num_moduli, uint64_t n) {
+    FPGA_ASSERT(coeff_poly, "requires coeff_poly != nullptr");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    FPGA_ASSERT(num_moduli > 0, "num_moduli must be positive integer");
+    FPGA_ASSERT((n == 16384) || (n == 8192) || (n == 4096) || (n == 2048) ||
+                    (n == 1024),
+                "requires n = 16384/8192/4096/2048/1024");
+    for (uint64_t i = 0; i < num_moduli; i++) {
+        FPGA_ASSERT(moduli[i] > 1, "moduli must be integers greater than 1");
+    }
+
+    NTTRns_int(coeff_poly, moduli, num_moduli, n);
+}
+
 }  // namespace fpga
 }  // namespace hexl
 }  // namespace intel
@@ -0,0 +1,183 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "numa_util.h"
+
+#include <glob.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+// mempolicy values from linux/mempolicy.h, kept local to avoid a libnuma
+// dependency.
+static const int kMpolPreferred = 1;
+static const unsigned kMpolMfMove = (1 << 1);
+static const unsigned kMaxNodeMaskWords = 16;
+
+static bool read_first_line(const std::string& path, std::string* line) {
+    std::ifstream f(path);
+    if (!f.is_open()) {
+        return false;
+    }
+    std::getline(f, *line);
+    return true;
+}
+
+// "dddd:bb:dd.f", the name of a PCI function in sysfs
+static bool is_pci_address(const std::string& name) {
+    const char* format = "xxxx:xx:xx.x";
+    if (name.size() != strlen(format)) {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); i++) {
+        bool digit = std::isxdigit(static_cast<unsigned char>(name[i]));
+        if ((format[i] == 'x') ? !digit : (name[i] != format[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the sysfs directory of the PCI function a device of an fpga class sits
+// on, found by walking up from the device it links to, which may be a
+// platform device of the driver below the PCI function.
+static std::string pci_function_of(const std::string& class_device) {
+    char resolved[PATH_MAX];
+    if (!realpath((class_device + "/device").c_str(), resolved)) {
+        return "";
+    }
+    std::string path = resolved;
+    while (path.size() > 1) {
+        std::string name = path.substr(path.rfind('/') + 1);
+        if (is_pci_address(name)) {
+            return path;
+        }
+        path = path.substr(0, path.rfind('/'));
+    }
+    return "";
+}
+
+int host_numa_node_of_device(int device_index) {
+    // the cards, by PCI address, of the fpga classes of the FPGA drivers
+    std::set<std::string> functions;
+    const char* patterns[] = {"/sys/class/fpga/*", "/sys/class/fpga_region/*"};
+    for (auto pattern : patterns) {
+        glob_t glob_result = {0};
+        if (::glob(pattern, 0, NULL, &glob_result) == 0) {
+            for (size_t i = 0; i < glob_result.gl_pathc; i++) {
+                std::string function =
+                    pci_function_of(glob_result.gl_pathv[i]);
+                if (!function.empty()) {
+                    functions.insert(function);
+                }
+            }
+        }
+        globfree(&glob_result);
+    }
+
+    // the runtime enumerates the cards in the order of their PCI address
+    if ((device_index < 0) || (size_t(device_index) >= functions.size())) {
+        return -1;
+    }
+    auto function = functions.begin();
+    std::advance(function, device_index);
+    std::string line;
+    if (!read_first_line(*function + "/numa_node", &line) || line.empty()) {
+        return -1;
+    }
+    return atoi(line.c_str());
+}
+
+bool host_numa_node_override(int device_id, int* node) {
+    const char* env = getenv("FPGA_NUMA_NODES");
+    if (!env) {
+        return false;
+    }
+    std::stringstream ss(env);
+    std::string item;
+    int id = 0;
+    while (std::getline(ss, item, ',')) {
+        if (id == device_id) {
+            if (item.empty()) {
+                return false;
+            }
+            *node = atoi(item.c_str());
+            return true;
+        }
+        id++;
+    }
+    return false;
+}
+
+bool host_bind_thread_to_node(int node) {
+    if (node < 0) {
+        return false;
+    }
+    std::string line;
+    std::string path =
+        "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+    if (!read_first_line(path, &line) || line.empty()) {
+        return false;
+    }
+
+    // cpulist format: "0-15,32-47"
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    std::stringstream ss(line);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        size_t dash = range.find('-');
+        int first = atoi(range.substr(0, dash).c_str());
+        int last = (dash == std::string::npos)
+                       ? first
+                       : atoi(range.substr(dash + 1).c_str());
+        for (int cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    if (CPU_COUNT(&cpus) == 0) {
+        return false;
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+bool host_bind_memory_to_node(void* ptr, size_t size, int node) {
+    if ((node < 0) || (node >= int(kMaxNodeMaskWords * 64)) || !ptr ||
+        (size == 0)) {
+        return false;
+    }
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    uintptr_t begin = (addr + page - 1) & ~(page - 1);
+    uintptr_t end = (addr + size) & ~(page - 1);
+    if (end <= begin) {
+        return false;
+    }
+
+    unsigned long mask[kMaxNodeMaskWords] = {};
+    mask[node / 64] = 1UL << (node % 64);
+    long rc = syscall(SYS_mbind, reinterpret_cast<void*>(begin), end - begin,
+                      kMpolPreferred, mask, kMaxNodeMaskWords * 64 + 1,
+                      kMpolMfMove);
+    return rc == 0;
+}
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
@@ -239,6 +239,35 @@ std::vector<uint64_t> GeneratePrimes(size_t num_primes, size_t bit_size,
     return ret;
 }
 
+void ComputeGaloisPermutationNTT(uint64_t n, uint64_t galois_elt,
+                                 std::vector<uint32_t>* table) {
+    FPGA_ASSERT(IsPowerOfTwo(n), "n must be a power of two");
+    FPGA_ASSERT((galois_elt & 1) && (galois_elt < 2 * n),
+                "galois_elt must be odd and less than 2n");
+    uint64_t log_n = Log2(n);
+    uint64_t mask = n - 1;
+    table->resize(n);
+    // slot i of the bit-reversed NTT form holds the evaluation at the odd
+    // power bitrev(n + i) of the root, which X -> X^galois_elt moves.
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t reversed = ReverseBitsUInt(n + i, log_n + 1);
+        uint64_t index_raw = ((galois_elt * reversed) >> 1) & mask;
+        (*table)[i] = static_cast<uint32_t>(ReverseBitsUInt(index_raw, log_n));
+    }
+}
+
+void ApplyGaloisPermutation(const uint64_t* input, uint64_t n,
+                            uint64_t num_moduli, const uint32_t* table,
+                            uint64_t* output) {
+    for (uint64_t m = 0; m < num_moduli; m++) {
+        const uint64_t* in = input + m * n;
+        uint64_t* out = output + m * n;
+        for (uint64_t i = 0; i < n; i++) {
+            out[i] = in[table[i]];
+        }
+    }
+}
+
 }  // namespace fpga
 }  // namespace hexl
 }  // namespace intel
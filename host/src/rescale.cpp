@@ -0,0 +1,40 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rescale.h"
+
+#include "fpga_assert.h"
+#include "rescale_int.h"
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+void Rescale(uint64_t** results, const uint64_t** operands, uint64_t count,
+             uint64_t n, uint64_t num_components, uint64_t num_moduli,
+             const uint64_t* moduli) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(operands, "requires operands != nullptr");
+    FPGA_ASSERT(n == 16384, "requires n = 16384");
+    FPGA_ASSERT(num_components > 0, "requires num_components > 0");
+    FPGA_ASSERT(num_moduli > 1, "requires num_moduli > 1");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    for (uint64_t i = 0; i < num_moduli; ++i) {
+        FPGA_ASSERT((moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 52)),
+                    "requires each modulus to be in the range of [2^16, 2^52]");
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(results[i] && operands[i],
+                    "requires results[i], operands[i] != nullptr");
+        FPGA_ASSERT(results[i] != operands[i],
+                    "requires results[i] != operands[i]");
+    }
+
+    Rescale_int(results, operands, count, n, num_components, num_moduli,
+                moduli);
+}
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
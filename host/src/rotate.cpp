@@ -0,0 +1,96 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "rotate.h"
+
+#include "fpga_assert.h"
+#include "rotate_int.h"
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+void Rotate(uint64_t** results, const uint64_t** ciphertexts, uint64_t count,
+            uint64_t galois_elt, uint64_t n, uint64_t decomp_modulus_size,
+            uint64_t key_modulus_size, uint64_t rns_modulus_size,
+            uint64_t key_component_count, const uint64_t* moduli,
+            const uint64_t** k_switch_keys, const uint64_t* modswitch_factors,
+            const uint64_t* twiddle_factors) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(ciphertexts, "requires ciphertexts != nullptr");
+    FPGA_ASSERT((n == 32768) || (n == 16384) || (n == 8192) || (n == 4096) ||
+                    (n == 2048) || (n == 1024),
+                "requires n = 32768/16384/8192/4096/2048/1024");
+    FPGA_ASSERT((galois_elt & 1) && (galois_elt < 2 * n),
+                "requires galois_elt to be odd and less than 2n");
+    FPGA_ASSERT(decomp_modulus_size > 0, "requires decomp_modulus_size > 0");
+    FPGA_ASSERT(key_modulus_size <= 7, "requires key_modulus_size <= 7");
+    FPGA_ASSERT(decomp_modulus_size < key_modulus_size,
+                "requires decomp_modulus_size < key_modulus_size");
+    FPGA_ASSERT(rns_modulus_size > 0, "requires rns_modulus_size > 0");
+    FPGA_ASSERT(key_component_count == 2, "requires key_component_count = 2");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    for (uint64_t i = 0; i < decomp_modulus_size; ++i) {
+        FPGA_ASSERT((moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 60)),
+                    "requires each modulus to be in the range of [2^16, 2^60]");
+    }
+    FPGA_ASSERT(k_switch_keys, "requires k_switch_keys != nullptr");
+    FPGA_ASSERT(modswitch_factors, "requires modswitch_factors != nullptr");
+    for (uint64_t i = 0; i < count; ++i) {
+        FPGA_ASSERT(results[i] && ciphertexts[i],
+                    "requires results[i], ciphertexts[i] != nullptr");
+        FPGA_ASSERT(results[i] != ciphertexts[i],
+                    "requires results[i] != ciphertexts[i]");
+    }
+
+    Rotate_int(results, ciphertexts, count, galois_elt, n, decomp_modulus_size,
+               key_modulus_size, rns_modulus_size, key_component_count, moduli,
+               k_switch_keys, modswitch_factors, twiddle_factors);
+}
+
+void RotateSteps(uint64_t** results, const uint64_t* ciphertext, uint64_t steps,
+                 const uint64_t* galois_elts, uint64_t n,
+                 uint64_t decomp_modulus_size, uint64_t key_modulus_size,
+                 uint64_t rns_modulus_size, uint64_t key_component_count,
+                 const uint64_t* moduli, const uint64_t*** k_switch_keys,
+                 const uint64_t* modswitch_factors,
+                 const uint64_t* twiddle_factors) {
+    FPGA_ASSERT(steps > 0, "steps must be positive integer");
+    FPGA_ASSERT(results, "requires results != nullptr");
+    FPGA_ASSERT(ciphertext, "requires ciphertext != nullptr");
+    FPGA_ASSERT(galois_elts, "requires galois_elts != nullptr");
+    FPGA_ASSERT((n == 32768) || (n == 16384) || (n == 8192) || (n == 4096) ||
+                    (n == 2048) || (n == 1024),
+                "requires n = 32768/16384/8192/4096/2048/1024");
+    FPGA_ASSERT(decomp_modulus_size > 0, "requires decomp_modulus_size > 0");
+    FPGA_ASSERT(key_modulus_size <= 7, "requires key_modulus_size <= 7");
+    FPGA_ASSERT(decomp_modulus_size < key_modulus_size,
+                "requires decomp_modulus_size < key_modulus_size");
+    FPGA_ASSERT(rns_modulus_size > 0, "requires rns_modulus_size > 0");
+    FPGA_ASSERT(key_component_count == 2, "requires key_component_count = 2");
+    FPGA_ASSERT(moduli, "requires moduli != nullptr");
+    for (uint64_t i = 0; i < decomp_modulus_size; ++i) {
+        FPGA_ASSERT((moduli[i] >= (1UL << 16)) && (moduli[i] <= (1UL << 60)),
+                    "requires each modulus to be in the range of [2^16, 2^60]");
+    }
+    FPGA_ASSERT(k_switch_keys, "requires k_switch_keys != nullptr");
+    FPGA_ASSERT(modswitch_factors, "requires modswitch_factors != nullptr");
+    for (uint64_t s = 0; s < steps; ++s) {
+        FPGA_ASSERT((galois_elts[s] & 1) && (galois_elts[s] < 2 * n),
+                    "requires galois_elts[s] to be odd and less than 2n");
+        FPGA_ASSERT(results[s] && k_switch_keys[s],
+                    "requires results[s], k_switch_keys[s] != nullptr");
+        FPGA_ASSERT(results[s] != ciphertext,
+                    "requires results[s] != ciphertext");
+    }
+
+    RotateSteps_int(results, ciphertext, steps, galois_elts, n,
+                    decomp_modulus_size, key_modulus_size, rns_modulus_size,
+                    key_component_count, moduli, k_switch_keys,
+                    modswitch_factors, twiddle_factors);
+}
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
@@ -0,0 +1,73 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "transform.h"
+
+#include "fpga_assert.h"
+#include "intt_int.h"
+#include "ntt_int.h"
+#include "number_theory_util.h"
+#include "transform_int.h"
+
+namespace intel {
+namespace hexl {
+namespace fpga {
+
+uint64_t CreateTransformPlan(uint64_t n, uint64_t modulus,
+                             uint64_t root_of_unity) {
+    FPGA_ASSERT((n == 16384) || (n == 8192) || (n == 4096) || (n == 2048) ||
+                    (n == 1024),
+                "requires n = 16384/8192/4096/2048/1024");
+    FPGA_ASSERT(modulus > 1, "modulus must be an integer greater than 1");
+    FPGA_ASSERT((modulus - 1) % (2 * n) == 0,
+                "requires modulus = 1 mod 2n");
+    FPGA_ASSERT((root_of_unity == 0) ||
+                    IsPrimitiveRoot(root_of_unity, 2 * n, modulus),
+                "root_of_unity must be a primitive 2n-th root of unity");
+
+    return CreateTransformPlan_int(n, modulus, root_of_unity);
+}
+
+void DestroyTransformPlan(uint64_t plan) { DestroyTransformPlan_int(plan); }
+
+void set_worksize_ForwardTransform(uint64_t ws) {
+    FPGA_ASSERT(
+        ws > 0,
+        "ws must be positive integer. ws==1 indicates synchronous execution.");
+    set_worksize_NTT_int(ws);
+}
+
+void ForwardTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(coeff_polys, "requires coeff_polys != nullptr");
+    for (uint64_t i = 0; i < count; i++) {
+        FPGA_ASSERT(coeff_polys[i], "requires coeff_polys[i] != nullptr");
+    }
+
+    ForwardTransform_int(coeff_polys, count, plan);
+}
+
+bool ForwardTransformCompleted() { return NTTCompleted_int(); }
+
+void set_worksize_InverseTransform(uint64_t ws) {
+    FPGA_ASSERT(
+        ws > 0,
+        "ws must be positive integer. ws==1 indicates synchronous execution.");
+    set_worksize_INTT_int(ws);
+}
+
+void InverseTransform(uint64_t** coeff_polys, uint64_t count, uint64_t plan) {
+    FPGA_ASSERT(count > 0, "count must be positive integer");
+    FPGA_ASSERT(coeff_polys, "requires coeff_polys != nullptr");
+    for (uint64_t i = 0; i < count; i++) {
+        FPGA_ASSERT(coeff_polys[i], "requires coeff_polys[i] != nullptr");
+    }
+
+    InverseTransform_int(coeff_polys, count, plan);
+}
+
+bool InverseTransformCompleted() { return INTTCompleted_int(); }
+
+}  // namespace fpga
+}  // namespace hexl
+}  // namespace intel
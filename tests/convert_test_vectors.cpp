@@ -0,0 +1,74 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+// Converts JSON KeySwitch test vectors to the binary test vector format,
+// written next to each of them with the .bin extension. The tests and the
+// benchmarks map the .bin files of KEYSWITCH_DATA_DIR in place of the JSON
+// ones when there are any.
+//
+// usage: convert_test_vectors <test vector>.json...
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "test_utils/keyswitch_test_vector.hpp"
+
+using hetest::utils::KeySwitchTestVector;
+
+// every field and array of a, the contents of the keys included, equals
+// the one of b
+static bool same_test_vector(const KeySwitchTestVector& a,
+                             const KeySwitchTestVector& b) {
+    bool same = (a.coeff_count == b.coeff_count) &&
+                (a.decomp_modulus_size == b.decomp_modulus_size) &&
+                (a.key_modulus_size == b.key_modulus_size) &&
+                (a.rns_modulus_size == b.rns_modulus_size) &&
+                (a.key_component_count == b.key_component_count) &&
+                (a.moduli == b.moduli) &&
+                (a.modswitch_factors == b.modswitch_factors) &&
+                (a.twiddle_factors == b.twiddle_factors) &&
+                (a.key_vectors.size() == b.key_vectors.size()) &&
+                (a.t_target_iter_ptr == b.t_target_iter_ptr) &&
+                (a.input == b.input) &&
+                (a.expected_output == b.expected_output);
+    uint64_t key_size =
+        a.key_component_count * a.key_modulus_size * a.coeff_count;
+    for (size_t k = 0; same && (k < a.key_vectors.size()); k++) {
+        same = std::equal(a.key_vectors[k], a.key_vectors[k] + key_size,
+                          b.key_vectors[k]);
+    }
+    return same;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <test vector>.json..."
+                  << std::endl;
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        std::string json_filename = argv[i];
+        std::string bin_filename =
+            json_filename.substr(0, json_filename.rfind(".json")) + ".bin";
+        try {
+            KeySwitchTestVector tv(json_filename.c_str());
+            hetest::utils::WriteKeySwitchTestVector(bin_filename.c_str(), tv);
+
+            // read it back
+            KeySwitchTestVector bin(bin_filename.c_str());
+            if (!same_test_vector(bin, tv)) {
+                std::cerr << bin_filename << " differs from " << json_filename
+                          << std::endl;
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << json_filename << " -> " << bin_filename << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+# Copyright (C) 2020-2022 Intel Corporation
+# SPDX-License-Identifier: Apache-2.0
+
+#!/usr/bin/env bash
+
+set -eo pipefail
+
+########################################
+# CPU run of every tier of the built-in CPU backend
+########################################
+
+for isa in scalar avx2 avx512ifma
+do
+    echo ""
+    echo "RUN_CHOICE=0 CPU_ISA=${isa}"
+    RUN_CHOICE=0 CPU_ISA=${isa} ./test_cpu_backend
+done
@@ -25,3 +25,19 @@ echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply.so FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY=8"
 # batch 8
 FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply.so FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY=8 ./test_dyadic_multiply
+
+########################################
+# FPGA run shared with the CPU backend
+########################################
+
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply.so FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY=8 FPGA_HYBRID=1"
+FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply.so FPGA_KERNEL=DYADIC_MULTIPLY BATCH_SIZE_DYADIC_MULTIPLY=8 FPGA_HYBRID=1 ./test_dyadic_multiply
+
+########################################
+# CPU run with the built-in CPU backend
+########################################
+
+echo ""
+echo "RUN_CHOICE=0"
+RUN_CHOICE=0 ./test_dyadic_multiply
@@ -25,3 +25,11 @@ FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply_keyswitch.so FPGA_KERNEL=DYAD
 echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply_keyswitch.so FPGA_KERNEL=DYADIC_MULTIPLY_KEYSWITCH BATCH_SIZE_DYADIC_MULTIPLY=2 BATCH_SIZE_KEYSWITCH=2"
 FPGA_BITSTREAM=${bitstream_dir}/libdyadic_multiply_keyswitch.so FPGA_KERNEL=DYADIC_MULTIPLY_KEYSWITCH BATCH_SIZE_DYADIC_MULTIPLY=2 BATCH_SIZE_KEYSWITCH=2 ./test_dyadic_multiply_keyswitch
+
+########################################
+# CPU run with the built-in CPU backend
+########################################
+
+echo ""
+echo "RUN_CHOICE=0"
+RUN_CHOICE=0 ./test_dyadic_multiply_keyswitch
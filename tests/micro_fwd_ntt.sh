@@ -25,3 +25,19 @@ echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt.so FPGA_KERNEL=NTT BATCH_SIZE_NTT=8"
 # batch 8
 FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt.so FPGA_KERNEL=NTT BATCH_SIZE_NTT=8 ./test_fwd_ntt
+
+########################################
+# FPGA run shared with the CPU backend
+########################################
+
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt.so FPGA_KERNEL=NTT BATCH_SIZE_NTT=8 FPGA_HYBRID=1"
+FPGA_BITSTREAM=${bitstream_dir}/libfwd_ntt.so FPGA_KERNEL=NTT BATCH_SIZE_NTT=8 FPGA_HYBRID=1 ./test_fwd_ntt
+
+########################################
+# CPU run with the built-in CPU backend
+########################################
+
+echo ""
+echo "RUN_CHOICE=0"
+RUN_CHOICE=0 ./test_fwd_ntt
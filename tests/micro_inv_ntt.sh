@@ -25,3 +25,20 @@ echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt.so FPGA_KERNEL=INTT BATCH_SIZE_INTT=8"
 # batch 8
 FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt.so FPGA_KERNEL=INTT BATCH_SIZE_INTT=8 ./test_inv_ntt
+
+########################################
+# FPGA run shared with the CPU backend
+########################################
+
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt.so FPGA_KERNEL=INTT BATCH_SIZE_INTT=8 FPGA_HYBRID=1"
+FPGA_BITSTREAM=${bitstream_dir}/libinv_ntt.so FPGA_KERNEL=INTT BATCH_SIZE_INTT=8 FPGA_HYBRID=1 ./test_inv_ntt
+
+########################################
+# CPU run with the built-in CPU backend
+########################################
+# the reference INTT wraps around on the unreduced inputs of 62-bit moduli,
+# the CPU backend transforms the reduced ones
+echo ""
+echo "RUN_CHOICE=0"
+RUN_CHOICE=0 ./test_inv_ntt --gtest_filter=-*iALL_MAX_POS_iters4_pbits62
@@ -31,4 +31,44 @@ echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=8192 FPGA_KERNEL=KEYSWIT
 FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=8192 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1 ./test_keyswitch
 echo ""
 echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=8192 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2"
-FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=8192 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1 ./test_keyswitch
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=8192 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 ./test_keyswitch
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_32k.so N=32768 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_32k.so N=32768 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1 ./test_keyswitch
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_32k.so N=32768 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_32k.so N=32768 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 ./test_keyswitch
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 ./test_keyswitch
+echo ""
+# generated test vectors of wide moduli, checked against the reference:
+# the 120-bit Barrett reduction, the 4-word key packing and the coefficient
+# count packed above 60-bit moduli
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=4096 MODULUS_BITS=60 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=4096 MODULUS_BITS=60 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 ./test_keyswitch --gtest_filter=KeySwitch.generated_reference_*
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=16384 MODULUS_BITS=55 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=16384 MODULUS_BITS=55 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=1 ./test_keyswitch --gtest_filter=KeySwitch.generated_reference_*
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=16384 MODULUS_BITS=60 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_60.so N=16384 MODULUS_BITS=60 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 ./test_keyswitch --gtest_filter=KeySwitch.generated_reference_*
+
+########################################
+# FPGA run shared with the CPU backend
+########################################
+
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 FPGA_HYBRID=1"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch.so N=16384 FPGA_KERNEL=KEYSWITCH BATCH_SIZE_KEYSWITCH=2 FPGA_HYBRID=1 ./test_keyswitch
+
+########################################
+# CPU run with the built-in CPU backend
+########################################
+
+echo ""
+echo "RUN_CHOICE=0"
+RUN_CHOICE=0 ./test_keyswitch
+echo ""
+echo "RUN_CHOICE=0 MODULUS_BITS=60"
+RUN_CHOICE=0 MODULUS_BITS=60 ./test_keyswitch --gtest_filter=KeySwitch.generated_reference_*
@@ -0,0 +1,32 @@
+# Copyright (C) 2020-2021 Intel Corporation
+# SPDX-License-Identifier: Apache-2.0
+
+#!/usr/bin/env bash
+
+set -eo pipefail
+
+spath=$(dirname $0)
+. ${spath}/bitstream_dir.sh
+
+if [[ -z ${RUN_CHOICE} ]] || [[ ${RUN_CHOICE} -eq 2 ]]
+then
+    aocl initialize acl0 pac_s10_usm
+fi
+
+########################################
+# FPGA run with individual bitstream
+########################################
+
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_tiled.so FPGA_KERNEL=KEYSWITCH_TILED"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_tiled.so FPGA_KERNEL=KEYSWITCH_TILED ./test_keyswitch_tiled
+echo ""
+echo "FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_tiled.so FPGA_KERNEL=KEYSWITCH_TILED BATCH_SIZE_DYADIC_MULTIPLY=8 BATCH_SIZE_NTT=8 BATCH_SIZE_INTT=8"
+FPGA_BITSTREAM=${bitstream_dir}/libkeyswitch_tiled.so FPGA_KERNEL=KEYSWITCH_TILED BATCH_SIZE_DYADIC_MULTIPLY=8 BATCH_SIZE_NTT=8 BATCH_SIZE_INTT=8 ./test_keyswitch_tiled
+
+########################################
+# CPU run with the built-in CPU backend
+########################################
+
+echo ""
+echo "RUN_CHOICE=0"
+RUN_CHOICE=0 ./test_keyswitch_tiled
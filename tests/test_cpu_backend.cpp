@@ -0,0 +1,252 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "cpu_backend.h"
+#include "gtest/gtest.h"
+#include "test_utils/ntt.hpp"
+
+// The built-in CPU backend runs the tier of env(CPU_ISA), capped by the
+// host, for the whole process: micro_cpu_backend.sh runs the tests once per
+// tier. Every tier is checked against the naive computations below, with
+// moduli on both sides of the 2^50 (AVX512 IFMA), 2^62 (lazy reduction) and
+// 2^63 (vector sums) limits of the tiers.
+
+using intel::hexl::fpga::cpu_isa;
+using intel::hexl::fpga::cpu_isa_name;
+using intel::hexl::fpga::cpu_isa_t;
+using intel::hexl::fpga::CpuNTT;
+
+static const uint64_t kMax = std::numeric_limits<uint64_t>::max();
+
+// the moduli of the products and sums, at the limits of the tiers
+static const std::vector<uint64_t> moduli = {
+    3,
+    (1UL << 40),
+    (1UL << 50) - 27,
+    (1UL << 50) + 55,
+    (1UL << 62) - 57,
+    (1UL << 62) + 135,
+    (1UL << 63) - 25,
+    (1UL << 63) + 29,
+    kMax - 58,
+};
+
+// n of the vector bodies and tails
+static const std::vector<uint64_t> sizes = {1, 7, 8, 16, 33};
+
+// the NTT friendly prime, 1 mod 2n, closest to limit from below, or from
+// above. limit is a power of two, 0 for 2^64.
+static uint64_t ntt_prime(uint64_t limit, uint64_t n, bool above) {
+    uint64_t value = above ? limit + 1 : limit - 2 * n + 1;
+    while (!hetest::utils::IsPrime(value)) {
+        value = above ? value + 2 * n : value - 2 * n;
+    }
+    return value;
+}
+
+// operands of the products, not reduced by the modulus, with the edge cases
+// first
+static std::vector<uint64_t> random_operands(uint64_t n, uint64_t modulus,
+                                             std::mt19937_64& gen) {
+    std::vector<uint64_t> operands = {0, modulus - 1, modulus, kMax};
+    operands.resize(n);
+    for (uint64_t i = 4; i < n; i++) {
+        operands[i] = gen();
+    }
+    return operands;
+}
+
+// operands reduced by the modulus, with the edge cases first
+static std::vector<uint64_t> random_residues(uint64_t n, uint64_t modulus,
+                                             std::mt19937_64& gen) {
+    std::uniform_int_distribution<uint64_t> distrib(0, modulus - 1);
+    std::vector<uint64_t> residues = {0, modulus - 1, modulus / 2};
+    residues.resize(n);
+    for (uint64_t i = 3; i < n; i++) {
+        residues[i] = distrib(gen);
+    }
+    return residues;
+}
+
+// the naive arithmetic, in 128 bits for the moduli of up to 64 bits
+static uint64_t mul_mod(uint64_t x, uint64_t y, uint64_t modulus) {
+    return static_cast<uint64_t>(static_cast<uint128_t>(x) * y % modulus);
+}
+
+static uint64_t add_mod(uint64_t x, uint64_t y, uint64_t modulus) {
+    return static_cast<uint64_t>((static_cast<uint128_t>(x) + y) % modulus);
+}
+
+static uint64_t pow_mod(uint64_t base, uint64_t exp, uint64_t modulus) {
+    uint64_t result = 1;
+    for (; exp; exp >>= 1) {
+        if (exp & 1) {
+            result = mul_mod(result, base, modulus);
+        }
+        base = mul_mod(base, base, modulus);
+    }
+    return result;
+}
+
+// a primitive 2n-th root of unity of the prime modulus
+static uint64_t primitive_root(uint64_t n, uint64_t modulus) {
+    for (uint64_t g = 2;; g++) {
+        uint64_t psi = pow_mod(g, (modulus - 1) / (2 * n), modulus);
+        if (pow_mod(psi, n, modulus) == modulus - 1) {
+            return psi;
+        }
+    }
+}
+
+// forward transform of a, in the bit reversed order of the NTT kernels:
+// A[k] = sum_j a[j] * psi^((2 * rev(k) + 1) * j)
+static std::vector<uint64_t> naive_ntt(const std::vector<uint64_t>& a,
+                                       uint64_t psi, uint64_t modulus) {
+    uint64_t n = a.size();
+    uint64_t bits = hetest::utils::Log2(n);
+    std::vector<uint64_t> r(n, 0);
+    for (uint64_t k = 0; k < n; k++) {
+        uint64_t rev = hetest::utils::ReverseBitsUInt(k, bits);
+        uint64_t w = pow_mod(psi, 2 * rev + 1, modulus);
+        for (uint64_t j = 0; j < n; j++) {
+            uint64_t term = mul_mod(a[j], pow_mod(w, j, modulus), modulus);
+            r[k] = add_mod(r[k], term, modulus);
+        }
+    }
+    return r;
+}
+
+// inverse of naive_ntt:
+// a[j] = n^-1 * sum_k A[k] * psi^-((2 * rev(k) + 1) * j)
+static std::vector<uint64_t> naive_intt(const std::vector<uint64_t>& x,
+                                        uint64_t psi, uint64_t modulus) {
+    uint64_t n = x.size();
+    uint64_t inv_psi = pow_mod(psi, 2 * n - 1, modulus);
+    uint64_t inv_n = pow_mod(n, modulus - 2, modulus);
+    uint64_t bits = hetest::utils::Log2(n);
+    std::vector<uint64_t> r(n, 0);
+    for (uint64_t k = 0; k < n; k++) {
+        uint64_t rev = hetest::utils::ReverseBitsUInt(k, bits);
+        uint64_t w = pow_mod(inv_psi, 2 * rev + 1, modulus);
+        for (uint64_t j = 0; j < n; j++) {
+            uint64_t term = mul_mod(x[k], pow_mod(w, j, modulus), modulus);
+            r[j] = add_mod(r[j], term, modulus);
+        }
+    }
+    for (auto& v : r) {
+        v = mul_mod(v, inv_n, modulus);
+    }
+    return r;
+}
+
+// CPU_ISA caps the tier the backend runs
+TEST(CpuBackend, isa) {
+    std::cout << "CPU backend tier " << cpu_isa_name(cpu_isa()) << std::endl;
+    const char* env = getenv("CPU_ISA");
+    if (env && (strcmp(env, "scalar") == 0)) {
+        ASSERT_EQ(cpu_isa(), cpu_isa_t::SCALAR);
+    } else if (env && (strcmp(env, "avx2") == 0)) {
+        ASSERT_LE(cpu_isa(), cpu_isa_t::AVX2);
+    }
+}
+
+TEST(CpuBackend, multiply_mod) {
+    std::mt19937_64 gen(0);
+    for (auto modulus : moduli) {
+        for (auto n : sizes) {
+            std::vector<uint64_t> operand1 = random_operands(n, modulus, gen);
+            std::vector<uint64_t> operand2 = random_operands(n, modulus, gen);
+            std::vector<uint64_t> expected(n);
+            for (uint64_t i = 0; i < n; i++) {
+                expected[i] = mul_mod(operand1[i], operand2[i], modulus);
+            }
+
+            std::vector<uint64_t> results(n);
+            intel::hexl::fpga::cpu_multiply_mod(
+                results.data(), operand1.data(), operand2.data(), n, modulus);
+            ASSERT_EQ(results, expected) << "modulus " << modulus;
+
+            // in place
+            intel::hexl::fpga::cpu_multiply_mod(
+                operand1.data(), operand1.data(), operand2.data(), n, modulus);
+            ASSERT_EQ(operand1, expected) << "modulus " << modulus;
+        }
+    }
+}
+
+TEST(CpuBackend, add_mod) {
+    std::mt19937_64 gen(0);
+    for (auto modulus : moduli) {
+        for (auto n : sizes) {
+            std::vector<uint64_t> operand1 = random_residues(n, modulus, gen);
+            std::vector<uint64_t> operand2 = random_residues(n, modulus, gen);
+            std::vector<uint64_t> expected(n);
+            for (uint64_t i = 0; i < n; i++) {
+                expected[i] = add_mod(operand1[i], operand2[i], modulus);
+            }
+
+            std::vector<uint64_t> results(n);
+            intel::hexl::fpga::cpu_add_mod(results.data(), operand1.data(),
+                                           operand2.data(), n, modulus);
+            ASSERT_EQ(results, expected) << "modulus " << modulus;
+
+            // in place
+            intel::hexl::fpga::cpu_add_mod(operand1.data(), operand1.data(),
+                                           operand2.data(), n, modulus);
+            ASSERT_EQ(operand1, expected) << "modulus " << modulus;
+        }
+    }
+}
+
+TEST(CpuBackend, ntt) {
+    std::mt19937_64 gen(0);
+    for (uint64_t n : {8, 16}) {
+        std::vector<uint64_t> primes = {
+            ntt_prime(1UL << 50, n, false), ntt_prime(1UL << 50, n, true),
+            ntt_prime(1UL << 62, n, false), ntt_prime(1UL << 62, n, true),
+            ntt_prime(1UL << 63, n, false), ntt_prime(1UL << 63, n, true),
+            ntt_prime(0, n, false)};
+        for (auto modulus : primes) {
+            uint64_t psi = primitive_root(n, modulus);
+            CpuNTT ntt(n, modulus, psi);
+
+            std::vector<uint64_t> coeffs = random_residues(n, modulus, gen);
+            std::vector<uint64_t> poly(coeffs);
+            ntt.forward(poly.data());
+            ASSERT_EQ(poly, naive_ntt(coeffs, psi, modulus))
+                << "modulus " << modulus;
+            ntt.inverse(poly.data());
+            ASSERT_EQ(poly, coeffs) << "modulus " << modulus;
+
+            // the exact transforms of the moduli from 2^62 on also take
+            // coefficients not reduced by the modulus
+            if (modulus > (1UL << 62)) {
+                std::vector<uint64_t> unreduced =
+                    random_operands(n, modulus, gen);
+                for (uint64_t i = 0; i < n; i++) {
+                    coeffs[i] = unreduced[i] % modulus;
+                }
+                poly = unreduced;
+                ntt.forward(poly.data());
+                ASSERT_EQ(poly, naive_ntt(coeffs, psi, modulus))
+                    << "modulus " << modulus;
+                poly = unreduced;
+                ntt.inverse(poly.data());
+                ASSERT_EQ(poly, naive_intt(coeffs, psi, modulus))
+                    << "modulus " << modulus;
+            }
+
+            std::vector<uint64_t> values = random_residues(n, modulus, gen);
+            poly = values;
+            ntt.inverse(poly.data());
+            ASSERT_EQ(poly, naive_intt(values, psi, modulus))
+                << "modulus " << modulus;
+        }
+    }
+}
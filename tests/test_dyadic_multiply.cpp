@@ -13,6 +13,14 @@ public:
                               uint64_t coeff_count, bool death = false);
     void test_matrix_dyadic_multiply(uint64_t n_rows, uint64_t n_columns,
                                      uint64_t num_moduli, uint64_t coeff_count);
+    void test_dyadic_multiply_batch(uint64_t num_dyadic_multiply,
+                                    uint64_t num_moduli, uint64_t coeff_count);
+    void test_multiply_plain(uint64_t num_multiply, uint64_t num_moduli,
+                             uint64_t coeff_count);
+    void test_multiply_accumulate(uint64_t num_multiply, uint64_t num_moduli,
+                                  uint64_t coeff_count, bool plain);
+    void test_dyadic_multiply_60bit(uint64_t num_dyadic_multiply,
+                                    uint64_t num_moduli, uint64_t coeff_count);
 
     void TestBody() override{};
 
@@ -146,6 +154,216 @@ void dyadic_multiply_test::test_matrix_dyadic_multiply(uint64_t n_rows,
     }
 }
 
+void dyadic_multiply_test::test_dyadic_multiply_batch(
+    uint64_t num_dyadic_multiply, uint64_t num_moduli, uint64_t coeff_count) {
+    setup_dyadic_io(num_dyadic_multiply, num_moduli, coeff_count);
+
+    // the batch shares the moduli of the first multiplication.
+    uint64_t* pmoduli = &moduli[0];
+
+    uint64_t size = num_dyadic_multiply * 3 * num_moduli * coeff_count;
+    std::vector<uint64_t> out(size, 0);
+    std::vector<uint64_t> exp(size, 0);
+
+    std::vector<uint64_t*> pout;
+    std::vector<const uint64_t*> pop1;
+    std::vector<const uint64_t*> pop2;
+    for (uint64_t n = 0; n < num_dyadic_multiply; n++) {
+        pout.push_back(&out[0] + n * num_moduli * coeff_count * 3);
+        pop1.push_back(&op1[0] + n * num_moduli * coeff_count * 2);
+        pop2.push_back(&op2[0] + n * num_moduli * coeff_count * 2);
+    }
+
+    intel::hexl::set_worksize_DyadicMultiply(num_dyadic_multiply);
+    for (uint64_t n = 0; n < num_dyadic_multiply; n++) {
+        intel::hexl::DyadicMultiply(&exp[0] + n * num_moduli * coeff_count * 3,
+                                    pop1[n], pop2[n], coeff_count, pmoduli,
+                                    num_moduli);
+    }
+    intel::hexl::DyadicMultiplyCompleted();
+
+    intel::hexl::DyadicMultiplyBatch(pout.data(), pop1.data(), pop2.data(),
+                                     num_dyadic_multiply, coeff_count, pmoduli,
+                                     num_moduli);
+    ASSERT_EQ(out, exp);
+}
+
+void dyadic_multiply_test::test_multiply_plain(uint64_t num_multiply,
+                                               uint64_t num_moduli,
+                                               uint64_t coeff_count) {
+    setup_dyadic_io(num_multiply, num_moduli, coeff_count);
+
+    // the plaintexts are the first polynomials of the second operands.
+    uint64_t* pmoduli = &moduli[0];
+    std::vector<uint64_t> plain;
+    for (uint64_t b = 0; b < num_multiply; b++) {
+        const uint64_t* pop2 = &op2[0] + b * num_moduli * coeff_count * 2;
+        plain.insert(plain.end(), pop2, pop2 + num_moduli * coeff_count);
+    }
+
+    uint64_t size = num_multiply * 2 * num_moduli * coeff_count;
+    std::vector<uint64_t> exp(size, 0);
+    for (uint64_t b = 0; b < num_multiply; b++) {
+        for (uint64_t c = 0; c < 2; c++) {
+            for (uint64_t m = 0; m < num_moduli; m++) {
+                uint64_t offset =
+                    ((b * 2 + c) * num_moduli + m) * coeff_count;
+                uint64_t plain_offset = (b * num_moduli + m) * coeff_count;
+                for (uint64_t i = 0; i < coeff_count; i++) {
+                    exp[offset + i] = (op1[offset + i] *
+                                       plain[plain_offset + i]) %
+                                      pmoduli[m];
+                }
+            }
+        }
+    }
+
+    std::vector<uint64_t> out(size, 0);
+    std::vector<uint64_t> out_batch(size, 0);
+    std::vector<uint64_t> out_dyadic(3 * num_moduli * coeff_count, 0);
+    std::vector<uint64_t*> pout;
+    std::vector<const uint64_t*> pct;
+    std::vector<const uint64_t*> ppt;
+    for (uint64_t n = 0; n < num_multiply; n++) {
+        pout.push_back(&out_batch[0] + n * num_moduli * coeff_count * 2);
+        pct.push_back(&op1[0] + n * num_moduli * coeff_count * 2);
+        ppt.push_back(&plain[0] + n * num_moduli * coeff_count);
+    }
+
+    // a ciphertext x ciphertext multiplication in between must not share
+    // the device batch of the plaintext multiplications.
+    intel::hexl::set_worksize_DyadicMultiply(num_multiply + 1);
+    for (uint64_t n = 0; n < num_multiply; n++) {
+        intel::hexl::MultiplyPlain(&out[0] + n * num_moduli * coeff_count * 2,
+                                   pct[n], ppt[n], coeff_count, pmoduli,
+                                   num_moduli);
+        if (n == num_multiply / 2) {
+            intel::hexl::DyadicMultiply(&out_dyadic[0], pct[0], &op2[0],
+                                        coeff_count, pmoduli, num_moduli);
+        }
+    }
+    intel::hexl::DyadicMultiplyCompleted();
+
+    intel::hexl::MultiplyPlainBatch(pout.data(), pct.data(), ppt.data(),
+                                    num_multiply, coeff_count, pmoduli,
+                                    num_moduli);
+
+    ASSERT_EQ(out, exp);
+    ASSERT_EQ(out_batch, exp);
+    std::vector<uint64_t> exp_dyadic(exp_out.begin(),
+                                     exp_out.begin() + out_dyadic.size());
+    ASSERT_EQ(out_dyadic, exp_dyadic);
+}
+
+void dyadic_multiply_test::test_multiply_accumulate(uint64_t num_multiply,
+                                                    uint64_t num_moduli,
+                                                    uint64_t coeff_count,
+                                                    bool plain) {
+    setup_dyadic_io(num_multiply, num_moduli, coeff_count);
+
+    uint64_t* pmoduli = &moduli[0];
+    uint64_t n_polys = plain ? 2 : 3;
+    uint64_t size = n_polys * num_moduli * coeff_count;
+    std::vector<uint64_t> products(num_multiply * size, 0);
+    std::vector<uint64_t*> pproducts;
+    std::vector<const uint64_t*> pop1;
+    std::vector<const uint64_t*> pop2;
+    for (uint64_t n = 0; n < num_multiply; n++) {
+        pproducts.push_back(&products[0] + n * size);
+        pop1.push_back(&op1[0] + n * num_moduli * coeff_count * 2);
+        pop2.push_back(&op2[0] + n * num_moduli * coeff_count * 2);
+    }
+
+    // the expected sum is built from the products of the batch api.
+    if (plain) {
+        intel::hexl::MultiplyPlainBatch(pproducts.data(), pop1.data(),
+                                        pop2.data(), num_multiply, coeff_count,
+                                        pmoduli, num_moduli);
+    } else {
+        intel::hexl::DyadicMultiplyBatch(pproducts.data(), pop1.data(),
+                                         pop2.data(), num_multiply,
+                                         coeff_count, pmoduli, num_moduli);
+    }
+    std::vector<uint64_t> exp(size, 0);
+    for (uint64_t n = 0; n < num_multiply; n++) {
+        for (uint64_t i = 0; i < size; i++) {
+            uint64_t modulus = pmoduli[(i / coeff_count) % num_moduli];
+            exp[i] = (exp[i] + pproducts[n][i]) % modulus;
+        }
+    }
+
+    // stale values must not leak into the sum.
+    std::vector<uint64_t> out(size, 1);
+    if (plain) {
+        intel::hexl::MultiplyPlainAccumulate(&out[0], pop1.data(), pop2.data(),
+                                             num_multiply, coeff_count,
+                                             pmoduli, num_moduli);
+    } else {
+        intel::hexl::DyadicMultiplyAccumulate(&out[0], pop1.data(),
+                                              pop2.data(), num_multiply,
+                                              coeff_count, pmoduli,
+                                              num_moduli);
+    }
+    ASSERT_EQ(out, exp);
+}
+
+// operands and moduli of up to 60 bits, reduced from 128-bit products.
+void dyadic_multiply_test::test_dyadic_multiply_60bit(
+    uint64_t num_dyadic_multiply, uint64_t num_moduli, uint64_t coeff_count) {
+    std::vector<uint64_t> moduli_60;
+    for (uint64_t m = 0; m < num_moduli; m++) {
+        moduli_60.push_back((1UL << 60) - 2 * m * coeff_count - 1);
+    }
+
+    uint64_t n_data = num_moduli * coeff_count * 2;
+    std::vector<uint64_t> x(num_dyadic_multiply * n_data);
+    std::vector<uint64_t> y(num_dyadic_multiply * n_data);
+    std::vector<uint64_t> exp(num_dyadic_multiply * num_moduli * coeff_count *
+                              3);
+    std::vector<uint64_t> out(exp.size(), 0);
+    uint64_t seed = 1;
+    for (auto& v : x) {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        v = seed >> 4;
+    }
+    for (auto& v : y) {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        v = seed >> 4;
+    }
+
+    for (uint64_t b = 0; b < num_dyadic_multiply; b++) {
+        uint64_t* px = &x[b * n_data];
+        uint64_t* py = &y[b * n_data];
+        uint64_t* pexp = &exp[b * num_moduli * coeff_count * 3];
+        for (uint64_t m = 0; m < num_moduli; m++) {
+            unsigned __int128 q = moduli_60[m];
+            for (uint64_t i = 0; i < coeff_count; i++) {
+                uint64_t i0 = m * coeff_count + i;
+                uint64_t i1 = (m + num_moduli) * coeff_count + i;
+                px[i0] %= moduli_60[m];
+                px[i1] %= moduli_60[m];
+                py[i0] %= moduli_60[m];
+                py[i1] %= moduli_60[m];
+                unsigned __int128 x0 = px[i0], x1 = px[i1];
+                unsigned __int128 y0 = py[i0], y1 = py[i1];
+                pexp[i0] = uint64_t((x0 * y0) % q);
+                pexp[i1] = uint64_t(((x0 * y1) % q + (x1 * y0) % q) % q);
+                pexp[(m + 2 * num_moduli) * coeff_count + i] =
+                    uint64_t((x1 * y1) % q);
+            }
+        }
+    }
+
+    intel::hexl::set_worksize_DyadicMultiply(num_dyadic_multiply);
+    for (uint64_t b = 0; b < num_dyadic_multiply; b++) {
+        intel::hexl::DyadicMultiply(&out[b * num_moduli * coeff_count * 3],
+                                    &x[b * n_data], &y[b * n_data],
+                                    coeff_count, moduli_60.data(), num_moduli);
+    }
+    intel::hexl::DyadicMultiplyCompleted();
+    ASSERT_EQ(out, exp);
+}
+
 TEST_F(dyadic_multiply_test, p512_m1_b1_16) {
     uint64_t coeff_count = 512 / 2;
     uint64_t num_moduli = 1;
@@ -264,6 +482,54 @@ TEST_F(dyadic_multiply_test, matrix_p32768_m14_b1_16x8) {
                                      coeff_count);
 }
 
+TEST_F(dyadic_multiply_test, batch_p16384_m7_b1_16) {
+    uint64_t coeff_count = 16384 / 2;
+    uint64_t num_moduli = 7;
+    uint64_t num_dyadic_multiply = 16;
+
+    dyadic_multiply_test mult;
+    mult.test_dyadic_multiply_batch(num_dyadic_multiply, num_moduli,
+                                    coeff_count);
+}
+
+TEST_F(dyadic_multiply_test, plain_p16384_m7_b1_16) {
+    uint64_t coeff_count = 16384 / 2;
+    uint64_t num_moduli = 7;
+    uint64_t num_multiply = 16;
+
+    dyadic_multiply_test mult;
+    mult.test_multiply_plain(num_multiply, num_moduli, coeff_count);
+}
+
+TEST_F(dyadic_multiply_test, accumulate_p16384_m7_b1_20) {
+    uint64_t coeff_count = 16384 / 2;
+    uint64_t num_moduli = 7;
+    uint64_t num_multiply = 20;
+
+    dyadic_multiply_test mult;
+    mult.test_multiply_accumulate(num_multiply, num_moduli, coeff_count,
+                                  false);
+}
+
+TEST_F(dyadic_multiply_test, plain_accumulate_p16384_m7_b1_20) {
+    uint64_t coeff_count = 16384 / 2;
+    uint64_t num_moduli = 7;
+    uint64_t num_multiply = 20;
+
+    dyadic_multiply_test mult;
+    mult.test_multiply_accumulate(num_multiply, num_moduli, coeff_count, true);
+}
+
+TEST_F(dyadic_multiply_test, p16384_m7_b1_16_60bit) {
+    uint64_t coeff_count = 16384 / 2;
+    uint64_t num_moduli = 7;
+    uint64_t num_dyadic_multiply = 16;
+
+    dyadic_multiply_test mult;
+    mult.test_dyadic_multiply_60bit(num_dyadic_multiply, num_moduli,
+                                    coeff_count);
+}
+
 TEST_F(dyadic_multiply_test, set_worksize_crash) {
 #ifdef FPGA_DEBUG
     EXPECT_DEATH(intel::hexl::set_worksize_DyadicMultiply(0), "Assertion");
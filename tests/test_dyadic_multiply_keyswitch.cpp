@@ -4,41 +4,17 @@
 #include <cstdlib>
 #include <vector>
 
-#include <glob.h>
 #include "gtest/gtest.h"
 
 #include <fstream>
 #include <memory>
-#include <nlohmann/json.hpp>
 #include <random>
 #include <string>
 
 #include "hexl-fpga.h"
+#include "test_utils/keyswitch_test_vector.hpp"
 
-struct KeySwitchTestVector {
-    explicit KeySwitchTestVector(const char* json_filename);
-
-    size_t coeff_count;
-    size_t decomp_modulus_size;
-    size_t key_modulus_size;
-    size_t rns_modulus_size;
-    size_t key_component_count;
-
-    std::vector<uint64_t> moduli;
-    std::vector<uint64_t> modswitch_factors;
-    std::vector<uint64_t> twiddle_factors;
-    std::vector<const uint64_t*> key_vectors;
-
-    std::vector<uint64_t> t_target_iter_ptr;
-    std::vector<uint64_t> input;
-    std::vector<uint64_t> expected_output;
-
-    std::vector<std::vector<uint64_t>> vectors;
-
-private:
-    std::ifstream json_file;
-    nlohmann::json js;
-};
+using hetest::utils::KeySwitchTestVector;
 
 class dyadic_multiply_keyswitch_test {
 public:
@@ -81,7 +57,6 @@ public:
         void check_results();
 
     private:
-        std::vector<std::string> glob(const char* pattern);
         std::vector<KeySwitchTestVector> test_vectors;
     };
 
@@ -182,76 +157,12 @@ void dyadic_multiply_keyswitch_test::dyadic_multiply_test::check_results() {
     ASSERT_EQ(out, exp_out);
 }
 
-KeySwitchTestVector::KeySwitchTestVector(const char* json_filename)
-    : json_file(json_filename) {
-    json_file >> js;
-
-    coeff_count = js["coeff_count"].get<uint64_t>();
-    decomp_modulus_size = js["decomp_modulus_size"].get<uint64_t>();
-    key_modulus_size = js["key_modulus_size"].get<uint64_t>();
-    rns_modulus_size = js["rns_modulus_size"].get<uint64_t>();
-    key_component_count = js["key_component_count"].get<uint64_t>();
-
-    moduli = js["moduli"].get<std::vector<uint64_t>>();
-    modswitch_factors = js["modswitch_factors"].get<std::vector<uint64_t>>();
-
-    bool twiddles = js.contains("inv_root_of_unity_powers");
-    twiddles &= js.contains("precon64_inv_root_of_unity_powers");
-    twiddles &= js.contains("root_of_unity_powers");
-    twiddles &= js.contains("precon64_root_of_unity_powers");
-
-    if (twiddles) {
-        for (uint64_t k = 0; k < key_modulus_size; k++) {
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(js["inv_root_of_unity_powers"][k][i]);
-            }
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(
-                    js["precon64_inv_root_of_unity_powers"][k][i]);
-            }
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(js["root_of_unity_powers"][k][i]);
-            }
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(
-                    js["precon64_root_of_unity_powers"][k][i]);
-            }
-        }
-    }
-
-    for (uint64_t k = 0; k < decomp_modulus_size; k++) {
-        std::vector<uint64_t> key_vector;
-        for (uint64_t i = 0; i < 2 * key_modulus_size * coeff_count; i++) {
-            key_vector.push_back(js["key_vector"][k][i]);
-        }
-        vectors.push_back(key_vector);
-        key_vectors.push_back(const_cast<uint64_t*>(&vectors[k].data()[0]));
-    }
-
-    t_target_iter_ptr = js["t_target_iter_ptr"].get<std::vector<uint64_t>>();
-    input = js["input"].get<std::vector<uint64_t>>();
-    expected_output = js["expected_output"].get<std::vector<uint64_t>>();
-}
-
-std::vector<std::string> dyadic_multiply_keyswitch_test::keyswitch_test::glob(
-    const char* pattern) {
-    glob_t glob_result = {0};
-
-    ::glob(pattern, GLOB_TILDE, NULL, &glob_result);
-
-    std::vector<std::string> filenames(
-        glob_result.gl_pathv, glob_result.gl_pathv + glob_result.gl_pathc);
-
-    globfree(&glob_result);
-
-    return filenames;
-}
-
 dyadic_multiply_keyswitch_test::keyswitch_test::keyswitch_test(
     const std::string& test_fullname) {
     std::vector<std::string> test_vector_files;
     for (size_t n = 0; n < 2; n++) {
-        std::vector<std::string> filesx = glob(test_fullname.c_str());
+        std::vector<std::string> filesx =
+            hetest::utils::GlobTestVectors(test_fullname);
 
         for (size_t i = 0; i < filesx.size(); i++) {
             test_vector_files.push_back(filesx[i]);
@@ -304,10 +215,66 @@ TEST(dyadic_multiply_keyswitch_test, batch_16384_6_7_7_2) {
         exit(1);
     }
     std::string test_file = "/16384_6_7_7_2_*";
-    std::string test_fullname = fname + test_file + ".json";
+    std::string test_fullname = fname + test_file;
 
     dyadic_multiply_keyswitch_test test(coeff_count / 2, num_moduli,
                                         num_dyadic_multiply, test_fullname);
     test.test_dyadic_multiply_keyswitch();
     test.check_results();
 }
+
+// MultiplyRelinearize must match a DyadicMultiply followed by a KeySwitch of
+// the third component of the product.
+TEST(dyadic_multiply_keyswitch_test, multiply_relinearize_16384_6_7_7_2) {
+    const char* fname = getenv("KEYSWITCH_DATA_DIR");
+    if (!fname) {
+        std::cerr << "set env(KEYSWITCH_DATA_DIR) to the test vector dir"
+                  << std::endl;
+        exit(1);
+    }
+    std::string test_file = "/16384_6_7_7_2_*";
+    std::string test_fullname = fname + test_file;
+
+    std::vector<std::string> files =
+        hetest::utils::GlobTestVectors(test_fullname);
+    ASSERT_GT(files.size(), 0u);
+    KeySwitchTestVector tv(files[0].c_str());
+
+    uint64_t n = tv.coeff_count;
+    uint64_t n_moduli = tv.decomp_modulus_size;
+    uint64_t size = n_moduli * n;
+
+    // the operands are reduced keyswitch inputs, in NTT form.
+    std::vector<uint64_t> op1(tv.input.begin(), tv.input.begin() + 2 * size);
+    std::vector<uint64_t> op2(op1.rbegin(), op1.rend());
+    for (uint64_t m = 0; m < n_moduli; m++) {
+        for (uint64_t i = 0; i < n; i++) {
+            op2[m * n + i] %= tv.moduli[m];
+            op2[size + m * n + i] %= tv.moduli[m];
+        }
+    }
+
+    std::vector<uint64_t> exp_out(3 * size, 0);
+    intel::hexl::DyadicMultiply(exp_out.data(), op1.data(), op2.data(), n,
+                                tv.moduli.data(), n_moduli);
+    intel::hexl::KeySwitch(exp_out.data(), exp_out.data() + 2 * size, n,
+                           n_moduli, tv.key_modulus_size, tv.rns_modulus_size,
+                           tv.key_component_count, tv.moduli.data(),
+                           tv.key_vectors.data(), tv.modswitch_factors.data(),
+                           tv.twiddle_factors.data());
+
+    std::vector<uint64_t> out(3 * size, 0);
+    uint64_t* pout = out.data();
+    const uint64_t* pop1 = op1.data();
+    const uint64_t* pop2 = op2.data();
+    intel::hexl::MultiplyRelinearize(
+        &pout, &pop1, &pop2, 1, n, n_moduli, tv.key_modulus_size,
+        tv.rns_modulus_size, tv.key_component_count, tv.moduli.data(),
+        tv.key_vectors.data(), tv.modswitch_factors.data(),
+        tv.twiddle_factors.data());
+
+    std::vector<uint64_t> relin(out.begin(), out.begin() + 2 * size);
+    std::vector<uint64_t> exp_relin(exp_out.begin(),
+                                    exp_out.begin() + 2 * size);
+    ASSERT_EQ(relin, exp_relin);
+}
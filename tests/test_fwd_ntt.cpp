@@ -69,26 +69,32 @@ using StimulusType = hetest::utils::StimulusType;
 class fwd_ntt_test : public ::testing::Test {
 public:
     void run_fwd_ntt_test(StimulusType stimulusType, uint64_t iterations,
-                          uint64_t bitsForPrime);
+                          uint64_t bitsForPrime, uint64_t degree = ntt_degree);
+    void run_fwd_ntt_rns_test(StimulusType stimulusType, uint64_t num_moduli,
+                              uint64_t bitsForPrime,
+                              uint64_t degree = ntt_degree);
+    void run_fwd_ntt_plan_test(StimulusType stimulusType, uint64_t num_plans,
+                               uint64_t count, uint64_t bitsForPrime,
+                               bool async, uint64_t degree = ntt_degree);
     void TestBody() override {}
 
 private:
     void load_fwd_ntt_data(StimulusType stimulusType, uint64_t iterations,
-                           uint64_t bitsForPrime);
+                           uint64_t bitsForPrime, uint64_t degree);
     std::vector<std::vector<uint64_t>> input_;
     std::vector<uint64_t> primes_;
 };
 
 void fwd_ntt_test::load_fwd_ntt_data(StimulusType stimulusType,
                                      uint64_t iterations,
-                                     uint64_t bitsForPrime) {
+                                     uint64_t bitsForPrime, uint64_t degree) {
     std::random_device rd;
     std::mt19937 gen(rd());
     this->primes_ =
-        hetest::utils::GeneratePrimes(iterations, bitsForPrime, ntt_degree);
+        hetest::utils::GeneratePrimes(iterations, bitsForPrime, degree);
     for (unsigned i = 0; i < iterations; i++) {
         std::vector<uint64_t> input;
-        input.resize(ntt_degree);
+        input.resize(degree);
         hetest::utils::genStimulusForNTT<uint64_t>(input, primes_[i],
                                                    stimulusType);
         input_.push_back(input);
@@ -96,11 +102,11 @@ void fwd_ntt_test::load_fwd_ntt_data(StimulusType stimulusType,
 }
 void fwd_ntt_test::run_fwd_ntt_test(StimulusType stimulusType,
                                     uint64_t iterations,
-                                    uint64_t bitsForPrime) {
-    load_fwd_ntt_data(stimulusType, iterations, bitsForPrime);
+                                    uint64_t bitsForPrime, uint64_t degree) {
+    load_fwd_ntt_data(stimulusType, iterations, bitsForPrime, degree);
 
     for (unsigned i = 0; i < iterations; i++) {
-        hetest::utils::NTT::NTTImpl ntt(ntt_degree, this->primes_[i]);
+        hetest::utils::NTT::NTTImpl ntt(degree, this->primes_[i]);
 
         std::vector<uint64_t> results = input_[i];
         std::vector<uint64_t> inNTT = input_[i];
@@ -109,13 +115,87 @@ void fwd_ntt_test::run_fwd_ntt_test(StimulusType stimulusType,
         intel::hexl::_set_worksize_NTT(1);
         intel::hexl::_NTT(results.data(), ntt.GetRootOfUnityPowersPtr(),
                           ntt.GetPrecon64RootOfUnityPowersPtr(),
-                          this->primes_[i], ntt_degree);
+                          this->primes_[i], degree);
         intel::hexl::_NTTCompleted();
         // Verify NTT output against reference output
         ASSERT_EQ(results, outNTT);
     }
 }
 
+// transforms the num_moduli limbs of one RNS polynomial in a single batch
+void fwd_ntt_test::run_fwd_ntt_rns_test(StimulusType stimulusType,
+                                        uint64_t num_moduli,
+                                        uint64_t bitsForPrime,
+                                        uint64_t degree) {
+    load_fwd_ntt_data(stimulusType, num_moduli, bitsForPrime, degree);
+
+    std::vector<uint64_t> results;
+    for (unsigned i = 0; i < num_moduli; i++) {
+        results.insert(results.end(), input_[i].begin(), input_[i].end());
+    }
+    intel::hexl::NTTRns(results.data(), this->primes_.data(), num_moduli,
+                        degree);
+
+    for (unsigned i = 0; i < num_moduli; i++) {
+        hetest::utils::NTT::NTTImpl ntt(degree, this->primes_[i]);
+        std::vector<uint64_t> out = input_[i];
+        ntt.ComputeForward(out.data(), input_[i].data(), 1, 1);
+        std::vector<uint64_t> limb(results.begin() + i * degree,
+                                   results.begin() + (i + 1) * degree);
+        ASSERT_EQ(limb, out);
+    }
+}
+
+// transforms count polynomials with each of num_plans plans, for a root of
+// unity other than the minimal one. The asynchronous run queues the
+// transforms of all the plans before waiting for them.
+void fwd_ntt_test::run_fwd_ntt_plan_test(StimulusType stimulusType,
+                                 uint64_t num_plans, uint64_t count,
+                                 uint64_t bitsForPrime, bool async,
+                                 uint64_t degree) {
+    this->primes_ =
+        hetest::utils::GeneratePrimes(num_plans, bitsForPrime, degree);
+    std::vector<uint64_t> roots(num_plans);
+    std::vector<uint64_t> plans(num_plans);
+    std::vector<std::vector<uint64_t>> results(num_plans * count);
+    std::vector<std::vector<uint64_t*>> polys(num_plans);
+    for (unsigned p = 0; p < num_plans; p++) {
+        roots[p] = hetest::utils::PowMod(
+            hetest::utils::MinimalPrimitiveRoot(2 * degree, primes_[p]), 3,
+            primes_[p]);
+        plans[p] =
+            intel::hexl::CreateTransformPlan(degree, primes_[p], roots[p]);
+        for (unsigned c = 0; c < count; c++) {
+            std::vector<uint64_t>& poly = results[p * count + c];
+            poly.resize(degree);
+            hetest::utils::genStimulusForNTT<uint64_t>(poly, primes_[p],
+                                                       stimulusType);
+            input_.push_back(poly);
+            polys[p].push_back(poly.data());
+        }
+    }
+
+    if (async) {
+        intel::hexl::set_worksize_ForwardTransform(num_plans * count);
+    }
+    for (unsigned p = 0; p < num_plans; p++) {
+        intel::hexl::ForwardTransform(polys[p].data(), count, plans[p]);
+    }
+    if (async) {
+        intel::hexl::ForwardTransformCompleted();
+    }
+
+    for (unsigned p = 0; p < num_plans; p++) {
+        hetest::utils::NTT::NTTImpl ntt(degree, primes_[p], roots[p]);
+        for (unsigned c = 0; c < count; c++) {
+            std::vector<uint64_t> out = input_[p * count + c];
+            ntt.ComputeForward(out.data(), input_[p * count + c].data(), 1, 1);
+            ASSERT_EQ(results[p * count + c], out);
+        }
+        intel::hexl::DestroyTransformPlan(plans[p]);
+    }
+}
+
 TEST_F(fwd_ntt_test, p16384_FWD_NTT_iRAND_iters4_pbits18) {
     fwd_ntt_test he_fpga_api;
     he_fpga_api.run_fwd_ntt_test(StimulusType::RANDOM, 4, 20);
@@ -168,3 +248,45 @@ TEST_F(fwd_ntt_test, p16384_FWD_NTT_iRAND_iters410_pbits64) {
     fwd_ntt_test he_fpga_api;
     he_fpga_api.run_fwd_ntt_test(StimulusType::RANDOM, 10, 62);
 }
+
+TEST_F(fwd_ntt_test, p8192_FWD_NTT_iRAND_iters4_pbits55) {
+    fwd_ntt_test he_fpga_api;
+    he_fpga_api.run_fwd_ntt_test(StimulusType::RANDOM, 4, 55, 8192);
+}
+
+TEST_F(fwd_ntt_test, p4096_FWD_NTT_iRAND_iters4_pbits55) {
+    fwd_ntt_test he_fpga_api;
+    he_fpga_api.run_fwd_ntt_test(StimulusType::RANDOM, 4, 55, 4096);
+}
+
+// alternates the sizes to check the kernel state is reset between batches,
+// the repeated size reuses the twiddle table cached on the device
+TEST_F(fwd_ntt_test, mixed_sizes_FWD_NTT_iRAND_iters4_pbits55) {
+    for (uint64_t degree : {4096, 16384, 1024, 16384}) {
+        fwd_ntt_test he_fpga_api;
+        he_fpga_api.run_fwd_ntt_test(StimulusType::RANDOM, 4, 55, degree);
+    }
+}
+
+// the 14 limbs of a ciphertext component, each with its own modulus, are
+// transformed in one batch
+TEST_F(fwd_ntt_test, p16384_FWD_NTT_RNS_iRAND_moduli14_pbits55) {
+    fwd_ntt_test he_fpga_api;
+    he_fpga_api.run_fwd_ntt_rns_test(StimulusType::RANDOM, 14, 55);
+}
+
+TEST_F(fwd_ntt_test, p4096_FWD_NTT_RNS_iRAND_moduli3_pbits32) {
+    fwd_ntt_test he_fpga_api;
+    he_fpga_api.run_fwd_ntt_rns_test(StimulusType::RANDOM, 3, 32, 4096);
+}
+
+TEST_F(fwd_ntt_test, p16384_FWD_NTT_PLAN_iRAND_plans1_count8_pbits55) {
+    fwd_ntt_test he_fpga_api;
+    he_fpga_api.run_fwd_ntt_plan_test(StimulusType::RANDOM, 1, 8, 55, false);
+}
+
+TEST_F(fwd_ntt_test, p4096_FWD_NTT_PLAN_iRAND_plans3_count4_pbits32_async) {
+    fwd_ntt_test he_fpga_api;
+    he_fpga_api.run_fwd_ntt_plan_test(StimulusType::RANDOM, 3, 4, 32, true,
+                                     4096);
+}
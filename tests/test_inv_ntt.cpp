@@ -69,26 +69,32 @@ using StimulusType = hetest::utils::StimulusType;
 class inv_ntt_test : public ::testing::Test {
 public:
     void run_inv_ntt_test(StimulusType stimulusType, uint64_t iterations,
-                          uint64_t bitsForPrime);
+                          uint64_t bitsForPrime, uint64_t degree = ntt_degree);
+    void run_inv_ntt_rns_test(StimulusType stimulusType, uint64_t num_moduli,
+                              uint64_t bitsForPrime,
+                              uint64_t degree = ntt_degree);
+    void run_inv_ntt_plan_test(StimulusType stimulusType, uint64_t num_plans,
+                               uint64_t count, uint64_t bitsForPrime,
+                               bool async, uint64_t degree = ntt_degree);
     void TestBody() override {}
 
 private:
     void load_inv_ntt_data(StimulusType stimulusType, uint64_t iterations,
-                           uint64_t bitsForPrime);
+                           uint64_t bitsForPrime, uint64_t degree);
     std::vector<std::vector<uint64_t>> input_;
     std::vector<uint64_t> primes_;
 };
 
 void inv_ntt_test::load_inv_ntt_data(StimulusType stimulusType,
                                      uint64_t iterations,
-                                     uint64_t bitsForPrime) {
+                                     uint64_t bitsForPrime, uint64_t degree) {
     std::random_device rd;
     std::mt19937 gen(rd());
     this->primes_ =
-        hetest::utils::GeneratePrimes(iterations, bitsForPrime, ntt_degree);
+        hetest::utils::GeneratePrimes(iterations, bitsForPrime, degree);
     for (unsigned i = 0; i < iterations; i++) {
         std::vector<uint64_t> input;
-        input.resize(ntt_degree);
+        input.resize(degree);
         hetest::utils::genStimulusForNTT<uint64_t>(input, primes_[i],
                                                    stimulusType);
         input_.push_back(input);
@@ -96,18 +102,18 @@ void inv_ntt_test::load_inv_ntt_data(StimulusType stimulusType,
 }
 void inv_ntt_test::run_inv_ntt_test(StimulusType stimulusType,
                                     uint64_t iterations,
-                                    uint64_t bitsForPrime) {
-    load_inv_ntt_data(stimulusType, iterations, bitsForPrime);
+                                    uint64_t bitsForPrime, uint64_t degree) {
+    load_inv_ntt_data(stimulusType, iterations, bitsForPrime, degree);
 
     for (unsigned i = 0; i < iterations; i++) {
-        hetest::utils::NTT::NTTImpl ntt(ntt_degree, this->primes_[i]);
+        hetest::utils::NTT::NTTImpl ntt(degree, this->primes_[i]);
 
         const uint64_t* inv_root_of_unity_powers =
             ntt.GetInvRootOfUnityPowersPtr();
-        uint64_t inv_ntt_degree =
-            hetest::utils::InverseUIntMod(ntt_degree, this->primes_[i]);
-        uint64_t W_op = inv_root_of_unity_powers[ntt_degree - 1];
-        uint64_t inv_n_w = hetest::utils::MultiplyUIntMod(inv_ntt_degree, W_op,
+        uint64_t inv_degree =
+            hetest::utils::InverseUIntMod(degree, this->primes_[i]);
+        uint64_t W_op = inv_root_of_unity_powers[degree - 1];
+        uint64_t inv_n_w = hetest::utils::MultiplyUIntMod(inv_degree, W_op,
                                                           this->primes_[i]);
 
         std::vector<uint64_t> results = input_[i];
@@ -117,13 +123,87 @@ void inv_ntt_test::run_inv_ntt_test(StimulusType stimulusType,
         intel::hexl::_set_worksize_INTT(1);
         intel::hexl::_INTT(results.data(), ntt.GetInvRootOfUnityPowersPtr(),
                            ntt.GetPrecon64InvRootOfUnityPowersPtr(),
-                           this->primes_[i], inv_ntt_degree, inv_n_w,
-                           ntt_degree);
+                           this->primes_[i], inv_degree, inv_n_w,
+                           degree);
         intel::hexl::_INTTCompleted();
         ASSERT_EQ(results, outINTT);
     }
 }
 
+// transforms the num_moduli limbs of one RNS polynomial in a single batch
+void inv_ntt_test::run_inv_ntt_rns_test(StimulusType stimulusType,
+                                        uint64_t num_moduli,
+                                        uint64_t bitsForPrime,
+                                        uint64_t degree) {
+    load_inv_ntt_data(stimulusType, num_moduli, bitsForPrime, degree);
+
+    std::vector<uint64_t> results;
+    for (unsigned i = 0; i < num_moduli; i++) {
+        results.insert(results.end(), input_[i].begin(), input_[i].end());
+    }
+    intel::hexl::INTTRns(results.data(), this->primes_.data(), num_moduli,
+                         degree);
+
+    for (unsigned i = 0; i < num_moduli; i++) {
+        hetest::utils::NTT::NTTImpl ntt(degree, this->primes_[i]);
+        std::vector<uint64_t> out = input_[i];
+        ntt.ComputeInverse(out.data(), input_[i].data(), 1, 1);
+        std::vector<uint64_t> limb(results.begin() + i * degree,
+                                   results.begin() + (i + 1) * degree);
+        ASSERT_EQ(limb, out);
+    }
+}
+
+// transforms count polynomials with each of num_plans plans, for a root of
+// unity other than the minimal one. The asynchronous run queues the
+// transforms of all the plans before waiting for them.
+void inv_ntt_test::run_inv_ntt_plan_test(StimulusType stimulusType,
+                                 uint64_t num_plans, uint64_t count,
+                                 uint64_t bitsForPrime, bool async,
+                                 uint64_t degree) {
+    this->primes_ =
+        hetest::utils::GeneratePrimes(num_plans, bitsForPrime, degree);
+    std::vector<uint64_t> roots(num_plans);
+    std::vector<uint64_t> plans(num_plans);
+    std::vector<std::vector<uint64_t>> results(num_plans * count);
+    std::vector<std::vector<uint64_t*>> polys(num_plans);
+    for (unsigned p = 0; p < num_plans; p++) {
+        roots[p] = hetest::utils::PowMod(
+            hetest::utils::MinimalPrimitiveRoot(2 * degree, primes_[p]), 3,
+            primes_[p]);
+        plans[p] =
+            intel::hexl::CreateTransformPlan(degree, primes_[p], roots[p]);
+        for (unsigned c = 0; c < count; c++) {
+            std::vector<uint64_t>& poly = results[p * count + c];
+            poly.resize(degree);
+            hetest::utils::genStimulusForNTT<uint64_t>(poly, primes_[p],
+                                                       stimulusType);
+            input_.push_back(poly);
+            polys[p].push_back(poly.data());
+        }
+    }
+
+    if (async) {
+        intel::hexl::set_worksize_InverseTransform(num_plans * count);
+    }
+    for (unsigned p = 0; p < num_plans; p++) {
+        intel::hexl::InverseTransform(polys[p].data(), count, plans[p]);
+    }
+    if (async) {
+        intel::hexl::InverseTransformCompleted();
+    }
+
+    for (unsigned p = 0; p < num_plans; p++) {
+        hetest::utils::NTT::NTTImpl ntt(degree, primes_[p], roots[p]);
+        for (unsigned c = 0; c < count; c++) {
+            std::vector<uint64_t> out = input_[p * count + c];
+            ntt.ComputeInverse(out.data(), input_[p * count + c].data(), 1, 1);
+            ASSERT_EQ(results[p * count + c], out);
+        }
+        intel::hexl::DestroyTransformPlan(plans[p]);
+    }
+}
+
 TEST_F(inv_ntt_test, p16384_INV_INTT_iRAND_iters4_pbits18) {
     inv_ntt_test he_fpga_api;
     he_fpga_api.run_inv_ntt_test(StimulusType::RANDOM, 4, 20);
@@ -176,3 +256,45 @@ TEST_F(inv_ntt_test, p16384_INV_INTT_iRAND_iters410_pbits64) {
     inv_ntt_test he_fpga_api;
     he_fpga_api.run_inv_ntt_test(StimulusType::RANDOM, 10, 62);
 }
+
+TEST_F(inv_ntt_test, p8192_INV_INTT_iRAND_iters4_pbits55) {
+    inv_ntt_test he_fpga_api;
+    he_fpga_api.run_inv_ntt_test(StimulusType::RANDOM, 4, 55, 8192);
+}
+
+TEST_F(inv_ntt_test, p4096_INV_INTT_iRAND_iters4_pbits55) {
+    inv_ntt_test he_fpga_api;
+    he_fpga_api.run_inv_ntt_test(StimulusType::RANDOM, 4, 55, 4096);
+}
+
+// alternates the sizes to check the kernel state is reset between batches,
+// the repeated size reuses the twiddle table cached on the device
+TEST_F(inv_ntt_test, mixed_sizes_INV_INTT_iRAND_iters4_pbits55) {
+    for (uint64_t degree : {4096, 16384, 1024, 16384}) {
+        inv_ntt_test he_fpga_api;
+        he_fpga_api.run_inv_ntt_test(StimulusType::RANDOM, 4, 55, degree);
+    }
+}
+
+// the 14 limbs of a ciphertext component, each with its own modulus, are
+// transformed in one batch
+TEST_F(inv_ntt_test, p16384_INV_INTT_RNS_iRAND_moduli14_pbits55) {
+    inv_ntt_test he_fpga_api;
+    he_fpga_api.run_inv_ntt_rns_test(StimulusType::RANDOM, 14, 55);
+}
+
+TEST_F(inv_ntt_test, p4096_INV_INTT_RNS_iRAND_moduli3_pbits32) {
+    inv_ntt_test he_fpga_api;
+    he_fpga_api.run_inv_ntt_rns_test(StimulusType::RANDOM, 3, 32, 4096);
+}
+
+TEST_F(inv_ntt_test, p16384_INV_INTT_PLAN_iRAND_plans1_count8_pbits55) {
+    inv_ntt_test he_fpga_api;
+    he_fpga_api.run_inv_ntt_plan_test(StimulusType::RANDOM, 1, 8, 55, false);
+}
+
+TEST_F(inv_ntt_test, p4096_INV_INTT_PLAN_iRAND_plans3_count4_pbits32_async) {
+    inv_ntt_test he_fpga_api;
+    he_fpga_api.run_inv_ntt_plan_test(StimulusType::RANDOM, 3, 4, 32, true,
+                                     4096);
+}
@@ -1,120 +1,50 @@
 // Copyright (C) 2020-2021 Intel Corporation
 // SPDX-License-Identifier: Apache-2.0
 
-#include <glob.h>
 #include <gtest/gtest.h>
 
+#include <cstdio>
 #include <fstream>
 #include <memory>
-#include <nlohmann/json.hpp>
 #include <random>
 #include <string>
 #include <vector>
 #include "hexl-fpga.h"
+#include "test_utils/keyswitch_reference.hpp"
+#include "test_utils/keyswitch_test_vector.hpp"
+#include "test_utils/ntt.hpp"
+#include "test_utils/test_vectors.hpp"
 
 static uint32_t get_n() {
     char* env = getenv("N");
-    // the valid values are 1024, 2048, 4096, 8192, 16384
-    // the default is 16384
+    // the valid values are 1024, 2048, 4096, 8192, 16384, 32768
+    // the default is 16384, 32768 requires libkeyswitch_32k.so
     uint32_t val = 16384;
     if (env) {
         val = strtol(env, NULL, 10);
         assert((val == 1024) || (val == 2048) || (val == 4096) ||
-               (val == 8192) || (val == 16384));
+               (val == 8192) || (val == 16384) || (val == 32768));
     }
     return val;
 }
 
 static uint32_t n_size = get_n();
 
-struct KeySwitchTestVector {
-    explicit KeySwitchTestVector(const char* json_filename);
-
-    size_t coeff_count;
-    size_t decomp_modulus_size;
-    size_t key_modulus_size;
-    size_t rns_modulus_size;
-    size_t key_component_count;
-
-    std::vector<uint64_t> moduli;
-    std::vector<uint64_t> modswitch_factors;
-    std::vector<uint64_t> twiddle_factors;
-    std::vector<const uint64_t*> key_vectors;
-
-    std::vector<uint64_t> t_target_iter_ptr;
-    std::vector<uint64_t> input;
-    std::vector<uint64_t> expected_output;
-
-    std::vector<std::vector<uint64_t>> vectors;
-
-private:
-    std::ifstream json_file;
-    nlohmann::json js;
-};
-
-KeySwitchTestVector::KeySwitchTestVector(const char* json_filename)
-    : json_file(json_filename) {
-    json_file >> js;
-
-    coeff_count = js["coeff_count"].get<uint64_t>();
-    decomp_modulus_size = js["decomp_modulus_size"].get<uint64_t>();
-    key_modulus_size = js["key_modulus_size"].get<uint64_t>();
-    rns_modulus_size = js["rns_modulus_size"].get<uint64_t>();
-    key_component_count = js["key_component_count"].get<uint64_t>();
-
-    moduli = js["moduli"].get<std::vector<uint64_t>>();
-    modswitch_factors = js["modswitch_factors"].get<std::vector<uint64_t>>();
-
-    bool twiddles = js.contains("inv_root_of_unity_powers");
-    twiddles &= js.contains("precon64_inv_root_of_unity_powers");
-    twiddles &= js.contains("root_of_unity_powers");
-    twiddles &= js.contains("precon64_root_of_unity_powers");
-
-    if (twiddles) {
-        for (uint64_t k = 0; k < key_modulus_size; k++) {
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(js["inv_root_of_unity_powers"][k][i]);
-            }
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(
-                    js["precon64_inv_root_of_unity_powers"][k][i]);
-            }
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(js["root_of_unity_powers"][k][i]);
-            }
-            for (uint64_t i = 0; i < coeff_count; i++) {
-                twiddle_factors.push_back(
-                    js["precon64_root_of_unity_powers"][k][i]);
-            }
-        }
-    }
-
-    for (uint64_t k = 0; k < decomp_modulus_size; k++) {
-        std::vector<uint64_t> key_vector;
-        for (uint64_t i = 0; i < 2 * key_modulus_size * coeff_count; i++) {
-            key_vector.push_back(js["key_vector"][k][i]);
-        }
-        vectors.push_back(key_vector);
-        key_vectors.push_back(const_cast<uint64_t*>(&vectors[k].data()[0]));
+static uint64_t get_modulus_bits() {
+    char* env = getenv("MODULUS_BITS");
+    // the bits of the moduli of the generated test vectors, up to 52, and up
+    // to 60 with libkeyswitch_60.so at N >= 4096
+    uint64_t val = 50;
+    if (env) {
+        val = strtoul(env, NULL, 10);
+        assert((val > 17) && (val <= 60));
     }
-
-    t_target_iter_ptr = js["t_target_iter_ptr"].get<std::vector<uint64_t>>();
-    input = js["input"].get<std::vector<uint64_t>>();
-    expected_output = js["expected_output"].get<std::vector<uint64_t>>();
+    return val;
 }
 
-std::vector<std::string> glob(const char* pattern) {
-    glob_t glob_result = {0};
-
-    ::glob(pattern, GLOB_TILDE, NULL, &glob_result);
-
-    std::vector<std::string> filenames(
-        glob_result.gl_pathv, glob_result.gl_pathv + glob_result.gl_pathc);
-
-    globfree(&glob_result);
+static uint64_t modulus_bits = get_modulus_bits();
 
-    return filenames;
-}
+using hetest::utils::KeySwitchTestVector;
 
 void test_KeySwitch(const std::vector<std::string>& files) {
     std::vector<KeySwitchTestVector> test_vectors;
@@ -145,6 +75,37 @@ void test_KeySwitch(const std::vector<std::string>& files) {
     }
 }
 
+void test_KeySwitchBatch(const std::vector<std::string>& files) {
+    std::vector<KeySwitchTestVector> test_vectors;
+    for (size_t i = 0; i < files.size(); i++) {
+        std::cout << "Constructing Test Vector " << i << " from File ... "
+                  << files[i] << std::endl;
+        test_vectors.push_back(KeySwitchTestVector(files[i].c_str()));
+    }
+
+    size_t test_vector_size = test_vectors.size();
+    assert(test_vector_size > 0);
+
+    std::vector<uint64_t*> results;
+    std::vector<const uint64_t*> t_target_iter_ptrs;
+    for (size_t i = 0; i < test_vector_size; i++) {
+        results.push_back(test_vectors[i].input.data());
+        t_target_iter_ptrs.push_back(test_vectors[i].t_target_iter_ptr.data());
+    }
+
+    intel::hexl::KeySwitchBatch(
+        results.data(), t_target_iter_ptrs.data(), test_vector_size,
+        test_vectors[0].coeff_count, test_vectors[0].decomp_modulus_size,
+        test_vectors[0].key_modulus_size, test_vectors[0].rns_modulus_size,
+        test_vectors[0].key_component_count, test_vectors[0].moduli.data(),
+        test_vectors[0].key_vectors.data(),
+        test_vectors[0].modswitch_factors.data(),
+        test_vectors[0].twiddle_factors.data());
+    for (size_t i = 0; i < files.size(); i++) {
+        ASSERT_EQ(test_vectors[i].input, test_vectors[i].expected_output);
+    }
+}
+
 TEST(KeySwitch, batch_6_7_7_2) {
     const char* fname = getenv("KEYSWITCH_DATA_DIR");
     if (!fname) {
@@ -157,8 +118,9 @@ TEST(KeySwitch, batch_6_7_7_2) {
 
     for (size_t n = 0; n < 2; n++) {
         std::string test_file = "/" + std::to_string(n_size) + "_6_7_7_2_*";
-        std::string test_fullname = fname + test_file + ".json";
-        std::vector<std::string> filesx = glob(test_fullname.c_str());
+        std::string test_fullname = fname + test_file;
+        std::vector<std::string> filesx =
+            hetest::utils::GlobTestVectors(test_fullname);
 
         for (size_t i = 0; i < filesx.size(); i++) {
             files.push_back(filesx[i]);
@@ -180,8 +142,9 @@ TEST(KeySwitch, batch_5_7_6_2_2) {
 
     for (size_t n = 0; n < 2; n++) {
         std::string test_file = "/" + std::to_string(n_size) + "_5_7_6_2_*";
-        std::string test_fullname = fname + test_file + ".json";
-        std::vector<std::string> filesx = glob(test_fullname.c_str());
+        std::string test_fullname = fname + test_file;
+        std::vector<std::string> filesx =
+            hetest::utils::GlobTestVectors(test_fullname);
 
         for (size_t i = 0; i < filesx.size(); i++) {
             files.push_back(filesx[i]);
@@ -189,3 +152,301 @@ TEST(KeySwitch, batch_5_7_6_2_2) {
     }
     test_KeySwitch(files);
 }
+
+TEST(KeySwitch, batch_api_6_7_7_2) {
+    const char* fname = getenv("KEYSWITCH_DATA_DIR");
+    if (!fname) {
+        std::cerr << "set env KEYSWITCH_DATA_DIR to the test vector dir"
+                  << std::endl;
+        exit(1);
+    }
+
+    std::string test_file = "/" + std::to_string(n_size) + "_6_7_7_2_*";
+    std::string test_fullname = fname + test_file;
+    std::vector<std::string> files =
+        hetest::utils::GlobTestVectors(test_fullname);
+
+    test_KeySwitchBatch(files);
+}
+
+// generated test vectors have no expected output, the batch api is checked
+// against the single operations
+TEST(KeySwitch, generated_3_4_4_2) {
+    std::vector<hetest::utils::KeySwitchVector> test_vectors;
+    for (uint64_t i = 0; i < 4; i++) {
+        test_vectors.emplace_back(n_size, 3, 4, 50, i);
+    }
+    hetest::utils::KeySwitchVector& tv = test_vectors[0];
+
+    std::vector<std::vector<uint64_t>> expected;
+    std::vector<uint64_t*> results;
+    std::vector<const uint64_t*> t_target_iter_ptrs;
+    for (auto& v : test_vectors) {
+        expected.push_back(v.input);
+        t_target_iter_ptrs.push_back(v.t_target_iter_ptr.data());
+    }
+    for (auto& v : test_vectors) {
+        results.push_back(v.input.data());
+    }
+
+    intel::hexl::set_worksize_KeySwitch(test_vectors.size());
+    for (size_t i = 0; i < test_vectors.size(); i++) {
+        intel::hexl::KeySwitch(
+            expected[i].data(), t_target_iter_ptrs[i], tv.coeff_count,
+            tv.decomp_modulus_size, tv.key_modulus_size, tv.rns_modulus_size,
+            tv.key_component_count, tv.moduli.data(), tv.key_vectors.data(),
+            tv.modswitch_factors.data(), tv.twiddle_factors.data());
+    }
+    intel::hexl::KeySwitchCompleted();
+
+    intel::hexl::KeySwitchBatch(
+        results.data(), t_target_iter_ptrs.data(), test_vectors.size(),
+        tv.coeff_count, tv.decomp_modulus_size, tv.key_modulus_size,
+        tv.rns_modulus_size, tv.key_component_count, tv.moduli.data(),
+        tv.key_vectors.data(), tv.modswitch_factors.data(),
+        tv.twiddle_factors.data());
+    for (size_t i = 0; i < test_vectors.size(); i++) {
+        ASSERT_EQ(test_vectors[i].input, expected[i]);
+    }
+}
+
+// generated test vectors, of MODULUS_BITS bit moduli, against the reference
+TEST(KeySwitch, generated_reference_6_7_7_2) {
+    std::vector<hetest::utils::KeySwitchVector> test_vectors;
+    for (uint64_t i = 0; i < 3; i++) {
+        test_vectors.emplace_back(n_size, 6, 7, modulus_bits, i);
+    }
+    hetest::utils::KeySwitchVector& tv = test_vectors[0];
+
+    std::vector<std::vector<uint64_t>> expected;
+    for (auto& v : test_vectors) {
+        expected.push_back(v.input);
+        hetest::utils::ReferenceKeySwitch(
+            expected.back().data(), v.t_target_iter_ptr.data(), tv.coeff_count,
+            tv.decomp_modulus_size, tv.key_modulus_size, 1,
+            tv.key_modulus_size - 1, tv.key_component_count, tv.moduli.data(),
+            tv.key_vectors.data());
+    }
+
+    intel::hexl::set_worksize_KeySwitch(test_vectors.size());
+    for (auto& v : test_vectors) {
+        intel::hexl::KeySwitch(
+            v.input.data(), v.t_target_iter_ptr.data(), tv.coeff_count,
+            tv.decomp_modulus_size, tv.key_modulus_size, tv.rns_modulus_size,
+            tv.key_component_count, tv.moduli.data(), tv.key_vectors.data(),
+            tv.modswitch_factors.data(), tv.twiddle_factors.data());
+    }
+    intel::hexl::KeySwitchCompleted();
+    for (size_t i = 0; i < test_vectors.size(); i++) {
+        ASSERT_EQ(test_vectors[i].input, expected[i]);
+    }
+}
+
+// a generated test vector written as a binary file reads back the same, and
+// a file whose arrays do not match its shape is rejected
+TEST(KeySwitch, binary_round_trip_3_4_4_2) {
+    hetest::utils::KeySwitchVector tv(n_size, 3, 4);
+    std::string filename =
+        ::testing::TempDir() + "keyswitch_round_trip_3_4_4_2.bin";
+    hetest::utils::WriteKeySwitchTestVector(filename.c_str(), tv);
+
+    {
+        KeySwitchTestVector bin(filename.c_str());
+        ASSERT_EQ(bin.coeff_count, tv.coeff_count);
+        ASSERT_EQ(bin.decomp_modulus_size, tv.decomp_modulus_size);
+        ASSERT_EQ(bin.key_modulus_size, tv.key_modulus_size);
+        ASSERT_EQ(bin.rns_modulus_size, tv.rns_modulus_size);
+        ASSERT_EQ(bin.key_component_count, tv.key_component_count);
+        ASSERT_EQ(bin.moduli, tv.moduli);
+        ASSERT_EQ(bin.modswitch_factors, tv.modswitch_factors);
+        ASSERT_EQ(bin.twiddle_factors, tv.twiddle_factors);
+        ASSERT_EQ(bin.t_target_iter_ptr, tv.t_target_iter_ptr);
+        ASSERT_EQ(bin.input, tv.input);
+        ASSERT_TRUE(bin.expected_output.empty());
+        ASSERT_EQ(bin.key_vectors.size(), tv.key_vectors.size());
+        uint64_t key_size =
+            tv.key_component_count * tv.key_modulus_size * tv.coeff_count;
+        for (size_t k = 0; k < tv.key_vectors.size(); k++) {
+            ASSERT_EQ(std::vector<uint64_t>(bin.key_vectors[k],
+                                            bin.key_vectors[k] + key_size),
+                      tv.vectors[k]);
+        }
+    }
+
+    // one modulus less than the header says
+    {
+        std::fstream file(filename,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        hetest::utils::KeySwitchTestVectorHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        header.arrays[hetest::utils::KEYSWITCH_MODULI].count--;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    ASSERT_THROW(KeySwitchTestVector(filename.c_str()), std::runtime_error);
+    std::remove(filename.c_str());
+}
+
+// reference automorphism X -> X^galois_elt of a polynomial in NTT form,
+// applied to its coefficients: X^i maps to X^(i * galois_elt mod 2n), and
+// X^n = -1.
+static std::vector<uint64_t> galois_ntt(const uint64_t* input, uint64_t n,
+                                        const uint64_t* moduli,
+                                        uint64_t num_moduli,
+                                        uint64_t galois_elt) {
+    std::vector<uint64_t> output(num_moduli * n);
+    std::vector<uint64_t> coeffs(n);
+    for (uint64_t k = 0; k < num_moduli; k++) {
+        uint64_t q = moduli[k];
+        hetest::utils::NTT ntt(n, q);
+        ntt.ComputeInverse(coeffs.data(), input + k * n, 1, 1);
+        uint64_t* poly = output.data() + k * n;
+        for (uint64_t i = 0; i < n; i++) {
+            uint64_t j = (i * galois_elt) % (2 * n);
+            if (j < n) {
+                poly[j] = coeffs[i];
+            } else {
+                poly[j - n] = (coeffs[i] == 0) ? 0 : q - coeffs[i];
+            }
+        }
+        ntt.ComputeForward(poly, poly, 1, 1);
+    }
+    return output;
+}
+
+void test_Rotate(const std::vector<std::string>& files, uint64_t galois_elt) {
+    std::vector<KeySwitchTestVector> test_vectors;
+    for (size_t i = 0; i < files.size(); i++) {
+        std::cout << "Constructing Test Vector " << i << " from File ... "
+                  << files[i] << std::endl;
+        test_vectors.push_back(KeySwitchTestVector(files[i].c_str()));
+    }
+
+    size_t test_vector_size = test_vectors.size();
+    assert(test_vector_size > 0);
+    uint64_t n = test_vectors[0].coeff_count;
+    uint64_t size = test_vectors[0].decomp_modulus_size * n;
+
+    // the ciphertexts are (c0, c1) = (input c0, t_target)
+    std::vector<std::vector<uint64_t>> ciphertexts(test_vector_size);
+    std::vector<std::vector<uint64_t>> rotated(test_vector_size);
+    std::vector<std::vector<uint64_t>> expected(test_vector_size);
+    std::vector<uint64_t*> results;
+    std::vector<const uint64_t*> ciphertext_ptrs;
+    for (size_t i = 0; i < test_vector_size; i++) {
+        const KeySwitchTestVector& tv = test_vectors[i];
+        ciphertexts[i].assign(tv.input.begin(), tv.input.begin() + size);
+        ciphertexts[i].insert(ciphertexts[i].end(),
+                              tv.t_target_iter_ptr.begin(),
+                              tv.t_target_iter_ptr.end());
+        rotated[i].resize(2 * size);
+        results.push_back(rotated[i].data());
+        ciphertext_ptrs.push_back(ciphertexts[i].data());
+
+        expected[i] = galois_ntt(ciphertexts[i].data(), n, tv.moduli.data(),
+                                 tv.decomp_modulus_size, galois_elt);
+        expected[i].resize(2 * size, 0);
+    }
+
+    std::vector<uint64_t*> expected_ptrs;
+    std::vector<std::vector<uint64_t>> t_targets;
+    std::vector<const uint64_t*> t_target_ptrs;
+    for (size_t i = 0; i < test_vector_size; i++) {
+        expected_ptrs.push_back(expected[i].data());
+        t_targets.push_back(galois_ntt(ciphertexts[i].data() + size, n,
+                                       test_vectors[i].moduli.data(),
+                                       test_vectors[i].decomp_modulus_size,
+                                       galois_elt));
+    }
+    for (size_t i = 0; i < test_vector_size; i++) {
+        t_target_ptrs.push_back(t_targets[i].data());
+    }
+
+    intel::hexl::KeySwitchBatch(
+        expected_ptrs.data(), t_target_ptrs.data(), test_vector_size, n,
+        test_vectors[0].decomp_modulus_size, test_vectors[0].key_modulus_size,
+        test_vectors[0].rns_modulus_size, test_vectors[0].key_component_count,
+        test_vectors[0].moduli.data(), test_vectors[0].key_vectors.data(),
+        test_vectors[0].modswitch_factors.data(),
+        test_vectors[0].twiddle_factors.data());
+
+    intel::hexl::Rotate(
+        results.data(), ciphertext_ptrs.data(), test_vector_size, galois_elt,
+        n, test_vectors[0].decomp_modulus_size,
+        test_vectors[0].key_modulus_size, test_vectors[0].rns_modulus_size,
+        test_vectors[0].key_component_count, test_vectors[0].moduli.data(),
+        test_vectors[0].key_vectors.data(),
+        test_vectors[0].modswitch_factors.data(),
+        test_vectors[0].twiddle_factors.data());
+    for (size_t i = 0; i < test_vector_size; i++) {
+        ASSERT_EQ(rotated[i], expected[i]);
+    }
+}
+
+TEST(KeySwitch, rotate_6_7_7_2) {
+    const char* fname = getenv("KEYSWITCH_DATA_DIR");
+    if (!fname) {
+        std::cerr << "set env KEYSWITCH_DATA_DIR to the test vector dir"
+                  << std::endl;
+        exit(1);
+    }
+
+    std::string test_file = "/" + std::to_string(n_size) + "_6_7_7_2_*";
+    std::string test_fullname = fname + test_file;
+    std::vector<std::string> files =
+        hetest::utils::GlobTestVectors(test_fullname);
+
+    // galois element 3 rotates the rows by one step
+    test_Rotate(files, 3);
+}
+
+// every step has a Galois key of its own, generated with its own seed, so
+// that the steps go to the device as separate batches.
+TEST(KeySwitch, rotate_steps_6_7_7_2) {
+    std::vector<uint64_t> galois_elts = {3, 5, 2 * n_size - 1};
+    uint64_t steps = galois_elts.size();
+    std::vector<hetest::utils::KeySwitchVector> test_vectors;
+    for (uint64_t s = 0; s < steps; s++) {
+        test_vectors.emplace_back(n_size, 6, 7, 50, s);
+    }
+    hetest::utils::KeySwitchVector& tv = test_vectors[0];
+
+    uint64_t n = tv.coeff_count;
+    uint64_t size = tv.decomp_modulus_size * n;
+    std::vector<uint64_t> ciphertext(tv.input.begin(),
+                                     tv.input.begin() + size);
+    ciphertext.insert(ciphertext.end(), tv.t_target_iter_ptr.begin(),
+                      tv.t_target_iter_ptr.end());
+
+    std::vector<std::vector<uint64_t>> rotated(
+        steps, std::vector<uint64_t>(2 * size));
+    std::vector<std::vector<uint64_t>> expected(
+        steps, std::vector<uint64_t>(2 * size));
+    std::vector<uint64_t*> results;
+    std::vector<const uint64_t**> keys;
+    for (uint64_t s = 0; s < steps; s++) {
+        results.push_back(rotated[s].data());
+        keys.push_back(test_vectors[s].key_vectors.data());
+    }
+
+    intel::hexl::RotateSteps(
+        results.data(), ciphertext.data(), steps, galois_elts.data(), n,
+        tv.decomp_modulus_size, tv.key_modulus_size, tv.rns_modulus_size,
+        tv.key_component_count, tv.moduli.data(), keys.data(),
+        tv.modswitch_factors.data(), tv.twiddle_factors.data());
+
+    // the steps share the decomposition of c1, so each is the hoisted
+    // keyswitch of its rotation rather than the one Rotate computes.
+    for (uint64_t s = 0; s < steps; s++) {
+        std::vector<uint64_t> c0 =
+            galois_ntt(ciphertext.data(), n, tv.moduli.data(),
+                       tv.decomp_modulus_size, galois_elts[s]);
+        std::copy(c0.begin(), c0.end(), expected[s].begin());
+        hetest::utils::ReferenceKeySwitch(
+            expected[s].data(), ciphertext.data() + size, n,
+            tv.decomp_modulus_size, tv.key_modulus_size, 1,
+            tv.key_modulus_size - 1, tv.key_component_count, tv.moduli.data(),
+            keys[s], galois_elts[s]);
+        ASSERT_EQ(rotated[s], expected[s]);
+    }
+}
@@ -0,0 +1,173 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "hexl-fpga.h"
+#include "test_utils/keyswitch_reference.hpp"
+#include "test_utils/keyswitch_test_vector.hpp"
+#include "test_utils/test_vectors.hpp"
+
+using hetest::utils::KeySwitchTestVector;
+using hetest::utils::KeySwitchVector;
+
+// with one digit per modulus and a single special modulus, the hybrid
+// keyswitch is the per-limb keyswitch of the test vectors.
+TEST(KeySwitchTiled, hybrid_per_limb_16384_6_7_7_2) {
+    const char* fname = getenv("KEYSWITCH_DATA_DIR");
+    if (!fname) {
+        std::cerr << "set env KEYSWITCH_DATA_DIR to the test vector dir"
+                  << std::endl;
+        exit(1);
+    }
+
+    std::string test_fullname = std::string(fname) + "/16384_6_7_7_2_*";
+    std::vector<std::string> files =
+        hetest::utils::GlobTestVectors(test_fullname);
+    ASSERT_GT(files.size(), 0u);
+
+    std::vector<KeySwitchTestVector> test_vectors;
+    std::vector<uint64_t*> results;
+    std::vector<const uint64_t*> t_target_iter_ptrs;
+    for (size_t i = 0; i < files.size(); i++) {
+        test_vectors.push_back(KeySwitchTestVector(files[i].c_str()));
+    }
+    for (auto& tv : test_vectors) {
+        results.push_back(tv.input.data());
+        t_target_iter_ptrs.push_back(tv.t_target_iter_ptr.data());
+    }
+
+    KeySwitchTestVector& tv = test_vectors[0];
+    intel::hexl::KeySwitchHybrid(
+        results.data(), t_target_iter_ptrs.data(), test_vectors.size(),
+        tv.coeff_count, tv.decomp_modulus_size, tv.key_modulus_size, 1,
+        tv.key_modulus_size - 1, tv.key_component_count, tv.moduli.data(),
+        tv.key_vectors.data());
+    for (auto& t : test_vectors) {
+        ASSERT_EQ(t.input, t.expected_output);
+    }
+}
+
+// more than 7 key moduli, the chains KeySwitch and KeySwitchBatch tile over
+// the kernels of the bitstream.
+TEST(KeySwitchTiled, generated_16384_8_9_2) {
+    std::vector<KeySwitchVector> test_vectors;
+    for (uint64_t i = 0; i < 3; i++) {
+        test_vectors.emplace_back(16384, 8, 9, 50, i);
+    }
+    KeySwitchVector& tv = test_vectors[0];
+
+    std::vector<std::vector<uint64_t>> expected;
+    std::vector<uint64_t*> results;
+    std::vector<const uint64_t*> t_target_iter_ptrs;
+    // the batch shares the keys of the first test vector
+    for (auto& v : test_vectors) {
+        expected.push_back(v.input);
+        hetest::utils::ReferenceKeySwitch(
+            expected.back().data(), v.t_target_iter_ptr.data(), tv.coeff_count,
+            tv.decomp_modulus_size, tv.key_modulus_size, 1,
+            tv.key_modulus_size - 1, tv.key_component_count, tv.moduli.data(),
+            tv.key_vectors.data());
+        t_target_iter_ptrs.push_back(v.t_target_iter_ptr.data());
+    }
+    for (auto& v : test_vectors) {
+        results.push_back(v.input.data());
+    }
+
+    intel::hexl::KeySwitch(results[0], t_target_iter_ptrs[0], tv.coeff_count,
+                           tv.decomp_modulus_size, tv.key_modulus_size,
+                           tv.rns_modulus_size, tv.key_component_count,
+                           tv.moduli.data(), tv.key_vectors.data(),
+                           tv.modswitch_factors.data());
+    ASSERT_EQ(test_vectors[0].input, expected[0]);
+
+    intel::hexl::KeySwitchBatch(
+        results.data() + 1, t_target_iter_ptrs.data() + 1,
+        test_vectors.size() - 1, tv.coeff_count, tv.decomp_modulus_size,
+        tv.key_modulus_size, tv.rns_modulus_size, tv.key_component_count,
+        tv.moduli.data(), tv.key_vectors.data(), tv.modswitch_factors.data());
+    for (size_t i = 1; i < test_vectors.size(); i++) {
+        ASSERT_EQ(test_vectors[i].input, expected[i]);
+    }
+}
+
+// KeySwitchHybrid of generated test vectors against the reference, the
+// batch sharing the keys of the first test vector.
+static void test_KeySwitchHybrid(uint64_t decomp_modulus_size,
+                                 uint64_t key_modulus_size,
+                                 uint64_t special_modulus_size, uint64_t dnum) {
+    std::vector<KeySwitchVector> test_vectors;
+    for (uint64_t i = 0; i < 2; i++) {
+        test_vectors.emplace_back(16384, decomp_modulus_size, key_modulus_size,
+                                  50, i);
+    }
+    KeySwitchVector& tv = test_vectors[0];
+
+    std::vector<std::vector<uint64_t>> expected;
+    std::vector<uint64_t*> results;
+    std::vector<const uint64_t*> t_target_iter_ptrs;
+    for (auto& v : test_vectors) {
+        expected.push_back(v.input);
+        hetest::utils::ReferenceKeySwitch(
+            expected.back().data(), v.t_target_iter_ptr.data(), tv.coeff_count,
+            decomp_modulus_size, key_modulus_size, special_modulus_size, dnum,
+            tv.key_component_count, tv.moduli.data(), tv.key_vectors.data());
+        t_target_iter_ptrs.push_back(v.t_target_iter_ptr.data());
+    }
+    for (auto& v : test_vectors) {
+        results.push_back(v.input.data());
+    }
+
+    intel::hexl::KeySwitchHybrid(
+        results.data(), t_target_iter_ptrs.data(), test_vectors.size(),
+        tv.coeff_count, decomp_modulus_size, key_modulus_size,
+        special_modulus_size, dnum, tv.key_component_count, tv.moduli.data(),
+        tv.key_vectors.data());
+    for (size_t i = 0; i < test_vectors.size(); i++) {
+        ASSERT_EQ(test_vectors[i].input, expected[i]);
+    }
+}
+
+// digits of 3, 3 and 2 moduli, the base conversion of several moduli, over
+// two tiles of output limbs.
+TEST(KeySwitchTiled, hybrid_generated_16384_8_9_1_3) {
+    test_KeySwitchHybrid(8, 9, 1, 3);
+}
+
+// two special moduli, the rounding by (P - 1) / 2 of a product P, over
+// two tiles of output limbs.
+TEST(KeySwitchTiled, hybrid_generated_16384_8_10_2_4) {
+    test_KeySwitchHybrid(8, 10, 2, 4);
+}
+
+// a single digit and three special moduli within one tile.
+TEST(KeySwitchTiled, hybrid_generated_16384_3_6_3_1) {
+    test_KeySwitchHybrid(3, 6, 3, 1);
+}
+
+// two chain lengths sharing the keys: the first tiles of both hold 7 limbs
+// starting at key modulus 0, but different key moduli.
+TEST(KeySwitchTiled, hybrid_shared_keys_16384_7_6_12_2_2) {
+    KeySwitchVector tv(16384, 7, 12, 50, 0);
+    for (uint64_t decomp_modulus_size : {7, 6}) {
+        uint64_t size = tv.key_component_count * decomp_modulus_size *
+                        tv.coeff_count;
+        std::vector<uint64_t> result(size, 0);
+        std::vector<uint64_t> expected(size, 0);
+        hetest::utils::ReferenceKeySwitch(
+            expected.data(), tv.t_target_iter_ptr.data(), tv.coeff_count,
+            decomp_modulus_size, tv.key_modulus_size, 2, 2,
+            tv.key_component_count, tv.moduli.data(), tv.key_vectors.data());
+
+        uint64_t* results[] = {result.data()};
+        const uint64_t* t_target_iter_ptrs[] = {tv.t_target_iter_ptr.data()};
+        intel::hexl::KeySwitchHybrid(
+            results, t_target_iter_ptrs, 1, tv.coeff_count,
+            decomp_modulus_size, tv.key_modulus_size, 2, 2,
+            tv.key_component_count, tv.moduli.data(), tv.key_vectors.data());
+        ASSERT_EQ(result, expected);
+    }
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2020-2021 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "hexl-fpga.h"
+#include "test_utils/ntt.hpp"
+
+static const uint64_t ntt_degree = 16384;
+
+// reference CKKS rescale of ciphertexts in NTT form
+static void reference_rescale(std::vector<uint64_t>* result,
+                              const std::vector<uint64_t>& operand,
+                              uint64_t num_components,
+                              const std::vector<uint64_t>& moduli) {
+    uint64_t n = ntt_degree;
+    uint64_t num_moduli = moduli.size();
+    uint64_t last = num_moduli - 1;
+    uint64_t q_last = moduli[last];
+    uint64_t half = q_last >> 1;
+    hetest::utils::NTT::NTTImpl ntt_last(n, q_last);
+
+    result->resize(num_components * last * n);
+    std::vector<uint64_t> c_last(n);
+    std::vector<uint64_t> t(n);
+    for (uint64_t k = 0; k < num_components; k++) {
+        const uint64_t* c = operand.data() + k * num_moduli * n;
+        ntt_last.ComputeInverse(c_last.data(), c + last * n, 1, 1);
+        for (uint64_t i = 0; i < last; i++) {
+            uint64_t qi = moduli[i];
+            hetest::utils::NTT::NTTImpl ntt(n, qi);
+            for (uint64_t j = 0; j < n; j++) {
+                uint64_t x = (c_last[j] + half) % q_last;
+                t[j] = (x % qi + qi - half % qi) % qi;
+            }
+            ntt.ComputeForward(t.data(), t.data(), 1, 1);
+            uint64_t inv = hetest::utils::InverseUIntMod(q_last % qi, qi);
+            for (uint64_t j = 0; j < n; j++) {
+                uint64_t d = (c[i * n + j] + qi - t[j]) % qi;
+                (*result)[(k * last + i) * n + j] =
+                    hetest::utils::MultiplyUIntMod(d, inv, qi);
+            }
+        }
+    }
+}
+
+static void run_rescale_test(uint64_t count, uint64_t num_components,
+                             uint64_t num_moduli, uint64_t bits) {
+    std::vector<uint64_t> moduli =
+        hetest::utils::GeneratePrimes(num_moduli, bits, ntt_degree);
+    uint64_t n = ntt_degree;
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::vector<std::vector<uint64_t>> operands(count);
+    std::vector<std::vector<uint64_t>> results(count);
+    std::vector<std::vector<uint64_t>> expected(count);
+    std::vector<const uint64_t*> operand_ptrs;
+    std::vector<uint64_t*> result_ptrs;
+    for (uint64_t c = 0; c < count; c++) {
+        operands[c].resize(num_components * num_moduli * n);
+        for (uint64_t k = 0; k < num_components; k++) {
+            for (uint64_t i = 0; i < num_moduli; i++) {
+                std::uniform_int_distribution<uint64_t> distrib(0,
+                                                                moduli[i] - 1);
+                for (uint64_t j = 0; j < n; j++) {
+                    operands[c][(k * num_moduli + i) * n + j] = distrib(gen);
+                }
+            }
+        }
+        results[c].resize(num_components * (num_moduli - 1) * n);
+        reference_rescale(&expected[c], operands[c], num_components, moduli);
+        operand_ptrs.push_back(operands[c].data());
+        result_ptrs.push_back(results[c].data());
+    }
+
+    intel::hexl::Rescale(result_ptrs.data(), operand_ptrs.data(), count, n,
+                         num_components, num_moduli, moduli.data());
+
+    for (uint64_t c = 0; c < count; c++) {
+        ASSERT_EQ(results[c], expected[c]);
+    }
+}
+
+TEST(Rescale, p16384_c2_m4_b1) { run_rescale_test(1, 2, 4, 50); }
+
+TEST(Rescale, p16384_c2_m7_b8) { run_rescale_test(8, 2, 7, 50); }
+
+TEST(Rescale, p16384_c3_m2_b3) { run_rescale_test(3, 3, 2, 40); }
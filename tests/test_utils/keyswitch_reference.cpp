@@ -0,0 +1,239 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "keyswitch_reference.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "ntt.hpp"
+
+namespace hetest {
+namespace utils {
+
+namespace {
+
+// unsigned integer of any size, in 64-bit words from the least significant
+class BigUInt {
+public:
+    explicit BigUInt(uint64_t value = 0) : words_(1, value) {}
+
+    BigUInt& operator*=(uint64_t x) {
+        uint64_t carry = 0;
+        for (auto& word : words_) {
+            uint128_t product = static_cast<uint128_t>(word) * x + carry;
+            word = static_cast<uint64_t>(product);
+            carry = static_cast<uint64_t>(product >> 64);
+        }
+        if (carry) {
+            words_.push_back(carry);
+        }
+        return *this;
+    }
+
+    BigUInt& operator+=(const BigUInt& x) {
+        if (words_.size() < x.words_.size()) {
+            words_.resize(x.words_.size(), 0);
+        }
+        uint64_t carry = 0;
+        for (size_t i = 0; i < words_.size(); i++) {
+            uint128_t sum = static_cast<uint128_t>(words_[i]) + carry;
+            if (i < x.words_.size()) {
+                sum += x.words_[i];
+            }
+            words_[i] = static_cast<uint64_t>(sum);
+            carry = static_cast<uint64_t>(sum >> 64);
+        }
+        if (carry) {
+            words_.push_back(carry);
+        }
+        return *this;
+    }
+
+    // floor(*this / 2)
+    BigUInt half() const {
+        BigUInt r(*this);
+        for (size_t i = 0; i < r.words_.size(); i++) {
+            r.words_[i] >>= 1;
+            if (i + 1 < r.words_.size()) {
+                r.words_[i] |= r.words_[i + 1] << 63;
+            }
+        }
+        return r;
+    }
+
+    uint64_t operator%(uint64_t modulus) const {
+        uint128_t r = 0;
+        for (size_t i = words_.size(); i-- > 0;) {
+            r = ((r << 64) | words_[i]) % modulus;
+        }
+        return static_cast<uint64_t>(r);
+    }
+
+private:
+    std::vector<uint64_t> words_;
+};
+
+// prod_{begin <= j < end, j != skip} moduli[j]
+BigUInt Product(const uint64_t* moduli, uint64_t begin, uint64_t end,
+                uint64_t skip) {
+    BigUInt product(1);
+    for (uint64_t j = begin; j < end; j++) {
+        if (j != skip) {
+            product *= moduli[j];
+        }
+    }
+    return product;
+}
+
+// lifts the residues x_j modulo q_j, j in [begin, end), to the integer
+// sum_j [x_j * (Q / q_j)^-1]_q_j * (Q / q_j), Q = prod_j q_j
+class Lift {
+public:
+    Lift(const uint64_t* moduli, uint64_t begin, uint64_t end)
+        : moduli_(moduli + begin, moduli + end) {
+        for (uint64_t j = begin; j < end; j++) {
+            q_hat_.push_back(Product(moduli, begin, end, j));
+            q_hat_inv_.push_back(
+                InverseUIntMod(q_hat_.back() % moduli[j], moduli[j]));
+        }
+    }
+
+    BigUInt operator()(const std::vector<uint64_t>& x) const {
+        BigUInt sum;
+        for (size_t j = 0; j < moduli_.size(); j++) {
+            BigUInt term(q_hat_[j]);
+            term *= MultiplyUIntMod(x[j], q_hat_inv_[j], moduli_[j]);
+            sum += term;
+        }
+        return sum;
+    }
+
+private:
+    std::vector<uint64_t> moduli_;
+    std::vector<BigUInt> q_hat_;
+    std::vector<uint64_t> q_hat_inv_;
+};
+
+}  // namespace
+
+void ReferenceKeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr,
+                        uint64_t n, uint64_t decomp_modulus_size,
+                        uint64_t key_modulus_size,
+                        uint64_t special_modulus_size, uint64_t dnum,
+                        uint64_t key_component_count, const uint64_t* moduli,
+                        const uint64_t* const* k_switch_keys,
+                        uint64_t galois_elt) {
+    uint64_t special_begin = key_modulus_size - special_modulus_size;
+    uint64_t alpha = (special_begin + dnum - 1) / dnum;
+    uint64_t digits = (decomp_modulus_size + alpha - 1) / alpha;
+    uint64_t rns_size = decomp_modulus_size + special_modulus_size;
+
+    // the ciphertext moduli, then the special moduli
+    std::vector<uint64_t> key_indices;
+    for (uint64_t i = 0; i < rns_size; i++) {
+        key_indices.push_back((i < decomp_modulus_size)
+                                  ? i
+                                  : special_begin + i - decomp_modulus_size);
+    }
+    std::vector<NTT> ntts;
+    for (auto k : key_indices) {
+        ntts.emplace_back(n, moduli[k]);
+    }
+
+    std::vector<uint64_t> a(decomp_modulus_size * n);
+    for (uint64_t j = 0; j < decomp_modulus_size; j++) {
+        ntts[j].ComputeInverse(&a[j * n], t_target_iter_ptr + j * n, 1, 1);
+    }
+
+    // the products with the keys summed over the digits, in NTT form
+    std::vector<uint64_t> prod(key_component_count * rns_size * n, 0);
+    std::vector<uint64_t> raised(rns_size * n);
+    std::vector<uint64_t> rotated(n);
+    for (uint64_t d = 0; d < digits; d++) {
+        uint64_t begin = d * alpha;
+        uint64_t end = std::min(begin + alpha, decomp_modulus_size);
+        Lift lift(moduli, begin, end);
+        std::vector<uint64_t> x(end - begin);
+        for (uint64_t l = 0; l < n; l++) {
+            for (uint64_t j = begin; j < end; j++) {
+                x[j - begin] = a[j * n + l];
+            }
+            BigUInt value = lift(x);
+            for (uint64_t i = 0; i < rns_size; i++) {
+                raised[i * n + l] = value % moduli[key_indices[i]];
+            }
+        }
+        // X^l -> X^(l * g mod 2n), X^n = -1
+        for (uint64_t i = 0; galois_elt && (i < rns_size); i++) {
+            uint64_t q = moduli[key_indices[i]];
+            for (uint64_t l = 0; l < n; l++) {
+                uint64_t index = (l * galois_elt) % (2 * n);
+                uint64_t value = raised[i * n + l];
+                rotated[index % n] =
+                    (index < n) ? value : SubUIntMod(0, value, q);
+            }
+            std::copy(rotated.begin(), rotated.end(), &raised[i * n]);
+        }
+        for (uint64_t i = 0; i < rns_size; i++) {
+            ntts[i].ComputeForward(&raised[i * n], &raised[i * n], 1, 1);
+        }
+        for (uint64_t k = 0; k < key_component_count; k++) {
+            for (uint64_t i = 0; i < rns_size; i++) {
+                uint64_t q = moduli[key_indices[i]];
+                const uint64_t* key =
+                    k_switch_keys[d] +
+                    (k * key_modulus_size + key_indices[i]) * n;
+                uint64_t* p = &prod[(k * rns_size + i) * n];
+                for (uint64_t l = 0; l < n; l++) {
+                    p[l] = AddUIntMod(
+                        p[l], MultiplyUIntMod(raised[i * n + l], key[l], q),
+                        q);
+                }
+            }
+        }
+    }
+
+    // (P - 1) / 2, P being odd
+    BigUInt p = Product(moduli, special_begin, key_modulus_size,
+                        key_modulus_size);
+    BigUInt half_p = p.half();
+    Lift lift_p(moduli, special_begin, key_modulus_size);
+
+    std::vector<uint64_t> v(special_modulus_size * n);
+    std::vector<uint64_t> t(decomp_modulus_size * n);
+    std::vector<uint64_t> x(special_modulus_size);
+    for (uint64_t k = 0; k < key_component_count; k++) {
+        for (uint64_t s = 0; s < special_modulus_size; s++) {
+            uint64_t i = decomp_modulus_size + s;
+            ntts[i].ComputeInverse(&v[s * n], &prod[(k * rns_size + i) * n],
+                                   1, 1);
+        }
+        for (uint64_t l = 0; l < n; l++) {
+            for (uint64_t s = 0; s < special_modulus_size; s++) {
+                uint64_t ps = moduli[special_begin + s];
+                x[s] = AddUIntMod(v[s * n + l], half_p % ps, ps);
+            }
+            BigUInt rounded = lift_p(x);
+            for (uint64_t i = 0; i < decomp_modulus_size; i++) {
+                t[i * n + l] =
+                    SubUIntMod(rounded % moduli[i], half_p % moduli[i],
+                               moduli[i]);
+            }
+        }
+        for (uint64_t i = 0; i < decomp_modulus_size; i++) {
+            uint64_t q = moduli[i];
+            uint64_t p_inv = InverseUIntMod(p % q, q);
+            ntts[i].ComputeForward(&t[i * n], &t[i * n], 1, 1);
+            const uint64_t* c = &prod[(k * rns_size + i) * n];
+            uint64_t* r = result + (k * decomp_modulus_size + i) * n;
+            for (uint64_t l = 0; l < n; l++) {
+                uint64_t diff = SubUIntMod(c[l], t[i * n + l], q);
+                r[l] = AddUIntMod(r[l], MultiplyUIntMod(diff, p_inv, q), q);
+            }
+        }
+    }
+}
+
+}  // namespace utils
+}  // namespace hetest
@@ -0,0 +1,38 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+
+namespace hetest {
+namespace utils {
+
+// Hybrid keyswitch computed coefficient by coefficient with big integers,
+// as the reference of KeySwitch and KeySwitchHybrid.
+// The decomp_modulus_size limbs of t_target_iter_ptr are split into digits
+// of alpha = ceil((key_modulus_size - special_modulus_size) / dnum) limbs.
+// The digit of the limbs [b, e) is lifted to the integer
+// sum_j [a_j * (Q / q_j)^-1]_q_j * (Q / q_j), Q = prod_{b <= j < e} q_j,
+// which is the lift of the fast base conversion, and reduced by every
+// ciphertext and special modulus. The products with the keys are summed
+// over the digits. The special part is then divided out with rounding: its
+// residues plus (P - 1) / 2, P the product of the special moduli, are
+// lifted the same way, and (P - 1) / 2 is subtracted again.
+// The lifts, the products of the moduli and (P - 1) / 2 are computed exactly,
+// so that none of the RNS shortcuts of the library is reused.
+// t_target_iter_ptr, the keys and result are in NTT form, and the
+// keyswitched ciphertext is added to result like KeySwitch does.
+// A nonzero galois_elt g applies the automorphism X -> X^g to the lifted
+// digits before their products with the keys, the hoisted keyswitch of the
+// rotation of t_target_iter_ptr that RotateSteps computes.
+void ReferenceKeySwitch(uint64_t* result, const uint64_t* t_target_iter_ptr,
+                        uint64_t n, uint64_t decomp_modulus_size,
+                        uint64_t key_modulus_size,
+                        uint64_t special_modulus_size, uint64_t dnum,
+                        uint64_t key_component_count, const uint64_t* moduli,
+                        const uint64_t* const* k_switch_keys,
+                        uint64_t galois_elt = 0);
+
+}  // namespace utils
+}  // namespace hetest
@@ -0,0 +1,269 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "keyswitch_test_vector.hpp"
+
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+#include "test_vectors.hpp"
+
+namespace hetest {
+namespace utils {
+
+namespace {
+
+const char kMagic[8] = {'H', 'E', 'X', 'L', 'K', 'S', 'T', 'V'};
+const uint64_t kVersion = 1;
+const uint64_t kAlignment = 64;
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return (s.size() >= suffix.size()) &&
+           (s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+std::vector<std::string> glob_files(const std::string& pattern) {
+    glob_t glob_result = {0};
+
+    ::glob(pattern.c_str(), GLOB_TILDE, NULL, &glob_result);
+
+    std::vector<std::string> filenames(
+        glob_result.gl_pathv, glob_result.gl_pathv + glob_result.gl_pathc);
+
+    globfree(&glob_result);
+
+    return filenames;
+}
+
+// writes the KeySwitchTestVector, or KeySwitchVector, tv with the given
+// expected output
+template <typename TestVector>
+void write_test_vector(const char* filename, const TestVector& tv,
+                       const std::vector<uint64_t>& expected_output) {
+    uint64_t key_size =
+        tv.key_component_count * tv.key_modulus_size * tv.coeff_count;
+    std::vector<uint64_t> keys;
+    for (auto key_vector : tv.key_vectors) {
+        keys.insert(keys.end(), key_vector, key_vector + key_size);
+    }
+
+    const std::vector<uint64_t>* arrays[KEYSWITCH_NUM_ARRAYS] = {};
+    arrays[KEYSWITCH_MODULI] = &tv.moduli;
+    arrays[KEYSWITCH_MODSWITCH_FACTORS] = &tv.modswitch_factors;
+    arrays[KEYSWITCH_TWIDDLE_FACTORS] = &tv.twiddle_factors;
+    arrays[KEYSWITCH_KEY_VECTOR] = &keys;
+    arrays[KEYSWITCH_T_TARGET_ITER_PTR] = &tv.t_target_iter_ptr;
+    arrays[KEYSWITCH_INPUT] = &tv.input;
+    arrays[KEYSWITCH_EXPECTED_OUTPUT] = &expected_output;
+
+    KeySwitchTestVectorHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.coeff_count = tv.coeff_count;
+    header.decomp_modulus_size = tv.decomp_modulus_size;
+    header.key_modulus_size = tv.key_modulus_size;
+    header.rns_modulus_size = tv.rns_modulus_size;
+    header.key_component_count = tv.key_component_count;
+    uint64_t offset = sizeof(header);
+    for (int a = 0; a < KEYSWITCH_NUM_ARRAYS; a++) {
+        header.arrays[a].offset = offset;
+        header.arrays[a].count = arrays[a]->size();
+        uint64_t bytes = arrays[a]->size() * sizeof(uint64_t);
+        offset += (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::string("cannot create ") + filename);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const char padding[kAlignment] = {};
+    for (int a = 0; a < KEYSWITCH_NUM_ARRAYS; a++) {
+        uint64_t bytes = arrays[a]->size() * sizeof(uint64_t);
+        file.write(reinterpret_cast<const char*>(arrays[a]->data()), bytes);
+        file.write(padding, (kAlignment - bytes % kAlignment) % kAlignment);
+    }
+    if (!file) {
+        throw std::runtime_error(std::string("cannot write ") + filename);
+    }
+}
+
+}  // namespace
+
+KeySwitchTestVector::KeySwitchTestVector(const char* filename) {
+    if (ends_with(filename, ".bin")) {
+        load_binary(filename);
+    } else {
+        load_json(filename);
+    }
+}
+
+void KeySwitchTestVector::load_json(const char* filename) {
+    std::ifstream json_file(filename);
+    if (!json_file) {
+        throw std::runtime_error(std::string("cannot open ") + filename);
+    }
+    nlohmann::json js;
+    json_file >> js;
+
+    coeff_count = js["coeff_count"].get<uint64_t>();
+    decomp_modulus_size = js["decomp_modulus_size"].get<uint64_t>();
+    key_modulus_size = js["key_modulus_size"].get<uint64_t>();
+    rns_modulus_size = js["rns_modulus_size"].get<uint64_t>();
+    key_component_count = js["key_component_count"].get<uint64_t>();
+
+    moduli = js["moduli"].get<std::vector<uint64_t>>();
+    modswitch_factors = js["modswitch_factors"].get<std::vector<uint64_t>>();
+
+    // the twiddle factors of each key modulus, in the order of the
+    // twiddle_factors argument of KeySwitch
+    const char* twiddles[] = {"inv_root_of_unity_powers",
+                              "precon64_inv_root_of_unity_powers",
+                              "root_of_unity_powers",
+                              "precon64_root_of_unity_powers"};
+    bool has_twiddles = true;
+    for (auto name : twiddles) {
+        has_twiddles &= js.contains(name);
+    }
+    if (has_twiddles) {
+        std::vector<std::vector<std::vector<uint64_t>>> powers;
+        for (auto name : twiddles) {
+            powers.push_back(
+                js[name].get<std::vector<std::vector<uint64_t>>>());
+        }
+        for (uint64_t k = 0; k < key_modulus_size; k++) {
+            for (auto& power : powers) {
+                twiddle_factors.insert(twiddle_factors.end(), power[k].begin(),
+                                       power[k].begin() + coeff_count);
+            }
+        }
+    }
+
+    vectors = js["key_vector"].get<std::vector<std::vector<uint64_t>>>();
+    vectors.resize(decomp_modulus_size);
+    for (auto& key_vector : vectors) {
+        key_vector.resize(2 * key_modulus_size * coeff_count);
+        key_vectors.push_back(key_vector.data());
+    }
+
+    t_target_iter_ptr = js["t_target_iter_ptr"].get<std::vector<uint64_t>>();
+    input = js["input"].get<std::vector<uint64_t>>();
+    expected_output = js["expected_output"].get<std::vector<uint64_t>>();
+}
+
+void KeySwitchTestVector::load_binary(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("cannot open ") + filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error(std::string("cannot stat ") + filename);
+    }
+    uint64_t size = st.st_size;
+    void* addr = nullptr;
+    if (size >= sizeof(KeySwitchTestVectorHeader)) {
+        addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if ((addr == nullptr) || (addr == MAP_FAILED)) {
+        throw std::runtime_error(std::string("cannot map ") + filename);
+    }
+    mapping_ = std::shared_ptr<const void>(
+        addr, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+
+    const uint8_t* base = static_cast<const uint8_t*>(addr);
+    const KeySwitchTestVectorHeader* header =
+        reinterpret_cast<const KeySwitchTestVectorHeader*>(base);
+    if ((memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) ||
+        (header->version != kVersion)) {
+        throw std::runtime_error(std::string("not a test vector file ") +
+                                 filename);
+    }
+    for (auto& array : header->arrays) {
+        if ((array.offset % kAlignment != 0) || (array.offset > size) ||
+            (array.count > (size - array.offset) / sizeof(uint64_t))) {
+            throw std::runtime_error(std::string("truncated test vector ") +
+                                     filename);
+        }
+    }
+
+    coeff_count = header->coeff_count;
+    decomp_modulus_size = header->decomp_modulus_size;
+    key_modulus_size = header->key_modulus_size;
+    rns_modulus_size = header->rns_modulus_size;
+    key_component_count = header->key_component_count;
+
+    // the arrays have the lengths of the shape in the header, the twiddle
+    // factors and the expected output being optional
+    uint64_t key_size = key_component_count * key_modulus_size * coeff_count;
+    uint64_t input_size =
+        key_component_count * decomp_modulus_size * coeff_count;
+    uint64_t counts[KEYSWITCH_NUM_ARRAYS] = {};
+    counts[KEYSWITCH_MODULI] = key_modulus_size;
+    counts[KEYSWITCH_MODSWITCH_FACTORS] = decomp_modulus_size;
+    counts[KEYSWITCH_TWIDDLE_FACTORS] = 4 * key_modulus_size * coeff_count;
+    counts[KEYSWITCH_KEY_VECTOR] = decomp_modulus_size * key_size;
+    counts[KEYSWITCH_T_TARGET_ITER_PTR] = decomp_modulus_size * coeff_count;
+    counts[KEYSWITCH_INPUT] = input_size;
+    counts[KEYSWITCH_EXPECTED_OUTPUT] = input_size;
+    for (int a = 0; a < KEYSWITCH_NUM_ARRAYS; a++) {
+        uint64_t count = header->arrays[a].count;
+        bool optional = (a == KEYSWITCH_TWIDDLE_FACTORS) ||
+                        (a == KEYSWITCH_EXPECTED_OUTPUT);
+        if ((count != counts[a]) && !(optional && (count == 0))) {
+            throw std::runtime_error(
+                std::string("arrays do not match the shape of test vector ") +
+                filename);
+        }
+    }
+
+    auto array = [&](KeySwitchTestVectorArray a) {
+        const uint64_t* begin =
+            reinterpret_cast<const uint64_t*>(base + header->arrays[a].offset);
+        return std::vector<uint64_t>(begin, begin + header->arrays[a].count);
+    };
+    moduli = array(KEYSWITCH_MODULI);
+    modswitch_factors = array(KEYSWITCH_MODSWITCH_FACTORS);
+    twiddle_factors = array(KEYSWITCH_TWIDDLE_FACTORS);
+    t_target_iter_ptr = array(KEYSWITCH_T_TARGET_ITER_PTR);
+    input = array(KEYSWITCH_INPUT);
+    expected_output = array(KEYSWITCH_EXPECTED_OUTPUT);
+
+    // the keys, the bulk of the file, are not copied
+    const uint64_t* keys = reinterpret_cast<const uint64_t*>(
+        base + header->arrays[KEYSWITCH_KEY_VECTOR].offset);
+    for (uint64_t k = 0; k < decomp_modulus_size; k++) {
+        key_vectors.push_back(keys + k * key_size);
+    }
+}
+
+void WriteKeySwitchTestVector(const char* filename,
+                              const KeySwitchTestVector& tv) {
+    write_test_vector(filename, tv, tv.expected_output);
+}
+
+void WriteKeySwitchTestVector(const char* filename,
+                              const KeySwitchVector& tv) {
+    write_test_vector(filename, tv, std::vector<uint64_t>());
+}
+
+std::vector<std::string> GlobTestVectors(const std::string& pattern) {
+    std::vector<std::string> files = glob_files(pattern + ".bin");
+    if (files.empty()) {
+        files = glob_files(pattern + ".json");
+    }
+    return files;
+}
+
+}  // namespace utils
+}  // namespace hetest
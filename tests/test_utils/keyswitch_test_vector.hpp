@@ -0,0 +1,102 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hetest {
+namespace utils {
+
+// Binary KeySwitch test vector: a header with the shape of the operation
+// and the offset and length of each array, followed by the arrays of
+// native uint64_t, each at a 64-byte aligned offset, so that the file can be
+// mapped and its arrays used in place.
+enum KeySwitchTestVectorArray {
+    KEYSWITCH_MODULI,
+    KEYSWITCH_MODSWITCH_FACTORS,
+    KEYSWITCH_TWIDDLE_FACTORS,
+    KEYSWITCH_KEY_VECTOR,
+    KEYSWITCH_T_TARGET_ITER_PTR,
+    KEYSWITCH_INPUT,
+    KEYSWITCH_EXPECTED_OUTPUT,
+    KEYSWITCH_NUM_ARRAYS
+};
+
+struct KeySwitchTestVectorHeader {
+    char magic[8];
+    uint64_t version;
+    uint64_t coeff_count;
+    uint64_t decomp_modulus_size;
+    uint64_t key_modulus_size;
+    uint64_t rns_modulus_size;
+    uint64_t key_component_count;
+    uint64_t reserved[3];
+    // byte offset and number of uint64_t of each array
+    struct {
+        uint64_t offset;
+        uint64_t count;
+    } arrays[KEYSWITCH_NUM_ARRAYS];
+};
+
+static_assert(sizeof(KeySwitchTestVectorHeader) % 64 == 0,
+              "the arrays of a test vector file must stay 64-byte aligned");
+
+// KeySwitch operation read from a test vector file, either the binary
+// container, a .bin file, or the JSON test vector it was converted from.
+// The keys of a binary file are used in place from its mapping, the other
+// arrays are copied. Throws std::runtime_error if the file cannot be read,
+// or if the lengths of its arrays do not match its shape.
+struct KeySwitchTestVector {
+    explicit KeySwitchTestVector(const char* filename);
+
+    // key_vectors points into vectors or the mapping
+    KeySwitchTestVector(const KeySwitchTestVector&) = delete;
+    KeySwitchTestVector& operator=(const KeySwitchTestVector&) = delete;
+    KeySwitchTestVector(KeySwitchTestVector&&) = default;
+    KeySwitchTestVector& operator=(KeySwitchTestVector&&) = default;
+
+    size_t coeff_count;
+    size_t decomp_modulus_size;
+    size_t key_modulus_size;
+    size_t rns_modulus_size;
+    size_t key_component_count;
+
+    std::vector<uint64_t> moduli;
+    std::vector<uint64_t> modswitch_factors;
+    // empty if the test vector has no twiddle factors
+    std::vector<uint64_t> twiddle_factors;
+    std::vector<const uint64_t*> key_vectors;
+
+    std::vector<uint64_t> t_target_iter_ptr;
+    std::vector<uint64_t> input;
+    std::vector<uint64_t> expected_output;
+
+    std::vector<std::vector<uint64_t>> vectors;
+
+private:
+    void load_json(const char* filename);
+    void load_binary(const char* filename);
+
+    std::shared_ptr<const void> mapping_;
+};
+
+struct KeySwitchVector;
+
+// Writes tv as a binary test vector file.
+void WriteKeySwitchTestVector(const char* filename,
+                              const KeySwitchTestVector& tv);
+
+// Writes the generated tv as a binary test vector file, without expected
+// output.
+void WriteKeySwitchTestVector(const char* filename, const KeySwitchVector& tv);
+
+// Returns the binary test vectors matching pattern.bin, or the JSON ones
+// matching pattern.json if there are none.
+std::vector<std::string> GlobTestVectors(const std::string& pattern);
+
+}  // namespace utils
+}  // namespace hetest
@@ -0,0 +1,144 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "test_vectors.hpp"
+
+#include <random>
+
+#include "ntt.hpp"
+
+namespace hetest {
+namespace utils {
+
+namespace {
+
+// n coefficients reduced by modulus
+void RandomLimb(uint64_t* limb, uint64_t n, uint64_t modulus,
+                std::mt19937_64& gen) {
+    std::uniform_int_distribution<uint64_t> distrib(0, modulus - 1);
+    for (uint64_t i = 0; i < n; i++) {
+        limb[i] = distrib(gen);
+    }
+}
+
+// limb i of poly is reduced by moduli[i % moduli.size()]
+std::vector<uint64_t> RandomPoly(uint64_t n, uint64_t limbs,
+                                 const std::vector<uint64_t>& moduli,
+                                 std::mt19937_64& gen) {
+    std::vector<uint64_t> poly(limbs * n);
+    for (uint64_t i = 0; i < limbs; i++) {
+        RandomLimb(&poly[i * n], n, moduli[i % moduli.size()], gen);
+    }
+    return poly;
+}
+
+}  // namespace
+
+void ComputeRootOfUnityPowers(uint64_t m_q, uint64_t m_degree,
+                              uint64_t m_degree_bits, uint64_t m_w,
+                              uint64_t* inv_root_of_unity_powers,
+                              uint64_t* precon64_inv_root_of_unity_powers,
+                              uint64_t* root_of_unity_powers,
+                              uint64_t* precon64_root_of_unity_powers) {
+    std::vector<uint64_t> inv_root_of_unity_powers_pre(m_degree);
+
+    root_of_unity_powers[0] = 1;
+    inv_root_of_unity_powers_pre[0] = 1;
+    uint64_t idx = 0;
+    uint64_t prev_idx = idx;
+
+    for (size_t i = 1; i < m_degree; i++) {
+        idx = ReverseBitsUInt(i, m_degree_bits);
+        root_of_unity_powers[idx] =
+            MultiplyUIntMod(root_of_unity_powers[prev_idx], m_w, m_q);
+        inv_root_of_unity_powers_pre[idx] =
+            InverseUIntMod(root_of_unity_powers[idx], m_q);
+
+        prev_idx = idx;
+    }
+
+    precon64_root_of_unity_powers[0] = 0;
+    for (size_t i = 1; i < m_degree; i++) {
+        precon64_root_of_unity_powers[i] =
+            MultiplyFactor(root_of_unity_powers[i], 64, m_q).BarrettFactor();
+    }
+
+    // the inverse powers in the order the INTT stages consume them
+    idx = 0;
+    for (size_t m = (m_degree >> 1); m > 0; m >>= 1) {
+        for (size_t i = 0; i < m; i++) {
+            inv_root_of_unity_powers[idx] = inv_root_of_unity_powers_pre[m + i];
+            idx++;
+        }
+    }
+
+    inv_root_of_unity_powers[m_degree - 1] = 0;
+
+    for (uint64_t i = 0; i < m_degree; i++) {
+        precon64_inv_root_of_unity_powers[i] =
+            MultiplyFactor(inv_root_of_unity_powers[i], 64, m_q)
+                .BarrettFactor();
+    }
+}
+
+KeySwitchVector::KeySwitchVector(uint64_t coeff_count,
+                                 uint64_t decomp_modulus_size,
+                                 uint64_t key_modulus_size,
+                                 uint64_t modulus_bits, uint64_t seed)
+    : coeff_count(coeff_count),
+      decomp_modulus_size(decomp_modulus_size),
+      key_modulus_size(key_modulus_size),
+      rns_modulus_size(key_modulus_size),
+      key_component_count(2) {
+    UTILS_CHECK(decomp_modulus_size < key_modulus_size,
+                "decomp_modulus_size " << decomp_modulus_size
+                                       << " must be less than key_modulus_size "
+                                       << key_modulus_size);
+    std::mt19937_64 gen(seed);
+    uint64_t n = coeff_count;
+
+    moduli = GeneratePrimes(key_modulus_size, modulus_bits - 1, n);
+    std::vector<uint64_t> decomp_moduli(moduli.begin(),
+                                        moduli.begin() + decomp_modulus_size);
+
+    uint64_t special_prime = moduli.back();
+    for (uint64_t i = 0; i < decomp_modulus_size; i++) {
+        modswitch_factors.push_back(
+            InverseUIntMod(special_prime % moduli[i], moduli[i]));
+    }
+
+    twiddle_factors.resize(4 * n * key_modulus_size);
+    for (uint64_t i = 0; i < key_modulus_size; i++) {
+        uint64_t* twiddles = &twiddle_factors[4 * n * i];
+        ComputeRootOfUnityPowers(
+            moduli[i], n, Log2(n), MinimalPrimitiveRoot(2 * n, moduli[i]),
+            twiddles, twiddles + n, twiddles + 2 * n, twiddles + 3 * n);
+    }
+
+    for (uint64_t k = 0; k < decomp_modulus_size; k++) {
+        vectors.push_back(
+            RandomPoly(n, key_component_count * key_modulus_size, moduli, gen));
+    }
+    for (auto& key : vectors) {
+        key_vectors.push_back(key.data());
+    }
+
+    t_target_iter_ptr = RandomPoly(n, decomp_modulus_size, decomp_moduli, gen);
+    input = RandomPoly(n, key_component_count * decomp_modulus_size,
+                       decomp_moduli, gen);
+}
+
+DyadicMultiplyVector::DyadicMultiplyVector(uint64_t coeff_count,
+                                           uint64_t num_moduli,
+                                           uint64_t modulus_bits,
+                                           uint64_t seed)
+    : coeff_count(coeff_count), num_moduli(num_moduli) {
+    std::mt19937_64 gen(seed);
+
+    moduli = GeneratePrimes(num_moduli, modulus_bits - 1, coeff_count);
+    operand1 = RandomPoly(coeff_count, 2 * num_moduli, moduli, gen);
+    operand2 = RandomPoly(coeff_count, 2 * num_moduli, moduli, gen);
+}
+
+}  // namespace utils
+}  // namespace hetest
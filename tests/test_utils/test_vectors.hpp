@@ -0,0 +1,80 @@
+// Copyright (C) 2020-2022 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace hetest {
+namespace utils {
+
+// Computes the twiddle factors of a KeySwitch key modulus in the layout of
+// the twiddle_factors argument of KeySwitch: the inverse root of unity
+// powers, their 64-bit Barrett factors, the root of unity powers and their
+// 64-bit Barrett factors, m_degree each.
+// @param m_w primitive 2*m_degree'th root of unity modulo m_q
+void ComputeRootOfUnityPowers(uint64_t m_q, uint64_t m_degree,
+                              uint64_t m_degree_bits, uint64_t m_w,
+                              uint64_t* inv_root_of_unity_powers,
+                              uint64_t* precon64_inv_root_of_unity_powers,
+                              uint64_t* root_of_unity_powers,
+                              uint64_t* precon64_root_of_unity_powers);
+
+// Random KeySwitch operation of any shape, generated in memory in place of
+// the KEYSWITCH_DATA_DIR files. The key moduli are NTT friendly primes of
+// modulus_bits bits in increasing order, the last one being the special
+// prime. Keys, input and target are uniform random, limb by limb reduced by
+// their modulus, so the result is valid but has no expected output.
+// The generated vectors of a seed are always the same.
+struct KeySwitchVector {
+    KeySwitchVector(uint64_t coeff_count, uint64_t decomp_modulus_size,
+                    uint64_t key_modulus_size, uint64_t modulus_bits = 50,
+                    uint64_t seed = 0);
+
+    // key_vectors points into vectors
+    KeySwitchVector(const KeySwitchVector&) = delete;
+    KeySwitchVector& operator=(const KeySwitchVector&) = delete;
+    KeySwitchVector(KeySwitchVector&&) = default;
+    KeySwitchVector& operator=(KeySwitchVector&&) = default;
+
+    uint64_t coeff_count;
+    uint64_t decomp_modulus_size;
+    uint64_t key_modulus_size;
+    uint64_t rns_modulus_size;
+    uint64_t key_component_count;
+
+    std::vector<uint64_t> moduli;
+    // inverse of the special prime modulo each of the decomp moduli
+    std::vector<uint64_t> modswitch_factors;
+    // 4 * coeff_count per key modulus
+    std::vector<uint64_t> twiddle_factors;
+    // decomp_modulus_size keys of key_component_count * key_modulus_size
+    // limbs
+    std::vector<const uint64_t*> key_vectors;
+
+    // decomp_modulus_size limbs
+    std::vector<uint64_t> t_target_iter_ptr;
+    // key_component_count * decomp_modulus_size limbs, the result is added
+    // to it
+    std::vector<uint64_t> input;
+
+    std::vector<std::vector<uint64_t>> vectors;
+};
+
+// Random DyadicMultiply operation, the operands of 2 polynomials of
+// num_moduli limbs reduced by NTT friendly primes of modulus_bits bits.
+struct DyadicMultiplyVector {
+    DyadicMultiplyVector(uint64_t coeff_count, uint64_t num_moduli,
+                         uint64_t modulus_bits = 50, uint64_t seed = 0);
+
+    uint64_t coeff_count;
+    uint64_t num_moduli;
+
+    std::vector<uint64_t> moduli;
+    std::vector<uint64_t> operand1;
+    std::vector<uint64_t> operand2;
+};
+
+}  // namespace utils
+}  // namespace hetest